@@ -1,20 +1,235 @@
 #include <stdio.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <stdatomic.h>
 #include "i2c_bsp.h"
 #include "user_config.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// All transactions run on a bus task, taken from one queue per priority level, highest first.
+// A transaction already on the wire is never interrupted, so a touch read waits at most for one
+// lower priority transaction, whose time on the bus is capped by the deadline of its device.
+//
+// A failed transaction puts its device into back-off, during which it fails at once without
+// touching the bus, doubling from EXAMPLE_I2C_BACKOFF_MIN_MS. A timeout also clears the bus, in
+// case SDA is held low, and a touch controller that keeps failing is reset through its RST pin and
+// switched back to normal mode before its next transaction.
+
+static const char *TAG = "i2c_bsp";
 
 static i2c_master_bus_handle_t user_i2c_port0_handle = NULL;
 i2c_master_dev_handle_t disp_touch_dev_handle = NULL;
 i2c_master_dev_handle_t drv2605_dev_handle;
 
-static uint32_t i2c_data_pdMS_TICKS = 0;
-static uint32_t i2c_done_pdMS_TICKS = 0;
+#define I2C_BSP_MAX_DEVS   4
+#define I2C_BSP_QUEUE_LEN  8
+#define I2C_BSP_STACK_SIZE (3 * 1024)
+
+typedef struct
+{
+  i2c_master_dev_handle_t handle;
+  const char *name;
+  i2c_prio_t prio;
+  uint32_t deadline_ms;  // Clock stretching the device may take, the transfer time comes on top
+  uint32_t failures;     // In a row
+  uint32_t backoff_ms;
+  _Atomic int64_t backoff_until_us;  // Set by the bus task, read by the submitters
+  bool reinit;                       // Reset, the init write goes before the next transaction
+  i2c_dev_stats_t stats;
+} i2c_dev_entry_t;
+
+typedef struct
+{
+  i2c_xfer_t xfer;
+  int64_t queued_us;
+} i2c_request_t;
+
+static const char *const prio_names[I2C_PRIO_LEVELS] = {"touch", "haptics", "sensor"};
+
+static i2c_dev_entry_t i2c_devs[I2C_BSP_MAX_DEVS];
+static int i2c_dev_cnt = 0;
+static QueueHandle_t i2c_queues[I2C_PRIO_LEVELS];
+static TaskHandle_t i2c_task = NULL;
+static i2c_prio_stats_t i2c_prio_stats[I2C_PRIO_LEVELS];
+
+static void i2c_add_device(i2c_device_config_t *dev_cfg, const char *name, i2c_prio_t prio, uint32_t deadline_ms, i2c_master_dev_handle_t *handle)
+{
+  ESP_ERROR_CHECK(i2c_master_bus_add_device(user_i2c_port0_handle, dev_cfg, handle));
+  if(i2c_dev_cnt < I2C_BSP_MAX_DEVS)
+  {
+    i2c_devs[i2c_dev_cnt].handle = *handle;
+    i2c_devs[i2c_dev_cnt].name = name;
+    i2c_devs[i2c_dev_cnt].prio = prio;
+    i2c_devs[i2c_dev_cnt].deadline_ms = deadline_ms;
+    i2c_dev_cnt++;
+  }
+}
+
+static i2c_dev_entry_t *i2c_dev_entry(i2c_master_dev_handle_t dev_handle)
+{
+  for(int i = 0; i<i2c_dev_cnt; i++)
+  {
+    if(i2c_devs[i].handle == dev_handle)
+    return &i2c_devs[i];
+  }
+  return NULL;
+}
+
+// Counts a finished transaction against its device
+static void i2c_account(i2c_dev_entry_t *dev, bool read, uint32_t us, esp_err_t ret)
+{
+  if(dev == NULL)
+  return;
+  if(read)
+  dev->stats.reads++;
+  else
+  dev->stats.writes++;
+  if(ret != ESP_OK)
+  dev->stats.errors++;
+  dev->stats.busy_us += us;
+  if(us > dev->stats.max_us)
+  dev->stats.max_us = us;
+}
+
+static esp_err_t i2c_execute(const i2c_xfer_t *x, int timeout_ms)
+{
+  uint8_t addr = (uint8_t)x->reg;
+  if(x->read_len)
+  {
+    if(x->reg != -1)
+    return i2c_master_transmit_receive(x->dev,&addr,1,x->read_buf,x->read_len,timeout_ms);
+    if(x->write_len)
+    return i2c_master_transmit_receive(x->dev,x->write_buf,x->write_len,x->read_buf,x->read_len,timeout_ms);
+    return i2c_master_receive(x->dev,x->read_buf,x->read_len,timeout_ms);
+  }
+  if(x->reg == -1)
+  return i2c_master_transmit(x->dev,x->write_buf,x->write_len,timeout_ms);
+  // The register byte goes out as its own buffer in front of the data, nothing is copied
+  i2c_master_transmit_multi_buffer_info_t parts[2] =
+  {
+    {.write_buffer = &addr, .buffer_size = 1},
+    {.write_buffer = x->write_buf, .buffer_size = x->write_len},
+  };
+  return i2c_master_multi_buffer_transmit(x->dev,parts,x->write_len ? 2 : 1,timeout_ms);
+}
+
+// Deadline of one transaction, the device's allowance plus the bits on the wire at 9 per byte
+static int i2c_deadline_ms(const i2c_dev_entry_t *dev, const i2c_xfer_t *x)
+{
+  const uint32_t bytes = 1 + (x->reg != -1) + x->write_len + (x->read_len ? 1 + x->read_len : 0);
+  const uint32_t wire_ms = (bytes * 9 * 1000 + EXAMPLE_I2C_SPEED_HZ - 1) / EXAMPLE_I2C_SPEED_HZ;
+  return (dev ? dev->deadline_ms : EXAMPLE_I2C_DEADLINE_MS) + wire_ms;
+}
+
+static void i2c_touch_reset(void)
+{
+  gpio_reset_pin(EXAMPLE_PIN_NUM_TOUCH_RST);
+  gpio_set_direction(EXAMPLE_PIN_NUM_TOUCH_RST, GPIO_MODE_OUTPUT);
+  gpio_set_level(EXAMPLE_PIN_NUM_TOUCH_RST, 0);
+  vTaskDelay(pdMS_TO_TICKS(EXAMPLE_I2C_TOUCH_RESET_MS));
+  gpio_set_level(EXAMPLE_PIN_NUM_TOUCH_RST, 1);
+}
+
+// lcd_touch_init() again, on the bus task: the controller comes out of reset in its default mode.
+// Left for the next transaction if the controller doesn't take it yet.
+static void i2c_touch_reinit(i2c_dev_entry_t *dev)
+{
+  uint8_t mode = 0x00;
+  const i2c_xfer_t x = {.dev = dev->handle, .reg = 0x00, .write_buf = &mode, .write_len = 1};
+  const int64_t start = esp_timer_get_time();
+  const esp_err_t ret = i2c_execute(&x, i2c_deadline_ms(dev, &x));
+  i2c_account(dev, false, (uint32_t)(esp_timer_get_time() - start), ret);
+  if(ret == ESP_OK)
+  dev->reinit = false;
+}
+
+static void i2c_health(i2c_dev_entry_t *dev, esp_err_t ret)
+{
+  if(dev == NULL)
+  return;
+  if(ret == ESP_OK)
+  {
+    if(dev->failures)
+    ESP_LOGI(TAG, "%s recovered after %" PRIu32 " failures", dev->name, dev->failures);
+    dev->failures = 0;
+    dev->backoff_ms = 0;
+    return;
+  }
+
+  dev->failures++;
+  uint32_t quiet_ms = 0;
+  // A timeout may be a slave holding SDA low, clocking it out frees the bus for everyone else
+  if(ret == ESP_ERR_TIMEOUT && i2c_master_bus_reset(user_i2c_port0_handle) == ESP_OK)
+  dev->stats.bus_clears++;
+  if(dev->handle == disp_touch_dev_handle && dev->failures % EXAMPLE_I2C_RESET_AFTER == 0)
+  {
+    i2c_touch_reset();
+    dev->stats.resets++;
+    dev->reinit = true;
+    quiet_ms = EXAMPLE_I2C_TOUCH_BOOT_MS;
+  }
+  dev->backoff_ms = dev->backoff_ms ? dev->backoff_ms * 2 : EXAMPLE_I2C_BACKOFF_MIN_MS;
+  if(dev->backoff_ms > EXAMPLE_I2C_BACKOFF_MAX_MS)
+  dev->backoff_ms = EXAMPLE_I2C_BACKOFF_MAX_MS;
+  if(quiet_ms < dev->backoff_ms)
+  quiet_ms = dev->backoff_ms;
+  atomic_store(&dev->backoff_until_us, esp_timer_get_time() + quiet_ms * 1000LL);
+  ESP_LOGW(TAG, "%s failed (%s), %" PRIu32 " in a row, backing off %" PRIu32 " ms", dev->name,
+           esp_err_to_name(ret), dev->failures, quiet_ms);
+}
+
+static bool i2c_next(i2c_prio_t *prio, i2c_request_t *req)
+{
+  for(int p = 0; p<I2C_PRIO_LEVELS; p++)
+  {
+    if(xQueueReceive(i2c_queues[p], req, 0) == pdTRUE)
+    {
+      *prio = (i2c_prio_t)p;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void i2c_bus_task(void *arg)
+{
+  i2c_request_t req;
+  i2c_prio_t prio;
+  while(1)
+  {
+    // One notification per submit, the queues are drained highest priority first
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while(i2c_next(&prio, &req))
+    {
+      i2c_dev_entry_t *dev = i2c_dev_entry(req.xfer.dev);
+      if(dev && dev->reinit && esp_timer_get_time() >= atomic_load(&dev->backoff_until_us))
+      i2c_touch_reinit(dev);
+      const int64_t start = esp_timer_get_time();
+      const esp_err_t ret = i2c_execute(&req.xfer, i2c_deadline_ms(dev, &req.xfer));
+      const int64_t end = esp_timer_get_time();
 
+      i2c_prio_stats_t *ps = &i2c_prio_stats[prio];
+      const uint32_t wait_us = (uint32_t)(start - req.queued_us);
+      ps->completed++;
+      ps->wait_us += wait_us;
+      if(wait_us > ps->wait_max_us)
+      ps->wait_max_us = wait_us;
+      i2c_account(dev, req.xfer.read_len != 0, (uint32_t)(end - start), ret);
+      i2c_health(dev, ret);
+      if(req.xfer.done)
+      req.xfer.done(ret, req.xfer.arg);
+    }
+  }
+}
 
 void i2c_master_Init(void)
 {
-  i2c_data_pdMS_TICKS = pdMS_TO_TICKS(5000);
-  i2c_done_pdMS_TICKS = pdMS_TO_TICKS(1000);
   /*i2c_port 0 init*/
   i2c_master_bus_config_t i2c_bus_config = 
   {
@@ -31,58 +246,128 @@ void i2c_master_Init(void)
   i2c_device_config_t dev_cfg = 
   {
     .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-    .scl_speed_hz = 300000,
+    .scl_speed_hz = EXAMPLE_I2C_SPEED_HZ,
   };
 
   dev_cfg.device_address = EXAMPLE_TOUCH_ADDR;
-  ESP_ERROR_CHECK(i2c_master_bus_add_device(user_i2c_port0_handle, &dev_cfg, &disp_touch_dev_handle));
+  i2c_add_device(&dev_cfg, "touch", I2C_PRIO_TOUCH, EXAMPLE_I2C_TOUCH_DEADLINE_MS, &disp_touch_dev_handle);
+
+  dev_cfg.device_address = EXAMPLE_DRV2605_ADDR;
+  i2c_add_device(&dev_cfg, "drv2605", I2C_PRIO_HAPTICS, EXAMPLE_I2C_DEADLINE_MS, &drv2605_dev_handle);
+
+  for(int p = 0; p<I2C_PRIO_LEVELS; p++)
+  {
+    i2c_queues[p] = xQueueCreate(I2C_BSP_QUEUE_LEN, sizeof(i2c_request_t));
+    assert(i2c_queues[p]);
+  }
+  BaseType_t ok = xTaskCreatePinnedToCore(i2c_bus_task, "i2c", I2C_BSP_STACK_SIZE, NULL,
+                                          EXAMPLE_I2C_TASK_PRIORITY, &i2c_task,
+                                          EXAMPLE_LVGL_TASK_CORE ? 0 : 1);
+  assert(ok == pdPASS);
+  (void)ok;
 }
 
-uint8_t i2c_write_buff(i2c_master_dev_handle_t dev_handle,int reg,uint8_t *buf,uint8_t len)
+esp_err_t i2c_bsp_submit(const i2c_xfer_t *xfer)
 {
-  uint8_t ret;
-  uint8_t *pbuf = NULL;
-  ret = i2c_master_bus_wait_all_done(user_i2c_port0_handle,i2c_done_pdMS_TICKS);
-  if(ret != ESP_OK)
-  return ret;
-  if(reg == -1)
+  i2c_dev_entry_t *dev = i2c_dev_entry(xfer->dev);
+  const i2c_prio_t prio = dev ? dev->prio : I2C_PRIO_SENSOR;
+  if(dev && esp_timer_get_time() < atomic_load(&dev->backoff_until_us))
   {
-    ret = i2c_master_transmit(dev_handle,buf,len,i2c_data_pdMS_TICKS);
+    dev->stats.skipped++;
+    return ESP_ERR_INVALID_STATE;
   }
-  else
+  const i2c_request_t req = {.xfer = *xfer, .queued_us = esp_timer_get_time()};
+  i2c_prio_stats[prio].submitted++;
+  if(xQueueSend(i2c_queues[prio], &req, 0) != pdTRUE)
   {
-    pbuf = (uint8_t*)malloc(len+1);
-    pbuf[0] = reg;
-    for(uint8_t i = 0; i<len; i++)
-    {
-      pbuf[i+1] = buf[i];
-    }
-    ret = i2c_master_transmit(dev_handle,pbuf,len+1,i2c_data_pdMS_TICKS);
-    free(pbuf);
-    pbuf = NULL;
+    i2c_prio_stats[prio].rejected++;
+    return ESP_ERR_NO_MEM;
+  }
+  xTaskNotifyGive(i2c_task);
+  return ESP_OK;
+}
+
+typedef struct
+{
+  SemaphoreHandle_t done;
+  esp_err_t ret;
+} i2c_sync_t;
+
+static void i2c_sync_done(esp_err_t ret, void *arg)
+{
+  i2c_sync_t *sync = (i2c_sync_t *)arg;
+  sync->ret = ret;
+  xSemaphoreGive(sync->done);
+}
+
+// Submits and waits for the bus task, the semaphore lives on the caller's stack
+static esp_err_t i2c_transact(i2c_xfer_t *xfer)
+{
+  StaticSemaphore_t buf;
+  i2c_sync_t sync = {.done = xSemaphoreCreateBinaryStatic(&buf), .ret = ESP_FAIL};
+  xfer->done = i2c_sync_done;
+  xfer->arg = &sync;
+  esp_err_t ret = i2c_bsp_submit(xfer);
+  if(ret == ESP_OK)
+  {
+    xSemaphoreTake(sync.done, portMAX_DELAY);
+    ret = sync.ret;
   }
+  vSemaphoreDelete(sync.done);
   return ret;
 }
+
+uint8_t i2c_write_buff(i2c_master_dev_handle_t dev_handle,int reg,uint8_t *buf,uint8_t len)
+{
+  i2c_xfer_t xfer = {.dev = dev_handle, .reg = reg, .write_buf = buf, .write_len = len};
+  return i2c_transact(&xfer);
+}
 uint8_t i2c_master_write_read_dev(i2c_master_dev_handle_t dev_handle,uint8_t *writeBuf,uint8_t writeLen,uint8_t *readBuf,uint8_t readLen)
 {
-  uint8_t ret;
-  ret = i2c_master_bus_wait_all_done(user_i2c_port0_handle,i2c_done_pdMS_TICKS);
-  if(ret != ESP_OK)
-  return ret;
-  ret = i2c_master_transmit_receive(dev_handle,writeBuf,writeLen,readBuf,readLen,i2c_data_pdMS_TICKS);
-  return ret;
+  i2c_xfer_t xfer = {.dev = dev_handle, .reg = -1, .write_buf = writeBuf, .write_len = writeLen,
+                     .read_buf = readBuf, .read_len = readLen};
+  return i2c_transact(&xfer);
 }
 uint8_t i2c_read_buff(i2c_master_dev_handle_t dev_handle,int reg,uint8_t *buf,uint8_t len)
 {
-  uint8_t ret;
-  uint8_t addr = 0;
-  ret = i2c_master_bus_wait_all_done(user_i2c_port0_handle,i2c_done_pdMS_TICKS);
-  if(ret != ESP_OK)
-  return ret;
-  if( reg == -1 )
-  {ret = i2c_master_receive(dev_handle, buf,len, i2c_data_pdMS_TICKS);}
-  else
-  {addr = (uint8_t)reg; ret = i2c_master_transmit_receive(dev_handle,&addr,1,buf,len,i2c_data_pdMS_TICKS);}
-  return ret;
+  i2c_xfer_t xfer = {.dev = dev_handle, .reg = reg, .read_buf = buf, .read_len = len};
+  return i2c_transact(&xfer);
+}
+
+bool i2c_bsp_get_stats(i2c_master_dev_handle_t dev_handle, i2c_dev_stats_t *stats)
+{
+  const i2c_dev_entry_t *dev = i2c_dev_entry(dev_handle);
+  if(dev == NULL)
+  return false;
+  *stats = dev->stats;
+  return true;
+}
+
+void i2c_bsp_get_prio_stats(i2c_prio_t prio, i2c_prio_stats_t *stats)
+{
+  *stats = i2c_prio_stats[prio];
 }
 
+void i2c_bsp_report(void)
+{
+  for(int i = 0; i<i2c_dev_cnt; i++)
+  {
+    const i2c_dev_stats_t *s = &i2c_devs[i].stats;
+    const uint32_t n = s->reads + s->writes;
+    if(n == 0)
+    continue;
+    ESP_LOGI(TAG, "%-8s %" PRIu32 " reads, %" PRIu32 " writes, %" PRIu32 " errors, %" PRIu64 " us avg, %" PRIu32 " us max",
+             i2c_devs[i].name, s->reads, s->writes, s->errors, s->busy_us / n, s->max_us);
+    if(s->errors)
+    ESP_LOGI(TAG, "%-8s %" PRIu32 " skipped in back-off, %" PRIu32 " bus clears, %" PRIu32 " resets",
+             i2c_devs[i].name, s->skipped, s->bus_clears, s->resets);
+  }
+  for(int p = 0; p<I2C_PRIO_LEVELS; p++)
+  {
+    const i2c_prio_stats_t *s = &i2c_prio_stats[p];
+    if(s->completed == 0)
+    continue;
+    ESP_LOGI(TAG, "%-8s queued %" PRIu64 " us avg, %" PRIu32 " us max, %" PRIu32 " of %" PRIu32 " rejected",
+             prio_names[p], s->wait_us / s->completed, s->wait_max_us, s->rejected, s->submitted);
+  }
+}
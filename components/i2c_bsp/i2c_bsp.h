@@ -9,12 +9,70 @@ extern i2c_master_dev_handle_t drv2605_dev_handle;
 extern "C" {
 #endif
 
+typedef struct
+{
+  uint32_t reads;   // Transactions that read, register reads included
+  uint32_t writes;
+  uint32_t errors;
+  uint32_t max_us;  // Slowest transaction on the bus
+  uint64_t busy_us;
+  uint32_t skipped;     // Transactions refused during back-off, without touching the bus
+  uint32_t bus_clears;  // Bus resets after a timeout
+  uint32_t resets;      // Device resets through its reset pin
+} i2c_dev_stats_t;
+
+// Devices take the priority given by i2c_master_Init(), lower values go first
+typedef enum
+{
+  I2C_PRIO_TOUCH = 0,
+  I2C_PRIO_HAPTICS,
+  I2C_PRIO_SENSOR,
+  I2C_PRIO_LEVELS,
+} i2c_prio_t;
+
+typedef struct
+{
+  uint32_t submitted;
+  uint32_t completed;
+  uint32_t rejected;     // Queue of the level was full
+  uint32_t wait_max_us;  // Longest time from submit to the start on the bus
+  uint64_t wait_us;
+} i2c_prio_stats_t;
+
+// Runs on the bus task once the transaction is over, must not block or transact itself
+typedef void (*i2c_done_cb_t)(esp_err_t ret, void *arg);
+
+// A register read (reg, read_buf), register write (reg, write_buf), plain write or read, or a
+// write followed by a read (reg -1, both buffers). The buffers must stay valid until done.
+typedef struct
+{
+  i2c_master_dev_handle_t dev;
+  int reg;  // -1 for none
+  uint8_t *write_buf;
+  uint8_t write_len;
+  uint8_t *read_buf;
+  uint8_t read_len;
+  i2c_done_cb_t done;  // May be NULL
+  void *arg;
+} i2c_xfer_t;
 
 void i2c_master_Init(void);
+
+// Queues a transaction on the bus task without waiting. ESP_ERR_NO_MEM when the queue of the
+// device's priority is full, ESP_ERR_INVALID_STATE while the device is in back-off after a
+// failure. `done` is not called for either.
+esp_err_t i2c_bsp_submit(const i2c_xfer_t *xfer);
+
+// Blocking helpers, submitted at the priority of the device and waited for
 uint8_t i2c_write_buff(i2c_master_dev_handle_t dev_handle,int reg,uint8_t *buf,uint8_t len);
 uint8_t i2c_master_write_read_dev(i2c_master_dev_handle_t dev_handle,uint8_t *writeBuf,uint8_t writeLen,uint8_t *readBuf,uint8_t readLen);
 uint8_t i2c_read_buff(i2c_master_dev_handle_t dev_handle,int reg,uint8_t *buf,uint8_t len);
 
+// Transaction counters and latency of a device added by i2c_master_Init()
+bool i2c_bsp_get_stats(i2c_master_dev_handle_t dev_handle, i2c_dev_stats_t *stats);
+void i2c_bsp_get_prio_stats(i2c_prio_t prio, i2c_prio_stats_t *stats);
+void i2c_bsp_report(void);
+
 #ifdef __cplusplus
 }
 #endif
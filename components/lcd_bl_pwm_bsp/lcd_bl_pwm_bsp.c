@@ -3,8 +3,12 @@
 #include "esp_err.h"
 #include "driver/ledc.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "user_config.h"
 
+static lcd_bl_fade_end_cb_t fade_end_cb = NULL;
+static void *fade_end_arg = NULL;
+
 void gpio_init(void)
 {
   gpio_config_t gpio_conf = {};
@@ -35,6 +39,7 @@ void lcd_bl_pwm_bsp_init(uint16_t duty)
     .timer_sel = LEDC_TIMER_3,
     .duty = duty,   //占空比
     .hpoint = 0,    //相位
+    .sleep_mode = LEDC_SLEEP_MODE_KEEP_ALIVE, // The panel stays lit in light sleep, on RC_FAST
   };
   ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_timer_config(&timer_conf));
   ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_channel_config(&ledc_conf));
@@ -44,4 +49,34 @@ void setUpduty(uint16_t duty)
 {
   ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, duty));
   ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1));
+}
+
+static bool IRAM_ATTR lcd_bl_fade_isr(const ledc_cb_param_t *param, void *arg)
+{
+  if(param->event != LEDC_FADE_END_EVT || fade_end_cb == NULL)
+  return false;
+  return fade_end_cb(fade_end_arg);
+}
+
+void lcd_bl_pwm_bsp_fade_init(lcd_bl_fade_end_cb_t cb, void *arg)
+{
+  fade_end_cb = cb;
+  fade_end_arg = arg;
+  ledc_cbs_t cbs = {.fade_cb = lcd_bl_fade_isr};
+  ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_fade_func_install(0));
+  ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_cb_register(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, &cbs, NULL));
+}
+
+uint16_t lcd_bl_pwm_bsp_fade(uint16_t duty, uint32_t time_ms)
+{
+  // A fade still running would make the next one wait for it, stop it where it is instead
+  ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_fade_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1));
+  const uint16_t from = ledc_get_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1);
+  ESP_ERROR_CHECK_WITHOUT_ABORT(ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, duty, time_ms, LEDC_FADE_NO_WAIT));
+  return from;
+}
+
+uint16_t lcd_bl_pwm_bsp_get_duty(void)
+{
+  return ledc_get_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1);
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef LCD_BL_PWM_BSP_H
 #define LCD_BL_PWM_BSP_H
 
+#include <stdint.h>
+#include <stdbool.h>
 
 
 #define  LCD_PWM_MODE_0   0
@@ -23,6 +25,16 @@ extern "C" {
 void lcd_bl_pwm_bsp_init(uint16_t duty);
 void setUpduty(uint16_t duty);
 
+// Called from the LEDC interrupt when a hardware fade ends, returns true to yield
+typedef bool (*lcd_bl_fade_end_cb_t)(void *arg);
+
+// Installs the LEDC fade service, after lcd_bl_pwm_bsp_init()
+void lcd_bl_pwm_bsp_fade_init(lcd_bl_fade_end_cb_t cb, void *arg);
+// Fades to `duty` in hardware and returns at once with the duty the fade started from. A fade
+// still running is stopped where it is.
+uint16_t lcd_bl_pwm_bsp_fade(uint16_t duty, uint32_t time_ms);
+uint16_t lcd_bl_pwm_bsp_get_duty(void);
+
 #ifdef __cplusplus
 }
 #endif
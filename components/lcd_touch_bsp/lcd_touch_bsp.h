@@ -1,6 +1,8 @@
 #ifndef LCD_TOUCH_BSP_H
 #define LCD_TOUCH_BSP_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -0,0 +1,214 @@
+// Spotify Web API, the player and library calls the UI needs. All of them go over the one
+// keep-alive connection to the API host in spotify_conn, so after the first call there is no
+// handshake left in them, only the request and the response.
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "spotify_api.h"
+
+static const char* TAG = "spotify_api";
+
+struct spotify_api
+{
+    spotify_conn_t*  conn;
+    spotify_timing_t timing;
+    char             auth[SPOTIFY_API_TOKEN_MAX + 32]; // Authorization header
+};
+
+typedef struct
+{
+    char   data[16];
+    size_t len;
+} spotify_api_small_body_t;
+
+static esp_err_t spotify_api_call(spotify_api_t* api, const char* method, const char* path,
+                                  spotify_body_cb_t cb, void* arg)
+{
+    if (!api->auth[0])
+    {
+        ESP_LOGE(TAG, "%s %s without a token", method, path);
+        return ESP_ERR_INVALID_STATE;
+    }
+    const esp_err_t err =
+        spotify_conn_request(api->conn, method, path, api->auth, NULL, 0, cb, arg, &api->timing);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "%s %s failed (%s)", method, path, esp_err_to_name(err));
+        return err;
+    }
+    const int status = api->timing.status;
+    if (status / 100 == 2)
+        return ESP_OK;
+    ESP_LOGW(TAG, "%s %s: %d %s", method, path, status, spotify_conn_error_body(api->conn));
+    switch (status)
+    {
+    case 401:
+        return ESP_ERR_INVALID_STATE;
+    case 404:
+        return ESP_ERR_NOT_FOUND;
+    default:
+        return ESP_FAIL;
+    }
+}
+
+static esp_err_t spotify_api_callf(spotify_api_t* api, const char* method, spotify_body_cb_t cb,
+                                   void* arg, const char* fmt, ...)
+    __attribute__((format(printf, 5, 6)));
+
+static esp_err_t spotify_api_callf(spotify_api_t* api, const char* method, spotify_body_cb_t cb,
+                                   void* arg, const char* fmt, ...)
+{
+    char    path[SPOTIFY_API_PATH_MAX];
+    va_list args;
+    va_start(args, fmt);
+    const int len = vsnprintf(path, sizeof(path), fmt, args);
+    va_end(args);
+    if (len < 0 || len >= (int) sizeof(path))
+        return ESP_ERR_INVALID_SIZE;
+    return spotify_api_call(api, method, path, cb, arg);
+}
+
+static bool spotify_api_small_body_cb(const char* data, size_t len, void* arg)
+{
+    spotify_api_small_body_t* body = (spotify_api_small_body_t*) arg;
+    size_t                    n    = sizeof(body->data) - 1 - body->len;
+    if (n > len)
+        n = len;
+    memcpy(body->data + body->len, data, n);
+    body->len += n;
+    body->data[body->len] = '\0';
+    return true;
+}
+
+spotify_api_t* spotify_api_create(const spotify_conn_config_t* config)
+{
+    spotify_api_t* api = (spotify_api_t*) calloc(1, sizeof(spotify_api_t));
+    if (!api)
+        return NULL;
+    api->conn = spotify_conn_create(config);
+    if (!api->conn)
+    {
+        free(api);
+        return NULL;
+    }
+    return api;
+}
+
+void spotify_api_destroy(spotify_api_t* api)
+{
+    if (!api)
+        return;
+    spotify_conn_destroy(api->conn);
+    free(api);
+}
+
+esp_err_t spotify_api_set_token(spotify_api_t* api, const char* token)
+{
+    if (strlen(token) >= SPOTIFY_API_TOKEN_MAX)
+        return ESP_ERR_INVALID_SIZE;
+    snprintf(api->auth, sizeof(api->auth), "Authorization: Bearer %s\r\n", token);
+    return ESP_OK;
+}
+
+esp_err_t spotify_api_get_playback(spotify_api_t* api, spotify_body_cb_t cb, void* arg)
+{
+    const esp_err_t err = spotify_api_call(api, "GET", "/v1/me/player", cb, arg);
+    // 204 without an active device
+    if (err == ESP_OK && api->timing.status == 204)
+        return ESP_ERR_NOT_FOUND;
+    return err;
+}
+
+esp_err_t spotify_api_get_queue(spotify_api_t* api, spotify_body_cb_t cb, void* arg)
+{
+    return spotify_api_call(api, "GET", "/v1/me/player/queue", cb, arg);
+}
+
+esp_err_t spotify_api_play(spotify_api_t* api)
+{
+    return spotify_api_call(api, "PUT", "/v1/me/player/play", NULL, NULL);
+}
+
+esp_err_t spotify_api_pause(spotify_api_t* api)
+{
+    return spotify_api_call(api, "PUT", "/v1/me/player/pause", NULL, NULL);
+}
+
+esp_err_t spotify_api_next(spotify_api_t* api)
+{
+    return spotify_api_call(api, "POST", "/v1/me/player/next", NULL, NULL);
+}
+
+esp_err_t spotify_api_previous(spotify_api_t* api)
+{
+    return spotify_api_call(api, "POST", "/v1/me/player/previous", NULL, NULL);
+}
+
+esp_err_t spotify_api_seek(spotify_api_t* api, uint32_t position_ms)
+{
+    return spotify_api_callf(api, "PUT", NULL, NULL, "/v1/me/player/seek?position_ms=%" PRIu32,
+                             position_ms);
+}
+
+esp_err_t spotify_api_set_volume(spotify_api_t* api, uint8_t percent)
+{
+    if (percent > 100)
+        percent = 100;
+    return spotify_api_callf(api, "PUT", NULL, NULL, "/v1/me/player/volume?volume_percent=%u",
+                             percent);
+}
+
+esp_err_t spotify_api_get_saved_tracks(spotify_api_t* api, uint32_t offset, uint32_t limit,
+                                       spotify_body_cb_t cb, void* arg)
+{
+    return spotify_api_callf(api, "GET", cb, arg,
+                             "/v1/me/tracks?offset=%" PRIu32 "&limit=%" PRIu32, offset, limit);
+}
+
+esp_err_t spotify_api_get_playlist_tracks(spotify_api_t* api, const char* playlist_id,
+                                          uint32_t offset, uint32_t limit, spotify_body_cb_t cb,
+                                          void* arg)
+{
+    return spotify_api_callf(api, "GET", cb, arg,
+                             "/v1/playlists/%s/tracks?offset=%" PRIu32 "&limit=%" PRIu32,
+                             playlist_id, offset, limit);
+}
+
+esp_err_t spotify_api_save_track(spotify_api_t* api, const char* track_id, bool save)
+{
+    return spotify_api_callf(api, save ? "PUT" : "DELETE", NULL, NULL, "/v1/me/tracks?ids=%s",
+                             track_id);
+}
+
+esp_err_t spotify_api_is_saved(spotify_api_t* api, const char* track_id, bool* saved)
+{
+    spotify_api_small_body_t body = {0};
+    const esp_err_t          err  = spotify_api_callf(
+        api, "GET", spotify_api_small_body_cb, &body, "/v1/me/tracks/contains?ids=%s", track_id);
+    if (err != ESP_OK)
+        return err;
+    // [true] or [false]
+    const char* value = body.data + strspn(body.data, "[ \t\r\n");
+    *saved            = strncmp(value, "true", 4) == 0;
+    return ESP_OK;
+}
+
+void spotify_api_get_timing(const spotify_api_t* api, spotify_timing_t* timing)
+{
+    *timing = api->timing;
+}
+
+void spotify_api_get_stats(const spotify_api_t* api, spotify_conn_stats_t* stats)
+{
+    spotify_conn_get_stats(api->conn, stats);
+}
+
+void spotify_api_report(const spotify_api_t* api)
+{
+    spotify_conn_report(api->conn);
+}
@@ -0,0 +1,67 @@
+#ifndef SPOTIFY_API_H
+#define SPOTIFY_API_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "spotify_conn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPOTIFY_API_HOST      "api.spotify.com"
+#define SPOTIFY_API_TOKEN_MAX 512
+#define SPOTIFY_API_PATH_MAX  256
+
+// The Spotify Web API over TLS, checked against the certificate bundle. A stand-in server takes a
+// config of its own.
+#define SPOTIFY_API_CONN_CONFIG()                                                                  \
+    {                                                                                              \
+        .host = SPOTIFY_API_HOST, .port = 443, .use_tls = true, .ca_pem = NULL,                    \
+        .timeout_ms = 10000, .idle_ms = 0,                                                         \
+    }
+
+typedef struct spotify_api spotify_api_t;
+
+// Not thread-safe, every call blocks until the response is in. One task makes all of them.
+spotify_api_t* spotify_api_create(const spotify_conn_config_t* config);
+void           spotify_api_destroy(spotify_api_t* api);
+
+// OAuth access token with the user-read-playback-state, user-modify-playback-state,
+// user-library-read and user-library-modify scopes. Getting and refreshing it is up to the caller.
+esp_err_t spotify_api_set_token(spotify_api_t* api, const char* token);
+
+// The calls return ESP_ERR_INVALID_STATE on 401, a token that expired, ESP_ERR_NOT_FOUND on 404,
+// for the player calls no active device, and ESP_FAIL on other errors. The JSON bodies go to `cb`
+// in the chunks they arrive in, spotify_json_body_cb() takes the tracks out of them.
+
+// Player. ESP_ERR_NOT_FOUND from get_playback when nothing plays.
+esp_err_t spotify_api_get_playback(spotify_api_t* api, spotify_body_cb_t cb, void* arg);
+esp_err_t spotify_api_get_queue(spotify_api_t* api, spotify_body_cb_t cb, void* arg);
+esp_err_t spotify_api_play(spotify_api_t* api);
+esp_err_t spotify_api_pause(spotify_api_t* api);
+esp_err_t spotify_api_next(spotify_api_t* api);
+esp_err_t spotify_api_previous(spotify_api_t* api);
+esp_err_t spotify_api_seek(spotify_api_t* api, uint32_t position_ms);
+esp_err_t spotify_api_set_volume(spotify_api_t* api, uint8_t percent);
+
+// Library
+esp_err_t spotify_api_get_saved_tracks(spotify_api_t* api, uint32_t offset, uint32_t limit,
+                                       spotify_body_cb_t cb, void* arg);
+esp_err_t spotify_api_get_playlist_tracks(spotify_api_t* api, const char* playlist_id,
+                                          uint32_t offset, uint32_t limit, spotify_body_cb_t cb,
+                                          void* arg);
+esp_err_t spotify_api_save_track(spotify_api_t* api, const char* track_id, bool save);
+esp_err_t spotify_api_is_saved(spotify_api_t* api, const char* track_id, bool* saved);
+
+// Connect, TLS and response times of the last call
+void spotify_api_get_timing(const spotify_api_t* api, spotify_timing_t* timing);
+void spotify_api_get_stats(const spotify_api_t* api, spotify_conn_stats_t* stats);
+void spotify_api_report(const spotify_api_t* api);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
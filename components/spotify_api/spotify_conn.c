@@ -0,0 +1,691 @@
+// Keep-alive HTTP/1.1 connection to one host, over TLS or plain TCP. A request on a new connection
+// to the Spotify API pays for a DNS lookup, a TCP connect and a TLS handshake, several round trips
+// and the key exchange, before the request itself is even sent. The connection stays open between
+// requests instead and is only opened again when the server closed it. The handshake after that
+// resumes the last TLS session where the server allows it.
+//
+// Only BSD sockets and mbedTLS, so the same code runs on the target and on Linux against a local
+// stand-in for the API, plain or with its own CA in `ca_pem`.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#include "esp_crt_bundle.h"
+#endif
+
+#include "spotify_conn.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static const char* TAG = "spotify_conn";
+
+struct spotify_conn
+{
+    spotify_conn_config_t    config;
+    char                     host[SPOTIFY_CONN_HOST_MAX];
+    char                     authority[SPOTIFY_CONN_HOST_MAX + 6]; // Host header
+    int                      fd;
+    bool                     tls_init;    // RNG, CAs and the SSL context, set up once
+    bool                     tls_up;      // Handshake done on fd
+    bool                     has_session; // To resume
+    bool                     timed_out;   // Last send or receive
+    bool                     sent;        // Whole request written, the server may have acted on it
+    mbedtls_ssl_context      ssl;
+    mbedtls_ssl_config       ssl_conf;
+    mbedtls_ssl_session      session;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_entropy_context  entropy;
+    mbedtls_x509_crt         ca;
+    int64_t                  used_us;     // End of the last request
+    int64_t                  first_rx_us; // First response byte, 0 before it
+    size_t                   rx_pos;
+    size_t                   rx_len;
+    char                     rx[SPOTIFY_CONN_RX_SIZE];
+    char                     tx[SPOTIFY_CONN_TX_SIZE];
+    char                     error[SPOTIFY_CONN_ERROR_SIZE];
+    spotify_conn_stats_t     stats;
+};
+
+typedef struct
+{
+    int    status;
+    bool   keep_alive;
+    bool   chunked;
+    bool   has_length;
+    size_t length;
+} spotify_conn_response_t;
+
+typedef struct
+{
+    spotify_body_cb_t cb;
+    void*             arg;
+    bool              pass;    // 2xx, to the callback. Otherwise kept in error.
+    bool              aborted; // By the callback
+    size_t            bytes;
+    size_t            error_len;
+} spotify_conn_body_t;
+
+// Monotonic, on the target and on Linux
+static int64_t spotify_conn_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int spotify_conn_bio_send(void* ctx, const unsigned char* buf, size_t len)
+{
+    spotify_conn_t* conn = (spotify_conn_t*) ctx;
+    const ssize_t   n    = send(conn->fd, buf, len, MSG_NOSIGNAL);
+    if (n >= 0)
+        return (int) n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+        conn->timed_out = true;
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    return errno == EPIPE || errno == ECONNRESET ? MBEDTLS_ERR_NET_CONN_RESET
+                                                 : MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+static int spotify_conn_bio_recv(void* ctx, unsigned char* buf, size_t len)
+{
+    spotify_conn_t* conn = (spotify_conn_t*) ctx;
+    const ssize_t   n    = recv(conn->fd, buf, len, 0);
+    if (n >= 0)
+        return (int) n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+        conn->timed_out = true;
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    return errno == ECONNRESET ? MBEDTLS_ERR_NET_CONN_RESET : MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+static bool spotify_conn_send(spotify_conn_t* conn, const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        const int n = conn->config.use_tls
+                          ? mbedtls_ssl_write(&conn->ssl, (const unsigned char*) data, len)
+                          : spotify_conn_bio_send(conn, (const unsigned char*) data, len);
+        if (n == MBEDTLS_ERR_SSL_WANT_READ || n == MBEDTLS_ERR_SSL_WANT_WRITE)
+            continue;
+        if (n <= 0)
+        {
+            ESP_LOGD(TAG, "Send failed (-0x%04X)", (unsigned) -n);
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Returns the bytes received, 0 when the peer closed, -1 on errors
+static int spotify_conn_recv(spotify_conn_t* conn, char* buf, size_t len)
+{
+    for (;;)
+    {
+        const int n = conn->config.use_tls
+                          ? mbedtls_ssl_read(&conn->ssl, (unsigned char*) buf, len)
+                          : spotify_conn_bio_recv(conn, (unsigned char*) buf, len);
+        if (n > 0)
+            return n;
+        if (n == 0 || n == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || n == MBEDTLS_ERR_SSL_CONN_EOF)
+            return 0;
+        if (n == MBEDTLS_ERR_SSL_WANT_READ || n == MBEDTLS_ERR_SSL_WANT_WRITE ||
+            n == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET)
+            continue;
+        ESP_LOGD(TAG, "Receive failed (-0x%04X)", (unsigned) -n);
+        return -1;
+    }
+}
+
+static esp_err_t spotify_conn_io_error(const spotify_conn_t* conn)
+{
+    return conn->timed_out ? ESP_ERR_TIMEOUT : ESP_FAIL;
+}
+
+static bool spotify_conn_tls_init(spotify_conn_t* conn)
+{
+    int ret = mbedtls_ctr_drbg_seed(&conn->drbg, mbedtls_entropy_func, &conn->entropy, NULL, 0);
+    if (ret == 0)
+        ret = mbedtls_ssl_config_defaults(&conn->ssl_conf, MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret == 0 && conn->config.ca_pem)
+    {
+        ret = mbedtls_x509_crt_parse(&conn->ca, (const unsigned char*) conn->config.ca_pem,
+                                     strlen(conn->config.ca_pem) + 1);
+        mbedtls_ssl_conf_ca_chain(&conn->ssl_conf, &conn->ca, NULL);
+    }
+    else if (ret == 0)
+    {
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        ret = esp_crt_bundle_attach(&conn->ssl_conf);
+#else
+        ESP_LOGE(TAG, "No certificate bundle, %s needs a ca_pem", conn->host);
+        ret = MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+#endif
+    }
+    if (ret == 0)
+    {
+        mbedtls_ssl_conf_authmode(&conn->ssl_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_rng(&conn->ssl_conf, mbedtls_ctr_drbg_random, &conn->drbg);
+        ret = mbedtls_ssl_setup(&conn->ssl, &conn->ssl_conf);
+    }
+    if (ret == 0)
+        ret = mbedtls_ssl_set_hostname(&conn->ssl, conn->host);
+    if (ret != 0)
+    {
+        ESP_LOGE(TAG, "TLS setup failed (-0x%04X)", (unsigned) -ret);
+        return false;
+    }
+    conn->tls_init = true;
+    return true;
+}
+
+static bool spotify_conn_handshake(spotify_conn_t* conn)
+{
+    if (!conn->tls_init && !spotify_conn_tls_init(conn))
+        return false;
+    mbedtls_ssl_session_reset(&conn->ssl);
+    if (conn->has_session)
+        mbedtls_ssl_set_session(&conn->ssl, &conn->session);
+    mbedtls_ssl_set_bio(&conn->ssl, conn, spotify_conn_bio_send, spotify_conn_bio_recv, NULL);
+
+    int ret;
+    do
+    {
+        ret = mbedtls_ssl_handshake(&conn->ssl);
+    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+    if (ret != 0)
+    {
+        ESP_LOGE(TAG, "TLS handshake with %s failed (-0x%04X)", conn->host, (unsigned) -ret);
+        conn->has_session = false;
+        return false;
+    }
+    conn->tls_up = true;
+
+    // For the next connection, when the server closes this one
+    mbedtls_ssl_session_free(&conn->session);
+    mbedtls_ssl_session_init(&conn->session);
+    conn->has_session = mbedtls_ssl_get_session(&conn->ssl, &conn->session) == 0;
+    return true;
+}
+
+static bool spotify_conn_connect(spotify_conn_t* conn, spotify_timing_t* timing)
+{
+    char port[6];
+    snprintf(port, sizeof(port), "%u", conn->config.port);
+    const struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo*      res   = NULL;
+
+    int64_t   start = spotify_conn_now_us();
+    const int err   = getaddrinfo(conn->host, port, &hints, &res);
+    timing->dns_us  = spotify_conn_now_us() - start;
+    if (err != 0 || !res)
+    {
+        ESP_LOGE(TAG, "DNS lookup of %s failed (%d)", conn->host, err);
+        return false;
+    }
+
+    start                   = spotify_conn_now_us();
+    const struct timeval tv = {.tv_sec  = conn->config.timeout_ms / 1000,
+                               .tv_usec = conn->config.timeout_ms % 1000 * 1000};
+    const int            on = 1;
+    int                  fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd >= 0)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        // Requests are small and wait for their answer
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        if (connect(fd, res->ai_addr, res->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    timing->connect_us = spotify_conn_now_us() - start;
+    if (fd < 0)
+    {
+        ESP_LOGE(TAG, "Connect to %s failed (%d)", conn->authority, errno);
+        return false;
+    }
+    conn->fd     = fd;
+    conn->rx_pos = 0;
+    conn->rx_len = 0;
+    conn->stats.connects++;
+    if (!conn->config.use_tls)
+        return true;
+
+    start               = spotify_conn_now_us();
+    const bool up       = spotify_conn_handshake(conn);
+    timing->tls_us      = spotify_conn_now_us() - start;
+    if (!up)
+        spotify_conn_close(conn);
+    return up;
+}
+
+// A keep-alive connection the server closed while it was idle reads as the end of the stream, or
+// as the close_notify alert before it. Neither takes a request any more.
+static bool spotify_conn_alive(spotify_conn_t* conn)
+{
+    if (conn->fd < 0)
+        return false;
+    if (conn->config.idle_ms > 0 &&
+        spotify_conn_now_us() - conn->used_us > (int64_t) conn->config.idle_ms * 1000)
+        return false;
+    char          c;
+    const ssize_t n = recv(conn->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+// Reads more into the receive buffer, after what is left in it. Returns the bytes read, 0 when the
+// peer closed, -1 on errors and with the buffer full.
+static int spotify_conn_fill(spotify_conn_t* conn)
+{
+    if (conn->rx_pos > 0)
+    {
+        memmove(conn->rx, conn->rx + conn->rx_pos, conn->rx_len - conn->rx_pos);
+        conn->rx_len -= conn->rx_pos;
+        conn->rx_pos = 0;
+    }
+    if (conn->rx_len == sizeof(conn->rx))
+        return -1;
+    const int n = spotify_conn_recv(conn, conn->rx + conn->rx_len, sizeof(conn->rx) - conn->rx_len);
+    if (n > 0)
+    {
+        if (!conn->first_rx_us)
+            conn->first_rx_us = spotify_conn_now_us();
+        conn->rx_len += n;
+    }
+    return n;
+}
+
+// The next line without its CRLF, NUL-terminated in the receive buffer until the next read
+static char* spotify_conn_read_line(spotify_conn_t* conn)
+{
+    for (;;)
+    {
+        char* line = conn->rx + conn->rx_pos;
+        char* end  = (char*) memchr(line, '\n', conn->rx_len - conn->rx_pos);
+        if (end)
+        {
+            conn->rx_pos = end + 1 - conn->rx;
+            if (end > line && end[-1] == '\r')
+                end--;
+            *end = '\0';
+            return line;
+        }
+        if (spotify_conn_fill(conn) <= 0)
+            return NULL;
+    }
+}
+
+static bool spotify_conn_header_is(const char* line, size_t len, const char* name)
+{
+    return strlen(name) == len && strncasecmp(line, name, len) == 0;
+}
+
+static esp_err_t spotify_conn_read_head(spotify_conn_t* conn, spotify_conn_response_t* resp)
+{
+    const char* line = spotify_conn_read_line(conn);
+    if (!line)
+        return spotify_conn_io_error(conn);
+    int minor = 0;
+    if (sscanf(line, "HTTP/1.%d %d", &minor, &resp->status) != 2)
+    {
+        ESP_LOGE(TAG, "Bad status line from %s", conn->host);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    resp->keep_alive = minor >= 1;
+
+    while ((line = spotify_conn_read_line(conn)) && *line)
+    {
+        const char* value = strchr(line, ':');
+        if (!value)
+            continue;
+        const size_t name_len = value - line;
+        value++;
+        while (*value == ' ' || *value == '\t')
+            value++;
+        if (spotify_conn_header_is(line, name_len, "Content-Length"))
+        {
+            resp->length     = strtoul(value, NULL, 10);
+            resp->has_length = true;
+        }
+        else if (spotify_conn_header_is(line, name_len, "Transfer-Encoding"))
+            resp->chunked = strcasecmp(value, "chunked") == 0;
+        else if (spotify_conn_header_is(line, name_len, "Connection"))
+        {
+            if (strcasecmp(value, "close") == 0)
+                resp->keep_alive = false;
+            else if (strcasecmp(value, "keep-alive") == 0)
+                resp->keep_alive = true;
+        }
+    }
+    if (!line)
+    {
+        ESP_LOGE(TAG, "Response head from %s cut off or over %d bytes", conn->host,
+                 SPOTIFY_CONN_RX_SIZE);
+        return spotify_conn_io_error(conn);
+    }
+    return ESP_OK;
+}
+
+static void spotify_conn_deliver(spotify_conn_t* conn, spotify_conn_body_t* body,
+                                 const char* data, size_t len)
+{
+    body->bytes += len;
+    if (body->pass)
+    {
+        if (body->cb && !body->cb(data, len, body->arg))
+            body->aborted = true;
+        return;
+    }
+    size_t n = sizeof(conn->error) - 1 - body->error_len;
+    if (n > len)
+        n = len;
+    memcpy(conn->error + body->error_len, data, n);
+    body->error_len += n;
+    conn->error[body->error_len] = '\0';
+}
+
+// Passes `len` body bytes on, with SIZE_MAX everything up to the end of the stream
+static esp_err_t spotify_conn_read_body(spotify_conn_t* conn, spotify_conn_body_t* body,
+                                        size_t len)
+{
+    while (len > 0 && !body->aborted)
+    {
+        if (conn->rx_pos == conn->rx_len)
+        {
+            conn->rx_pos = 0;
+            conn->rx_len = 0;
+            const int n  = spotify_conn_fill(conn);
+            if (n == 0 && len == SIZE_MAX)
+                return ESP_OK;
+            if (n <= 0)
+            {
+                ESP_LOGE(TAG, "Body from %s cut off", conn->host);
+                return spotify_conn_io_error(conn);
+            }
+        }
+        size_t n = conn->rx_len - conn->rx_pos;
+        if (n > len)
+            n = len;
+        spotify_conn_deliver(conn, body, conn->rx + conn->rx_pos, n);
+        conn->rx_pos += n;
+        if (len != SIZE_MAX)
+            len -= n;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t spotify_conn_read_chunked(spotify_conn_t* conn, spotify_conn_body_t* body)
+{
+    for (;;)
+    {
+        const char* line = spotify_conn_read_line(conn);
+        if (!line)
+            return spotify_conn_io_error(conn);
+        char*               end;
+        const unsigned long size = strtoul(line, &end, 16);
+        if (end == line)
+            return ESP_ERR_INVALID_RESPONSE;
+        if (size == 0)
+            break;
+        const esp_err_t err = spotify_conn_read_body(conn, body, size);
+        if (err != ESP_OK || body->aborted)
+            return err;
+        // The CRLF after the data
+        line = spotify_conn_read_line(conn);
+        if (!line)
+            return spotify_conn_io_error(conn);
+        if (*line)
+            return ESP_ERR_INVALID_RESPONSE;
+    }
+    // Trailers, up to the empty line
+    for (;;)
+    {
+        const char* line = spotify_conn_read_line(conn);
+        if (!line)
+            return spotify_conn_io_error(conn);
+        if (!*line)
+            return ESP_OK;
+    }
+}
+
+// Sending these twice leaves the same state as sending them once. A POST such as next track would
+// skip twice.
+static bool spotify_conn_idempotent(const char* method)
+{
+    return strcmp(method, "GET") == 0 || strcmp(method, "HEAD") == 0 ||
+           strcmp(method, "PUT") == 0 || strcmp(method, "DELETE") == 0;
+}
+
+static esp_err_t spotify_conn_exchange(spotify_conn_t* conn, const char* method, const char* path,
+                                       const char* headers, const char* body, size_t body_len,
+                                       spotify_body_cb_t cb, void* arg, spotify_timing_t* timing)
+{
+    size_t len = snprintf(conn->tx, sizeof(conn->tx), "%s %s HTTP/1.1\r\nHost: %s\r\n%s", method,
+                          path, conn->authority, headers ? headers : "");
+    // Spotify answers a PUT or POST without it with 411
+    if (len < sizeof(conn->tx) && (body_len > 0 || strcmp(method, "GET") != 0))
+        len += snprintf(conn->tx + len, sizeof(conn->tx) - len, "Content-Length: %u\r\n",
+                        (unsigned) body_len);
+    if (len < sizeof(conn->tx))
+        len += snprintf(conn->tx + len, sizeof(conn->tx) - len, "\r\n");
+    if (len >= sizeof(conn->tx))
+    {
+        ESP_LOGE(TAG, "Request head for %s over %d bytes", path, SPOTIFY_CONN_TX_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    conn->timed_out     = false;
+    conn->sent          = false;
+    conn->first_rx_us   = 0;
+    const int64_t start = spotify_conn_now_us();
+    bool          sent;
+    // Small bodies go out with the head, in one segment or TLS record
+    if (body_len <= sizeof(conn->tx) - len)
+    {
+        if (body_len > 0)
+            memcpy(conn->tx + len, body, body_len);
+        sent = spotify_conn_send(conn, conn->tx, len + body_len);
+    }
+    else
+        sent = spotify_conn_send(conn, conn->tx, len) && spotify_conn_send(conn, body, body_len);
+    const int64_t sent_us = spotify_conn_now_us();
+    timing->send_us       = sent_us - start;
+    if (!sent)
+        return spotify_conn_io_error(conn);
+    conn->sent = true;
+
+    spotify_conn_response_t resp;
+    esp_err_t               err;
+    do
+    {
+        memset(&resp, 0, sizeof(resp));
+        err = spotify_conn_read_head(conn, &resp);
+    } while (err == ESP_OK && resp.status >= 100 && resp.status < 200);
+    if (err != ESP_OK)
+        return err;
+    timing->wait_us = conn->first_rx_us - sent_us;
+    timing->status  = resp.status;
+
+    const bool has_body = resp.status != 204 && resp.status != 304 && strcmp(method, "HEAD") != 0;
+
+    spotify_conn_body_t rb = {.cb = cb, .arg = arg, .pass = resp.status / 100 == 2};
+    conn->error[0]         = '\0';
+    if (!has_body)
+        err = ESP_OK;
+    else if (resp.chunked)
+        err = spotify_conn_read_chunked(conn, &rb);
+    else if (resp.has_length)
+        err = spotify_conn_read_body(conn, &rb, resp.length);
+    else
+    {
+        // Delimited by the end of the connection
+        resp.keep_alive = false;
+        err             = spotify_conn_read_body(conn, &rb, SIZE_MAX);
+    }
+    timing->recv_us    = spotify_conn_now_us() - conn->first_rx_us;
+    timing->body_bytes = rb.bytes;
+    if (err == ESP_OK && (!resp.keep_alive || rb.aborted))
+        spotify_conn_close(conn);
+    return err;
+}
+
+spotify_conn_t* spotify_conn_create(const spotify_conn_config_t* config)
+{
+    if (!config->host || strlen(config->host) >= SPOTIFY_CONN_HOST_MAX)
+        return NULL;
+    spotify_conn_t* conn = (spotify_conn_t*) calloc(1, sizeof(spotify_conn_t));
+    if (!conn)
+        return NULL;
+    conn->config = *config;
+    strcpy(conn->host, config->host);
+    conn->config.host = conn->host;
+    if (conn->config.port == (config->use_tls ? 443 : 80))
+        snprintf(conn->authority, sizeof(conn->authority), "%s", conn->host);
+    else
+        snprintf(conn->authority, sizeof(conn->authority), "%s:%u", conn->host, config->port);
+    conn->fd = -1;
+    mbedtls_ssl_init(&conn->ssl);
+    mbedtls_ssl_config_init(&conn->ssl_conf);
+    mbedtls_ssl_session_init(&conn->session);
+    mbedtls_ctr_drbg_init(&conn->drbg);
+    mbedtls_entropy_init(&conn->entropy);
+    mbedtls_x509_crt_init(&conn->ca);
+    return conn;
+}
+
+void spotify_conn_destroy(spotify_conn_t* conn)
+{
+    if (!conn)
+        return;
+    spotify_conn_close(conn);
+    mbedtls_ssl_free(&conn->ssl);
+    mbedtls_ssl_config_free(&conn->ssl_conf);
+    mbedtls_ssl_session_free(&conn->session);
+    mbedtls_ctr_drbg_free(&conn->drbg);
+    mbedtls_entropy_free(&conn->entropy);
+    mbedtls_x509_crt_free(&conn->ca);
+    free(conn);
+}
+
+esp_err_t spotify_conn_request(spotify_conn_t* conn, const char* method, const char* path,
+                               const char* headers, const char* body, size_t body_len,
+                               spotify_body_cb_t cb, void* arg, spotify_timing_t* timing)
+{
+    spotify_timing_t t     = {0};
+    const int64_t    start = spotify_conn_now_us();
+    esp_err_t        err   = ESP_FAIL;
+    conn->stats.requests++;
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        t.reused = spotify_conn_alive(conn);
+        if (!t.reused)
+        {
+            spotify_conn_close(conn);
+            if (!spotify_conn_connect(conn, &t))
+            {
+                err = ESP_FAIL;
+                break;
+            }
+        }
+        err = spotify_conn_exchange(conn, method, path, headers, body, body_len, cb, arg, &t);
+        // Only a reused connection the server closed before it answered is worth another try, and
+        // only when the request did not get through or doing it twice does no harm
+        if (err == ESP_OK || !t.reused || conn->first_rx_us ||
+            (conn->sent && !spotify_conn_idempotent(method)))
+            break;
+        ESP_LOGD(TAG, "%s closed the connection, sending %s again", conn->host, path);
+        conn->stats.retries++;
+        spotify_conn_close(conn);
+    }
+    if (err != ESP_OK)
+    {
+        spotify_conn_close(conn);
+        conn->stats.failures++;
+    }
+    t.total_us    = spotify_conn_now_us() - start;
+    conn->used_us = spotify_conn_now_us();
+
+    if (t.reused)
+        conn->stats.reuses++;
+    conn->stats.dns_us += t.dns_us;
+    conn->stats.connect_us += t.connect_us;
+    conn->stats.tls_us += t.tls_us;
+    conn->stats.wait_us += t.wait_us;
+    conn->stats.total_us += t.total_us;
+    ESP_LOGD(TAG,
+             "%s %s: %d, %s, dns %" PRId64 " connect %" PRId64 " tls %" PRId64 " send %" PRId64
+             " wait %" PRId64 " recv %" PRId64 " total %" PRId64 " us, %u bytes",
+             method, path, t.status, t.reused ? "reused" : "new", t.dns_us, t.connect_us, t.tls_us,
+             t.send_us, t.wait_us, t.recv_us, t.total_us, (unsigned) t.body_bytes);
+    if (timing)
+        *timing = t;
+    return err;
+}
+
+const char* spotify_conn_error_body(const spotify_conn_t* conn)
+{
+    return conn->error;
+}
+
+void spotify_conn_close(spotify_conn_t* conn)
+{
+    if (conn->fd < 0)
+        return;
+    if (conn->tls_up)
+        mbedtls_ssl_close_notify(&conn->ssl);
+    close(conn->fd);
+    conn->fd     = -1;
+    conn->tls_up = false;
+    conn->rx_pos = 0;
+    conn->rx_len = 0;
+}
+
+void spotify_conn_get_stats(const spotify_conn_t* conn, spotify_conn_stats_t* stats)
+{
+    *stats = conn->stats;
+}
+
+void spotify_conn_report(const spotify_conn_t* conn)
+{
+    const spotify_conn_stats_t* s        = &conn->stats;
+    const int64_t               connects = s->connects ? s->connects : 1;
+    const int64_t               requests = s->requests ? s->requests : 1;
+    ESP_LOGI(TAG,
+             "%s: %" PRIu32 " requests, %" PRIu32 " reused, %" PRIu32 " retried, %" PRIu32
+             " failed, %" PRIu32 " connections",
+             conn->authority, s->requests, s->reuses, s->retries, s->failures, s->connects);
+    ESP_LOGI(TAG, "  per connection: dns %" PRId64 " connect %" PRId64 " tls %" PRId64 " us",
+             s->dns_us / connects, s->connect_us / connects, s->tls_us / connects);
+    ESP_LOGI(TAG, "  per request: wait %" PRId64 " total %" PRId64 " us, %" PRId64 " us connecting",
+             s->wait_us / requests, s->total_us / requests,
+             (s->dns_us + s->connect_us + s->tls_us) / requests);
+}
@@ -0,0 +1,86 @@
+#ifndef SPOTIFY_CONN_H
+#define SPOTIFY_CONN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPOTIFY_CONN_HOST_MAX   64
+#define SPOTIFY_CONN_RX_SIZE    2048 // Receive buffer, the response headers have to fit
+#define SPOTIFY_CONN_TX_SIZE    1024 // Request line and headers
+#define SPOTIFY_CONN_ERROR_SIZE 128  // Start of an error body, kept for the log
+
+typedef struct
+{
+    const char* host;
+    uint16_t    port;
+    bool        use_tls;
+    const char* ca_pem;     // Kept by the caller. NULL for the certificate bundle.
+    uint32_t    timeout_ms; // Connect, send and every receive
+    uint32_t    idle_ms;    // Reconnects after this long unused, 0 leaves it to the server
+} spotify_conn_config_t;
+
+// One request. The connect times are 0 when the connection was reused.
+typedef struct
+{
+    bool    reused;
+    int64_t dns_us;
+    int64_t connect_us; // TCP
+    int64_t tls_us;     // Handshake
+    int64_t send_us;    // Request written
+    int64_t wait_us;    // Request written to the first response byte
+    int64_t recv_us;    // First response byte to the end of the body
+    int64_t total_us;
+    int     status;
+    size_t  body_bytes;
+} spotify_timing_t;
+
+typedef struct
+{
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t connects;  // TCP connections opened
+    uint32_t reuses;    // Requests on an open connection
+    uint32_t retries;   // Requests sent again on a new connection, see spotify_conn_request()
+    int64_t  dns_us;    // Sums
+    int64_t  connect_us;
+    int64_t  tls_us;
+    int64_t  wait_us;
+    int64_t  total_us;
+} spotify_conn_stats_t;
+
+// Body bytes as they arrive, only for 2xx responses. Returning false drops the connection.
+typedef bool (*spotify_body_cb_t)(const char* data, size_t len, void* arg);
+
+typedef struct spotify_conn spotify_conn_t;
+
+spotify_conn_t* spotify_conn_create(const spotify_conn_config_t* config);
+void            spotify_conn_destroy(spotify_conn_t* conn);
+
+// Sends one HTTP/1.1 request on the open connection, connecting first without one. A reused
+// connection the server closed meanwhile is reopened and the request sent again, if it could not
+// be written or the method is idempotent (GET, HEAD, PUT, DELETE). A POST the server may have
+// received is not repeated, that fails instead. `headers` are extra header lines, each ending in
+// "\r\n". Returns ESP_OK for any complete response, the status is in `timing`.
+esp_err_t spotify_conn_request(spotify_conn_t* conn, const char* method, const char* path,
+                               const char* headers, const char* body, size_t body_len,
+                               spotify_body_cb_t cb, void* arg, spotify_timing_t* timing);
+
+// The start of the last error body, NUL-terminated
+const char* spotify_conn_error_body(const spotify_conn_t* conn);
+
+void spotify_conn_close(spotify_conn_t* conn);
+
+void spotify_conn_get_stats(const spotify_conn_t* conn, spotify_conn_stats_t* stats);
+void spotify_conn_report(const spotify_conn_t* conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,699 @@
+// Streaming JSON extraction for the Spotify responses. A queue or a page of playlist tracks is tens
+// of kilobytes of nested JSON, and a DOM of it takes several times that in small heap blocks, all
+// to read five fields per track. Here the body is parsed byte by byte as the chunks come off the
+// connection, only the container nesting is kept, and the strings and numbers the UI binds are
+// copied straight into a fixed spotify_track_t. Everything else is skipped without being copied.
+//
+// Which values are kept follows from where they are: the roles below mark the containers on the
+// way to a track, keys are matched only in those.
+
+#include <string.h>
+
+#include "spotify_json.h"
+
+enum
+{
+    SPOTIFY_JSON_VALUE = 0,
+    SPOTIFY_JSON_VALUE_OR_END, // After [
+    SPOTIFY_JSON_KEY_OR_END,   // After {
+    SPOTIFY_JSON_KEY,
+    SPOTIFY_JSON_COLON,
+    SPOTIFY_JSON_AFTER_VALUE,
+    SPOTIFY_JSON_STRING,
+    SPOTIFY_JSON_ESCAPE,
+    SPOTIFY_JSON_UNICODE,
+    SPOTIFY_JSON_NUMBER,
+    SPOTIFY_JSON_LITERAL,
+    SPOTIFY_JSON_DONE,
+    SPOTIFY_JSON_STOPPED,
+    SPOTIFY_JSON_ERROR,
+};
+
+enum
+{
+    SPOTIFY_JSON_ROLE_SKIP = 0,
+    SPOTIFY_JSON_ROLE_ROOT,
+    SPOTIFY_JSON_ROLE_TRACKS, // Array of tracks, the queue
+    SPOTIFY_JSON_ROLE_ITEMS,  // Array of {added_at, track}, saved and playlist tracks
+    SPOTIFY_JSON_ROLE_ITEM,
+    SPOTIFY_JSON_ROLE_TRACK,
+    SPOTIFY_JSON_ROLE_ALBUM,
+    SPOTIFY_JSON_ROLE_IMAGES,
+    SPOTIFY_JSON_ROLE_IMAGE,
+    SPOTIFY_JSON_ROLE_ARTISTS,
+    SPOTIFY_JSON_ROLE_ARTIST,
+};
+
+enum
+{
+    SPOTIFY_JSON_KEY_OTHER = 0,
+    SPOTIFY_JSON_KEY_ITEM,
+    SPOTIFY_JSON_KEY_CURRENTLY_PLAYING,
+    SPOTIFY_JSON_KEY_QUEUE,
+    SPOTIFY_JSON_KEY_ITEMS,
+    SPOTIFY_JSON_KEY_TRACK,
+    SPOTIFY_JSON_KEY_ALBUM,
+    SPOTIFY_JSON_KEY_IMAGES,
+    SPOTIFY_JSON_KEY_ARTISTS,
+    SPOTIFY_JSON_KEY_NAME,
+    SPOTIFY_JSON_KEY_URI,
+    SPOTIFY_JSON_KEY_URL,
+    SPOTIFY_JSON_KEY_WIDTH,
+    SPOTIFY_JSON_KEY_DURATION_MS,
+    SPOTIFY_JSON_KEY_PROGRESS_MS,
+    SPOTIFY_JSON_KEY_IS_PLAYING,
+};
+
+enum
+{
+    SPOTIFY_JSON_TARGET_NONE = 0,
+    SPOTIFY_JSON_TARGET_NAME,
+    SPOTIFY_JSON_TARGET_ARTIST,
+    SPOTIFY_JSON_TARGET_URI,
+    SPOTIFY_JSON_TARGET_URL,
+    SPOTIFY_JSON_TARGET_WIDTH,
+    SPOTIFY_JSON_TARGET_DURATION,
+    SPOTIFY_JSON_TARGET_PROGRESS,
+    SPOTIFY_JSON_TARGET_IS_PLAYING,
+};
+
+typedef struct
+{
+    const char* name;
+    uint8_t     key;
+} spotify_json_key_t;
+
+static const spotify_json_key_t s_keys[] = {
+    {"name", SPOTIFY_JSON_KEY_NAME},
+    {"uri", SPOTIFY_JSON_KEY_URI},
+    {"url", SPOTIFY_JSON_KEY_URL},
+    {"width", SPOTIFY_JSON_KEY_WIDTH},
+    {"duration_ms", SPOTIFY_JSON_KEY_DURATION_MS},
+    {"artists", SPOTIFY_JSON_KEY_ARTISTS},
+    {"album", SPOTIFY_JSON_KEY_ALBUM},
+    {"images", SPOTIFY_JSON_KEY_IMAGES},
+    {"track", SPOTIFY_JSON_KEY_TRACK},
+    {"items", SPOTIFY_JSON_KEY_ITEMS},
+    {"item", SPOTIFY_JSON_KEY_ITEM},
+    {"queue", SPOTIFY_JSON_KEY_QUEUE},
+    {"currently_playing", SPOTIFY_JSON_KEY_CURRENTLY_PLAYING},
+    {"progress_ms", SPOTIFY_JSON_KEY_PROGRESS_MS},
+    {"is_playing", SPOTIFY_JSON_KEY_IS_PLAYING},
+};
+
+static bool spotify_json_is_ws(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static spotify_json_frame_t* spotify_json_top(spotify_json_t* json)
+{
+    return json->depth ? &json->frames[json->depth - 1] : NULL;
+}
+
+static uint8_t spotify_json_child_role(const spotify_json_frame_t* parent, bool array)
+{
+    if (!parent)
+        return array ? SPOTIFY_JSON_ROLE_SKIP : SPOTIFY_JSON_ROLE_ROOT;
+    uint8_t role = SPOTIFY_JSON_ROLE_SKIP;
+    bool    want = false; // Array for the role
+    if (parent->array)
+    {
+        switch (parent->role)
+        {
+        case SPOTIFY_JSON_ROLE_TRACKS:
+            role = SPOTIFY_JSON_ROLE_TRACK;
+            break;
+        case SPOTIFY_JSON_ROLE_ITEMS:
+            role = SPOTIFY_JSON_ROLE_ITEM;
+            break;
+        case SPOTIFY_JSON_ROLE_IMAGES:
+            role = SPOTIFY_JSON_ROLE_IMAGE;
+            break;
+        case SPOTIFY_JSON_ROLE_ARTISTS:
+            role = SPOTIFY_JSON_ROLE_ARTIST;
+            break;
+        }
+        return array ? SPOTIFY_JSON_ROLE_SKIP : role;
+    }
+    switch (parent->role)
+    {
+    case SPOTIFY_JSON_ROLE_ROOT:
+        if (parent->key == SPOTIFY_JSON_KEY_ITEM ||
+            parent->key == SPOTIFY_JSON_KEY_CURRENTLY_PLAYING)
+            role = SPOTIFY_JSON_ROLE_TRACK;
+        else if (parent->key == SPOTIFY_JSON_KEY_QUEUE)
+        {
+            role = SPOTIFY_JSON_ROLE_TRACKS;
+            want = true;
+        }
+        else if (parent->key == SPOTIFY_JSON_KEY_ITEMS)
+        {
+            role = SPOTIFY_JSON_ROLE_ITEMS;
+            want = true;
+        }
+        break;
+    case SPOTIFY_JSON_ROLE_ITEM:
+        if (parent->key == SPOTIFY_JSON_KEY_TRACK)
+            role = SPOTIFY_JSON_ROLE_TRACK;
+        break;
+    case SPOTIFY_JSON_ROLE_TRACK:
+        if (parent->key == SPOTIFY_JSON_KEY_ALBUM)
+            role = SPOTIFY_JSON_ROLE_ALBUM;
+        else if (parent->key == SPOTIFY_JSON_KEY_ARTISTS)
+        {
+            role = SPOTIFY_JSON_ROLE_ARTISTS;
+            want = true;
+        }
+        break;
+    case SPOTIFY_JSON_ROLE_ALBUM:
+        if (parent->key == SPOTIFY_JSON_KEY_IMAGES)
+        {
+            role = SPOTIFY_JSON_ROLE_IMAGES;
+            want = true;
+        }
+        break;
+    }
+    return array == want ? role : SPOTIFY_JSON_ROLE_SKIP;
+}
+
+// What the scalar value starting now is kept as
+static uint8_t spotify_json_target(spotify_json_t* json)
+{
+    const spotify_json_frame_t* top = spotify_json_top(json);
+    if (!top || top->array)
+        return SPOTIFY_JSON_TARGET_NONE;
+    switch (top->role)
+    {
+    case SPOTIFY_JSON_ROLE_ROOT:
+        if (top->key == SPOTIFY_JSON_KEY_PROGRESS_MS)
+            return SPOTIFY_JSON_TARGET_PROGRESS;
+        if (top->key == SPOTIFY_JSON_KEY_IS_PLAYING)
+            return SPOTIFY_JSON_TARGET_IS_PLAYING;
+        break;
+    case SPOTIFY_JSON_ROLE_TRACK:
+        if (top->key == SPOTIFY_JSON_KEY_NAME)
+            return SPOTIFY_JSON_TARGET_NAME;
+        if (top->key == SPOTIFY_JSON_KEY_URI)
+            return SPOTIFY_JSON_TARGET_URI;
+        if (top->key == SPOTIFY_JSON_KEY_DURATION_MS)
+            return SPOTIFY_JSON_TARGET_DURATION;
+        break;
+    case SPOTIFY_JSON_ROLE_ARTIST:
+        if (top->key == SPOTIFY_JSON_KEY_NAME)
+            return SPOTIFY_JSON_TARGET_ARTIST;
+        break;
+    case SPOTIFY_JSON_ROLE_IMAGE:
+        if (top->key == SPOTIFY_JSON_KEY_URL)
+            return SPOTIFY_JSON_TARGET_URL;
+        if (top->key == SPOTIFY_JSON_KEY_WIDTH)
+            return SPOTIFY_JSON_TARGET_WIDTH;
+        break;
+    }
+    return SPOTIFY_JSON_TARGET_NONE;
+}
+
+static bool spotify_json_push(spotify_json_t* json, bool array)
+{
+    if (json->depth == SPOTIFY_JSON_MAX_DEPTH)
+        return false;
+    spotify_json_frame_t* parent = spotify_json_top(json);
+    spotify_json_frame_t* frame  = &json->frames[json->depth++];
+    frame->array                 = array;
+    frame->role                  = spotify_json_child_role(parent, array);
+    frame->key                   = SPOTIFY_JSON_KEY_OTHER;
+    // Arrays count their elements, objects take the index of the element they are in
+    if (array)
+        frame->index = 0;
+    else
+        frame->index = parent && parent->role != SPOTIFY_JSON_ROLE_ROOT ? parent->index : -1;
+    if (frame->role == SPOTIFY_JSON_ROLE_TRACK)
+    {
+        memset(&json->track, 0, sizeof(json->track));
+        json->track.index = frame->index;
+        json->image_width = 0;
+    }
+    else if (frame->role == SPOTIFY_JSON_ROLE_IMAGE)
+    {
+        json->url[0] = '\0';
+        json->width  = 0;
+    }
+    return true;
+}
+
+static void spotify_json_pick_image(spotify_json_t* json)
+{
+    const uint16_t w    = json->width;
+    const uint16_t best = json->image_width;
+    bool           better;
+    if (!json->url[0])
+        return;
+    if (!json->track.image_url[0])
+        better = true;
+    else if (w >= SPOTIFY_JSON_IMAGE_WIDTH)
+        better = best < SPOTIFY_JSON_IMAGE_WIDTH || w < best;
+    else
+        better = best < SPOTIFY_JSON_IMAGE_WIDTH && w > best;
+    if (better)
+    {
+        strcpy(json->track.image_url, json->url);
+        json->image_width = w;
+    }
+}
+
+static void spotify_json_pop(spotify_json_t* json, bool array)
+{
+    spotify_json_frame_t* top = spotify_json_top(json);
+    if (!top || top->array != array)
+    {
+        json->state = SPOTIFY_JSON_ERROR;
+        return;
+    }
+    json->depth--;
+    json->state = json->depth ? SPOTIFY_JSON_AFTER_VALUE : SPOTIFY_JSON_DONE;
+    if (top->role == SPOTIFY_JSON_ROLE_IMAGE)
+        spotify_json_pick_image(json);
+    else if (top->role == SPOTIFY_JSON_ROLE_TRACK)
+    {
+        json->tracks++;
+        if (json->cb && !json->cb(&json->track, json->arg))
+            json->state = SPOTIFY_JSON_STOPPED;
+    }
+}
+
+static void spotify_json_begin_string(spotify_json_t* json)
+{
+    json->out       = NULL;
+    json->out_len   = 0;
+    json->truncated = false;
+    if (json->in_key)
+    {
+        json->out      = json->key;
+        json->out_size = sizeof(json->key);
+    }
+    else
+    {
+        switch (json->target)
+        {
+        case SPOTIFY_JSON_TARGET_NAME:
+            json->out      = json->track.name;
+            json->out_size = sizeof(json->track.name);
+            break;
+        case SPOTIFY_JSON_TARGET_URI:
+            json->out      = json->track.uri;
+            json->out_size = sizeof(json->track.uri);
+            break;
+        case SPOTIFY_JSON_TARGET_URL:
+            json->out      = json->url;
+            json->out_size = sizeof(json->url);
+            break;
+        case SPOTIFY_JSON_TARGET_ARTIST:
+        {
+            size_t len = strlen(json->track.artists);
+            if (len > 0)
+            {
+                // Room for the separator and a few characters
+                if (len + 2 + 4 > sizeof(json->track.artists))
+                    break;
+                memcpy(json->track.artists + len, ", ", 2);
+                len += 2;
+            }
+            json->out      = json->track.artists + len;
+            json->out_size = sizeof(json->track.artists) - len;
+            break;
+        }
+        }
+    }
+    if (json->out)
+        json->out[0] = '\0';
+    json->state = SPOTIFY_JSON_STRING;
+}
+
+// Ends the string kept before a character that doesn't fit, the rest of it is skipped
+static void spotify_json_cut(spotify_json_t* json)
+{
+    json->out[json->out_len] = '\0';
+    json->out                = NULL;
+    json->truncated          = true;
+}
+
+// All `len` bytes of one character
+static void spotify_json_put(spotify_json_t* json, const char* bytes, size_t len)
+{
+    if (!json->out)
+        return;
+    if (json->out_len + len >= json->out_size)
+    {
+        spotify_json_cut(json);
+        return;
+    }
+    memcpy(json->out + json->out_len, bytes, len);
+    json->out_len += len;
+}
+
+// Raw string bytes. A lead byte takes the room of its whole sequence, so the continuations fit.
+static void spotify_json_put_raw(spotify_json_t* json, const char* data, size_t len)
+{
+    for (size_t i = 0; i < len && json->out; i++)
+    {
+        const uint8_t c    = (uint8_t) data[i];
+        const size_t  need = c < 0xC0 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+        if (json->out_len + need >= json->out_size)
+            spotify_json_cut(json);
+        else
+            json->out[json->out_len++] = (char) c;
+    }
+}
+
+static void spotify_json_put_cp(spotify_json_t* json, uint32_t cp)
+{
+    char   utf8[4];
+    size_t len;
+    if (cp < 0x80)
+    {
+        utf8[0] = (char) cp;
+        len     = 1;
+    }
+    else if (cp < 0x800)
+    {
+        utf8[0] = (char) (0xC0 | cp >> 6);
+        utf8[1] = (char) (0x80 | (cp & 0x3F));
+        len     = 2;
+    }
+    else if (cp < 0x10000)
+    {
+        utf8[0] = (char) (0xE0 | cp >> 12);
+        utf8[1] = (char) (0x80 | (cp >> 6 & 0x3F));
+        utf8[2] = (char) (0x80 | (cp & 0x3F));
+        len     = 3;
+    }
+    else
+    {
+        utf8[0] = (char) (0xF0 | cp >> 18);
+        utf8[1] = (char) (0x80 | (cp >> 12 & 0x3F));
+        utf8[2] = (char) (0x80 | (cp >> 6 & 0x3F));
+        utf8[3] = (char) (0x80 | (cp & 0x3F));
+        len     = 4;
+    }
+    spotify_json_put(json, utf8, len);
+}
+
+// A high surrogate not followed by its low half
+static void spotify_json_flush_surrogate(spotify_json_t* json)
+{
+    if (json->high_surrogate)
+    {
+        json->high_surrogate = 0;
+        spotify_json_put_cp(json, 0xFFFD);
+    }
+}
+
+static void spotify_json_unicode(spotify_json_t* json, uint32_t cp)
+{
+    if (cp >= 0xD800 && cp < 0xDC00)
+    {
+        spotify_json_flush_surrogate(json);
+        json->high_surrogate = (uint16_t) cp;
+        return;
+    }
+    if (cp >= 0xDC00 && cp < 0xE000)
+    {
+        if (!json->high_surrogate)
+            cp = 0xFFFD;
+        else
+            cp = 0x10000 + ((uint32_t) (json->high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+        json->high_surrogate = 0;
+    }
+    else
+        spotify_json_flush_surrogate(json);
+    spotify_json_put_cp(json, cp);
+}
+
+static uint8_t spotify_json_key_id(const spotify_json_t* json)
+{
+    if (json->truncated)
+        return SPOTIFY_JSON_KEY_OTHER;
+    for (size_t i = 0; i < sizeof(s_keys) / sizeof(s_keys[0]); i++)
+    {
+        if (strcmp(json->key, s_keys[i].name) == 0)
+            return s_keys[i].key;
+    }
+    return SPOTIFY_JSON_KEY_OTHER;
+}
+
+static void spotify_json_value_end(spotify_json_t* json)
+{
+    json->state = json->depth ? SPOTIFY_JSON_AFTER_VALUE : SPOTIFY_JSON_DONE;
+}
+
+static void spotify_json_end_string(spotify_json_t* json)
+{
+    spotify_json_flush_surrogate(json);
+    if (json->out)
+        json->out[json->out_len] = '\0';
+    if (json->in_key)
+    {
+        spotify_json_top(json)->key = spotify_json_key_id(json);
+        json->in_key                = false;
+        json->state                 = SPOTIFY_JSON_COLON;
+        return;
+    }
+    // A part of a URI or URL is of no use
+    if (json->truncated && json->target == SPOTIFY_JSON_TARGET_URI)
+        json->track.uri[0] = '\0';
+    else if (json->truncated && json->target == SPOTIFY_JSON_TARGET_URL)
+        json->url[0] = '\0';
+    spotify_json_value_end(json);
+}
+
+static void spotify_json_end_number(spotify_json_t* json)
+{
+    switch (json->target)
+    {
+    case SPOTIFY_JSON_TARGET_DURATION:
+        json->track.duration_ms = json->number;
+        break;
+    case SPOTIFY_JSON_TARGET_PROGRESS:
+        json->playback.progress_ms = json->number;
+        break;
+    case SPOTIFY_JSON_TARGET_WIDTH:
+        json->width = json->number > UINT16_MAX ? UINT16_MAX : (uint16_t) json->number;
+        break;
+    }
+    spotify_json_value_end(json);
+}
+
+static void spotify_json_end_literal(spotify_json_t* json)
+{
+    if (json->target == SPOTIFY_JSON_TARGET_IS_PLAYING)
+        json->playback.is_playing = json->literal_true;
+    spotify_json_value_end(json);
+}
+
+static void spotify_json_value(spotify_json_t* json, char c)
+{
+    json->target = spotify_json_target(json);
+    if (c == '{' || c == '[')
+    {
+        if (!spotify_json_push(json, c == '['))
+            json->state = SPOTIFY_JSON_ERROR;
+        else
+            json->state = c == '[' ? SPOTIFY_JSON_VALUE_OR_END : SPOTIFY_JSON_KEY_OR_END;
+    }
+    else if (c == '"')
+        spotify_json_begin_string(json);
+    else if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        json->number   = c == '-' ? 0 : (uint32_t) (c - '0');
+        json->fraction = false;
+        json->state    = SPOTIFY_JSON_NUMBER;
+    }
+    else if (c == 't' || c == 'f' || c == 'n')
+    {
+        json->literal_true = c == 't';
+        json->state        = SPOTIFY_JSON_LITERAL;
+    }
+    else
+        json->state = SPOTIFY_JSON_ERROR;
+}
+
+void spotify_json_init(spotify_json_t* json, spotify_track_cb_t cb, void* arg)
+{
+    memset(json, 0, sizeof(*json));
+    json->cb  = cb;
+    json->arg = arg;
+}
+
+bool spotify_json_feed(spotify_json_t* json, const char* data, size_t len)
+{
+    if (json->state == SPOTIFY_JSON_ERROR || json->state == SPOTIFY_JSON_STOPPED)
+        return false;
+    json->bytes += len;
+    size_t i = 0;
+    while (i < len)
+    {
+        const char c = data[i];
+        switch (json->state)
+        {
+        case SPOTIFY_JSON_STRING:
+        {
+            // Most of the document, the plain runs go in one piece
+            size_t end = i;
+            while (end < len && data[end] != '"' && data[end] != '\\')
+                end++;
+            if (end > i)
+            {
+                spotify_json_flush_surrogate(json);
+                spotify_json_put_raw(json, data + i, end - i);
+            }
+            i = end;
+            if (i < len)
+            {
+                if (data[i] == '"')
+                    spotify_json_end_string(json);
+                else
+                    json->state = SPOTIFY_JSON_ESCAPE;
+                i++;
+            }
+            continue;
+        }
+        case SPOTIFY_JSON_ESCAPE:
+        {
+            static const char escapes[] = "\"\"\\\\//b\bf\fn\nr\rt\t";
+            json->state                 = SPOTIFY_JSON_STRING;
+            if (c == 'u')
+            {
+                json->hex     = 0;
+                json->hex_len = 0;
+                json->state   = SPOTIFY_JSON_UNICODE;
+            }
+            else
+            {
+                const char* e = strchr(escapes, c);
+                if (!c || !e || (e - escapes) % 2)
+                    json->state = SPOTIFY_JSON_ERROR;
+                else
+                    spotify_json_unicode(json, (uint8_t) e[1]);
+            }
+            break;
+        }
+        case SPOTIFY_JSON_UNICODE:
+        {
+            const int digit = c >= '0' && c <= '9'   ? c - '0'
+                              : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                              : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                                     : -1;
+            if (digit < 0)
+            {
+                json->state = SPOTIFY_JSON_ERROR;
+                break;
+            }
+            json->hex = (uint16_t) (json->hex << 4 | digit);
+            if (++json->hex_len == 4)
+            {
+                spotify_json_unicode(json, json->hex);
+                json->state = SPOTIFY_JSON_STRING;
+            }
+            break;
+        }
+        case SPOTIFY_JSON_NUMBER:
+            if (c >= '0' && c <= '9')
+            {
+                if (!json->fraction)
+                    json->number = json->number > (UINT32_MAX - 9) / 10
+                                       ? UINT32_MAX
+                                       : json->number * 10 + (uint32_t) (c - '0');
+            }
+            else if (c == '.' || c == 'e' || c == 'E')
+                json->fraction = true;
+            else if (c != '-' && c != '+')
+            {
+                // Ends with the character after it
+                spotify_json_end_number(json);
+                continue;
+            }
+            break;
+        case SPOTIFY_JSON_LITERAL:
+            if (c < 'a' || c > 'z')
+            {
+                spotify_json_end_literal(json);
+                continue;
+            }
+            break;
+        default:
+            if (spotify_json_is_ws(c))
+                break;
+            switch (json->state)
+            {
+            case SPOTIFY_JSON_VALUE_OR_END:
+                if (c == ']')
+                    spotify_json_pop(json, true);
+                else
+                    spotify_json_value(json, c);
+                break;
+            case SPOTIFY_JSON_VALUE:
+                spotify_json_value(json, c);
+                break;
+            case SPOTIFY_JSON_KEY_OR_END:
+            case SPOTIFY_JSON_KEY:
+                if (c == '}' && json->state == SPOTIFY_JSON_KEY_OR_END)
+                    spotify_json_pop(json, false);
+                else if (c == '"')
+                {
+                    json->in_key = true;
+                    spotify_json_begin_string(json);
+                }
+                else
+                    json->state = SPOTIFY_JSON_ERROR;
+                break;
+            case SPOTIFY_JSON_COLON:
+                json->state = c == ':' ? SPOTIFY_JSON_VALUE : SPOTIFY_JSON_ERROR;
+                break;
+            case SPOTIFY_JSON_AFTER_VALUE:
+                if (c == ',')
+                {
+                    spotify_json_frame_t* top = spotify_json_top(json);
+                    if (top->array)
+                        top->index++;
+                    json->state = top->array ? SPOTIFY_JSON_VALUE : SPOTIFY_JSON_KEY;
+                }
+                else if (c == '}' || c == ']')
+                    spotify_json_pop(json, c == ']');
+                else
+                    json->state = SPOTIFY_JSON_ERROR;
+                break;
+            default:
+                // Only whitespace after the document
+                json->state = SPOTIFY_JSON_ERROR;
+                break;
+            }
+            break;
+        }
+        if (json->state == SPOTIFY_JSON_ERROR || json->state == SPOTIFY_JSON_STOPPED)
+            return false;
+        i++;
+    }
+    return true;
+}
+
+bool spotify_json_body_cb(const char* data, size_t len, void* arg)
+{
+    return spotify_json_feed((spotify_json_t*) arg, data, len);
+}
+
+esp_err_t spotify_json_finish(spotify_json_t* json)
+{
+    // A number is only over at the character after it
+    if (json->depth == 0 && json->state == SPOTIFY_JSON_NUMBER)
+        spotify_json_end_number(json);
+    else if (json->depth == 0 && json->state == SPOTIFY_JSON_LITERAL)
+        spotify_json_end_literal(json);
+    return json->state == SPOTIFY_JSON_DONE || json->state == SPOTIFY_JSON_STOPPED
+               ? ESP_OK
+               : ESP_ERR_INVALID_RESPONSE;
+}
+
+const spotify_playback_t* spotify_json_playback(const spotify_json_t* json)
+{
+    return &json->playback;
+}
@@ -0,0 +1,96 @@
+#ifndef SPOTIFY_JSON_H
+#define SPOTIFY_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPOTIFY_JSON_MAX_DEPTH    16  // Deeper documents are an error
+#define SPOTIFY_JSON_IMAGE_WIDTH  300 // Album art picked: the narrowest at least this wide
+#define SPOTIFY_TRACK_NAME_MAX    64
+#define SPOTIFY_TRACK_ARTISTS_MAX 96
+#define SPOTIFY_TRACK_URI_MAX     40
+#define SPOTIFY_TRACK_IMAGE_MAX   80
+
+typedef struct
+{
+    int16_t  index; // -1 for the track playing, its position in the queue or list otherwise
+    uint32_t duration_ms;
+    char     name[SPOTIFY_TRACK_NAME_MAX];       // UTF-8, cut at a character
+    char     artists[SPOTIFY_TRACK_ARTISTS_MAX]; // Comma separated
+    char     uri[SPOTIFY_TRACK_URI_MAX];         // Empty when it didn't fit
+    char     image_url[SPOTIFY_TRACK_IMAGE_MAX];
+} spotify_track_t;
+
+typedef struct
+{
+    uint32_t progress_ms;
+    bool     is_playing;
+} spotify_playback_t;
+
+// Every track as soon as its object ends. Returning false stops the extraction.
+typedef bool (*spotify_track_cb_t)(const spotify_track_t* track, void* arg);
+
+typedef struct
+{
+    uint8_t role;
+    uint8_t key;   // Last key, in an object
+    bool    array;
+    int16_t index; // Element in an array, the track's index in an object
+} spotify_json_frame_t;
+
+// Everything the extraction needs, no allocations. Static or on the stack, ~600 bytes.
+typedef struct
+{
+    spotify_track_cb_t   cb;
+    void*                arg;
+    uint8_t              state;
+    uint8_t              depth;
+    uint8_t              target; // Where the value being parsed goes
+    bool                 in_key;
+    bool                 fraction;
+    bool                 literal_true;
+    uint8_t              hex_len;
+    uint16_t             hex;
+    uint16_t             high_surrogate;
+    uint32_t             number;
+    char*                out; // String being kept, NULL when skipped
+    size_t               out_len;
+    size_t               out_size;
+    bool                 truncated;
+    uint16_t             width;       // Of the album image being parsed
+    uint16_t             image_width; // Of the one picked
+    char                 url[SPOTIFY_TRACK_IMAGE_MAX];
+    char                 key[24];
+    spotify_json_frame_t frames[SPOTIFY_JSON_MAX_DEPTH];
+    spotify_track_t      track;
+    spotify_playback_t   playback;
+    uint32_t             tracks; // Passed to cb
+    size_t               bytes;
+} spotify_json_t;
+
+// Picks the tracks out of the playback state, queue, saved tracks and playlist tracks responses
+void spotify_json_init(spotify_json_t* json, spotify_track_cb_t cb, void* arg);
+
+// The next chunk of the document, split anywhere. Returns false on an error or once cb stopped.
+bool spotify_json_feed(spotify_json_t* json, const char* data, size_t len);
+
+// As spotify_body_cb_t, with the spotify_json_t as `arg`
+bool spotify_json_body_cb(const char* data, size_t len, void* arg);
+
+// ESP_OK after a complete document or one cb stopped, ESP_ERR_INVALID_RESPONSE otherwise
+esp_err_t spotify_json_finish(spotify_json_t* json);
+
+// progress_ms and is_playing of a playback state response
+const spotify_playback_t* spotify_json_playback(const spotify_json_t* json);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
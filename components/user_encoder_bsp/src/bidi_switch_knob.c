@@ -14,6 +14,10 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "bidi_switch_knob.h"
+#include "user_config.h"
+
+// The PCNT backend lives in bidi_switch_knob_pcnt.c, the GPIO helpers below serve both
+#if !EXAMPLE_ENCODER_USE_PCNT
 
 static const char *TAG = "Knob";
 
@@ -267,6 +271,8 @@ esp_err_t iot_knob_stop(void)
     return ESP_OK;
 }
 
+#endif
+
 esp_err_t knob_gpio_init(uint32_t gpio_num)
 {
     gpio_config_t gpio_cfg = {
@@ -0,0 +1,335 @@
+/*
+ * PCNT backend of the iot_knob API, selected with EXAMPLE_ENCODER_USE_PCNT.
+ *
+ * The knob closes phase A to ground once per detent clockwise and phase B once per detent
+ * counter-clockwise. One PCNT unit counts the falling edges of both phases, A up and B down,
+ * between limits of +-1: every detent reaches a limit, which resets the counter in hardware and
+ * raises the watch point interrupt. Nothing runs while the knob rests.
+ *
+ * A detent counts on the edge that closes the contact, as the knob clicks in. The timer backend
+ * counts it once the contact opens again, however long it was held. Counts and callbacks are the
+ * same, they only come earlier.
+ *
+ * The glitch filter only covers sub-microsecond noise, contact bounce lasts milliseconds. After a
+ * detent its phase is ignored until the contact has read open for DEBOUNCE_TICKS samples, the
+ * same rule the timer backend applies to every sample. host_test/test_knob_pcnt.cpp plays bouncing
+ * waveforms through it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "bidi_switch_knob.h"
+#include "user_config.h"
+
+#if EXAMPLE_ENCODER_USE_PCNT
+
+static const char *TAG = "Knob";
+
+#define TICKS_INTERVAL     1 // ms between contact samples while a phase settles
+#define DEBOUNCE_TICKS     3
+#define GLITCH_FILTER_NS   1000
+#define KNOB_TASK_STACK    (3 * 1024)
+#define KNOB_TASK_PRIORITY 5
+
+#define KNOB_CHECK(a, str, ret_val)                               \
+    if (!(a))                                                     \
+    {                                                             \
+        ESP_LOGE(TAG, "%s(%d): %s", __FUNCTION__, __LINE__, str); \
+        return (ret_val);                                         \
+    }
+
+#define KNOB_CHECK_GOTO(a, str, label)                                         \
+    if (!(a))                                                                  \
+    {                                                                          \
+        ESP_LOGE(TAG, "%s:%d (%s):%s", __FILE__, __LINE__, __FUNCTION__, str); \
+        goto label;                                                            \
+    }
+
+#define CALL_EVENT_CB(ev) \
+    if (knob->cb[ev])     \
+    knob->cb[ev](knob, knob->usr_data[ev])
+
+typedef struct Knob
+{
+    pcnt_unit_handle_t unit;
+    pcnt_channel_handle_t chan[KNOB_EVENT_MAX];
+    uint32_t gpio[KNOB_EVENT_MAX];                  /*!< Phase B for KNOB_LEFT, A for KNOB_RIGHT */
+    volatile bool armed[KNOB_EVENT_MAX];            /*!< Phase settled, its next edge is a detent */
+    volatile uint32_t detents[KNOB_EVENT_MAX];      /*!< Counted in the ISR */
+    uint32_t handled[KNOB_EVENT_MAX];               /*!< Passed on to the callbacks */
+    uint8_t open_ticks[KNOB_EVENT_MAX];             /*!< Samples the contact read open */
+    knob_event_t event;                             /*!< Current event */
+    int count_value;                                /*!< Knob count */
+    void *usr_data[KNOB_EVENT_MAX];                 /*!< User data for event */
+    knob_cb_t cb[KNOB_EVENT_MAX];                   /*!< Event callback */
+    struct Knob *next;                              /*!< Next pointer */
+} knob_dev_t;
+
+static knob_dev_t *s_head_handle = NULL;
+static TaskHandle_t s_knob_task = NULL;
+static bool s_is_running = false;
+
+static bool IRAM_ATTR knob_on_reach(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t *edata,
+                                    void *user_ctx)
+{
+    knob_dev_t *knob = (knob_dev_t *)user_ctx;
+    knob_event_t event = edata->watch_point_value > 0 ? KNOB_RIGHT : KNOB_LEFT;
+    BaseType_t woken = pdFALSE;
+
+    if (knob->armed[event])
+    {
+        knob->armed[event] = false;
+        knob->detents[event]++;
+    }
+    vTaskNotifyGiveFromISR(s_knob_task, &woken);
+    return woken == pdTRUE;
+}
+
+// Hands the counted detents to the callbacks and re-arms phases that settled. Returns whether a
+// phase is still settling.
+static bool knob_handler(knob_dev_t *knob)
+{
+    bool settling = false;
+    for (int ev = 0; ev < KNOB_EVENT_MAX; ev++)
+    {
+        while (knob->handled[ev] != knob->detents[ev])
+        {
+            knob->handled[ev]++;
+            knob->count_value += ev == KNOB_RIGHT ? 1 : -1;
+            knob->event = (knob_event_t)ev;
+            CALL_EVENT_CB(ev);
+        }
+        if (knob->armed[ev])
+            continue;
+        knob->open_ticks[ev] = gpio_get_level(knob->gpio[ev]) ? knob->open_ticks[ev] + 1 : 0;
+        if (knob->open_ticks[ev] >= DEBOUNCE_TICKS)
+        {
+            knob->open_ticks[ev] = 0;
+            knob->armed[ev] = true;
+        }
+        else
+        {
+            settling = true;
+        }
+    }
+    return settling;
+}
+
+static void knob_task(void *arg)
+{
+    bool settling = false;
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, settling ? pdMS_TO_TICKS(TICKS_INTERVAL) : portMAX_DELAY);
+        settling = false;
+        for (knob_dev_t *target = s_head_handle; target; target = target->next)
+        {
+            settling |= knob_handler(target);
+        }
+    }
+}
+
+static esp_err_t knob_new_channel(knob_dev_t *knob, knob_event_t event)
+{
+    pcnt_chan_config_t chan_config = {
+        .edge_gpio_num = knob->gpio[event],
+        .level_gpio_num = -1,
+    };
+    esp_err_t ret = pcnt_new_channel(knob->unit, &chan_config, &knob->chan[event]);
+    if (ret != ESP_OK)
+        return ret;
+    return pcnt_channel_set_edge_action(knob->chan[event], PCNT_CHANNEL_EDGE_ACTION_HOLD,
+                                        event == KNOB_RIGHT ? PCNT_CHANNEL_EDGE_ACTION_INCREASE
+                                                            : PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+}
+
+static void knob_free(knob_dev_t *knob)
+{
+    if (knob->unit)
+    {
+        pcnt_unit_stop(knob->unit);
+        pcnt_unit_disable(knob->unit);
+    }
+    for (int ev = 0; ev < KNOB_EVENT_MAX; ev++)
+    {
+        if (knob->chan[ev])
+            pcnt_del_channel(knob->chan[ev]);
+    }
+    if (knob->unit)
+        pcnt_del_unit(knob->unit);
+    free(knob);
+}
+
+knob_handle_t iot_knob_create(const knob_config_t *config)
+{
+    KNOB_CHECK(NULL != config, "config pointer can't be NULL!", NULL)
+    KNOB_CHECK(config->gpio_encoder_a != config->gpio_encoder_b, "encoder A can't be the same as encoder B", NULL);
+
+    if (!s_knob_task)
+    {
+        BaseType_t ok = xTaskCreate(knob_task, "knob", KNOB_TASK_STACK, NULL, KNOB_TASK_PRIORITY, &s_knob_task);
+        KNOB_CHECK(pdPASS == ok, "knob task create failed", NULL);
+    }
+
+    knob_dev_t *knob = (knob_dev_t *)calloc(1, sizeof(knob_dev_t));
+    KNOB_CHECK(NULL != knob, "alloc knob failed", NULL);
+    knob->gpio[KNOB_RIGHT] = config->gpio_encoder_a;
+    knob->gpio[KNOB_LEFT] = config->gpio_encoder_b;
+    knob->armed[KNOB_RIGHT] = true;
+    knob->armed[KNOB_LEFT] = true;
+    knob->event = KNOB_NONE;
+
+    pcnt_unit_config_t unit_config = {
+        .low_limit = -1,
+        .high_limit = 1,
+    };
+    pcnt_glitch_filter_config_t filter_config = {
+        .max_glitch_ns = GLITCH_FILTER_NS,
+    };
+    pcnt_event_callbacks_t cbs = {
+        .on_reach = knob_on_reach,
+    };
+    esp_err_t ret = pcnt_new_unit(&unit_config, &knob->unit);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt unit create failed", _knob_free);
+    ret = pcnt_unit_set_glitch_filter(knob->unit, &filter_config);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt glitch filter failed", _knob_free);
+    ret = knob_new_channel(knob, KNOB_RIGHT);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "encoder A channel init failed", _knob_free);
+    ret = knob_new_channel(knob, KNOB_LEFT);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "encoder B channel init failed", _knob_free);
+    // Reaching a limit resets the counter, so every detent fires one of these
+    ret = pcnt_unit_add_watch_point(knob->unit, 1);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt watch point failed", _knob_free);
+    ret = pcnt_unit_add_watch_point(knob->unit, -1);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt watch point failed", _knob_free);
+    ret = pcnt_unit_register_event_callbacks(knob->unit, &cbs, knob);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt callback failed", _knob_free);
+
+    // The phases need their pull-ups, the PCNT channels only route the inputs
+    ret = knob_gpio_init(config->gpio_encoder_a);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "encoder A gpio init failed", _knob_free);
+    ret = knob_gpio_init(config->gpio_encoder_b);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "encoder B gpio init failed", _encoder_deinit);
+
+    ret = pcnt_unit_enable(knob->unit);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt enable failed", _encoder_deinit);
+    ret = pcnt_unit_clear_count(knob->unit);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt clear failed", _encoder_deinit);
+    ret = pcnt_unit_start(knob->unit);
+    KNOB_CHECK_GOTO(ESP_OK == ret, "pcnt start failed", _encoder_deinit);
+    s_is_running = true;
+
+    knob->next = s_head_handle;
+    s_head_handle = knob;
+
+    ESP_LOGI(TAG, "Iot Knob Config Succeed (PCNT), encoder A:%d, encoder B:%d", config->gpio_encoder_a, config->gpio_encoder_b);
+    return (knob_handle_t)knob;
+
+_encoder_deinit:
+    knob_gpio_deinit(config->gpio_encoder_b);
+    knob_gpio_deinit(config->gpio_encoder_a);
+_knob_free:
+    knob_free(knob);
+    return NULL;
+}
+
+esp_err_t iot_knob_delete(knob_handle_t knob_handle)
+{
+    KNOB_CHECK(NULL != knob_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    knob_dev_t *knob = (knob_dev_t *)knob_handle;
+    knob_dev_t **curr;
+    for (curr = &s_head_handle; *curr;)
+    {
+        knob_dev_t *entry = *curr;
+        if (entry == knob)
+        {
+            *curr = entry->next;
+        }
+        else
+        {
+            curr = &entry->next;
+        }
+    }
+    knob_gpio_deinit(knob->gpio[KNOB_RIGHT]);
+    knob_gpio_deinit(knob->gpio[KNOB_LEFT]);
+    knob_free(knob);
+    return ESP_OK;
+}
+
+esp_err_t iot_knob_register_cb(knob_handle_t knob_handle, knob_event_t event, knob_cb_t cb, void *usr_data)
+{
+    KNOB_CHECK(NULL != knob_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    KNOB_CHECK(event < KNOB_EVENT_MAX, "event is invalid", ESP_ERR_INVALID_ARG);
+    knob_dev_t *knob = (knob_dev_t *)knob_handle;
+    knob->cb[event] = cb;
+    knob->usr_data[event] = usr_data;
+    return ESP_OK;
+}
+
+esp_err_t iot_knob_unregister_cb(knob_handle_t knob_handle, knob_event_t event)
+{
+    KNOB_CHECK(NULL != knob_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    KNOB_CHECK(event < KNOB_EVENT_MAX, "event is invalid", ESP_ERR_INVALID_ARG);
+    knob_dev_t *knob = (knob_dev_t *)knob_handle;
+    knob->cb[event] = NULL;
+    knob->usr_data[event] = NULL;
+    return ESP_OK;
+}
+
+knob_event_t iot_knob_get_event(knob_handle_t knob_handle)
+{
+    KNOB_CHECK(NULL != knob_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    knob_dev_t *knob = (knob_dev_t *)knob_handle;
+    return knob->event;
+}
+
+int iot_knob_get_count_value(knob_handle_t knob_handle)
+{
+    KNOB_CHECK(NULL != knob_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    knob_dev_t *knob = (knob_dev_t *)knob_handle;
+    return knob->count_value;
+}
+
+esp_err_t iot_knob_clear_count_value(knob_handle_t knob_handle)
+{
+    KNOB_CHECK(NULL != knob_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    knob_dev_t *knob = (knob_dev_t *)knob_handle;
+    knob->count_value = 0;
+    return ESP_OK;
+}
+
+esp_err_t iot_knob_resume(void)
+{
+    KNOB_CHECK(s_head_handle, "no knob created", ESP_ERR_INVALID_STATE);
+    KNOB_CHECK(!s_is_running, "knob is already running", ESP_ERR_INVALID_STATE);
+
+    for (knob_dev_t *target = s_head_handle; target; target = target->next)
+    {
+        esp_err_t err = pcnt_unit_start(target->unit);
+        KNOB_CHECK(ESP_OK == err, "pcnt start failed", ESP_FAIL);
+    }
+    s_is_running = true;
+    return ESP_OK;
+}
+
+esp_err_t iot_knob_stop(void)
+{
+    KNOB_CHECK(s_head_handle, "no knob created", ESP_ERR_INVALID_STATE);
+    KNOB_CHECK(s_is_running, "knob is not running", ESP_ERR_INVALID_STATE);
+
+    for (knob_dev_t *target = s_head_handle; target; target = target->next)
+    {
+        esp_err_t err = pcnt_unit_stop(target->unit);
+        KNOB_CHECK(ESP_OK == err, "pcnt stop failed", ESP_FAIL);
+    }
+    s_is_running = false;
+    return ESP_OK;
+}
+
+#endif
@@ -1,24 +1,39 @@
 #include <stdio.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "user_encoder_bsp.h"
 #include "user_config.h"
 #include "bidi_switch_knob.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
 static const char *TAG = "encoder";
 
 EventGroupHandle_t knob_even_ = NULL;
 
 static knob_handle_t s_knob = 0;
+// The event bits only tell that the knob moved, the delta keeps every detent until it is taken
+static atomic_int_fast32_t s_delta = 0;
+static _Atomic int64_t s_last_us = 0;
+static user_encoder_detent_cb_t s_detent_cb = NULL;
+
 static void _knob_left_cb(void *arg, void *data)
 {
+  atomic_fetch_sub(&s_delta, 1);
+  atomic_store(&s_last_us, esp_timer_get_time());
+  if(s_detent_cb)
+  s_detent_cb(atomic_load(&s_last_us));
   uint8_t eventBits_ = 0;
   SET_BIT(eventBits_,0);
   xEventGroupSetBits(knob_even_,eventBits_);
 }
 static void _knob_right_cb(void *arg, void *data)
 {
+  atomic_fetch_add(&s_delta, 1);
+  atomic_store(&s_last_us, esp_timer_get_time());
+  if(s_detent_cb)
+  s_detent_cb(atomic_load(&s_last_us));
   uint8_t eventBits_ = 0;
   SET_BIT(eventBits_,1);
   xEventGroupSetBits(knob_even_,eventBits_);
@@ -39,4 +54,26 @@ void user_encoder_init(void)
   }
   ESP_ERROR_CHECK(iot_knob_register_cb(s_knob, KNOB_LEFT, _knob_left_cb, NULL));
   ESP_ERROR_CHECK(iot_knob_register_cb(s_knob, KNOB_RIGHT, _knob_right_cb, NULL));
-}
\ No newline at end of file
+}
+
+void user_encoder_take(user_encoder_delta_t *delta)
+{
+  delta->steps = (int32_t)atomic_exchange(&s_delta, 0);
+  delta->last_us = atomic_load(&s_last_us);
+}
+
+void user_encoder_set_detent_cb(user_encoder_detent_cb_t cb)
+{
+  s_detent_cb = cb;
+}
+
+void user_encoder_set_idle(bool idle)
+{
+#if !EXAMPLE_ENCODER_USE_PCNT
+  // The sampling timer would wake the chip every few ms, the PCNT costs nothing at rest
+  if(idle)
+  iot_knob_stop();
+  else
+  iot_knob_resume();
+#endif
+}
@@ -2,6 +2,8 @@
 #ifndef USER_ENCODER_H
 #define USER_ENCODER_H
 
+#include <stdint.h>
+#include <stdbool.h>
 
 extern EventGroupHandle_t knob_even_;
 
@@ -9,8 +11,26 @@ extern EventGroupHandle_t knob_even_;
 extern "C" {
 #endif
 
+typedef struct
+{
+  int32_t steps;   // Detents since the last take, clockwise positive
+  int64_t last_us; // Time of the latest detent, 0 if there never was one
+} user_encoder_delta_t;
+
+// Called from the knob task on every detent, with its time
+typedef void (*user_encoder_detent_cb_t)(int64_t time_us);
+
 void user_encoder_init(void);
 
+// Takes the detents counted since the previous call. Never blocks, and no detent is lost between calls.
+void user_encoder_take(user_encoder_delta_t *delta);
+
+void user_encoder_set_detent_cb(user_encoder_detent_cb_t cb);
+
+// Stops sampling the knob while the UI is idle and the chip may sleep. Only the timer backend
+// samples, with EXAMPLE_ENCODER_USE_PCNT this does nothing.
+void user_encoder_set_idle(bool idle);
+
 #ifdef __cplusplus
 }
 #endif
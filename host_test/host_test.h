@@ -0,0 +1,75 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Checks for the host tests. A failed check is reported and the test goes on, the exit code of
+// host_test_result() tells ctest.
+
+#include <math.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int host_test_failures;
+extern int host_test_checks;
+
+#define CHECK(cond)                                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        host_test_checks++;                                                                        \
+        if (!(cond))                                                                               \
+        {                                                                                          \
+            host_test_failures++;                                                                  \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                        \
+        }                                                                                          \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                             \
+    do                                                                                             \
+    {                                                                                              \
+        const long long _a = (long long) (a);                                                      \
+        const long long _b = (long long) (b);                                                      \
+        host_test_checks++;                                                                        \
+        if (_a != _b)                                                                              \
+        {                                                                                          \
+            host_test_failures++;                                                                  \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b,   \
+                   _a, _b);                                                                        \
+        }                                                                                          \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tol)                                                                      \
+    do                                                                                             \
+    {                                                                                              \
+        const double _a = (double) (a);                                                            \
+        const double _b = (double) (b);                                                            \
+        host_test_checks++;                                                                        \
+        if (fabs(_a - _b) > (tol))                                                                 \
+        {                                                                                          \
+            host_test_failures++;                                                                  \
+            printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, _a, \
+                   _b);                                                                            \
+        }                                                                                          \
+    } while (0)
+
+#define RUN_TEST(fn)                                                                               \
+    do                                                                                             \
+    {                                                                                              \
+        const int _before = host_test_failures;                                                    \
+        fn();                                                                                      \
+        printf("%s %s\n", host_test_failures == _before ? "PASS" : "FAIL", #fn);                   \
+    } while (0)
+
+// Exit code for main()
+static inline int host_test_result(void)
+{
+    printf("%d checks, %d failed\n", host_test_checks, host_test_failures);
+    return host_test_failures ? 1 : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+# Local stand-in for the Spotify API host, for test_spotify_conn. Keep-alive HTTP/1.1, plain or
+# with --tls over certs/server.pem, which certs/ca.pem signed. Binds a free port on localhost and
+# prints it, then serves until killed.
+#
+#   /drop...      The first time this path comes in the connection is closed without an answer,
+#                 like a keep-alive connection the server timed out just as the request arrived.
+#                 Answered after that.
+#   /seen?path=P  How many times P came in, counting the dropped ones
+#   anything else 200 with "{}"
+
+import os
+import socket
+import ssl
+import sys
+import threading
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+seen = {}
+lock = threading.Lock()
+
+
+def read_request(conn, buf):
+    while b"\r\n\r\n" not in buf:
+        data = conn.recv(4096)
+        if not data:
+            return None, None, buf
+        buf += data
+    head, buf = buf.split(b"\r\n\r\n", 1)
+    lines = head.decode().split("\r\n")
+    method, path, _ = lines[0].split(" ")
+    length = 0
+    for line in lines[1:]:
+        name, _, value = line.partition(":")
+        if name.strip().lower() == "content-length":
+            length = int(value)
+    while len(buf) < length:
+        data = conn.recv(4096)
+        if not data:
+            return None, None, buf
+        buf += data
+    return method, path, buf[length:]
+
+
+def answer(conn, body):
+    conn.sendall(b"HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n%s" % (len(body), body))
+
+
+def serve(conn):
+    buf = b""
+    try:
+        while True:
+            method, path, buf = read_request(conn, buf)
+            if not method:
+                return
+            with lock:
+                seen[path] = seen.get(path, 0) + 1
+                count = seen[path]
+            if path.startswith("/seen?path="):
+                with lock:
+                    answer(conn, b"%d" % seen.get(path[len("/seen?path="):], 0))
+            elif path.startswith("/drop") and count == 1:
+                return
+            else:
+                answer(conn, b"{}")
+    except (OSError, ssl.SSLError):
+        pass
+    finally:
+        conn.close()
+
+
+def main():
+    context = None
+    if "--tls" in sys.argv:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        # What the mbedTLS of the target negotiates
+        context.maximum_version = ssl.TLSVersion.TLSv1_2
+        context.load_cert_chain(os.path.join(HERE, "certs/server.pem"),
+                                os.path.join(HERE, "certs/server.key"))
+    # localhost may resolve to either
+    try:
+        server = socket.create_server(("::", 0), family=socket.AF_INET6, dualstack_ipv6=True)
+    except (OSError, ValueError):
+        server = socket.create_server(("127.0.0.1", 0))
+    server.listen()
+    print(server.getsockname()[1], flush=True)
+    while True:
+        conn, _ = server.accept()
+        try:
+            if context:
+                conn = context.wrap_socket(conn, server_side=True)
+        except (OSError, ssl.SSLError):
+            conn.close()
+            continue
+        threading.Thread(target=serve, args=(conn,), daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()
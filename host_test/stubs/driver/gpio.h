@@ -0,0 +1,93 @@
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    GPIO_NUM_NC  = -1,
+    GPIO_NUM_0   = 0,
+    GPIO_NUM_9   = 9,
+    GPIO_NUM_10  = 10,
+    GPIO_NUM_11  = 11,
+    GPIO_NUM_12  = 12,
+    GPIO_NUM_MAX = 49,
+} gpio_num_t;
+
+typedef enum
+{
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+typedef enum
+{
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum
+{
+    GPIO_PULLDOWN_DISABLE = 0,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef enum
+{
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+typedef struct
+{
+    uint64_t        pin_bit_mask;
+    gpio_mode_t     mode;
+    gpio_pullup_t   pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void* arg);
+
+esp_err_t gpio_config(const gpio_config_t* config);
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num);
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int       gpio_get_level(gpio_num_t gpio_num);
+esp_err_t gpio_install_isr_service(int flags);
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr, void* arg);
+
+// Host helpers: the pins are plain records, an edge calls the handler the driver code added
+typedef struct
+{
+    gpio_mode_t     mode;
+    gpio_int_type_t intr_type;
+    uint32_t        level;
+    uint32_t        writes;     // gpio_set_level() calls
+    int64_t         changed_us; // host_time_us of the last one
+    gpio_isr_t      isr;
+    void*           isr_arg;
+} host_gpio_t;
+
+extern host_gpio_t host_gpio[GPIO_NUM_MAX];
+extern esp_err_t   host_gpio_isr_service_err; // What gpio_install_isr_service() returns
+
+void host_gpio_reset(void);
+bool host_gpio_fire(gpio_num_t gpio_num); // False when no handler was added
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef DRIVER_PULSE_CNT_H
+#define DRIVER_PULSE_CNT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_pcnt_unit* pcnt_unit_handle_t;
+typedef struct host_pcnt_chan* pcnt_channel_handle_t;
+
+typedef struct
+{
+    int low_limit;
+    int high_limit;
+    int intr_priority;
+} pcnt_unit_config_t;
+
+typedef struct
+{
+    int edge_gpio_num;
+    int level_gpio_num;
+} pcnt_chan_config_t;
+
+typedef struct
+{
+    uint32_t max_glitch_ns;
+} pcnt_glitch_filter_config_t;
+
+typedef enum
+{
+    PCNT_CHANNEL_EDGE_ACTION_HOLD = 0,
+    PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+    PCNT_CHANNEL_EDGE_ACTION_DECREASE,
+} pcnt_channel_edge_action_t;
+
+typedef struct
+{
+    int watch_point_value;
+} pcnt_watch_event_data_t;
+
+typedef bool (*pcnt_watch_cb_t)(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t* edata,
+                                void* user_ctx);
+
+typedef struct
+{
+    pcnt_watch_cb_t on_reach;
+} pcnt_event_callbacks_t;
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t* config, pcnt_unit_handle_t* ret_unit);
+esp_err_t pcnt_del_unit(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit,
+                                      const pcnt_glitch_filter_config_t* config);
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_disable(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_stop(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit);
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int* value);
+esp_err_t pcnt_unit_add_watch_point(pcnt_unit_handle_t unit, int watch_point);
+esp_err_t pcnt_unit_register_event_callbacks(pcnt_unit_handle_t unit,
+                                             const pcnt_event_callbacks_t* cbs, void* user_data);
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t* config,
+                           pcnt_channel_handle_t* ret_chan);
+esp_err_t pcnt_del_channel(pcnt_channel_handle_t chan);
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan,
+                                       pcnt_channel_edge_action_t pos_act,
+                                       pcnt_channel_edge_action_t neg_act);
+
+// Host helpers. The input level goes to the GPIO record and through the channels of the running
+// units routed to the pin: the counter moves, resets at its limits and calls on_reach at watch
+// points, in the caller's context like the ISR. The glitch filter is not modelled, drop pulses
+// shorter than host_pcnt_glitch_ns() from the waveform instead.
+void     host_pcnt_input(int gpio_num, int level);
+uint32_t host_pcnt_glitch_ns(void);
+uint32_t host_pcnt_units(void); // Created and not deleted
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
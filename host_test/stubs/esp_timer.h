@@ -0,0 +1,24 @@
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_timer* esp_timer_handle_t;
+
+// Host clock, only moves when a test moves it
+extern int64_t host_time_us;
+
+static inline int64_t esp_timer_get_time(void)
+{
+    return host_time_us;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
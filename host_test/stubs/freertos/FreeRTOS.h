@@ -0,0 +1,56 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+// FreeRTOS on the host: every task is a thread, but only one of them or the test runs at a time.
+// Tasks run when the test lets the scheduler go (host_freertos_run(), host_freertos_advance()) or
+// blocks itself, and until they block. Time is host_time_us and only moves at those points, so a
+// run is the same every time. There is no preemption, a task that unblocks a higher priority one
+// keeps running until it blocks.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY      ((TickType_t) 0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms)  ((TickType_t) ((uint64_t) (ms) * configTICK_RATE_HZ / 1000))
+#define pdTICKS_TO_MS(t)   ((uint32_t) ((uint64_t) (t) * 1000 / configTICK_RATE_HZ))
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  1
+#define pdFAIL  0
+
+#define portYIELD_FROM_ISR(woken) ((void) (woken))
+#define portENTER_CRITICAL(mux)   ((void) (mux))
+#define portEXIT_CRITICAL(mux)    ((void) (mux))
+
+typedef struct
+{
+    int owner;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+// Runs every task that can run, at the current time, until all of them block
+void host_freertos_run(void);
+
+// Moves host_time_us forward by `us`, running the tasks whose timeouts expire on the way
+void host_freertos_advance(int64_t us);
+
+// Ends every task and frees the objects, for the next test
+void host_freertos_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,585 @@
+// FreeRTOS tasks, notifications, queues and semaphores on host threads, in lockstep with the test.
+// A task only runs while s_running points at it, everything else waits on s_cond. The test thread
+// is the scheduler: it picks the task to run and waits until that task blocks again.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define HOST_TASKS  16
+#define HOST_QUEUES 32
+
+#define HOST_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+typedef enum
+{
+    WAIT_NONE = 0, // Ready to run
+    WAIT_NOTIFY_TAKE,
+    WAIT_NOTIFY_WAIT,
+    WAIT_RECEIVE,
+    WAIT_SEND,
+    WAIT_DELAY,
+    WAIT_SUSPENDED,
+    WAIT_DONE,
+} host_wait_t;
+
+struct host_task
+{
+    pthread_t          thread;
+    TaskFunction_t     fn;
+    void*              arg;
+    char               name[16];
+    UBaseType_t        prio;
+    uint32_t           notify;
+    bool               notified; // Pending notification for xTaskNotifyWait()
+    host_wait_t        wait;
+    struct host_queue* queue;
+    int64_t            timeout_us; // INT64_MAX while blocked forever
+    bool               exit;       // Ended by host_freertos_reset()
+};
+
+struct host_queue
+{
+    uint8_t*    items; // NULL for semaphores
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    bool        is_static; // Lives no longer than the caller's buffer, freed when deleted
+};
+
+static pthread_mutex_t            s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t             s_cond = PTHREAD_COND_INITIALIZER;
+static struct host_task*          s_running; // NULL while the test thread runs
+static struct host_task*          s_tasks[HOST_TASKS];
+static int                        s_task_cnt;
+static struct host_queue*         s_queues[HOST_QUEUES];
+static int                        s_queue_cnt;
+static __thread struct host_task* s_self;
+
+static void host_fatal(const char* what)
+{
+    printf("freertos stub: %s\n", what);
+    abort();
+}
+
+static bool host_wait_over(const struct host_task* t, host_wait_t wait,
+                           const struct host_queue* q)
+{
+    switch (wait)
+    {
+        case WAIT_NONE:
+            return true;
+        case WAIT_NOTIFY_TAKE:
+            return t->notify > 0;
+        case WAIT_NOTIFY_WAIT:
+            return t->notified;
+        case WAIT_RECEIVE:
+            return q->count > 0;
+        case WAIT_SEND:
+            return q->count < q->length;
+        default:
+            return false;
+    }
+}
+
+static bool host_can_run(const struct host_task* t)
+{
+    if (t->wait == WAIT_DONE || t->wait == WAIT_SUSPENDED)
+        return false;
+    return host_wait_over(t, t->wait, t->queue) || t->timeout_us <= host_time_us;
+}
+
+// Called by a task with the lock held, returns once the scheduler picked it again
+static void host_park(struct host_task* self)
+{
+    s_running = NULL;
+    pthread_cond_broadcast(&s_cond);
+    while (s_running != self)
+        pthread_cond_wait(&s_cond, &s_lock);
+    if (self->exit)
+    {
+        self->wait = WAIT_DONE;
+        s_running  = NULL;
+        pthread_cond_broadcast(&s_cond);
+        pthread_mutex_unlock(&s_lock);
+        pthread_exit(NULL);
+    }
+}
+
+// Called by the test thread with the lock held, returns once the task blocked again
+static void host_switch_to(struct host_task* t)
+{
+    s_running = t;
+    pthread_cond_broadcast(&s_cond);
+    while (s_running != NULL)
+        pthread_cond_wait(&s_cond, &s_lock);
+}
+
+// Runs the highest priority task that can run. False when there is none.
+static bool host_run_one(void)
+{
+    struct host_task* best = NULL;
+    for (int i = 0; i < s_task_cnt; i++)
+    {
+        if (host_can_run(s_tasks[i]) && (!best || s_tasks[i]->prio > best->prio))
+            best = s_tasks[i];
+    }
+    if (!best)
+        return false;
+    host_switch_to(best);
+    return true;
+}
+
+static int64_t host_next_timeout(void)
+{
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < s_task_cnt; i++)
+    {
+        if (s_tasks[i]->wait != WAIT_DONE && s_tasks[i]->wait != WAIT_SUSPENDED &&
+            s_tasks[i]->timeout_us < next)
+            next = s_tasks[i]->timeout_us;
+    }
+    return next;
+}
+
+static int64_t host_timeout(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+        return INT64_MAX;
+    return host_time_us + (int64_t) pdTICKS_TO_MS(ticks) * 1000;
+}
+
+// Blocks the caller until `wait` is over or `ticks` passed, with the lock held. A task parks, the
+// test thread runs the scheduler instead. Returns false on a timeout.
+static bool host_block(host_wait_t wait, struct host_queue* q, TickType_t ticks)
+{
+    struct host_task* self = s_self;
+    if (host_wait_over(self, wait, q))
+        return true;
+    if (ticks == 0)
+        return false;
+
+    const int64_t timeout = host_timeout(ticks);
+    if (self)
+    {
+        self->wait       = wait;
+        self->queue      = q;
+        self->timeout_us = timeout;
+        host_park(self);
+        self->wait       = WAIT_NONE;
+        self->timeout_us = INT64_MAX;
+        return host_wait_over(self, wait, q);
+    }
+
+    while (!host_wait_over(NULL, wait, q))
+    {
+        if (host_run_one())
+            continue;
+        const int64_t next = host_next_timeout();
+        if (timeout <= next)
+        {
+            if (timeout == INT64_MAX)
+                host_fatal("the test blocks forever, no task can run");
+            host_time_us = HOST_MAX(host_time_us, timeout);
+            return false;
+        }
+        host_time_us = HOST_MAX(host_time_us, next);
+    }
+    return true;
+}
+
+static void* host_task_main(void* arg)
+{
+    struct host_task* self = (struct host_task*) arg;
+    s_self                 = self;
+    pthread_mutex_lock(&s_lock);
+    while (s_running != self)
+        pthread_cond_wait(&s_cond, &s_lock);
+    pthread_mutex_unlock(&s_lock);
+    if (!self->exit)
+        self->fn(self->arg);
+    pthread_mutex_lock(&s_lock);
+    self->wait = WAIT_DONE;
+    s_running  = NULL;
+    pthread_cond_broadcast(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+    return NULL;
+}
+
+void host_freertos_run(void)
+{
+    pthread_mutex_lock(&s_lock);
+    while (host_run_one())
+        ;
+    pthread_mutex_unlock(&s_lock);
+}
+
+void host_freertos_advance(int64_t us)
+{
+    pthread_mutex_lock(&s_lock);
+    const int64_t end = host_time_us + us;
+    while (1)
+    {
+        while (host_run_one())
+            ;
+        const int64_t next = host_next_timeout();
+        if (next > end)
+            break;
+        host_time_us = HOST_MAX(host_time_us, next);
+    }
+    host_time_us = HOST_MAX(host_time_us, end);
+    pthread_mutex_unlock(&s_lock);
+}
+
+void host_freertos_reset(void)
+{
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < s_task_cnt; i++)
+    {
+        struct host_task* t = s_tasks[i];
+        if (t->wait != WAIT_DONE)
+        {
+            t->exit = true;
+            host_switch_to(t);
+        }
+        pthread_mutex_unlock(&s_lock);
+        pthread_join(t->thread, NULL);
+        pthread_mutex_lock(&s_lock);
+        free(t);
+    }
+    for (int i = 0; i < s_queue_cnt; i++)
+    {
+        free(s_queues[i]->items);
+        free(s_queues[i]);
+    }
+    s_task_cnt  = 0;
+    s_queue_cnt = 0;
+    pthread_mutex_unlock(&s_lock);
+}
+
+// Tasks
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t prio, TaskHandle_t* handle, BaseType_t core)
+{
+    if (s_task_cnt == HOST_TASKS)
+        host_fatal("too many tasks");
+    struct host_task* t = (struct host_task*) calloc(1, sizeof(*t));
+    t->fn               = fn;
+    t->arg              = arg;
+    t->prio             = prio;
+    t->timeout_us       = INT64_MAX;
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    pthread_mutex_lock(&s_lock);
+    s_tasks[s_task_cnt++] = t;
+    pthread_mutex_unlock(&s_lock);
+    if (pthread_create(&t->thread, NULL, host_task_main, t) != 0)
+        host_fatal("no thread for a task");
+    if (handle)
+        *handle = t;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                       UBaseType_t prio, TaskHandle_t* handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    pthread_mutex_lock(&s_lock);
+    if (task == NULL || task == s_self)
+    {
+        s_self->exit = true;
+        host_park(s_self); // Does not return
+    }
+    task->wait = WAIT_SUSPENDED; // Never picked again, its thread ends in host_freertos_reset()
+    pthread_mutex_unlock(&s_lock);
+}
+
+void vTaskSuspend(TaskHandle_t task)
+{
+    pthread_mutex_lock(&s_lock);
+    if (task == NULL || task == s_self)
+    {
+        s_self->wait = WAIT_SUSPENDED;
+        host_park(s_self);
+    }
+    else
+    {
+        task->wait = WAIT_SUSPENDED;
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    pthread_mutex_lock(&s_lock);
+    host_block(WAIT_DELAY, NULL, ticks);
+    pthread_mutex_unlock(&s_lock);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t) (host_time_us / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_self;
+}
+
+const char* host_task_name(TaskHandle_t task)
+{
+    return task->name;
+}
+
+bool host_task_blocked(TaskHandle_t task)
+{
+    return task->wait != WAIT_NONE && task->wait != WAIT_DONE;
+}
+
+int64_t host_task_timeout_us(TaskHandle_t task)
+{
+    return task->timeout_us;
+}
+
+// Notifications
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    if (!s_self)
+        host_fatal("ulTaskNotifyTake() outside a task");
+    pthread_mutex_lock(&s_lock);
+    host_block(WAIT_NOTIFY_TAKE, NULL, wait);
+    const uint32_t value = s_self->notify;
+    if (value)
+        s_self->notify = clear ? 0 : value - 1;
+    s_self->notified = false;
+    pthread_mutex_unlock(&s_lock);
+    return value;
+}
+
+static void host_notify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    switch (action)
+    {
+        case eSetBits:
+            task->notify |= value;
+            break;
+        case eIncrement:
+            task->notify++;
+            break;
+        case eSetValueWithOverwrite:
+            task->notify = value;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (!task->notified)
+                task->notify = value;
+            break;
+        default:
+            break;
+    }
+    task->notified = true;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&s_lock);
+    host_notify(task, 0, eIncrement);
+    pthread_mutex_unlock(&s_lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken)
+{
+    xTaskNotifyGive(task);
+    if (woken)
+        *woken = pdTRUE;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    pthread_mutex_lock(&s_lock);
+    host_notify(task, value, action);
+    pthread_mutex_unlock(&s_lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t* woken)
+{
+    if (woken)
+        *woken = pdTRUE;
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value,
+                           TickType_t wait)
+{
+    if (!s_self)
+        host_fatal("xTaskNotifyWait() outside a task");
+    pthread_mutex_lock(&s_lock);
+    if (!s_self->notified)
+        s_self->notify &= ~clear_on_entry;
+    const bool got = host_block(WAIT_NOTIFY_WAIT, NULL, wait);
+    if (value)
+        *value = s_self->notify;
+    if (got)
+    {
+        s_self->notify &= ~clear_on_exit;
+        s_self->notified = false;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return got ? pdTRUE : pdFALSE;
+}
+
+// Queues and semaphores
+
+static struct host_queue* host_queue_new(UBaseType_t length, UBaseType_t item_size)
+{
+    if (s_queue_cnt == HOST_QUEUES)
+        host_fatal("too many queues");
+    struct host_queue* q = (struct host_queue*) calloc(1, sizeof(*q));
+    q->length            = length;
+    q->item_size         = item_size;
+    if (item_size)
+        q->items = (uint8_t*) calloc(length, item_size);
+    pthread_mutex_lock(&s_lock);
+    s_queues[s_queue_cnt++] = q;
+    pthread_mutex_unlock(&s_lock);
+    return q;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    return host_queue_new(length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    // Freed by host_freertos_reset(), a blocked task may still look at it. Static semaphores go
+    // right away, they are made and deleted per call and would run out of slots.
+    if (!queue->is_static)
+        return;
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < s_queue_cnt; i++)
+    {
+        if (s_queues[i] == queue)
+            s_queues[i] = s_queues[--s_queue_cnt];
+    }
+    pthread_mutex_unlock(&s_lock);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t wait)
+{
+    pthread_mutex_lock(&s_lock);
+    const bool ok = host_block(WAIT_SEND, q, wait);
+    if (ok)
+    {
+        if (q->item_size)
+            memcpy(q->items + (q->head + q->count) % q->length * q->item_size, item,
+                   q->item_size);
+        q->count++;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ok ? pdPASS : pdFAIL;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t wait)
+{
+    return xQueueSend(q, item, wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken)
+{
+    if (woken)
+        *woken = pdTRUE;
+    return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t wait)
+{
+    pthread_mutex_lock(&s_lock);
+    const bool ok = host_block(WAIT_RECEIVE, q, wait);
+    if (ok)
+    {
+        if (q->item_size)
+            memcpy(item, q->items + q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ok ? pdPASS : pdFAIL;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    return q->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q)
+{
+    return q->length - q->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q)
+{
+    pthread_mutex_lock(&s_lock);
+    q->count = 0;
+    q->head  = 0;
+    pthread_mutex_unlock(&s_lock);
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_queue_new(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer)
+{
+    struct host_queue* q = host_queue_new(1, 0);
+    q->is_static         = true;
+    return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    struct host_queue* q = host_queue_new(max, 0);
+    q->count             = initial;
+    return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    return xQueueReceive(sem, NULL, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return xQueueSend(sem, NULL, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken)
+{
+    return xQueueSendFromISR(sem, NULL, woken);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    return sem->count;
+}
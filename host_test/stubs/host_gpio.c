@@ -0,0 +1,81 @@
+// GPIO records behind the driver/gpio.h stub
+
+#include <string.h>
+#include "driver/gpio.h"
+#include "esp_timer.h"
+
+host_gpio_t host_gpio[GPIO_NUM_MAX];
+esp_err_t   host_gpio_isr_service_err = ESP_OK;
+
+static bool s_isr_service;
+
+void host_gpio_reset(void)
+{
+    memset(host_gpio, 0, sizeof(host_gpio));
+    host_gpio_isr_service_err = ESP_OK;
+    s_isr_service             = false;
+}
+
+bool host_gpio_fire(gpio_num_t gpio_num)
+{
+    if (!host_gpio[gpio_num].isr)
+        return false;
+    host_gpio[gpio_num].isr(host_gpio[gpio_num].isr_arg);
+    return true;
+}
+
+esp_err_t gpio_config(const gpio_config_t* config)
+{
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++)
+    {
+        if (!(config->pin_bit_mask & (1ULL << pin)))
+            continue;
+        host_gpio[pin].mode      = config->mode;
+        host_gpio[pin].intr_type = config->intr_type;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    memset(&host_gpio[gpio_num], 0, sizeof(host_gpio[gpio_num]));
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    host_gpio[gpio_num].mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    host_gpio[gpio_num].level = level;
+    host_gpio[gpio_num].writes++;
+    host_gpio[gpio_num].changed_us = host_time_us;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    return (int) host_gpio[gpio_num].level;
+}
+
+esp_err_t gpio_install_isr_service(int flags)
+{
+    if (host_gpio_isr_service_err != ESP_OK)
+        return host_gpio_isr_service_err;
+    if (s_isr_service)
+        return ESP_ERR_INVALID_STATE;
+    s_isr_service = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr, void* arg)
+{
+    if (!s_isr_service)
+        return ESP_ERR_INVALID_STATE;
+    host_gpio[gpio_num].isr     = isr;
+    host_gpio[gpio_num].isr_arg = arg;
+    return ESP_OK;
+}
@@ -0,0 +1,110 @@
+// Namespaces and u8 values behind the nvs.h stub, committed as soon as they are set
+
+#include <stdbool.h>
+#include <string.h>
+#include "nvs.h"
+
+#define HOST_NVS_ENTRIES 16
+#define HOST_NVS_NAME    16 // As NVS_KEY_NAME_MAX_SIZE, the terminator included
+
+typedef struct
+{
+    char    name[HOST_NVS_NAME];
+    char    key[HOST_NVS_NAME];
+    uint8_t value;
+} host_nvs_entry_t;
+
+typedef struct
+{
+    char name[HOST_NVS_NAME];
+    bool write;
+    bool open;
+} host_nvs_handle_t;
+
+esp_err_t host_nvs_open_err = ESP_OK;
+
+static host_nvs_entry_t  s_entries[HOST_NVS_ENTRIES];
+static int               s_entry_cnt;
+static host_nvs_handle_t s_handles[4];
+
+void host_nvs_reset(void)
+{
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(s_handles, 0, sizeof(s_handles));
+    s_entry_cnt       = 0;
+    host_nvs_open_err = ESP_OK;
+}
+
+static host_nvs_entry_t* host_nvs_find(const char* name, const char* key)
+{
+    for (int i = 0; i < s_entry_cnt; i++)
+    {
+        if (!strcmp(s_entries[i].name, name) && (!key || !strcmp(s_entries[i].key, key)))
+            return &s_entries[i];
+    }
+    return NULL;
+}
+
+bool host_nvs_get_u8(const char* name, const char* key, uint8_t* value)
+{
+    const host_nvs_entry_t* e = host_nvs_find(name, key);
+    if (e)
+        *value = e->value;
+    return e != NULL;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+    if (host_nvs_open_err != ESP_OK)
+        return host_nvs_open_err;
+    if (strlen(name) >= HOST_NVS_NAME)
+        return ESP_ERR_INVALID_ARG;
+    // A namespace only exists once something was written to it
+    if (open_mode == NVS_READONLY && !host_nvs_find(name, NULL))
+        return ESP_ERR_NVS_NOT_FOUND;
+    for (uint32_t i = 0; i < sizeof(s_handles) / sizeof(s_handles[0]); i++)
+    {
+        if (s_handles[i].open)
+            continue;
+        strcpy(s_handles[i].name, name);
+        s_handles[i].write = open_mode == NVS_READWRITE;
+        s_handles[i].open  = true;
+        *out_handle        = i + 1;
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out_value)
+{
+    return host_nvs_get_u8(s_handles[handle - 1].name, key, out_value) ? ESP_OK
+                                                                      : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value)
+{
+    const host_nvs_handle_t* h = &s_handles[handle - 1];
+    if (!h->write)
+        return ESP_ERR_NVS_READ_ONLY;
+    host_nvs_entry_t* e = host_nvs_find(h->name, key);
+    if (!e)
+    {
+        if (s_entry_cnt == HOST_NVS_ENTRIES || strlen(key) >= HOST_NVS_NAME)
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        e = &s_entries[s_entry_cnt++];
+        strcpy(e->name, h->name);
+        strcpy(e->key, key);
+    }
+    e->value = value;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    s_handles[handle - 1].open = false;
+}
@@ -0,0 +1,226 @@
+// Pulse counter units behind the driver/pulse_cnt.h stub
+
+#include <stdlib.h>
+#include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
+
+#define HOST_PCNT_UNITS    4
+#define HOST_PCNT_CHANNELS 2
+#define HOST_PCNT_WATCH    4
+
+struct host_pcnt_chan
+{
+    struct host_pcnt_unit*     unit;
+    int                        gpio;
+    pcnt_channel_edge_action_t pos;
+    pcnt_channel_edge_action_t neg;
+};
+
+struct host_pcnt_unit
+{
+    pcnt_unit_config_t     config;
+    uint32_t               glitch_ns;
+    bool                   enabled;
+    bool                   running;
+    int                    count;
+    int                    watch[HOST_PCNT_WATCH];
+    int                    watch_cnt;
+    pcnt_event_callbacks_t cbs;
+    void*                  user_data;
+    struct host_pcnt_chan* chan[HOST_PCNT_CHANNELS];
+};
+
+static struct host_pcnt_unit* s_units[HOST_PCNT_UNITS];
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t* config, pcnt_unit_handle_t* ret_unit)
+{
+    if (config->low_limit >= 0 || config->high_limit <= 0)
+        return ESP_ERR_INVALID_ARG;
+    for (int i = 0; i < HOST_PCNT_UNITS; i++)
+    {
+        if (s_units[i])
+            continue;
+        s_units[i]         = (struct host_pcnt_unit*) calloc(1, sizeof(struct host_pcnt_unit));
+        s_units[i]->config = *config;
+        *ret_unit          = s_units[i];
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t pcnt_del_unit(pcnt_unit_handle_t unit)
+{
+    if (unit->enabled)
+        return ESP_ERR_INVALID_STATE;
+    for (int i = 0; i < HOST_PCNT_UNITS; i++)
+    {
+        if (s_units[i] == unit)
+            s_units[i] = NULL;
+    }
+    free(unit);
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit,
+                                      const pcnt_glitch_filter_config_t* config)
+{
+    // 1023 APB cycles at most
+    if (config && config->max_glitch_ns > 12787)
+        return ESP_ERR_INVALID_ARG;
+    unit->glitch_ns = config ? config->max_glitch_ns : 0;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t unit)
+{
+    unit->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_disable(pcnt_unit_handle_t unit)
+{
+    unit->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit)
+{
+    if (!unit->enabled)
+        return ESP_ERR_INVALID_STATE;
+    unit->running = true;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_stop(pcnt_unit_handle_t unit)
+{
+    if (!unit->enabled)
+        return ESP_ERR_INVALID_STATE;
+    unit->running = false;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit)
+{
+    unit->count = 0;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int* value)
+{
+    *value = unit->count;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_add_watch_point(pcnt_unit_handle_t unit, int watch_point)
+{
+    if (watch_point < unit->config.low_limit || watch_point > unit->config.high_limit ||
+        unit->watch_cnt == HOST_PCNT_WATCH)
+        return ESP_ERR_INVALID_ARG;
+    unit->watch[unit->watch_cnt++] = watch_point;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_register_event_callbacks(pcnt_unit_handle_t unit,
+                                             const pcnt_event_callbacks_t* cbs, void* user_data)
+{
+    if (unit->enabled)
+        return ESP_ERR_INVALID_STATE;
+    unit->cbs       = *cbs;
+    unit->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t* config,
+                           pcnt_channel_handle_t* ret_chan)
+{
+    for (int i = 0; i < HOST_PCNT_CHANNELS; i++)
+    {
+        if (unit->chan[i])
+            continue;
+        struct host_pcnt_chan* chan =
+            (struct host_pcnt_chan*) calloc(1, sizeof(struct host_pcnt_chan));
+        chan->unit    = unit;
+        chan->gpio    = config->edge_gpio_num;
+        unit->chan[i] = chan;
+        *ret_chan     = chan;
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t pcnt_del_channel(pcnt_channel_handle_t chan)
+{
+    for (int i = 0; i < HOST_PCNT_CHANNELS; i++)
+    {
+        if (chan->unit->chan[i] == chan)
+            chan->unit->chan[i] = NULL;
+    }
+    free(chan);
+    return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan,
+                                       pcnt_channel_edge_action_t pos_act,
+                                       pcnt_channel_edge_action_t neg_act)
+{
+    chan->pos = pos_act;
+    chan->neg = neg_act;
+    return ESP_OK;
+}
+
+static void host_pcnt_step(struct host_pcnt_unit* unit, int step)
+{
+    unit->count += step;
+    const int value = unit->count;
+    // The counter goes back to zero at either limit
+    if (value == unit->config.high_limit || value == unit->config.low_limit)
+        unit->count = 0;
+    for (int i = 0; i < unit->watch_cnt; i++)
+    {
+        if (unit->watch[i] != value || !unit->cbs.on_reach)
+            continue;
+        const pcnt_watch_event_data_t edata = {.watch_point_value = value};
+        unit->cbs.on_reach(unit, &edata, unit->user_data);
+    }
+}
+
+void host_pcnt_input(int gpio_num, int level)
+{
+    const int prev = (int) host_gpio[gpio_num].level;
+    host_gpio[gpio_num].level = (uint32_t) level;
+    if (prev == level)
+        return;
+    for (int u = 0; u < HOST_PCNT_UNITS; u++)
+    {
+        struct host_pcnt_unit* unit = s_units[u];
+        if (!unit || !unit->running)
+            continue;
+        for (int c = 0; c < HOST_PCNT_CHANNELS; c++)
+        {
+            const struct host_pcnt_chan* chan = unit->chan[c];
+            if (!chan || chan->gpio != gpio_num)
+                continue;
+            const pcnt_channel_edge_action_t act = level ? chan->pos : chan->neg;
+            if (act != PCNT_CHANNEL_EDGE_ACTION_HOLD)
+                host_pcnt_step(unit, act == PCNT_CHANNEL_EDGE_ACTION_INCREASE ? 1 : -1);
+        }
+    }
+}
+
+uint32_t host_pcnt_glitch_ns(void)
+{
+    for (int u = 0; u < HOST_PCNT_UNITS; u++)
+    {
+        if (s_units[u])
+            return s_units[u]->glitch_ns;
+    }
+    return 0;
+}
+
+uint32_t host_pcnt_units(void)
+{
+    uint32_t n = 0;
+    for (int u = 0; u < HOST_PCNT_UNITS; u++)
+        n += s_units[u] != NULL;
+    return n;
+}
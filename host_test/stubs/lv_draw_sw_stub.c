@@ -0,0 +1,136 @@
+// lv_draw_sw_blend_basic() of LVGL 8.4 in the normal mode, for RGB565 without an alpha screen or
+// set_px_cb. The word-at-a-time paths and the result caching of the original only skip work,
+// they produce the same pixels as the per-pixel loops here.
+
+#include "lvgl.h"
+
+void lv_draw_sw_init_ctx(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx)
+{
+    memset(draw_ctx, 0, sizeof(lv_draw_sw_ctx_t));
+    ((lv_draw_sw_ctx_t*) draw_ctx)->blend = lv_draw_sw_blend_basic;
+}
+
+void lv_draw_sw_deinit_ctx(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx)
+{
+    memset(draw_ctx, 0, sizeof(lv_draw_sw_ctx_t));
+}
+
+static void fill_normal(lv_color_t* dest_buf, const lv_area_t* dest_area, lv_coord_t dest_stride,
+                        lv_color_t color, lv_opa_t opa, const lv_opa_t* mask,
+                        lv_coord_t mask_stride)
+{
+    const int32_t w = lv_area_get_width(dest_area);
+    const int32_t h = lv_area_get_height(dest_area);
+
+    for (int32_t y = 0; y < h; y++)
+    {
+        for (int32_t x = 0; x < w; x++)
+        {
+            if (mask == NULL)
+            {
+                dest_buf[x] = opa >= LV_OPA_MAX ? color : lv_color_mix(color, dest_buf[x], opa);
+            }
+            // Only the mask matters
+            else if (opa >= LV_OPA_MAX)
+            {
+                dest_buf[x] = mask[x] == LV_OPA_COVER ? color
+                                                      : lv_color_mix(color, dest_buf[x], mask[x]);
+            }
+            else if (mask[x])
+            {
+                const lv_opa_t opa_tmp =
+                    mask[x] == LV_OPA_COVER ? opa : (lv_opa_t) ((uint32_t) mask[x] * opa >> 8);
+                dest_buf[x] = opa_tmp == LV_OPA_COVER ? color
+                                                      : lv_color_mix(color, dest_buf[x], opa_tmp);
+            }
+        }
+        dest_buf += dest_stride;
+        if (mask)
+            mask += mask_stride;
+    }
+}
+
+static void map_normal(lv_color_t* dest_buf, const lv_area_t* dest_area, lv_coord_t dest_stride,
+                       const lv_color_t* src_buf, lv_coord_t src_stride, lv_opa_t opa,
+                       const lv_opa_t* mask, lv_coord_t mask_stride)
+{
+    const int32_t w = lv_area_get_width(dest_area);
+    const int32_t h = lv_area_get_height(dest_area);
+
+    for (int32_t y = 0; y < h; y++)
+    {
+        for (int32_t x = 0; x < w; x++)
+        {
+            if (mask == NULL)
+            {
+                dest_buf[x] =
+                    opa >= LV_OPA_MAX ? src_buf[x] : lv_color_mix(src_buf[x], dest_buf[x], opa);
+            }
+            // Images switch to the mask alone only above LV_OPA_MAX, fills at it
+            else if (opa > LV_OPA_MAX)
+            {
+                if (mask[x] == LV_OPA_COVER)
+                    dest_buf[x] = src_buf[x];
+                else if (mask[x])
+                    dest_buf[x] = lv_color_mix(src_buf[x], dest_buf[x], mask[x]);
+            }
+            else if (mask[x])
+            {
+                const lv_opa_t opa_tmp =
+                    mask[x] >= LV_OPA_MAX ? opa : (lv_opa_t) ((uint32_t) opa * mask[x] >> 8);
+                dest_buf[x] = lv_color_mix(src_buf[x], dest_buf[x], opa_tmp);
+            }
+        }
+        dest_buf += dest_stride;
+        src_buf += src_stride;
+        if (mask)
+            mask += mask_stride;
+    }
+}
+
+void lv_draw_sw_blend_basic(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc)
+{
+    const lv_opa_t* mask = dsc->mask_buf;
+    if (dsc->mask_buf && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP)
+        return;
+    if (dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER)
+        mask = NULL;
+
+    const lv_coord_t dest_stride = lv_area_get_width(draw_ctx->buf_area);
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area))
+        return;
+
+    if (draw_ctx->wait_for_finish)
+        draw_ctx->wait_for_finish(draw_ctx);
+
+    lv_color_t* dest_buf = (lv_color_t*) draw_ctx->buf;
+    dest_buf += dest_stride * (blend_area.y1 - draw_ctx->buf_area->y1) +
+                (blend_area.x1 - draw_ctx->buf_area->x1);
+
+    const lv_color_t* src_buf    = dsc->src_buf;
+    lv_coord_t        src_stride = 0;
+    if (src_buf)
+    {
+        src_stride = lv_area_get_width(dsc->blend_area);
+        src_buf += src_stride * (blend_area.y1 - dsc->blend_area->y1) +
+                   (blend_area.x1 - dsc->blend_area->x1);
+    }
+
+    lv_coord_t mask_stride = 0;
+    if (mask)
+    {
+        mask_stride = lv_area_get_width(dsc->mask_area);
+        mask += mask_stride * (blend_area.y1 - dsc->mask_area->y1) +
+                (blend_area.x1 - dsc->mask_area->x1);
+    }
+
+    if (dsc->blend_mode != LV_BLEND_MODE_NORMAL)
+        return;
+    if (src_buf == NULL)
+        fill_normal(dest_buf, &blend_area, dest_stride, dsc->color, dsc->opa, mask, mask_stride);
+    else
+        map_normal(dest_buf, &blend_area, dest_stride, src_buf, src_stride, dsc->opa, mask,
+                   mask_stride);
+}
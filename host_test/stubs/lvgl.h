@@ -0,0 +1,466 @@
+#ifndef LVGL_H
+#define LVGL_H
+
+// The part of the LVGL 8 API the tested modules use. Objects are plain records the tests build
+// and inspect, nothing is rendered.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LV_MIN(a, b)            ((a) < (b) ? (a) : (b))
+#define LV_MAX(a, b)            ((a) > (b) ? (a) : (b))
+#define LV_CLAMP(min, val, max) (LV_MAX(min, (LV_MIN(val, max))))
+
+#define LV_INV_BUF_SIZE 32
+
+typedef int16_t  lv_coord_t;
+typedef uint8_t  lv_opa_t;
+typedef uint8_t  lv_res_t;
+typedef uint32_t lv_style_selector_t;
+typedef uint16_t lv_style_prop_t;
+
+enum
+{
+    LV_RES_INV = 0,
+    LV_RES_OK,
+};
+
+enum
+{
+    LV_OPA_TRANSP = 0,
+    LV_OPA_0      = 0,
+    LV_OPA_10     = 25,
+    LV_OPA_20     = 51,
+    LV_OPA_30     = 76,
+    LV_OPA_40     = 102,
+    LV_OPA_50     = 127,
+    LV_OPA_60     = 153,
+    LV_OPA_70     = 178,
+    LV_OPA_80     = 204,
+    LV_OPA_90     = 229,
+    LV_OPA_100    = 255,
+    LV_OPA_COVER  = 255,
+};
+#define LV_OPA_MIN 2
+#define LV_OPA_MAX 253
+
+// RGB565 with the bytes swapped, CONFIG_LV_COLOR_16_SWAP
+typedef union
+{
+    struct
+    {
+        uint16_t green_h : 3;
+        uint16_t red : 5;
+        uint16_t blue : 5;
+        uint16_t green_l : 3;
+    } ch;
+    uint16_t full;
+} lv_color_t;
+
+#define LV_UDIV255(x) (((x) * 0x8081U) >> 0x17)
+
+static inline lv_color_t lv_color_make(uint8_t r, uint8_t g, uint8_t b)
+{
+    lv_color_t color;
+    color.ch.green_h = (g >> 5) & 0x7;
+    color.ch.red     = (r >> 3) & 0x1F;
+    color.ch.blue    = (b >> 3) & 0x1F;
+    color.ch.green_l = (g >> 2) & 0x7;
+    return color;
+}
+
+static inline lv_color_t lv_color_hex(uint32_t c)
+{
+    return lv_color_make((uint8_t) (c >> 16), (uint8_t) (c >> 8), (uint8_t) c);
+}
+
+static inline lv_color_t lv_color_white(void)
+{
+    return lv_color_hex(0xFFFFFF);
+}
+
+static inline lv_color_t lv_color_black(void)
+{
+    return lv_color_hex(0x000000);
+}
+
+// As LVGL 8.4 with LV_COLOR_MIX_ROUND_OFS 128
+static inline lv_color_t lv_color_mix(lv_color_t c1, lv_color_t c2, uint8_t mix)
+{
+    const uint32_t g1 = (c1.ch.green_h << 3) | c1.ch.green_l;
+    const uint32_t g2 = (c2.ch.green_h << 3) | c2.ch.green_l;
+    const uint32_t g  = LV_UDIV255(g1 * mix + g2 * (255 - mix) + 128);
+    lv_color_t     ret;
+    ret.ch.red     = LV_UDIV255((uint32_t) c1.ch.red * mix + c2.ch.red * (255 - mix) + 128);
+    ret.ch.green_h = g >> 3;
+    ret.ch.green_l = g & 0x7;
+    ret.ch.blue    = LV_UDIV255((uint32_t) c1.ch.blue * mix + c2.ch.blue * (255 - mix) + 128);
+    return ret;
+}
+
+static inline void lv_color_fill(lv_color_t* buf, lv_color_t color, uint32_t px_num)
+{
+    while (px_num--)
+        *buf++ = color;
+}
+
+typedef struct
+{
+    lv_coord_t x1;
+    lv_coord_t y1;
+    lv_coord_t x2;
+    lv_coord_t y2;
+} lv_area_t;
+
+static inline void lv_area_set(lv_area_t* a, lv_coord_t x1, lv_coord_t y1, lv_coord_t x2,
+                               lv_coord_t y2)
+{
+    a->x1 = x1;
+    a->y1 = y1;
+    a->x2 = x2;
+    a->y2 = y2;
+}
+
+static inline lv_coord_t lv_area_get_width(const lv_area_t* a)
+{
+    return (lv_coord_t) (a->x2 - a->x1 + 1);
+}
+
+static inline lv_coord_t lv_area_get_height(const lv_area_t* a)
+{
+    return (lv_coord_t) (a->y2 - a->y1 + 1);
+}
+
+static inline uint32_t lv_area_get_size(const lv_area_t* a)
+{
+    return (uint32_t) (a->x2 - a->x1 + 1) * (uint32_t) (a->y2 - a->y1 + 1);
+}
+
+static inline bool _lv_area_intersect(lv_area_t* res, const lv_area_t* a, const lv_area_t* b)
+{
+    res->x1 = LV_MAX(a->x1, b->x1);
+    res->y1 = LV_MAX(a->y1, b->y1);
+    res->x2 = LV_MIN(a->x2, b->x2);
+    res->y2 = LV_MIN(a->y2, b->y2);
+    return res->x1 <= res->x2 && res->y1 <= res->y2;
+}
+
+static inline void _lv_area_join(lv_area_t* res, const lv_area_t* a, const lv_area_t* b)
+{
+    res->x1 = LV_MIN(a->x1, b->x1);
+    res->y1 = LV_MIN(a->y1, b->y1);
+    res->x2 = LV_MAX(a->x2, b->x2);
+    res->y2 = LV_MAX(a->y2, b->y2);
+}
+
+static inline bool _lv_area_is_on(const lv_area_t* a, const lv_area_t* b)
+{
+    return a->x1 <= b->x2 && a->x2 >= b->x1 && a->y1 <= b->y2 && a->y2 >= b->y1;
+}
+
+static inline bool _lv_area_is_in(const lv_area_t* in, const lv_area_t* holder, lv_coord_t radius)
+{
+    (void) radius;
+    return in->x1 >= holder->x1 && in->y1 >= holder->y1 && in->x2 <= holder->x2 &&
+           in->y2 <= holder->y2;
+}
+
+// Styles, only local ones
+enum
+{
+    LV_STYLE_BG_OPA = 1,
+    LV_STYLE_BG_IMG_SRC,
+    LV_STYLE_BG_IMG_OPA,
+    LV_STYLE_BORDER_OPA,
+    LV_STYLE_OPA,
+    LV_STYLE_BG_COLOR,
+};
+
+#define LV_PART_MAIN     0x000000
+#define LV_PART_KNOB     0x030000
+#define LV_STATE_DEFAULT 0x0000
+#define LV_STATE_FOCUSED 0x0002
+#define LV_STATE_PRESSED 0x0020
+
+typedef union
+{
+    int32_t     num;
+    const void* ptr;
+    lv_color_t  color;
+} lv_style_value_t;
+
+#define LV_OBJ_HOST_STYLES   8
+#define LV_OBJ_HOST_CHILDREN 16
+#define LV_OBJ_HOST_EVENTS   4
+
+typedef struct _lv_obj_class_t
+{
+    const struct _lv_obj_class_t* base_class;
+    const char*                   name;
+} lv_obj_class_t;
+
+extern const lv_obj_class_t lv_obj_class;
+extern const lv_obj_class_t lv_btn_class;
+extern const lv_obj_class_t lv_arc_class;
+extern const lv_obj_class_t lv_label_class;
+extern const lv_obj_class_t lv_img_class;
+
+typedef enum
+{
+    LV_OBJ_FLAG_HIDDEN       = (1L << 0),
+    LV_OBJ_FLAG_CLICKABLE    = (1L << 1),
+    LV_OBJ_FLAG_SCROLLABLE   = (1L << 4),
+    LV_OBJ_FLAG_EVENT_BUBBLE = (1L << 14),
+} lv_obj_flag_t;
+
+typedef enum
+{
+    LV_EVENT_ALL = 0,
+    LV_EVENT_PRESSED,
+    LV_EVENT_PRESSING,
+    LV_EVENT_PRESS_LOST,
+    LV_EVENT_SHORT_CLICKED,
+    LV_EVENT_LONG_PRESSED,
+    LV_EVENT_LONG_PRESSED_REPEAT,
+    LV_EVENT_CLICKED,
+    LV_EVENT_RELEASED,
+    LV_EVENT_KEY                 = 13,
+    LV_EVENT_FOCUSED,
+    LV_EVENT_DEFOCUSED,
+    LV_EVENT_VALUE_CHANGED       = 28,
+    LV_EVENT_SCREEN_UNLOAD_START = 36,
+    LV_EVENT_SCREEN_LOAD_START,
+    LV_EVENT_SCREEN_LOADED,
+    LV_EVENT_SCREEN_UNLOADED,
+    _LV_EVENT_LAST,
+} lv_event_code_t;
+
+typedef struct _lv_obj_t lv_obj_t;
+typedef struct _lv_event_t lv_event_t;
+typedef void (*lv_event_cb_t)(lv_event_t* e);
+
+typedef struct
+{
+    lv_style_prop_t     prop;
+    lv_style_selector_t selector;
+    lv_style_value_t    value;
+} lv_obj_host_style_t;
+
+typedef struct
+{
+    lv_event_cb_t   cb;
+    lv_event_code_t filter;
+    void*           user_data;
+} lv_obj_host_event_t;
+
+struct _lv_obj_t
+{
+    const lv_obj_class_t* class_p;
+    lv_obj_t*             parent;
+    lv_obj_t*             children[LV_OBJ_HOST_CHILDREN];
+    uint32_t              child_cnt;
+    uint32_t              flags;
+    uint16_t              state;
+    lv_obj_host_style_t   styles[LV_OBJ_HOST_STYLES];
+    uint32_t              style_cnt;
+    lv_obj_host_event_t   events[LV_OBJ_HOST_EVENTS];
+    uint32_t              event_cnt;
+    uint32_t              invalidated; // lv_obj_invalidate() calls
+    lv_event_code_t       last_event;  // Last code lv_event_send() delivered
+    uint32_t              event_sent;  // lv_event_send() calls
+    int32_t               value;       // Arc value
+    int32_t               min_value;
+    int32_t               max_value;
+};
+
+struct _lv_event_t
+{
+    lv_obj_t*       target;
+    lv_obj_t*       current_target;
+    lv_event_code_t code;
+    void*           user_data;
+    void*           param;
+};
+
+// Host helpers: objects come from a pool, lv_host_reset() frees them all
+lv_obj_t* lv_host_obj_create(lv_obj_t* parent, const lv_obj_class_t* class_p);
+void      lv_host_reset(void);
+
+lv_obj_t* lv_obj_create(lv_obj_t* parent);
+bool      lv_obj_is_valid(const lv_obj_t* obj);
+void      lv_obj_invalidate(const lv_obj_t* obj);
+uint32_t  lv_obj_get_child_cnt(const lv_obj_t* obj);
+lv_obj_t* lv_obj_get_child(const lv_obj_t* obj, int32_t id);
+lv_obj_t* lv_obj_get_parent(const lv_obj_t* obj);
+bool      lv_obj_has_flag(const lv_obj_t* obj, lv_obj_flag_t f);
+void      lv_obj_add_flag(lv_obj_t* obj, lv_obj_flag_t f);
+void      lv_obj_clear_flag(lv_obj_t* obj, lv_obj_flag_t f);
+bool      lv_obj_check_type(const lv_obj_t* obj, const lv_obj_class_t* class_p);
+bool      lv_obj_has_class(const lv_obj_t* obj, const lv_obj_class_t* class_p);
+uint16_t  lv_obj_get_state(const lv_obj_t* obj);
+lv_res_t  lv_obj_get_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t* value,
+                                      lv_style_selector_t selector);
+void      lv_obj_set_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t value,
+                                      lv_style_selector_t selector);
+bool      lv_obj_remove_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop,
+                                         lv_style_selector_t selector);
+// The local values of LV_STATE_DEFAULT, else LVGL's defaults: there are no themes
+lv_color_t lv_obj_get_style_bg_color(const lv_obj_t* obj, uint32_t part);
+lv_opa_t   lv_obj_get_style_bg_opa(const lv_obj_t* obj, uint32_t part);
+void      lv_obj_add_event_cb(lv_obj_t* obj, lv_event_cb_t cb, lv_event_code_t filter,
+                              void* user_data);
+uint32_t  lv_obj_get_event_cnt(const lv_obj_t* obj); // Host only, LVGL keeps it in spec_attr
+
+lv_res_t        lv_event_send(lv_obj_t* obj, lv_event_code_t code, void* param);
+lv_event_code_t lv_event_get_code(lv_event_t* e);
+lv_obj_t*       lv_event_get_target(lv_event_t* e);
+lv_obj_t*       lv_event_get_current_target(lv_event_t* e);
+void*           lv_event_get_user_data(lv_event_t* e);
+
+int32_t lv_arc_get_value(const lv_obj_t* obj);
+int32_t lv_arc_get_min_value(const lv_obj_t* obj);
+int32_t lv_arc_get_max_value(const lv_obj_t* obj);
+void    lv_arc_set_value(lv_obj_t* obj, int32_t value);
+
+// Displays
+typedef enum
+{
+    LV_SCR_LOAD_ANIM_NONE = 0,
+    LV_SCR_LOAD_ANIM_OVER_LEFT,
+    LV_SCR_LOAD_ANIM_OVER_RIGHT,
+    LV_SCR_LOAD_ANIM_OVER_TOP,
+    LV_SCR_LOAD_ANIM_OVER_BOTTOM,
+    LV_SCR_LOAD_ANIM_MOVE_LEFT,
+    LV_SCR_LOAD_ANIM_MOVE_RIGHT,
+    LV_SCR_LOAD_ANIM_MOVE_TOP,
+    LV_SCR_LOAD_ANIM_MOVE_BOTTOM,
+    LV_SCR_LOAD_ANIM_FADE_IN,
+    LV_SCR_LOAD_ANIM_FADE_ON = LV_SCR_LOAD_ANIM_FADE_IN,
+    LV_SCR_LOAD_ANIM_FADE_OUT,
+    LV_SCR_LOAD_ANIM_OUT_LEFT,
+    LV_SCR_LOAD_ANIM_OUT_RIGHT,
+    LV_SCR_LOAD_ANIM_OUT_TOP,
+    LV_SCR_LOAD_ANIM_OUT_BOTTOM,
+} lv_scr_load_anim_t;
+
+// Software rendering, the blend step only
+typedef enum
+{
+    LV_DRAW_MASK_RES_TRANSP,
+    LV_DRAW_MASK_RES_FULL_COVER,
+    LV_DRAW_MASK_RES_CHANGED,
+    LV_DRAW_MASK_RES_UNKNOWN,
+} lv_draw_mask_res_t;
+
+typedef enum
+{
+    LV_BLEND_MODE_NORMAL,
+    LV_BLEND_MODE_ADDITIVE,
+    LV_BLEND_MODE_SUBTRACTIVE,
+    LV_BLEND_MODE_MULTIPLY,
+    LV_BLEND_MODE_REPLACE,
+} lv_blend_mode_t;
+
+typedef struct
+{
+    const lv_area_t*   blend_area;
+    const lv_color_t*  src_buf; // NULL for a fill with `color`
+    lv_color_t         color;
+    lv_opa_t*          mask_buf;
+    lv_draw_mask_res_t mask_res;
+    const lv_area_t*   mask_area;
+    lv_opa_t           opa;
+    lv_blend_mode_t    blend_mode;
+} lv_draw_sw_blend_dsc_t;
+
+typedef struct _lv_draw_ctx_t
+{
+    void*            buf;
+    lv_area_t*       buf_area;
+    const lv_area_t* clip_area;
+    void (*wait_for_finish)(struct _lv_draw_ctx_t* draw_ctx);
+} lv_draw_ctx_t;
+
+typedef struct
+{
+    lv_draw_ctx_t base_draw;
+    void (*blend)(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc);
+} lv_draw_sw_ctx_t;
+
+typedef struct
+{
+    void*    buf1;
+    void*    buf2;
+    void*    buf_act; // The buffer being rendered
+    uint32_t size;
+} lv_disp_draw_buf_t;
+
+typedef struct _lv_disp_drv_t
+{
+    lv_coord_t          hor_res;
+    lv_coord_t          ver_res;
+    uint32_t            antialiasing : 1;
+    uint32_t            screen_transp : 1;
+    void*               user_data;
+    void*               set_px_cb;
+    lv_draw_ctx_t*      draw_ctx;
+    lv_disp_draw_buf_t* draw_buf;
+} lv_disp_drv_t;
+
+// The blend of LVGL 8.4 in the normal mode, transcribed from lv_draw_sw_blend.c. The other modes
+// are not needed by the tests.
+void lv_draw_sw_init_ctx(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx);
+void lv_draw_sw_deinit_ctx(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx);
+void lv_draw_sw_blend_basic(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc);
+
+#define LV_HOST_SCREENS 8
+
+typedef struct _lv_disp_t
+{
+    lv_disp_drv_t* driver;
+    lv_obj_t*      act_scr;
+    lv_obj_t*      scr_to_load;
+    lv_obj_t*      screens[LV_HOST_SCREENS];
+    uint32_t       screen_cnt;
+} lv_disp_t;
+
+// Host helper: the default display, its driver and its active screen
+lv_disp_t* lv_host_disp(void);
+
+lv_disp_t* lv_disp_get_default(void);
+lv_disp_t* _lv_refr_get_disp_refreshing(void); // The default display on the host
+lv_obj_t*  lv_disp_get_scr_act(lv_disp_t* disp);
+lv_obj_t*  lv_scr_act(void);
+lv_coord_t lv_disp_get_hor_res(lv_disp_t* disp);
+lv_coord_t lv_disp_get_ver_res(lv_disp_t* disp);
+
+// Groups and input devices
+#define LV_HOST_GROUP_OBJS 32
+
+typedef struct _lv_group_t
+{
+    lv_obj_t* objs[LV_HOST_GROUP_OBJS];
+    uint32_t  obj_cnt;
+    bool      editing;
+    bool      wrap;
+} lv_group_t;
+
+lv_group_t* lv_group_create(void);
+void        lv_group_add_obj(lv_group_t* group, lv_obj_t* obj);
+void        lv_group_remove_all_objs(lv_group_t* group);
+void        lv_group_set_editing(lv_group_t* group, bool edit);
+void        lv_group_set_wrap(lv_group_t* group, bool en);
+lv_obj_t*   lv_group_get_focused(const lv_group_t* group);
+uint32_t    lv_group_get_obj_count(lv_group_t* group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
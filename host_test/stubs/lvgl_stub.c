@@ -0,0 +1,354 @@
+// Object records behind the LVGL stub
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lvgl.h"
+
+#define LV_HOST_OBJS 256
+
+const lv_obj_class_t lv_obj_class   = {NULL, "obj"};
+const lv_obj_class_t lv_btn_class   = {&lv_obj_class, "btn"};
+const lv_obj_class_t lv_arc_class   = {&lv_obj_class, "arc"};
+const lv_obj_class_t lv_label_class = {&lv_obj_class, "label"};
+const lv_obj_class_t lv_img_class   = {&lv_obj_class, "img"};
+
+static lv_obj_t      s_objs[LV_HOST_OBJS];
+static uint32_t      s_obj_cnt;
+static lv_disp_drv_t s_drv = {360, 360, 1, 0, NULL, NULL, NULL};
+static lv_disp_t     s_disp;
+static lv_group_t    s_groups[4];
+static uint32_t      s_group_cnt;
+
+lv_obj_t* lv_host_obj_create(lv_obj_t* parent, const lv_obj_class_t* class_p)
+{
+    if (s_obj_cnt == LV_HOST_OBJS)
+    {
+        printf("lvgl stub: out of objects\n");
+        abort();
+    }
+    lv_obj_t* obj = &s_objs[s_obj_cnt++];
+    memset(obj, 0, sizeof(*obj));
+    obj->class_p   = class_p;
+    obj->parent    = parent;
+    obj->max_value = 100;
+    // Plain objects and buttons are clickable by default, as in LVGL
+    if (class_p == &lv_obj_class || class_p == &lv_btn_class || class_p == &lv_arc_class)
+        obj->flags |= LV_OBJ_FLAG_CLICKABLE;
+    if (parent)
+    {
+        if (parent->child_cnt == LV_OBJ_HOST_CHILDREN)
+        {
+            printf("lvgl stub: too many children\n");
+            abort();
+        }
+        parent->children[parent->child_cnt++] = obj;
+    }
+    else if (s_disp.screen_cnt < LV_HOST_SCREENS)
+    {
+        s_disp.screens[s_disp.screen_cnt++] = obj;
+        if (!s_disp.act_scr)
+            s_disp.act_scr = obj;
+    }
+    return obj;
+}
+
+void lv_host_reset(void)
+{
+    s_obj_cnt   = 0;
+    s_group_cnt = 0;
+    memset(&s_disp, 0, sizeof(s_disp));
+    memset(&s_drv, 0, sizeof(s_drv));
+    s_disp.driver      = &s_drv;
+    s_drv.hor_res      = 360;
+    s_drv.ver_res      = 360;
+    s_drv.antialiasing = 1;
+}
+
+lv_disp_t* lv_host_disp(void)
+{
+    s_disp.driver = &s_drv;
+    return &s_disp;
+}
+
+lv_obj_t* lv_obj_create(lv_obj_t* parent)
+{
+    return lv_host_obj_create(parent, &lv_obj_class);
+}
+
+bool lv_obj_is_valid(const lv_obj_t* obj)
+{
+    return obj >= s_objs && obj < s_objs + s_obj_cnt;
+}
+
+void lv_obj_invalidate(const lv_obj_t* obj)
+{
+    if (obj)
+        ((lv_obj_t*) obj)->invalidated++;
+}
+
+uint32_t lv_obj_get_child_cnt(const lv_obj_t* obj)
+{
+    return obj->child_cnt;
+}
+
+lv_obj_t* lv_obj_get_child(const lv_obj_t* obj, int32_t id)
+{
+    if (id < 0)
+        id += (int32_t) obj->child_cnt;
+    return id >= 0 && (uint32_t) id < obj->child_cnt ? obj->children[id] : NULL;
+}
+
+lv_obj_t* lv_obj_get_parent(const lv_obj_t* obj)
+{
+    return obj->parent;
+}
+
+bool lv_obj_has_flag(const lv_obj_t* obj, lv_obj_flag_t f)
+{
+    return (obj->flags & f) == (uint32_t) f;
+}
+
+void lv_obj_add_flag(lv_obj_t* obj, lv_obj_flag_t f)
+{
+    obj->flags |= f;
+}
+
+void lv_obj_clear_flag(lv_obj_t* obj, lv_obj_flag_t f)
+{
+    obj->flags &= ~(uint32_t) f;
+}
+
+bool lv_obj_check_type(const lv_obj_t* obj, const lv_obj_class_t* class_p)
+{
+    return obj->class_p == class_p;
+}
+
+bool lv_obj_has_class(const lv_obj_t* obj, const lv_obj_class_t* class_p)
+{
+    for (const lv_obj_class_t* c = obj->class_p; c; c = c->base_class)
+        if (c == class_p)
+            return true;
+    return false;
+}
+
+uint16_t lv_obj_get_state(const lv_obj_t* obj)
+{
+    return obj->state;
+}
+
+lv_res_t lv_obj_get_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t* value,
+                                     lv_style_selector_t selector)
+{
+    for (uint32_t i = 0; i < obj->style_cnt; i++)
+    {
+        if (obj->styles[i].prop == prop && obj->styles[i].selector == selector)
+        {
+            *value = obj->styles[i].value;
+            return LV_RES_OK;
+        }
+    }
+    return LV_RES_INV;
+}
+
+void lv_obj_set_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t value,
+                                 lv_style_selector_t selector)
+{
+    for (uint32_t i = 0; i < obj->style_cnt; i++)
+    {
+        if (obj->styles[i].prop == prop && obj->styles[i].selector == selector)
+        {
+            obj->styles[i].value = value;
+            return;
+        }
+    }
+    if (obj->style_cnt == LV_OBJ_HOST_STYLES)
+    {
+        printf("lvgl stub: too many styles\n");
+        abort();
+    }
+    obj->styles[obj->style_cnt].prop     = prop;
+    obj->styles[obj->style_cnt].selector = selector;
+    obj->styles[obj->style_cnt].value    = value;
+    obj->style_cnt++;
+}
+
+bool lv_obj_remove_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop,
+                                    lv_style_selector_t selector)
+{
+    for (uint32_t i = 0; i < obj->style_cnt; i++)
+    {
+        if (obj->styles[i].prop == prop && obj->styles[i].selector == selector)
+        {
+            obj->styles[i] = obj->styles[--obj->style_cnt];
+            return true;
+        }
+    }
+    return false;
+}
+
+lv_color_t lv_obj_get_style_bg_color(const lv_obj_t* obj, uint32_t part)
+{
+    lv_style_value_t value;
+    if (lv_obj_get_local_style_prop((lv_obj_t*) obj, LV_STYLE_BG_COLOR, &value,
+                                    part | LV_STATE_DEFAULT) != LV_RES_OK)
+        return lv_color_white();
+    return value.color;
+}
+
+lv_opa_t lv_obj_get_style_bg_opa(const lv_obj_t* obj, uint32_t part)
+{
+    lv_style_value_t value;
+    if (lv_obj_get_local_style_prop((lv_obj_t*) obj, LV_STYLE_BG_OPA, &value,
+                                    part | LV_STATE_DEFAULT) != LV_RES_OK)
+        return LV_OPA_TRANSP;
+    return (lv_opa_t) value.num;
+}
+
+void lv_obj_add_event_cb(lv_obj_t* obj, lv_event_cb_t cb, lv_event_code_t filter, void* user_data)
+{
+    if (obj->event_cnt == LV_OBJ_HOST_EVENTS)
+    {
+        printf("lvgl stub: too many event callbacks\n");
+        abort();
+    }
+    obj->events[obj->event_cnt].cb        = cb;
+    obj->events[obj->event_cnt].filter    = filter;
+    obj->events[obj->event_cnt].user_data = user_data;
+    obj->event_cnt++;
+}
+
+uint32_t lv_obj_get_event_cnt(const lv_obj_t* obj)
+{
+    return obj->event_cnt;
+}
+
+// Delivered to the target, and to the parents as long as LV_OBJ_FLAG_EVENT_BUBBLE is set
+lv_res_t lv_event_send(lv_obj_t* obj, lv_event_code_t code, void* param)
+{
+    if (!obj)
+        return LV_RES_INV;
+    obj->last_event = code;
+    obj->event_sent++;
+    lv_event_t e = {obj, obj, code, NULL, param};
+    for (lv_obj_t* cur = obj; cur;
+         cur           = lv_obj_has_flag(cur, LV_OBJ_FLAG_EVENT_BUBBLE) ? cur->parent : NULL)
+    {
+        e.current_target = cur;
+        for (uint32_t i = 0; i < cur->event_cnt; i++)
+        {
+            if (cur->events[i].filter != LV_EVENT_ALL && cur->events[i].filter != code)
+                continue;
+            e.user_data = cur->events[i].user_data;
+            cur->events[i].cb(&e);
+        }
+    }
+    return LV_RES_OK;
+}
+
+lv_event_code_t lv_event_get_code(lv_event_t* e)
+{
+    return e->code;
+}
+
+lv_obj_t* lv_event_get_target(lv_event_t* e)
+{
+    return e->target;
+}
+
+lv_obj_t* lv_event_get_current_target(lv_event_t* e)
+{
+    return e->current_target;
+}
+
+void* lv_event_get_user_data(lv_event_t* e)
+{
+    return e->user_data;
+}
+
+int32_t lv_arc_get_value(const lv_obj_t* obj)
+{
+    return obj->value;
+}
+
+int32_t lv_arc_get_min_value(const lv_obj_t* obj)
+{
+    return obj->min_value;
+}
+
+int32_t lv_arc_get_max_value(const lv_obj_t* obj)
+{
+    return obj->max_value;
+}
+
+void lv_arc_set_value(lv_obj_t* obj, int32_t value)
+{
+    obj->value = LV_CLAMP(obj->min_value, value, obj->max_value);
+}
+
+lv_disp_t* lv_disp_get_default(void)
+{
+    return lv_host_disp();
+}
+
+lv_disp_t* _lv_refr_get_disp_refreshing(void)
+{
+    return lv_host_disp();
+}
+
+lv_obj_t* lv_disp_get_scr_act(lv_disp_t* disp)
+{
+    return disp->act_scr;
+}
+
+lv_obj_t* lv_scr_act(void)
+{
+    return s_disp.act_scr;
+}
+
+lv_coord_t lv_disp_get_hor_res(lv_disp_t* disp)
+{
+    return disp->driver->hor_res;
+}
+
+lv_coord_t lv_disp_get_ver_res(lv_disp_t* disp)
+{
+    return disp->driver->ver_res;
+}
+
+lv_group_t* lv_group_create(void)
+{
+    lv_group_t* group = &s_groups[s_group_cnt++ % 4];
+    memset(group, 0, sizeof(*group));
+    return group;
+}
+
+void lv_group_add_obj(lv_group_t* group, lv_obj_t* obj)
+{
+    if (group->obj_cnt < LV_HOST_GROUP_OBJS)
+        group->objs[group->obj_cnt++] = obj;
+}
+
+void lv_group_remove_all_objs(lv_group_t* group)
+{
+    group->obj_cnt = 0;
+}
+
+void lv_group_set_editing(lv_group_t* group, bool edit)
+{
+    group->editing = edit;
+}
+
+void lv_group_set_wrap(lv_group_t* group, bool en)
+{
+    group->wrap = en;
+}
+
+lv_obj_t* lv_group_get_focused(const lv_group_t* group)
+{
+    return group->obj_cnt ? group->objs[0] : NULL;
+}
+
+uint32_t lv_group_get_obj_count(lv_group_t* group)
+{
+    return group->obj_cnt;
+}
@@ -0,0 +1,44 @@
+#ifndef NVS_H
+#define NVS_H
+
+// The NVS API for single u8 values, kept in memory by host_nvs.c
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_NVS_BASE             0x1100
+#define ESP_ERR_NVS_NOT_FOUND        (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_NOT_ENOUGH_SPACE (ESP_ERR_NVS_BASE + 0x05)
+#define ESP_ERR_NVS_READ_ONLY        (ESP_ERR_NVS_BASE + 0x07)
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle);
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out_value);
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value);
+esp_err_t nvs_commit(nvs_handle_t handle);
+void      nvs_close(nvs_handle_t handle);
+
+// Host helpers: everything is gone after a reset, and nvs_open() fails with host_nvs_open_err
+// unless it is ESP_OK
+extern esp_err_t host_nvs_open_err;
+
+void host_nvs_reset(void);
+bool host_nvs_get_u8(const char* name, const char* key, uint8_t* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
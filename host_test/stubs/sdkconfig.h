@@ -0,0 +1,13 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// The options of the project sdkconfig the host tests compile against
+
+#define CONFIG_LV_COLOR_DEPTH          16
+#define CONFIG_LV_COLOR_DEPTH_16       1
+#define CONFIG_LV_COLOR_16_SWAP        1
+#define CONFIG_LV_DISP_DEF_REFR_PERIOD 30
+#define CONFIG_LV_INDEV_DEF_READ_PERIOD 30
+#define CONFIG_FREERTOS_HZ             1000
+
+#endif
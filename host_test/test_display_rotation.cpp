@@ -0,0 +1,152 @@
+// Touch transforms of the panel rotations: each maps the panel onto itself, puts a touch where the
+// MADCTL scan order drew the pixel under it, and turning by 90 degrees four times gets back to the
+// start. The rotation persists in NVS.
+
+#include <string.h>
+#include "display_rotation.h"
+#include "host_test.h"
+#include "nvs.h"
+#include "user_config.h"
+
+#define W EXAMPLE_LCD_H_RES
+#define H EXAMPLE_LCD_V_RES
+
+typedef struct
+{
+    int x;
+    int y;
+} point_t;
+
+static point_t map(display_rotation_t rotation, point_t p)
+{
+    float x;
+    float y;
+    display_rotation_map(display_rotation_transform(rotation), p.x, p.y, &x, &y);
+    return {(int) x, (int) y};
+}
+
+// Where the panel shows the pixel LVGL drew at `p`: rows and columns exchanged first, then the
+// columns and rows mirrored, as the MIPI DCS address order bits do
+static point_t panel_pixel(uint8_t madctl, point_t p)
+{
+    if (madctl & 0x20)
+        p = {p.y, p.x};
+    if (madctl & 0x40)
+        p.x = W - 1 - p.x;
+    if (madctl & 0x80)
+        p.y = H - 1 - p.y;
+    return p;
+}
+
+// No point leaves the panel or shares its target with another
+static void test_onto_the_panel(void)
+{
+    static uint8_t hit[H][W];
+    for (int r = 0; r < DISPLAY_ROTATIONS; r++)
+    {
+        memset(hit, 0, sizeof(hit));
+        uint32_t outside = 0;
+        for (int y = 0; y < H; y++)
+        {
+            for (int x = 0; x < W; x++)
+            {
+                const point_t p = map((display_rotation_t) r, {x, y});
+                if (p.x < 0 || p.x >= W || p.y < 0 || p.y >= H)
+                    outside++;
+                else
+                    hit[p.y][p.x]++;
+            }
+        }
+        CHECK_EQ(outside, 0);
+        uint32_t once = 0;
+        for (int y = 0; y < H; y++)
+            for (int x = 0; x < W; x++)
+                once += hit[y][x] == 1;
+        CHECK_EQ(once, W * H);
+    }
+}
+
+// Touching the panel where a pixel lights up gives back the LVGL coordinates of that pixel
+static void test_matches_madctl(void)
+{
+    static const point_t points[] = {{0, 0}, {W - 1, 0}, {0, H - 1}, {W - 1, H - 1}, {12, 300},
+                                     {180, 180}, {359, 41}};
+    for (int r = 0; r < DISPLAY_ROTATIONS; r++)
+    {
+        const uint8_t madctl = display_rotation_madctl((display_rotation_t) r);
+        for (const point_t& lvgl : points)
+        {
+            const point_t touch = panel_pixel(madctl, lvgl);
+            const point_t back  = map((display_rotation_t) r, touch);
+            CHECK_EQ(back.x, lvgl.x);
+            CHECK_EQ(back.y, lvgl.y);
+        }
+    }
+    CHECK_EQ(display_rotation_madctl(DISPLAY_ROTATION_0), 0x00);
+}
+
+// At 90 degrees the middle of the top edge of the panel is the middle of the left edge of the UI.
+// Turning by 90 four times, or by 90 and then 270, is no rotation.
+static void test_turns(void)
+{
+    const point_t top = map(DISPLAY_ROTATION_90, {W / 2, 0});
+    CHECK_EQ(top.x, 0);
+    CHECK_EQ(top.y, H / 2 - 1);
+    const point_t half = map(DISPLAY_ROTATION_180, {10, 20});
+    CHECK_EQ(half.x, W - 11);
+    CHECK_EQ(half.y, H - 21);
+
+    static const point_t points[] = {{0, 0}, {W - 1, 7}, {100, 250}, {359, 359}};
+    for (const point_t& p : points)
+    {
+        point_t q = p;
+        for (int i = 0; i < 4; i++)
+            q = map(DISPLAY_ROTATION_90, q);
+        CHECK_EQ(q.x, p.x);
+        CHECK_EQ(q.y, p.y);
+        q = map(DISPLAY_ROTATION_270, map(DISPLAY_ROTATION_90, p));
+        CHECK_EQ(q.x, p.x);
+        CHECK_EQ(q.y, p.y);
+        q = map(DISPLAY_ROTATION_180, map(DISPLAY_ROTATION_180, p));
+        CHECK_EQ(q.x, p.x);
+        CHECK_EQ(q.y, p.y);
+        q = map(DISPLAY_ROTATION_0, p);
+        CHECK_EQ(q.x, p.x);
+        CHECK_EQ(q.y, p.y);
+    }
+}
+
+static void test_nvs(void)
+{
+    host_nvs_reset();
+    CHECK_EQ(display_rotation_load(), EXAMPLE_ROTATION_DEFAULT / 90 % 4);
+
+    CHECK_EQ(display_rotation_save(DISPLAY_ROTATION_270), ESP_OK);
+    CHECK_EQ(display_rotation_load(), DISPLAY_ROTATION_270);
+    CHECK_EQ(display_rotation_save(DISPLAY_ROTATION_90), ESP_OK);
+    CHECK_EQ(display_rotation_load(), DISPLAY_ROTATION_90);
+
+    // Not a rotation, as from another firmware: the default
+    nvs_handle_t nvs;
+    CHECK_EQ(nvs_open("display", NVS_READWRITE, &nvs), ESP_OK);
+    CHECK_EQ(nvs_set_u8(nvs, "rotation", 7), ESP_OK);
+    nvs_close(nvs);
+    CHECK_EQ(display_rotation_load(), EXAMPLE_ROTATION_DEFAULT / 90 % 4);
+
+    host_nvs_open_err = ESP_ERR_NO_MEM;
+    CHECK_EQ(display_rotation_save(DISPLAY_ROTATION_180), ESP_ERR_NO_MEM);
+    CHECK_EQ(display_rotation_load(), EXAMPLE_ROTATION_DEFAULT / 90 % 4);
+    host_nvs_open_err = ESP_OK;
+    uint8_t value     = 0;
+    CHECK(host_nvs_get_u8("display", "rotation", &value));
+    CHECK_EQ(value, 7);
+}
+
+int main(void)
+{
+    RUN_TEST(test_onto_the_panel);
+    RUN_TEST(test_matches_madctl);
+    RUN_TEST(test_turns);
+    RUN_TEST(test_nvs);
+    return host_test_result();
+}
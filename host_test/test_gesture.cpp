@@ -0,0 +1,117 @@
+// Gesture recognizer on a trace with one touch per case: a tap, swipes, strokes that are too slow
+// or diagonal, a long press and a jog along the bezel, with and without jogs enabled. Each touch
+// has to come out as exactly the expected gesture.
+
+#include <string.h>
+#include "gesture.h"
+#include "host_test.h"
+#include "touch_sampler.h"
+
+static const touch_sample_t s_trace[] = {
+#include "traces/gestures.inc"
+};
+static const uint32_t s_trace_len = sizeof(s_trace) / sizeof(s_trace[0]);
+
+#define TOUCHES 8
+
+typedef struct
+{
+    uint32_t count[GESTURE_JOG + 1]; // Events by type
+    float    jog_deg;
+    bool     owned; // The recognizer took the touch from the widgets at some point
+    int16_t  x;     // Start of the touch, as reported by the last event
+    int16_t  y;
+} touch_result_t;
+
+static touch_result_t s_results[TOUCHES];
+
+// Feeds the trace like the indev read does, returns the number of touches
+static uint32_t replay(bool jog_enabled)
+{
+    gesture_recognizer_t g;
+    gesture_init(&g, jog_enabled);
+    memset(s_results, 0, sizeof(s_results));
+    uint32_t touch = 0;
+    for (uint32_t i = 0; i < s_trace_len && touch < TOUCHES; i++)
+    {
+        const touch_sample_t* s = &s_trace[i];
+        gesture_event_t       event;
+        touch_result_t*       r = &s_results[touch];
+        if (gesture_feed(&g, s->x, s->y, s->pressed, s->time_us, &event))
+        {
+            r->count[event.type]++;
+            r->jog_deg += event.jog_deg;
+            r->x = event.x;
+            r->y = event.y;
+        }
+        r->owned |= gesture_owns_touch(&g);
+        if (!s->pressed)
+        {
+            CHECK(!gesture_owns_touch(&g));
+            touch++;
+        }
+    }
+    return touch;
+}
+
+static uint32_t events(const touch_result_t* r)
+{
+    uint32_t n = 0;
+    for (uint32_t c : r->count)
+        n += c;
+    return n;
+}
+
+// Only the one gesture, once
+static bool only(const touch_result_t* r, gesture_type_t type)
+{
+    return r->count[type] == 1 && events(r) == 1 && !r->owned;
+}
+
+static void test_swipes(void)
+{
+    CHECK_EQ(replay(false), TOUCHES);
+    CHECK_EQ(events(&s_results[0]), 0); // Tap
+    CHECK(only(&s_results[1], GESTURE_SWIPE_RIGHT));
+    CHECK_NEAR(s_results[1].x, 90, 1);
+    CHECK_NEAR(s_results[1].y, 150, 1);
+    CHECK(only(&s_results[2], GESTURE_SWIPE_LEFT));
+    CHECK_EQ(events(&s_results[3]), 0); // Too slow
+    CHECK_EQ(events(&s_results[4]), 0); // Diagonal
+    CHECK(only(&s_results[5], GESTURE_SWIPE_UP));
+}
+
+static void test_long_press(void)
+{
+    replay(false);
+    CHECK(only(&s_results[6], GESTURE_LONG_PRESS));
+}
+
+// With jogs off the quarter turn is a diagonal stroke, nothing. With them on it locks in after
+// EXAMPLE_GESTURE_JOG_START_DEG and reports the whole way round, and owns the touch.
+static void test_jog(void)
+{
+    replay(false);
+    CHECK_EQ(events(&s_results[7]), 0);
+    CHECK(!s_results[7].owned);
+
+    replay(true);
+    const touch_result_t* r = &s_results[7];
+    CHECK(r->owned);
+    CHECK(r->count[GESTURE_JOG] > 10);
+    CHECK_EQ(events(r), r->count[GESTURE_JOG]);
+    CHECK_NEAR(r->jog_deg, 90, 2);
+
+    // The other touches don't start in the ring, or don't travel around it
+    for (uint32_t i = 0; i < 7; i++)
+        CHECK_EQ(s_results[i].count[GESTURE_JOG], 0);
+    CHECK(only(&s_results[1], GESTURE_SWIPE_RIGHT));
+}
+
+int main(void)
+{
+    RUN_TEST(test_swipes);
+    RUN_TEST(test_long_press);
+    RUN_TEST(test_jog);
+    return host_test_result();
+}
@@ -0,0 +1,220 @@
+// Haptics task against a mock DRV2605 on the I2C bus: the effects reach the sequencer in the order
+// they were asked for, detent bursts merge, a sequence starts right away when the chip is idle and
+// no later than one poll after the previous one ends, and the bus sees only the few transfers a
+// sequence needs.
+
+#include <string.h>
+#include <vector>
+#include "host_test.h"
+#include "freertos/FreeRTOS.h"
+#include "haptics.h"
+#include "i2c_bsp.h"
+#include "user_config.h"
+
+#define REG_STATUS   0x00
+#define REG_MODE     0x01
+#define REG_LIBRARY  0x03
+#define REG_WAVESEQ1 0x04
+#define REG_GO       0x0C
+#define REG_FEEDBACK 0x1A
+
+#define ID_DRV2605L 7
+
+#define TICK   26 // Effect ids of the ROM library haptics.cpp plays
+#define CLICK  4
+#define DOUBLE 10
+
+i2c_master_dev_handle_t disp_touch_dev_handle = NULL;
+i2c_master_dev_handle_t drv2605_dev_handle    = (i2c_master_dev_handle_t) &drv2605_dev_handle;
+
+typedef struct
+{
+    std::vector<uint8_t> effects;
+    int64_t              go_us; // GO written
+} sequence_t;
+
+// The chip: registers, and the sequencer playing until `busy_until_us`
+static struct
+{
+    uint8_t                 regs[256];
+    int64_t                 busy_until_us;
+    std::vector<sequence_t> played;
+    uint32_t                transfers;
+    int64_t                 bus_us;
+} s_drv;
+
+// Register address and data, one ACK bit per byte
+static int64_t bus_time_us(uint32_t bytes)
+{
+    return (int64_t) (bytes + 2) * 9 * 1000000 / EXAMPLE_I2C_SPEED_HZ;
+}
+
+static int64_t effect_ms(uint8_t id)
+{
+    return id == DOUBLE ? 90 : id == CLICK ? 30 : 15;
+}
+
+static void bus_transfer(uint32_t bytes)
+{
+    const int64_t us = bus_time_us(bytes);
+    host_time_us += us;
+    s_drv.bus_us += us;
+    s_drv.transfers++;
+}
+
+uint8_t i2c_read_buff(i2c_master_dev_handle_t dev_handle, int reg, uint8_t* buf, uint8_t len)
+{
+    CHECK(dev_handle == drv2605_dev_handle);
+    if (reg == REG_GO)
+        s_drv.regs[REG_GO] = host_time_us < s_drv.busy_until_us;
+    memcpy(buf, s_drv.regs + reg, len);
+    bus_transfer(len);
+    return ESP_OK;
+}
+
+uint8_t i2c_write_buff(i2c_master_dev_handle_t dev_handle, int reg, uint8_t* buf, uint8_t len)
+{
+    CHECK(dev_handle == drv2605_dev_handle);
+    bus_transfer(len);
+    memcpy(s_drv.regs + reg, buf, len);
+    if (reg == REG_GO && (buf[0] & 1))
+    {
+        CHECK(host_time_us >= s_drv.busy_until_us); // Never restarted while playing
+        sequence_t seq;
+        int64_t    ms = 0;
+        for (int i = 0; i < 8 && s_drv.regs[REG_WAVESEQ1 + i]; i++)
+        {
+            seq.effects.push_back(s_drv.regs[REG_WAVESEQ1 + i]);
+            ms += effect_ms(s_drv.regs[REG_WAVESEQ1 + i]);
+        }
+        seq.go_us           = host_time_us;
+        s_drv.busy_until_us = host_time_us + ms * 1000;
+        s_drv.played.push_back(seq);
+    }
+    return ESP_OK;
+}
+
+static haptics_stats_t stats(void)
+{
+    haptics_stats_t s;
+    haptics_get_stats(&s);
+    return s;
+}
+
+// Lets the queued sequences play out and the task go back to waiting
+static void settle(void)
+{
+    do
+        host_freertos_advance(2 * EXAMPLE_HAPTICS_POLL_MS * 1000);
+    while (host_time_us < s_drv.busy_until_us + EXAMPLE_HAPTICS_POLL_MS * 1000);
+    s_drv.played.clear();
+}
+
+static bool played(uint32_t i, std::vector<uint8_t> effects)
+{
+    return i < s_drv.played.size() && s_drv.played[i].effects == effects;
+}
+
+static void test_init(void)
+{
+    CHECK_EQ(s_drv.regs[REG_MODE], 0x00); // Out of standby, internal trigger
+    CHECK_EQ(s_drv.regs[REG_LIBRARY], EXAMPLE_HAPTICS_LIBRARY);
+    CHECK_EQ(s_drv.regs[REG_FEEDBACK] & 0x80, EXAMPLE_HAPTICS_LRA ? 0x80 : 0);
+    CHECK_EQ(s_drv.regs[REG_FEEDBACK] & 0x7F, 0x36); // The rest kept
+    CHECK(s_drv.played.empty());
+}
+
+// Asked for while the task was busy elsewhere: one sequence, in order
+static void test_order(void)
+{
+    haptics_play(HAPTICS_CLICK);
+    haptics_play(HAPTICS_LONG_PRESS);
+    haptics_play(HAPTICS_DETENT);
+    haptics_play(HAPTICS_CLICK);
+    host_freertos_run();
+    CHECK_EQ(s_drv.played.size(), 1);
+    CHECK(played(0, {CLICK, DOUBLE, TICK, CLICK}));
+    settle();
+}
+
+static void test_detents_merge(void)
+{
+    const uint32_t coalesced = stats().coalesced;
+    for (int i = 0; i < 10; i++)
+        haptics_play(HAPTICS_DETENT);
+    haptics_play(HAPTICS_CLICK);
+    haptics_play(HAPTICS_DETENT);
+    haptics_play(HAPTICS_DETENT);
+    host_freertos_run();
+    CHECK(played(0, {TICK, CLICK, TICK}));
+    CHECK_EQ(stats().coalesced, coalesced + 10);
+    settle();
+}
+
+// More than the sequencer holds: the rest goes in the next sequence, the queue drops the overflow
+static void test_overflow(void)
+{
+    const haptics_stats_t before = stats();
+    for (int i = 0; i < 20; i++)
+        haptics_play(i % 2 ? HAPTICS_CLICK : HAPTICS_LONG_PRESS);
+    host_freertos_run();
+    settle();
+    // Sixteen queued, the first and then seven more in one sequence, the other eight after it
+    const haptics_stats_t after = stats();
+    CHECK_EQ(after.requested - before.requested, 20);
+    CHECK_EQ(after.dropped - before.dropped, 4);
+    CHECK_EQ(after.sequences - before.sequences, 2);
+    CHECK_EQ(after.effects - before.effects, 16);
+}
+
+// Idle chip: GO goes out within the two writes. Busy chip: the next sequence waits for GO to
+// clear, and starts no later than one poll after that.
+static void test_timing(void)
+{
+    const haptics_stats_t before = stats();
+    const uint32_t        xfers  = s_drv.transfers;
+    const int64_t         ask_us = host_time_us;
+    haptics_play(HAPTICS_LONG_PRESS);
+    host_freertos_run();
+    CHECK_EQ(s_drv.played.size(), 1);
+    CHECK(s_drv.played[0].go_us - ask_us <= bus_time_us(8) + bus_time_us(1));
+    CHECK_EQ(s_drv.transfers - xfers, 2);
+    const int64_t end_us = s_drv.busy_until_us;
+
+    // Comes in while the double click plays
+    host_freertos_advance(10000);
+    haptics_play(HAPTICS_CLICK);
+    host_freertos_run();
+    CHECK_EQ(s_drv.played.size(), 1);
+    while (s_drv.played.size() < 2 && host_time_us < end_us + 100000)
+        host_freertos_advance(1000);
+    CHECK_EQ(s_drv.played.size(), 2);
+    CHECK(s_drv.played[1].go_us >= end_us);
+    CHECK(s_drv.played[1].go_us <= end_us + EXAMPLE_HAPTICS_POLL_MS * 1000 + 1000);
+    settle();
+
+    // The GO bit is read once per poll while playing, and once more after the chip cleared it
+    const haptics_stats_t after = stats();
+    const uint32_t        polls = after.polls - before.polls;
+    CHECK_NEAR(polls, (effect_ms(DOUBLE) + effect_ms(CLICK)) / EXAMPLE_HAPTICS_POLL_MS + 2, 1);
+    CHECK_EQ(s_drv.transfers - xfers, 2 * 2 + polls);
+    CHECK_EQ(after.bus_errors, 0);
+    CHECK_EQ(after.bus_us, s_drv.bus_us);
+}
+
+int main(void)
+{
+    s_drv.regs[REG_STATUS]   = ID_DRV2605L << 5;
+    s_drv.regs[REG_FEEDBACK] = 0x36; // Reset value
+    s_drv.regs[REG_MODE]     = 0x40; // Standby
+    CHECK(haptics_init());
+    host_freertos_run();
+
+    RUN_TEST(test_init);
+    RUN_TEST(test_order);
+    RUN_TEST(test_detents_merge);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_timing);
+    host_freertos_reset();
+    return host_test_result();
+}
@@ -0,0 +1,631 @@
+// I2C bus task against mock devices on a mock bus. Register writes go out as the register byte and
+// the caller's buffer, with the same bytes on the wire as the heap copy they replaced and no
+// allocation, and the benchmark prints what the copy used to cost per write. A touch read waits
+// for at most the one transaction on the wire, however much lower priority traffic is queued. With
+// faults injected, failing devices back off, a timeout clears the bus, and a touch controller that
+// keeps failing is reset and switched back to normal mode before it is read again.
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include "host_test.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "i2c_bsp.h"
+#include "user_config.h"
+
+#define MOCK_DEVS 4
+
+#define SENSOR_ADDR 0x6B // Not added by i2c_master_Init(), so it goes at sensor priority
+
+#define TOUCH_MODE_RESET 0x01  // Anything but normal mode, which reports no touches
+#define TOUCH_BOOT_US    50000 // From the RST release to the first ACK
+
+// Everything allocated through malloc() by the test and i2c_bsp.c, see -Wl,--wrap=malloc
+static uint32_t s_mallocs;
+
+extern "C" void* __real_malloc(size_t size);
+extern "C" void* __wrap_malloc(size_t size)
+{
+    s_mallocs++;
+    return __real_malloc(size);
+}
+
+// A register file behind an address: a write sets the register pointer and stores the rest from
+// there on, a read reads from the pointer
+typedef struct
+{
+    uint16_t             address;
+    uint8_t              regs[256];
+    uint8_t              reg;
+    uint32_t             stretch_us; // Clock stretching on every transaction
+    uint32_t             transactions;
+    uint32_t             multi_buffer; // Writes handed over as several buffers
+    uint8_t              wire[260];    // Bytes of the last write, register first
+    size_t               wire_len;
+    std::vector<int64_t> started_us; // Of every transaction that reached the bus
+    esp_err_t            fail;       // Returned by the next `fail_cnt` transactions, a NACK
+    uint32_t             fail_cnt;
+    int                  rst_pin;  // -1 for none
+    int64_t              rst_us;   // Release of the last reset seen
+    int64_t              ready_us; // NACKs everything before, booting
+    uint32_t             resets;
+    int64_t              mode_us; // Last write to register 0
+} mock_dev_t;
+
+static struct
+{
+    mock_dev_t devs[MOCK_DEVS];
+    int        dev_cnt;
+    uint32_t   speed_hz;
+    int        busy; // Transactions on the wire, never more than one
+    uint32_t   resets;
+} s_bus;
+
+// A touch read the touch task asked for, and when its done callback ran
+typedef struct
+{
+    int64_t   asked_us;
+    int64_t   done_us;
+    esp_err_t ret;
+    uint8_t   buf[7];
+} touch_read_t;
+
+// When the touch task asks for the next reads. It runs on the other core, so it asks while
+// another transaction is on the wire.
+static std::deque<int64_t>       s_touch_at;
+static std::vector<touch_read_t> s_touch_reads;
+
+static void touch_done(esp_err_t ret, void* arg)
+{
+    touch_read_t* read = &s_touch_reads[(intptr_t) arg];
+    read->done_us      = host_time_us;
+    read->ret          = ret;
+}
+
+static void touch_ask(void)
+{
+    s_touch_reads.push_back({host_time_us, -1, ESP_FAIL, {}});
+    touch_read_t*    read = &s_touch_reads.back();
+    const i2c_xfer_t xfer = {.dev      = disp_touch_dev_handle,
+                             .reg      = 0x00,
+                             .read_buf = read->buf,
+                             .read_len = sizeof(read->buf),
+                             .done     = touch_done,
+                             .arg      = (void*) (intptr_t) (s_touch_reads.size() - 1)};
+    CHECK_EQ(i2c_bsp_submit(&xfer), ESP_OK);
+}
+
+// Time on the bus, with the touch task asking on the way
+static void bus_time(int64_t us)
+{
+    const int64_t end = host_time_us + us;
+    while (!s_touch_at.empty() && s_touch_at.front() < end)
+    {
+        host_time_us = std::max(host_time_us, s_touch_at.front());
+        s_touch_at.pop_front();
+        touch_ask();
+    }
+    host_time_us = end;
+}
+
+// Address and data, one ACK bit per byte
+static int64_t wire_us(size_t bytes)
+{
+    return (int64_t) bytes * 9 * 1000000 / s_bus.speed_hz;
+}
+
+static mock_dev_t* mock_dev(uint16_t address)
+{
+    for (int i = 0; i < s_bus.dev_cnt; i++)
+    {
+        if (s_bus.devs[i].address == address)
+            return &s_bus.devs[i];
+    }
+    return NULL;
+}
+
+// A pulse on RST since the last transaction: back to the defaults, and booting
+static void reset_line(mock_dev_t* dev)
+{
+    const host_gpio_t* rst = &host_gpio[dev->rst_pin];
+    if (rst->mode != GPIO_MODE_OUTPUT || rst->changed_us == dev->rst_us)
+        return;
+    dev->resets++;
+    dev->regs[0]  = TOUCH_MODE_RESET;
+    dev->rst_us   = rst->changed_us;
+    dev->ready_us = rst->level ? rst->changed_us + TOUCH_BOOT_US : INT64_MAX;
+}
+
+static esp_err_t transaction(i2c_master_dev_handle_t handle, const uint8_t* write, size_t write_len,
+                             uint8_t* read, size_t read_len, int timeout_ms)
+{
+    mock_dev_t* dev = (mock_dev_t*) handle;
+    CHECK(s_bus.busy++ == 0);
+    dev->transactions++;
+    dev->started_us.push_back(host_time_us);
+    if (dev->rst_pin >= 0)
+        reset_line(dev);
+    const int64_t us = dev->stretch_us + wire_us(1 + write_len + (read_len ? 1 + read_len : 0));
+    if (us > timeout_ms * 1000)
+    {
+        bus_time(timeout_ms * 1000);
+        s_bus.busy--;
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = host_time_us < dev->ready_us ? ESP_FAIL : ESP_OK;
+    if (dev->fail_cnt)
+    {
+        dev->fail_cnt--;
+        ret = dev->fail;
+    }
+    if (ret != ESP_OK)
+    {
+        bus_time(wire_us(1)); // Address NACKed
+        s_bus.busy--;
+        return ret;
+    }
+    bus_time(us);
+    if (write_len > 1 && write[0] == 0)
+        dev->mode_us = host_time_us;
+    if (write_len)
+    {
+        dev->reg = write[0];
+        for (size_t i = 1; i < write_len; i++)
+            dev->regs[(uint8_t) (dev->reg + i - 1)] = write[i];
+        memcpy(dev->wire, write, write_len);
+        dev->wire_len = write_len;
+    }
+    for (size_t i = 0; i < read_len; i++)
+        read[i] = dev->regs[(uint8_t) (dev->reg + i)];
+    if (dev->rst_pin >= 0 && dev->regs[0] != 0 && read_len > 2 && dev->reg == 0)
+        read[2] = 0; // Touch data only in normal mode
+    s_bus.busy--;
+    return ESP_OK;
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* config,
+                             i2c_master_bus_handle_t*       ret_bus_handle)
+{
+    *ret_bus_handle = (i2c_master_bus_handle_t) &s_bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t    bus_handle,
+                                    const i2c_device_config_t* dev_config,
+                                    i2c_master_dev_handle_t*   ret_handle)
+{
+    if (s_bus.dev_cnt == MOCK_DEVS)
+        return ESP_ERR_NO_MEM;
+    mock_dev_t* dev = &s_bus.devs[s_bus.dev_cnt++];
+    dev->address    = dev_config->device_address;
+    dev->rst_pin    = dev->address == EXAMPLE_TOUCH_ADDR ? EXAMPLE_PIN_NUM_TOUCH_RST : -1;
+    s_bus.speed_hz  = dev_config->scl_speed_hz;
+    *ret_handle     = (i2c_master_dev_handle_t) dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_reset(i2c_master_bus_handle_t bus_handle)
+{
+    s_bus.resets++;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t* write_buffer,
+                              size_t write_size, int xfer_timeout_ms)
+{
+    return transaction(i2c_dev, write_buffer, write_size, NULL, 0, xfer_timeout_ms);
+}
+
+esp_err_t i2c_master_multi_buffer_transmit(i2c_master_dev_handle_t                  i2c_dev,
+                                           i2c_master_transmit_multi_buffer_info_t* buffer_info,
+                                           size_t array_size, int xfer_timeout_ms)
+{
+    // One start condition, the buffers back to back
+    uint8_t bytes[260];
+    size_t  len = 0;
+    for (size_t i = 0; i < array_size; i++)
+    {
+        memcpy(bytes + len, buffer_info[i].write_buffer, buffer_info[i].buffer_size);
+        len += buffer_info[i].buffer_size;
+    }
+    ((mock_dev_t*) i2c_dev)->multi_buffer++;
+    return transaction(i2c_dev, bytes, len, NULL, 0, xfer_timeout_ms);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t* write_buffer,
+                                      size_t write_size, uint8_t* read_buffer, size_t read_size,
+                                      int xfer_timeout_ms)
+{
+    return transaction(i2c_dev, write_buffer, write_size, read_buffer, read_size, xfer_timeout_ms);
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t* read_buffer,
+                             size_t read_size, int xfer_timeout_ms)
+{
+    return transaction(i2c_dev, NULL, 0, read_buffer, read_size, xfer_timeout_ms);
+}
+
+// The register write before the bus task: a heap copy with the register in front
+static esp_err_t copy_write(i2c_master_dev_handle_t dev_handle, int reg, uint8_t* buf, uint8_t len)
+{
+    uint8_t* pbuf = (uint8_t*) malloc(len + 1);
+    pbuf[0]       = reg;
+    for (uint8_t i = 0; i < len; i++)
+        pbuf[i + 1] = buf[i];
+    const esp_err_t ret = i2c_master_transmit(dev_handle, pbuf, len + 1, EXAMPLE_I2C_DEADLINE_MS);
+    free(pbuf);
+    return ret;
+}
+
+// The register write of i2c_execute()
+static esp_err_t multi_buffer_write(i2c_master_dev_handle_t dev_handle, int reg, uint8_t* buf,
+                                    uint8_t len)
+{
+    uint8_t                                 addr     = (uint8_t) reg;
+    i2c_master_transmit_multi_buffer_info_t parts[2] = {
+        {.write_buffer = &addr, .buffer_size = 1},
+        {.write_buffer = buf, .buffer_size = len},
+    };
+    return i2c_master_multi_buffer_transmit(dev_handle, parts, len ? 2 : 1,
+                                            EXAMPLE_I2C_DEADLINE_MS);
+}
+
+static void fill(uint8_t* buf, size_t len, uint8_t seed)
+{
+    for (size_t i = 0; i < len; i++)
+        buf[i] = (uint8_t) (seed + i * 37);
+}
+
+// Through the bus task: the register and the data as one write, straight from the caller's buffer
+static void test_register_write(void)
+{
+    mock_dev_t* drv = mock_dev(EXAMPLE_DRV2605_ADDR);
+    uint8_t     data[16];
+    fill(data, sizeof(data), 1);
+    const uint32_t mallocs = s_mallocs;
+    const uint32_t multi   = drv->multi_buffer;
+    CHECK_EQ(i2c_write_buff(drv2605_dev_handle, 0x04, data, sizeof(data)), ESP_OK);
+    CHECK_EQ(s_mallocs, mallocs);
+    CHECK_EQ(drv->multi_buffer, multi + 1);
+    CHECK_EQ(drv->wire_len, 1 + sizeof(data));
+    CHECK_EQ(drv->wire[0], 0x04);
+    CHECK(memcmp(drv->wire + 1, data, sizeof(data)) == 0);
+    CHECK(memcmp(drv->regs + 0x04, data, sizeof(data)) == 0);
+
+    // Register only, as the touch mode switch and register pointer writes do
+    CHECK_EQ(i2c_write_buff(drv2605_dev_handle, 0x0C, data, 0), ESP_OK);
+    CHECK_EQ(drv->wire_len, 1);
+    CHECK_EQ(drv->wire[0], 0x0C);
+    CHECK_EQ(s_mallocs, mallocs);
+
+    i2c_dev_stats_t stats;
+    CHECK(i2c_bsp_get_stats(drv2605_dev_handle, &stats));
+    CHECK_EQ(stats.writes, 2);
+    CHECK_EQ(stats.errors, 0);
+}
+
+// Both writes on the mock bus for the payloads the firmware uses (mode switch, DRV2605 sequence)
+// and larger ones. Same bytes on the wire, so the same bus time; the copy adds an allocation and a
+// copy per write. Host CPU time, not the ESP32-S3's, only the ratio carries over.
+static void test_benchmark(void)
+{
+    static const uint8_t sizes[]    = {1, 8, 32, 128};
+    const int            iterations = 200000;
+    mock_dev_t*          drv        = mock_dev(EXAMPLE_DRV2605_ADDR);
+    printf("    bytes  multi-buffer ns  copy ns  copy allocations\n");
+    for (uint8_t len : sizes)
+    {
+        uint8_t data[128];
+        fill(data, len, len);
+
+        copy_write(drv2605_dev_handle, 0x10, data, len);
+        uint8_t copied[260];
+        memcpy(copied, drv->wire, drv->wire_len);
+        const size_t copied_len = drv->wire_len;
+        multi_buffer_write(drv2605_dev_handle, 0x10, data, len);
+        CHECK_EQ(drv->wire_len, copied_len);
+        CHECK(memcmp(drv->wire, copied, copied_len) == 0);
+
+        double         ns[2];
+        const uint32_t mallocs = s_mallocs;
+        uint32_t       allocs[2];
+        for (int path = 0; path < 2; path++)
+        {
+            const uint32_t before = s_mallocs;
+            const auto     start  = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                if (path == 0)
+                    multi_buffer_write(drv2605_dev_handle, 0x10, data, len);
+                else
+                    copy_write(drv2605_dev_handle, 0x10, data, len);
+            }
+            const std::chrono::duration<double, std::nano> took =
+                std::chrono::steady_clock::now() - start;
+            ns[path]     = took.count() / iterations;
+            allocs[path] = s_mallocs - before;
+        }
+        CHECK_EQ(allocs[0], 0);
+        CHECK_EQ(allocs[1], iterations);
+        CHECK_EQ(s_mallocs - mallocs, iterations);
+        printf("    %5u  %15.1f  %7.1f  %16u\n", len, ns[0], ns[1], allocs[1] / iterations);
+    }
+}
+
+// Low priority traffic that keeps its queues full until `s_flood_until_us`
+typedef struct
+{
+    i2c_xfer_t xfer;
+    uint8_t    buf[32];
+    uint32_t   done;
+} flood_t;
+
+static int64_t                 s_flood_until_us;
+static i2c_master_dev_handle_t s_sensor;
+
+static void flood_done(esp_err_t ret, void* arg)
+{
+    flood_t* f = (flood_t*) arg;
+    CHECK_EQ(ret, ESP_OK);
+    f->done++;
+    if (host_time_us < s_flood_until_us)
+        CHECK_EQ(i2c_bsp_submit(&f->xfer), ESP_OK);
+}
+
+// The slowest transaction below touch: a sensor read stretched to just under its deadline
+static int64_t sensor_us(void)
+{
+    return mock_dev(SENSOR_ADDR)->stretch_us + wire_us(1 + 1 + 1 + 32);
+}
+
+// Two seconds of `haptics` DRV2605 sequence writes and `sensors` sensor reads in flight, with a
+// touch read asked for every 10 ms at a different phase each time. Every touch read has to finish
+// within the longest lower priority transaction plus its own. Returns the flood transactions done.
+static uint32_t flood(int haptics, int sensors)
+{
+    static flood_t flows[16];
+    memset(flows, 0, sizeof(flows));
+    for (int i = 0; i < haptics + sensors; i++)
+    {
+        flood_t* f = &flows[i];
+        if (i < haptics)
+            f->xfer = {.dev       = drv2605_dev_handle,
+                       .reg       = 0x04,
+                       .write_buf = f->buf,
+                       .write_len = 8,
+                       .done      = flood_done,
+                       .arg       = f};
+        else
+            f->xfer = {.dev      = s_sensor,
+                       .reg      = 0x28,
+                       .read_buf = f->buf,
+                       .read_len = 32,
+                       .done     = flood_done,
+                       .arg      = f};
+    }
+
+    i2c_prio_stats_t before;
+    i2c_bsp_get_prio_stats(I2C_PRIO_TOUCH, &before);
+    s_touch_reads.clear();
+    s_touch_reads.reserve(200);
+    const int64_t start_us = host_time_us + 1000;
+    s_flood_until_us       = start_us + 2000000;
+    for (int i = 0; i < 200; i++)
+        s_touch_at.push_back(start_us + i * 10000 + (i * 7919) % 10000);
+    host_freertos_advance(start_us - host_time_us);
+    for (int i = 0; i < haptics + sensors; i++)
+        CHECK_EQ(i2c_bsp_submit(&flows[i].xfer), ESP_OK);
+    host_freertos_run();
+    CHECK(s_touch_at.empty());
+    CHECK(host_time_us >= s_flood_until_us);
+
+    const int64_t touch_us = wire_us(1 + 1 + 1 + 7);
+    int64_t       worst_us = 0;
+    CHECK_EQ(s_touch_reads.size(), 200);
+    for (const touch_read_t& r : s_touch_reads)
+    {
+        CHECK_EQ(r.ret, ESP_OK);
+        CHECK_EQ(r.buf[2], 1);
+        worst_us = std::max(worst_us, r.done_us - r.asked_us);
+    }
+    CHECK(worst_us <= sensor_us() + touch_us);
+
+    i2c_prio_stats_t after;
+    i2c_bsp_get_prio_stats(I2C_PRIO_TOUCH, &after);
+    CHECK_EQ(after.completed - before.completed, 200);
+    CHECK_EQ(after.rejected, 0);
+    CHECK(after.wait_max_us <= sensor_us());
+
+    uint32_t done = 0;
+    for (int i = 0; i < haptics + sensors; i++)
+        done += flows[i].done;
+    printf("    touch reads done within %" PRId64 " us, %" PRIu32 " transactions alongside\n",
+           worst_us, done);
+    return done;
+}
+
+// Sensor reads back to back, each holding the bus for most of its deadline. With the queue full
+// all the time a FIFO would have put eight of them in front of each touch read.
+static void test_touch_under_sensor_load(void)
+{
+    const uint32_t done = flood(0, 8);
+    CHECK(done > 2000000 / sensor_us() * 9 / 10);
+}
+
+// Both lower levels full. The haptics writes take the bus the touch reads leave, the sensor reads
+// wait for them, and the touch reads still only wait for the transaction on the wire.
+static void test_touch_under_mixed_load(void)
+{
+    i2c_dev_stats_t before;
+    CHECK(i2c_bsp_get_stats(drv2605_dev_handle, &before));
+    flood(8, 8);
+    i2c_dev_stats_t after;
+    CHECK(i2c_bsp_get_stats(drv2605_dev_handle, &after));
+    CHECK(after.writes - before.writes > 2000);
+}
+
+typedef struct
+{
+    esp_err_t ret;
+    bool      done;
+} sync_t;
+
+static void sync_done(esp_err_t ret, void* arg)
+{
+    sync_t* sync = (sync_t*) arg;
+    sync->ret    = ret;
+    sync->done   = true;
+}
+
+// i2c_read_buff() and i2c_write_buff() with the whole error code, they truncate it to a byte
+static esp_err_t transact(i2c_master_dev_handle_t dev, int reg, uint8_t* buf, uint8_t len,
+                          bool write)
+{
+    sync_t     sync = {ESP_FAIL, false};
+    i2c_xfer_t xfer = {.dev = dev, .reg = reg, .done = sync_done, .arg = &sync};
+    if (write)
+    {
+        xfer.write_buf = buf;
+        xfer.write_len = len;
+    }
+    else
+    {
+        xfer.read_buf = buf;
+        xfer.read_len = len;
+    }
+    const esp_err_t ret = i2c_bsp_submit(&xfer);
+    if (ret != ESP_OK)
+        return ret;
+    // The bus task may sleep on the way, holding RST low
+    host_freertos_run();
+    while (!sync.done)
+        host_freertos_advance(1000);
+    return sync.ret;
+}
+
+static i2c_dev_stats_t dev_stats(i2c_master_dev_handle_t dev)
+{
+    i2c_dev_stats_t stats = {};
+    CHECK(i2c_bsp_get_stats(dev, &stats));
+    return stats;
+}
+
+// The controller NACKs EXAMPLE_I2C_RESET_AFTER reads in a row while the touch task keeps reading
+// every 10 ms. It is reset through RST, left alone while it boots, and switched back to normal mode
+// before the next read, which reports the finger again.
+static void test_touch_reset(void)
+{
+    mock_dev_t*           touch  = mock_dev(EXAMPLE_TOUCH_ADDR);
+    const i2c_dev_stats_t before = dev_stats(disp_touch_dev_handle);
+    const int64_t         start  = host_time_us;
+    touch->fail                  = ESP_FAIL;
+    touch->fail_cnt              = EXAMPLE_I2C_RESET_AFTER;
+
+    uint8_t  buf[7];
+    int64_t  ok_us   = -1;
+    uint32_t failed  = 0;
+    uint32_t refused = 0;
+    while (ok_us < 0 && host_time_us < start + 1000000)
+    {
+        const esp_err_t ret = transact(disp_touch_dev_handle, 0x00, buf, sizeof(buf), false);
+        if (ret == ESP_OK)
+            ok_us = host_time_us;
+        else if (ret == ESP_ERR_INVALID_STATE)
+            refused++;
+        else
+            failed++;
+        host_freertos_advance(10000);
+    }
+    CHECK_EQ(failed, EXAMPLE_I2C_RESET_AFTER);
+    CHECK(refused > 0);
+    CHECK_EQ(touch->resets, 1);
+    CHECK_EQ(host_gpio[EXAMPLE_PIN_NUM_TOUCH_RST].level, 1);
+    CHECK(ok_us >= touch->rst_us + EXAMPLE_I2C_TOUCH_BOOT_MS * 1000);
+    CHECK_EQ(touch->regs[0], 0x00);
+    CHECK(touch->mode_us >= touch->ready_us);
+    CHECK(touch->mode_us <= ok_us);
+    CHECK_EQ(buf[2], 1);
+
+    const i2c_dev_stats_t after = dev_stats(disp_touch_dev_handle);
+    CHECK_EQ(after.errors - before.errors, EXAMPLE_I2C_RESET_AFTER);
+    CHECK_EQ(after.resets - before.resets, 1);
+    CHECK_EQ(after.skipped - before.skipped, refused);
+    CHECK_EQ(after.writes - before.writes, 1); // The mode switch
+}
+
+// The DRV2605 holds SCL past its deadline. Each timeout clears the bus, and the device is left
+// alone for twice as long after each failure in a row, while the touch reads go on.
+static void test_timeout_backoff(void)
+{
+    mock_dev_t*           drv    = mock_dev(EXAMPLE_DRV2605_ADDR);
+    const i2c_dev_stats_t before = dev_stats(drv2605_dev_handle);
+    const uint32_t        clears = s_bus.resets;
+    drv->stretch_us              = (EXAMPLE_I2C_DEADLINE_MS + 10) * 1000;
+    drv->started_us.clear();
+
+    // Asked for every millisecond, the bus only sees the ones after each back-off
+    uint8_t data[8] = {};
+    uint8_t buf[7];
+    for (int i = 0; i < 200; i++)
+    {
+        const esp_err_t ret = transact(drv2605_dev_handle, 0x04, data, sizeof(data), true);
+        CHECK(ret == ESP_ERR_TIMEOUT || ret == ESP_ERR_INVALID_STATE);
+        if (i % 10 == 0)
+            CHECK_EQ(transact(disp_touch_dev_handle, 0x00, buf, sizeof(buf), false), ESP_OK);
+        host_freertos_advance(1000);
+    }
+    const std::vector<int64_t>& at = drv->started_us;
+    CHECK_EQ(at.size(), 5);
+    int64_t backoff_us = EXAMPLE_I2C_BACKOFF_MIN_MS * 1000;
+    for (size_t i = 1; i < at.size(); i++)
+    {
+        const int64_t gap_us = at[i] - at[i - 1] - EXAMPLE_I2C_DEADLINE_MS * 1000;
+        CHECK(gap_us >= backoff_us);
+        CHECK(gap_us <= backoff_us + 2000);
+        backoff_us *= 2;
+    }
+    const i2c_dev_stats_t failing = dev_stats(drv2605_dev_handle);
+    CHECK_EQ(failing.errors - before.errors, at.size());
+    CHECK_EQ(failing.bus_clears - before.bus_clears, at.size());
+    CHECK_EQ(s_bus.resets - clears, at.size());
+    CHECK_EQ(failing.resets, before.resets); // Only the touch controller has a reset line
+    CHECK_EQ(failing.skipped - before.skipped, 200 - at.size());
+
+    // Released: the first write after the back-off gets through, and the next one right away
+    drv->stretch_us = 0;
+    host_freertos_advance(EXAMPLE_I2C_BACKOFF_MAX_MS * 1000);
+    CHECK_EQ(transact(drv2605_dev_handle, 0x04, data, sizeof(data), true), ESP_OK);
+    CHECK_EQ(transact(drv2605_dev_handle, 0x04, data, sizeof(data), true), ESP_OK);
+    CHECK_EQ(dev_stats(drv2605_dev_handle).errors, failing.errors);
+}
+
+int main(void)
+{
+    host_gpio_reset();
+    i2c_master_Init();
+    CHECK_EQ(s_bus.dev_cnt, 2);
+    CHECK(mock_dev(EXAMPLE_TOUCH_ADDR) != NULL);
+    host_freertos_run();
+
+    const i2c_device_config_t sensor = {.dev_addr_length = I2C_ADDR_BIT_LEN_7,
+                                        .device_address  = SENSOR_ADDR,
+                                        .scl_speed_hz    = EXAMPLE_I2C_SPEED_HZ};
+    CHECK_EQ(i2c_master_bus_add_device((i2c_master_bus_handle_t) &s_bus, &sensor, &s_sensor),
+             ESP_OK);
+    mock_dev(SENSOR_ADDR)->stretch_us     = EXAMPLE_I2C_DEADLINE_MS * 1000 - 500;
+    mock_dev(EXAMPLE_TOUCH_ADDR)->regs[2] = 1; // One finger
+
+    RUN_TEST(test_register_write);
+    RUN_TEST(test_benchmark);
+    RUN_TEST(test_touch_under_sensor_load);
+    RUN_TEST(test_touch_under_mixed_load);
+    RUN_TEST(test_touch_reset);
+    RUN_TEST(test_timeout_backoff);
+    host_freertos_reset();
+    return host_test_result();
+}
@@ -0,0 +1,182 @@
+// Input-to-photon measurement: the histogram buckets, which input a response belongs to, and the
+// inputs that end up unanswered or overlapped
+
+#include "esp_timer.h"
+#include "host_test.h"
+#include "input_latency.h"
+#include "lvgl.h"
+
+static lv_obj_t* s_queue;
+static lv_obj_t* s_player;
+static lv_obj_t* s_unnamed;
+
+static const lv_area_t ROW   = {0, 100, 359, 140};
+static const lv_area_t OTHER = {0, 300, 359, 340};
+
+static void setup(void)
+{
+    input_latency_reset();
+    host_time_us = 1000000;
+}
+
+static void show(lv_obj_t* scr)
+{
+    lv_host_disp()->act_scr = scr;
+}
+
+// An input read at the current time, answered by invalidating ROW, flushed `latency_us` after
+// the hardware saw it
+static void answered(input_latency_type_t type, int64_t latency_us)
+{
+    const int64_t input_us = host_time_us;
+    input_latency_indev_read();
+    input_latency_input(type, input_us);
+    input_latency_invalidate(&ROW);
+    host_time_us = input_us + latency_us;
+    input_latency_indev_read();
+    input_latency_flush(&ROW);
+    host_time_us += 1000;
+}
+
+static void test_buckets(void)
+{
+    setup();
+    show(s_queue);
+    static const int64_t latencies[] = {0, 4999, 5000, 9999, 10000, 159999, 160000, 10000000};
+    for (int64_t us : latencies)
+        answered(INPUT_LATENCY_TOUCH_DRAG, us);
+
+    const input_latency_hist_t* h = input_latency_get_hist("queue", INPUT_LATENCY_TOUCH_DRAG);
+    CHECK(h != NULL);
+    if (!h)
+        return;
+    CHECK_EQ(h->count, 8);
+    CHECK_EQ(h->buckets[0], 2); // [0, 5) ms
+    CHECK_EQ(h->buckets[1], 2); // [5, 10) ms
+    CHECK_EQ(h->buckets[2], 1);
+    CHECK_EQ(h->buckets[31], 1); // [155, 160) ms
+    CHECK_EQ(h->buckets[INPUT_LATENCY_BUCKETS - 1], 2); // 160 ms and slower
+    CHECK_EQ(h->max_us, 10000000);
+    CHECK_EQ(h->sum_us, 0 + 4999 + 5000 + 9999 + 10000 + 159999 + 160000 + 10000000);
+    uint32_t total = 0;
+    for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+        total += h->buckets[i];
+    CHECK_EQ(total, h->count);
+}
+
+// Each screen and input type has its own histogram, screens without a name share "other"
+static void test_attribution(void)
+{
+    setup();
+    show(s_queue);
+    answered(INPUT_LATENCY_TOUCH_PRESS, 12000);
+    answered(INPUT_LATENCY_ENCODER, 30000);
+    show(s_player);
+    answered(INPUT_LATENCY_ENCODER, 7000);
+    show(s_unnamed);
+    answered(INPUT_LATENCY_TOUCH_RELEASE, 3000);
+
+    const input_latency_hist_t* h = input_latency_get_hist("queue", INPUT_LATENCY_TOUCH_PRESS);
+    CHECK(h && h->count == 1 && h->buckets[2] == 1);
+    h = input_latency_get_hist("queue", INPUT_LATENCY_ENCODER);
+    CHECK(h && h->count == 1 && h->buckets[6] == 1);
+    h = input_latency_get_hist("player", INPUT_LATENCY_ENCODER);
+    CHECK(h && h->count == 1 && h->buckets[1] == 1);
+    h = input_latency_get_hist("other", INPUT_LATENCY_TOUCH_RELEASE);
+    CHECK(h && h->count == 1 && h->buckets[0] == 1);
+    CHECK(input_latency_get_hist("player", INPUT_LATENCY_TOUCH_PRESS) == NULL);
+    CHECK(input_latency_get_hist("settings", INPUT_LATENCY_ENCODER) == NULL);
+
+    input_latency_stats_t stats;
+    input_latency_get_stats(&stats);
+    CHECK_EQ(stats.inputs, 4);
+    CHECK_EQ(stats.measured, 4);
+    input_latency_report();
+}
+
+// The response is what gets invalidated until the next indev read, and only a flush over it counts
+static void test_response_window(void)
+{
+    setup();
+    show(s_queue);
+
+    // Nothing invalidated before the next read: unanswered
+    input_latency_indev_read();
+    input_latency_input(INPUT_LATENCY_TOUCH_PRESS, host_time_us);
+    host_time_us += 30000;
+    input_latency_indev_read();
+    input_latency_invalidate(&ROW); // Too late, belongs to nothing
+    input_latency_flush(&ROW);
+    const input_latency_hist_t* h = input_latency_get_hist("queue", INPUT_LATENCY_TOUCH_PRESS);
+    CHECK(h && h->count == 0 && h->unanswered == 1);
+
+    // A flush elsewhere doesn't end it, the one over the response does. The refresh may also come
+    // before the next read.
+    const int64_t input_us = host_time_us;
+    input_latency_input(INPUT_LATENCY_TOUCH_DRAG, input_us);
+    input_latency_invalidate(&ROW);
+    host_time_us += 8000;
+    input_latency_flush(&OTHER);
+    host_time_us += 4000;
+    input_latency_flush(&ROW);
+    h = input_latency_get_hist("queue", INPUT_LATENCY_TOUCH_DRAG);
+    CHECK(h && h->count == 1 && h->max_us == 12000);
+
+    // The bounding box of everything invalidated is the response
+    input_latency_indev_read();
+    input_latency_input(INPUT_LATENCY_TOUCH_DRAG, host_time_us);
+    input_latency_invalidate(&ROW);
+    input_latency_invalidate(&OTHER);
+    input_latency_indev_read();
+    const lv_area_t between = {0, 200, 359, 210};
+    host_time_us += 5000;
+    input_latency_flush(&between);
+    CHECK(h->count == 2);
+}
+
+// An input while an earlier one still waits rides along with it, and a response that is never
+// flushed is dropped after the timeout
+static void test_overlap_and_timeout(void)
+{
+    setup();
+    show(s_player);
+    input_latency_indev_read();
+    input_latency_input(INPUT_LATENCY_ENCODER, host_time_us);
+    input_latency_invalidate(&ROW);
+    input_latency_indev_read();
+    host_time_us += 20000;
+    input_latency_input(INPUT_LATENCY_ENCODER, host_time_us);
+
+    input_latency_stats_t stats;
+    input_latency_get_stats(&stats);
+    CHECK_EQ(stats.inputs, 2);
+    CHECK_EQ(stats.overlapped, 1);
+
+    // Clipped away, say outside the round panel: never flushed
+    host_time_us += EXAMPLE_INPUT_LATENCY_TIMEOUT_MS * 1000;
+    input_latency_indev_read();
+    input_latency_get_stats(&stats);
+    CHECK_EQ(stats.unanswered, 1);
+    CHECK_EQ(stats.measured, 0);
+
+    // Measuring again afterwards
+    answered(INPUT_LATENCY_ENCODER, 9000);
+    const input_latency_hist_t* h = input_latency_get_hist("player", INPUT_LATENCY_ENCODER);
+    CHECK(h && h->count == 1 && h->unanswered == 1 && h->buckets[1] == 1);
+}
+
+int main(void)
+{
+    lv_host_reset();
+    s_queue   = lv_obj_create(NULL);
+    s_player  = lv_obj_create(NULL);
+    s_unnamed = lv_obj_create(NULL);
+    input_latency_name_screen(s_queue, "queue");
+    input_latency_name_screen(s_player, "player");
+
+    RUN_TEST(test_buckets);
+    RUN_TEST(test_attribution);
+    RUN_TEST(test_response_window);
+    RUN_TEST(test_overlap_and_timeout);
+    return host_test_result();
+}
@@ -0,0 +1,221 @@
+// PCNT knob backend against contact waveforms: bouncing presses and releases, chatter while the
+// contact is held, sub-microsecond glitches and fast spins. Each detent has to come out exactly
+// once, on the edge that closes the contact.
+
+#include <algorithm>
+#include <vector>
+#include "host_test.h"
+#include "bidi_switch_knob.h"
+#include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
+#include "freertos/FreeRTOS.h"
+
+#define PIN_A 8 // Closes once per clockwise detent
+#define PIN_B 7
+
+typedef struct
+{
+    int64_t ns;
+    int     gpio;
+    int     level;
+} edge_t;
+
+static std::vector<edge_t> s_wave;
+static knob_handle_t       s_knob;
+static uint32_t            s_seed = 1;
+
+static struct
+{
+    uint32_t count[KNOB_EVENT_MAX];
+    int64_t  last_us;
+} s_detents;
+
+static uint32_t next_rand(uint32_t n)
+{
+    s_seed = s_seed * 1664525 + 1013904223;
+    return (s_seed >> 8) % n;
+}
+
+static void knob_cb(void* knob, void* arg)
+{
+    s_detents.count[(intptr_t) arg]++;
+    s_detents.last_us = host_time_us;
+}
+
+// The contact closes at `ns`, or opens with `level` 1. A bouncing contact flips back for a few
+// pulses of 20 to 300 us first.
+static int64_t contact(int gpio, int level, int64_t ns, int bounces)
+{
+    s_wave.push_back({ns, gpio, level});
+    for (int i = 0; i < bounces; i++)
+    {
+        ns += 20000 + next_rand(280000);
+        s_wave.push_back({ns, gpio, !level});
+        ns += 20000 + next_rand(280000);
+        s_wave.push_back({ns, gpio, level});
+    }
+    return ns;
+}
+
+// One detent: the phase closes, is held for `hold_ms` and opens again
+static int64_t detent(int gpio, int64_t ns, int hold_ms, int bounces)
+{
+    contact(gpio, 0, ns, bounces);
+    return contact(gpio, 1, ns + hold_ms * 1000000LL, bounces);
+}
+
+// Pulses shorter than the glitch filter never reach the counter
+static void glitch_filter(void)
+{
+    const int64_t max_ns = host_pcnt_glitch_ns();
+    std::stable_sort(s_wave.begin(), s_wave.end(),
+                     [](const edge_t& a, const edge_t& b) { return a.ns < b.ns; });
+    std::vector<edge_t> out;
+    for (const edge_t& e : s_wave)
+    {
+        // The last edge on this pin, if it was less than the filter ago the pulse goes
+        auto last = std::find_if(out.rbegin(), out.rend(),
+                                 [&](const edge_t& o) { return o.gpio == e.gpio; });
+        if (last != out.rend() && e.ns - last->ns < max_ns)
+            out.erase(std::next(last).base());
+        else
+            out.push_back(e);
+    }
+    s_wave = out;
+}
+
+// Drives the waveform into the pins, the knob task runs on its own ticks in between. Leaves the
+// contacts settled.
+static void play(void)
+{
+    glitch_filter();
+    for (const edge_t& e : s_wave)
+    {
+        const int64_t us = (e.ns + 999) / 1000;
+        if (us > host_time_us)
+            host_freertos_advance(us - host_time_us);
+        host_pcnt_input(e.gpio, e.level);
+        host_freertos_run();
+    }
+    s_wave.clear();
+    host_freertos_advance(50000);
+}
+
+static int64_t now_ns(void)
+{
+    return host_time_us * 1000;
+}
+
+static void setup(void)
+{
+    s_detents = {};
+    iot_knob_clear_count_value(s_knob);
+}
+
+// Counted as the contact closes, not once it opens again like the timer backend did
+static void test_counts_on_the_press_edge(void)
+{
+    setup();
+    const int64_t press = now_ns() + 1000000;
+    detent(PIN_A, press, 12, 0);
+    glitch_filter();
+    host_freertos_advance(press / 1000 - host_time_us);
+    host_pcnt_input(PIN_A, 0);
+    host_freertos_run();
+    CHECK_EQ(s_detents.count[KNOB_RIGHT], 1);
+    CHECK_EQ(s_detents.last_us, press / 1000);
+    CHECK_EQ(iot_knob_get_count_value(s_knob), 1);
+    CHECK_EQ(iot_knob_get_event(s_knob), KNOB_RIGHT);
+    s_wave.erase(s_wave.begin());
+    play();
+    CHECK_EQ(s_detents.count[KNOB_RIGHT], 1);
+    CHECK_EQ(s_detents.count[KNOB_LEFT], 0);
+}
+
+// Bounce at both ends of every detent, at up to 40 detents/s
+static void test_bounce(void)
+{
+    setup();
+    int64_t ns = now_ns() + 1000000;
+    for (int i = 0; i < 50; i++)
+    {
+        const int gpio = i < 30 ? PIN_A : PIN_B;
+        ns = detent(gpio, ns, 5 + next_rand(10), 1 + next_rand(6));
+        ns += (5 + next_rand(10)) * 1000000LL;
+    }
+    play();
+    CHECK_EQ(s_detents.count[KNOB_RIGHT], 30);
+    CHECK_EQ(s_detents.count[KNOB_LEFT], 20);
+    CHECK_EQ(iot_knob_get_count_value(s_knob), 10);
+}
+
+// The contact lifts for a moment while held, shorter than the debounce: still one detent
+static void test_chatter_while_held(void)
+{
+    setup();
+    const int64_t ns = now_ns() + 1000000;
+    contact(PIN_B, 0, ns, 2);
+    contact(PIN_B, 1, ns + 6000000, 0);
+    contact(PIN_B, 0, ns + 7500000, 3);
+    detent(PIN_B, ns + 9000000, 0, 0);
+    contact(PIN_B, 1, ns + 14000000, 2);
+    play();
+    CHECK_EQ(s_detents.count[KNOB_LEFT], 1);
+    CHECK_EQ(s_detents.count[KNOB_RIGHT], 0);
+}
+
+// Sub-microsecond spikes on both lines while the knob rests
+static void test_glitches(void)
+{
+    setup();
+    CHECK(host_pcnt_glitch_ns() >= 500);
+    int64_t ns = now_ns() + 1000000;
+    for (int i = 0; i < 200; i++)
+    {
+        const int gpio = i % 2 ? PIN_A : PIN_B;
+        s_wave.push_back({ns, gpio, 0});
+        s_wave.push_back({ns + 100 + next_rand(400), gpio, 1});
+        ns += 1000000 + next_rand(3000000);
+    }
+    play();
+    CHECK_EQ(s_detents.count[KNOB_LEFT] + s_detents.count[KNOB_RIGHT], 0);
+}
+
+// A quick flick: short holds, the contact open just long enough to settle
+static void test_fast_spin(void)
+{
+    setup();
+    int64_t ns = now_ns() + 1000000;
+    for (int i = 0; i < 40; i++)
+    {
+        ns = detent(PIN_A, ns, 3, next_rand(3));
+        ns += 5000000;
+    }
+    play();
+    CHECK_EQ(s_detents.count[KNOB_RIGHT], 40);
+}
+
+int main(void)
+{
+    host_gpio_reset();
+    host_gpio[PIN_A].level = 1; // Pulled up, open
+    host_gpio[PIN_B].level = 1;
+    const knob_config_t config = {.gpio_encoder_a = PIN_A, .gpio_encoder_b = PIN_B};
+    s_knob                     = iot_knob_create(&config);
+    CHECK(s_knob != NULL);
+    CHECK_EQ(host_pcnt_units(), 1);
+    iot_knob_register_cb(s_knob, KNOB_RIGHT, knob_cb, (void*) (intptr_t) KNOB_RIGHT);
+    iot_knob_register_cb(s_knob, KNOB_LEFT, knob_cb, (void*) (intptr_t) KNOB_LEFT);
+    host_freertos_run();
+
+    RUN_TEST(test_counts_on_the_press_edge);
+    RUN_TEST(test_bounce);
+    RUN_TEST(test_chatter_while_held);
+    RUN_TEST(test_glitches);
+    RUN_TEST(test_fast_spin);
+
+    iot_knob_delete(s_knob);
+    CHECK_EQ(host_pcnt_units(), 0);
+    host_freertos_reset();
+    return host_test_result();
+}
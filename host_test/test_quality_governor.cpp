@@ -0,0 +1,207 @@
+// Quality governor driven with synthetic frame times: tier steps, the effects of each tier and
+// the screen transitions taken over from the generated UI. The panels are laid out like the
+// generated screens: translucent ones on a black screen, some nested, some in a transparent box.
+
+#include "host_test.h"
+#include "lvgl.h"
+#include "quality_governor.h"
+#include "user_config.h"
+
+static lv_scr_load_anim_t s_fademode;
+static int                s_spd;
+
+// What the generated ui_helpers.c defines, the linker wrap sends the calls through the governor
+extern "C" void __real__ui_screen_change(lv_obj_t** target, lv_scr_load_anim_t fademode, int spd,
+                                         int delay, void (*target_init)(void))
+{
+    s_fademode = fademode;
+    s_spd      = spd;
+}
+
+extern "C" void __wrap__ui_screen_change(lv_obj_t** target, lv_scr_load_anim_t fademode, int spd,
+                                         int delay, void (*target_init)(void));
+
+static lv_obj_t* s_scr;   // Black, with a wallpaper at 50
+static lv_obj_t* s_row;   // Translucent white row panel, bg_opa 30 with a border at 150
+static lv_obj_t* s_inner; // Black at bg_opa 127 on the row
+static lv_obj_t* s_title; // Panel at bg_opa 150 in the colour of the theme, no local one
+static lv_obj_t* s_box;   // Transparent container
+static lv_obj_t* s_panel; // Green title panel at bg_opa 30 in the container, as the generated UI has
+
+static const lv_color_t GREEN = lv_color_hex(0x1DDA63);
+
+static const uint32_t FRAME_PX = EXAMPLE_QUALITY_MIN_PX;
+static const uint32_t OVER_MS  = EXAMPLE_QUALITY_BUDGET_MS * 2;
+static const uint32_t OK_MS    = EXAMPLE_QUALITY_BUDGET_MS - 1; // In budget, no headroom
+static const uint32_t FAST_MS  = EXAMPLE_QUALITY_BUDGET_MS / 2; // Under 60% of the budget
+
+static void set_opa(lv_obj_t* obj, lv_style_prop_t prop, int32_t opa)
+{
+    lv_style_value_t value;
+    value.num = opa;
+    lv_obj_set_local_style_prop(obj, prop, value, LV_PART_MAIN | LV_STATE_DEFAULT);
+}
+
+static int32_t get_opa(lv_obj_t* obj, lv_style_prop_t prop)
+{
+    lv_style_value_t value;
+    if (lv_obj_get_local_style_prop(obj, prop, &value, LV_PART_MAIN | LV_STATE_DEFAULT) !=
+        LV_RES_OK)
+        return -1;
+    return value.num;
+}
+
+static void set_color(lv_obj_t* obj, lv_color_t color)
+{
+    lv_style_value_t value;
+    value.color = color;
+    lv_obj_set_local_style_prop(obj, LV_STYLE_BG_COLOR, value, LV_PART_MAIN | LV_STATE_DEFAULT);
+}
+
+// The local background colour, -1 without one
+static int32_t get_color(lv_obj_t* obj)
+{
+    lv_style_value_t value;
+    if (lv_obj_get_local_style_prop(obj, LV_STYLE_BG_COLOR, &value,
+                                    LV_PART_MAIN | LV_STATE_DEFAULT) != LV_RES_OK)
+        return -1;
+    return value.color.full;
+}
+
+// One decision window with `over` frames over budget, the rest at `rest_ms`
+static quality_tier_t window(uint32_t over, uint32_t rest_ms)
+{
+    for (uint32_t i = 0; i < EXAMPLE_QUALITY_WINDOW; i++)
+        quality_governor_frame_done(i < over ? OVER_MS : rest_ms, FRAME_PX);
+    return quality_governor_get_tier();
+}
+
+static void screen_change(void)
+{
+    lv_obj_t* target = s_scr;
+    __wrap__ui_screen_change(&target, LV_SCR_LOAD_ANIM_FADE_ON, 500, 0, NULL);
+}
+
+static void test_small_frames_ignored(void)
+{
+    for (int i = 0; i < 10 * EXAMPLE_QUALITY_WINDOW; i++)
+        quality_governor_frame_done(OVER_MS * 4, FRAME_PX - 1);
+    CHECK_EQ(quality_governor_get_tier(), QUALITY_TIER_FULL);
+}
+
+static void test_quarter_over_holds(void)
+{
+    for (int i = 0; i < 4; i++)
+        CHECK_EQ(window(EXAMPLE_QUALITY_WINDOW / 4, OK_MS), QUALITY_TIER_FULL);
+    screen_change();
+    CHECK_EQ(s_fademode, LV_SCR_LOAD_ANIM_FADE_ON);
+    CHECK_EQ(s_spd, 500);
+}
+
+static void test_steps_down(void)
+{
+    const uint32_t over = EXAMPLE_QUALITY_WINDOW / 4 + 1;
+
+    CHECK_EQ(window(over, OK_MS), QUALITY_TIER_NO_TRANSITIONS);
+    screen_change();
+    CHECK_EQ(s_fademode, LV_SCR_LOAD_ANIM_NONE);
+    CHECK_EQ(s_spd, 0);
+    CHECK_EQ(get_opa(s_row, LV_STYLE_BG_OPA), 30);
+
+    // Translucent panels turn opaque in the colour they had over their background
+    CHECK_EQ(window(over, OK_MS), QUALITY_TIER_OPAQUE);
+    const lv_color_t row = lv_color_mix(lv_color_white(), lv_color_black(), 30);
+    CHECK_EQ(get_opa(s_row, LV_STYLE_BG_OPA), LV_OPA_COVER);
+    CHECK_EQ(get_color(s_row), row.full);
+    CHECK_EQ(get_opa(s_row, LV_STYLE_BORDER_OPA), LV_OPA_COVER);
+    CHECK_EQ(get_opa(s_inner, LV_STYLE_BG_OPA), LV_OPA_COVER);
+    CHECK_EQ(get_color(s_inner), lv_color_mix(lv_color_black(), row, 127).full);
+    CHECK_EQ(get_opa(s_title, LV_STYLE_BG_OPA), LV_OPA_COVER);
+    CHECK_EQ(get_color(s_title), lv_color_mix(lv_color_white(), lv_color_black(), 150).full);
+    CHECK_EQ(get_opa(s_box, LV_STYLE_BG_OPA), LV_OPA_TRANSP);
+    CHECK_EQ(get_opa(s_panel, LV_STYLE_BG_OPA), LV_OPA_COVER);
+    CHECK_EQ(get_color(s_panel), lv_color_mix(GREEN, lv_color_black(), 30).full);
+    CHECK(get_color(s_panel) != lv_color_black().full);
+    CHECK_EQ(get_opa(s_scr, LV_STYLE_BG_IMG_OPA), LV_OPA_TRANSP);
+    CHECK(lv_host_disp()->driver->antialiasing);
+
+    const uint32_t invalidated = s_scr->invalidated;
+    CHECK_EQ(window(over, OK_MS), QUALITY_TIER_NO_AA);
+    CHECK(!lv_host_disp()->driver->antialiasing);
+    CHECK(s_scr->invalidated > invalidated);
+
+    // Nothing below the last tier
+    CHECK_EQ(window(EXAMPLE_QUALITY_WINDOW, OK_MS), QUALITY_TIER_NO_AA);
+}
+
+static void test_no_headroom_holds(void)
+{
+    for (int i = 0; i < 4; i++)
+        CHECK_EQ(window(0, OK_MS), QUALITY_TIER_NO_AA);
+    // Headroom has to come in windows in a row
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_NO_AA);
+    CHECK_EQ(window(0, OK_MS), QUALITY_TIER_NO_AA);
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_NO_AA);
+}
+
+static void test_steps_up(void)
+{
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_OPAQUE);
+    CHECK(lv_host_disp()->driver->antialiasing);
+    CHECK_EQ(get_opa(s_row, LV_STYLE_BG_OPA), LV_OPA_COVER);
+
+    // Colour and opacity both come back, a colour from the theme stays with the theme
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_OPAQUE);
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_NO_TRANSITIONS);
+    CHECK_EQ(get_opa(s_row, LV_STYLE_BG_OPA), 30);
+    CHECK_EQ(get_color(s_row), lv_color_white().full);
+    CHECK_EQ(get_opa(s_row, LV_STYLE_BORDER_OPA), 150);
+    CHECK_EQ(get_opa(s_inner, LV_STYLE_BG_OPA), 127);
+    CHECK_EQ(get_color(s_inner), lv_color_black().full);
+    CHECK_EQ(get_opa(s_title, LV_STYLE_BG_OPA), 150);
+    CHECK_EQ(get_color(s_title), -1);
+    CHECK_EQ(get_opa(s_panel, LV_STYLE_BG_OPA), 30);
+    CHECK_EQ(get_color(s_panel), GREEN.full);
+    CHECK_EQ(get_opa(s_scr, LV_STYLE_BG_IMG_OPA), 50);
+    screen_change();
+    CHECK_EQ(s_fademode, LV_SCR_LOAD_ANIM_NONE);
+
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_NO_TRANSITIONS);
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_FULL);
+    screen_change();
+    CHECK_EQ(s_fademode, LV_SCR_LOAD_ANIM_FADE_ON);
+    CHECK_EQ(s_spd, 500);
+
+    CHECK_EQ(window(0, FAST_MS), QUALITY_TIER_FULL);
+}
+
+int main(void)
+{
+    lv_host_reset();
+    s_scr   = lv_obj_create(NULL);
+    s_row   = lv_obj_create(s_scr);
+    s_inner = lv_obj_create(s_row);
+    s_title = lv_obj_create(s_scr);
+    s_box   = lv_obj_create(s_scr);
+    s_panel = lv_obj_create(s_box);
+    set_color(s_scr, lv_color_black());
+    set_opa(s_scr, LV_STYLE_BG_OPA, LV_OPA_COVER);
+    set_opa(s_scr, LV_STYLE_BG_IMG_OPA, 50);
+    set_color(s_row, lv_color_white());
+    set_opa(s_row, LV_STYLE_BG_OPA, 30);
+    set_opa(s_row, LV_STYLE_BORDER_OPA, 150);
+    set_color(s_inner, lv_color_black());
+    set_opa(s_inner, LV_STYLE_BG_OPA, 127);
+    set_opa(s_title, LV_STYLE_BG_OPA, 150);
+    set_opa(s_box, LV_STYLE_BG_OPA, LV_OPA_TRANSP);
+    set_color(s_panel, GREEN);
+    set_opa(s_panel, LV_STYLE_BG_OPA, 30);
+
+    // One governor, the tests continue from the tier the previous one left
+    RUN_TEST(test_small_frames_ignored);
+    RUN_TEST(test_quarter_over_holds);
+    RUN_TEST(test_steps_down);
+    RUN_TEST(test_no_headroom_holds);
+    RUN_TEST(test_steps_up);
+    return host_test_result();
+}
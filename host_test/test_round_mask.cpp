@@ -0,0 +1,243 @@
+// Round mask clip of the blends, driven the way lv_refr drives a draw context: buf_area and
+// clip_area point at the stripe being rendered, with nothing set up before the first blend. Each
+// blend must reach LVGL's blend clipped to the bounding box of its visible pixels, and the
+// statistics must add up to what was blended and sent.
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "lvgl.h"
+#include "round_mask.h"
+#include "user_config.h"
+
+#define BUF_W EXAMPLE_LCD_H_RES
+#define BUF_H EXAMPLE_LVGL_BUF_HEIGHT
+
+static lv_color_t         s_buf[BUF_W * BUF_H];
+static lv_color_t         s_layer[BUF_W * BUF_H];
+static lv_disp_draw_buf_t s_draw_buf = {s_buf, NULL, s_buf, BUF_W * BUF_H};
+static lv_draw_sw_ctx_t   s_ctx;
+static lv_area_t          s_stripe;
+static uint32_t           s_seed = 1;
+
+// What LVGL's blend was last called with
+static uint32_t  s_calls;
+static lv_area_t s_seen_clip;
+
+static void recording_blend(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc)
+{
+    s_calls++;
+    s_seen_clip = *draw_ctx->clip_area;
+    lv_draw_sw_blend_basic(draw_ctx, dsc);
+}
+
+static uint32_t next_rand(void)
+{
+    s_seed = s_seed * 1664525 + 1013904223;
+    return s_seed >> 8;
+}
+
+// The ellipse test itself, not the span table of round_mask
+static bool visible(int32_t x, int32_t y)
+{
+    const int64_t w  = EXAMPLE_LCD_H_RES;
+    const int64_t h  = EXAMPLE_LCD_V_RES;
+    const int64_t dx = 2 * x + 1 - w;
+    const int64_t dy = 2 * y + 1 - h;
+    return dx * dx * h * h + dy * dy * w * w <= w * w * h * h;
+}
+
+// Bounding box of the visible pixels of `area`, false when there are none
+static bool visible_bbox(const lv_area_t* area, lv_area_t* bbox)
+{
+    bool found = false;
+    for (int32_t y = area->y1; y <= area->y2; y++)
+    {
+        for (int32_t x = area->x1; x <= area->x2; x++)
+        {
+            if (!visible(x, y))
+                continue;
+            if (!found)
+                lv_area_set(bbox, x, y, x, y);
+            bbox->x1 = LV_MIN(bbox->x1, x);
+            bbox->y1 = LV_MIN(bbox->y1, y);
+            bbox->x2 = LV_MAX(bbox->x2, x);
+            bbox->y2 = LV_MAX(bbox->y2, y);
+            found    = true;
+        }
+    }
+    return found;
+}
+
+static bool same_area(const lv_area_t* a, const lv_area_t* b)
+{
+    return a->x1 == b->x1 && a->y1 == b->y1 && a->x2 == b->x2 && a->y2 == b->y2;
+}
+
+static void setup(void)
+{
+    lv_host_reset();
+    lv_disp_drv_t* drv = lv_host_disp()->driver;
+    drv->draw_buf      = &s_draw_buf;
+    drv->draw_ctx      = (lv_draw_ctx_t*) &s_ctx;
+    lv_draw_sw_init_ctx(drv, (lv_draw_ctx_t*) &s_ctx);
+    s_ctx.blend = recording_blend;
+    round_mask_wrap_blend((lv_draw_ctx_t*) &s_ctx);
+    s_calls = 0;
+    // Starts from a clean frame
+    round_mask_frame_done();
+}
+
+// As refr_area() before it renders stripe `row`
+static void start_stripe(int32_t row)
+{
+    lv_area_set(&s_stripe, 0, row * BUF_H, BUF_W - 1, row * BUF_H + BUF_H - 1);
+    s_ctx.base_draw.buf       = s_buf;
+    s_ctx.base_draw.buf_area  = &s_stripe;
+    s_ctx.base_draw.clip_area = &s_stripe;
+    memset(s_buf, 0, sizeof(s_buf));
+}
+
+static void fill(const lv_area_t* area, uint16_t color)
+{
+    lv_draw_sw_blend_dsc_t dsc = {};
+    dsc.blend_area             = area;
+    dsc.color.full             = color;
+    dsc.opa                    = LV_OPA_COVER;
+    s_ctx.blend((lv_draw_ctx_t*) &s_ctx, &dsc);
+}
+
+static void test_wraps_the_blend(void)
+{
+    setup();
+    CHECK(s_ctx.blend != recording_blend);
+    start_stripe(0);
+    fill(&s_stripe, 0xFFFF);
+    CHECK_EQ(s_calls, 1);
+    // The narrowed clip is gone once the blend returns
+    CHECK(s_ctx.base_draw.clip_area == &s_stripe);
+}
+
+// Whole stripes top to bottom: every visible pixel is drawn, nothing outside the visible box of
+// the stripe is
+static void test_clips_every_stripe(void)
+{
+    setup();
+    uint32_t missed  = 0;
+    uint32_t outside = 0;
+    uint32_t drawn   = 0;
+    for (int32_t row = 0; row < EXAMPLE_LCD_V_RES / BUF_H; row++)
+    {
+        start_stripe(row);
+        fill(&s_stripe, 0xFFFF);
+
+        lv_area_t bbox;
+        CHECK(visible_bbox(&s_stripe, &bbox));
+        CHECK(same_area(&s_seen_clip, &bbox));
+        for (int32_t y = s_stripe.y1; y <= s_stripe.y2; y++)
+        {
+            for (int32_t x = 0; x < BUF_W; x++)
+            {
+                const bool set = s_buf[(y - s_stripe.y1) * BUF_W + x].full == 0xFFFF;
+                const bool in  = x >= bbox.x1 && x <= bbox.x2 && y >= bbox.y1 && y <= bbox.y2;
+                missed += visible(x, y) && !set;
+                outside += set && !in;
+                drawn += set;
+            }
+        }
+    }
+    CHECK_EQ(missed, 0);
+    CHECK_EQ(outside, 0);
+    // The corners of the top and bottom stripes are skipped
+    CHECK(drawn < EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES);
+    printf("  full screen fill: %u of %d px blended\n", drawn,
+           EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES);
+}
+
+// Random blends, many of them in the corners
+static void test_random_blends(void)
+{
+    setup();
+    uint32_t bad    = 0;
+    uint32_t hidden = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        start_stripe(next_rand() % (EXAMPLE_LCD_V_RES / BUF_H));
+        const int32_t   x1   = next_rand() % BUF_W;
+        const int32_t   x2   = LV_MIN(BUF_W - 1, x1 + (int32_t) (next_rand() % 64));
+        const int32_t   y1   = s_stripe.y1 - 4 + (int32_t) (next_rand() % (BUF_H + 4));
+        const int32_t   y2   = y1 + (int32_t) (next_rand() % 16);
+        const lv_area_t area = {(lv_coord_t) x1, (lv_coord_t) y1, (lv_coord_t) x2,
+                                (lv_coord_t) y2};
+
+        lv_area_t      clipped;
+        lv_area_t      bbox;
+        const uint32_t calls = s_calls;
+        fill(&area, 0xFFFF);
+        if (!_lv_area_intersect(&clipped, &area, &s_stripe) || !visible_bbox(&clipped, &bbox))
+        {
+            hidden++;
+            bad += s_calls != calls;
+        }
+        else
+        {
+            bad += s_calls != calls + 1 || !same_area(&s_seen_clip, &bbox);
+        }
+    }
+    CHECK_EQ(bad, 0);
+    CHECK(hidden > 0);
+}
+
+// A layer buffer is not in panel coordinates, it goes through as it is
+static void test_layers_unclipped(void)
+{
+    setup();
+    start_stripe(0);
+    s_ctx.base_draw.buf = s_layer;
+    fill(&s_stripe, 0xFFFF);
+    CHECK_EQ(s_calls, 1);
+    CHECK(same_area(&s_seen_clip, &s_stripe));
+    CHECK(s_layer[0].full == 0xFFFF);
+}
+
+static void test_stats(void)
+{
+    setup();
+    round_mask_stats_t before;
+    round_mask_get_stats(&before);
+
+    start_stripe(0);
+    fill(&s_stripe, 0xFFFF);
+    lv_area_t bbox;
+    visible_bbox(&s_stripe, &bbox);
+    // A corner with nothing visible
+    const lv_area_t corner = {0, 0, 9, 9};
+    fill(&corner, 0xFFFF);
+
+    round_mask_band_t bands[BUF_H / 2];
+    const int         band_num =
+        round_mask_pack_bands(&s_stripe, (uint8_t*) s_buf, sizeof(lv_color_t), bands, BUF_H / 2);
+    uint32_t sent = 0;
+    for (int i = 0; i < band_num; i++)
+        sent += lv_area_get_size(&bands[i].area);
+    round_mask_frame_done();
+
+    round_mask_stats_t after;
+    round_mask_get_stats(&after);
+    CHECK_EQ(after.frames, before.frames + 1);
+    CHECK_EQ(after.last_frame.px_full, lv_area_get_size(&s_stripe));
+    CHECK_EQ(after.last_frame.px_blend, lv_area_get_size(&s_stripe) + 100);
+    CHECK_EQ(after.last_frame.px_rendered, lv_area_get_size(&bbox));
+    CHECK_EQ(after.last_frame.px_sent, sent);
+    CHECK(sent < lv_area_get_size(&s_stripe));
+    CHECK_EQ(after.total_px_blend - before.total_px_blend, after.last_frame.px_blend);
+}
+
+int main(void)
+{
+    RUN_TEST(test_wraps_the_blend);
+    RUN_TEST(test_clips_every_stripe);
+    RUN_TEST(test_random_blends);
+    RUN_TEST(test_layers_unclipped);
+    RUN_TEST(test_stats);
+    return host_test_result();
+}
@@ -0,0 +1,238 @@
+// Vector blend backend against LVGL's blend, on the scalar kernels the host runs. Covers what
+// simd_draw adds around the kernels: the split of every row into an aligned body and a scalar
+// head and tail, the mask to mix conversion, strides, clipping and the hand-back to LVGL.
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "lvgl.h"
+#include "parallel_draw.h"
+#include "simd_draw.h"
+#include "user_config.h"
+
+#define BUF_W EXAMPLE_LCD_H_RES
+#define BUF_H 24
+#define SRC_W (BUF_W + 32)
+
+static uint32_t s_split_jobs;
+
+// Both bands one after the other, the lower one as band 1 like on the helper core
+void parallel_draw_rows(parallel_draw_fn fn, void* arg, int32_t y1, int32_t y2, int32_t w)
+{
+    if (y2 > y1)
+    {
+        const int32_t mid = y1 + (y2 - y1 + 1) / 2;
+        fn(arg, y1, mid - 1, 0);
+        fn(arg, mid, y2, 1);
+        s_split_jobs++;
+    }
+    else
+    {
+        fn(arg, y1, y2, 0);
+    }
+}
+
+alignas(16) static lv_color_t s_out[BUF_W * BUF_H];
+alignas(16) static lv_color_t s_ref[BUF_W * BUF_H];
+alignas(16) static lv_color_t s_src[SRC_W * BUF_H + 8];
+alignas(16) static lv_opa_t   s_mask[SRC_W * BUF_H + 8];
+
+static simd_draw_ctx_t  s_ctx;
+static lv_draw_sw_ctx_t s_ref_ctx;
+static lv_area_t        s_buf_area = {0, 100, BUF_W - 1, 100 + BUF_H - 1};
+static lv_area_t        s_clip;
+static uint32_t         s_seed = 1;
+
+static uint32_t next_rand(void)
+{
+    s_seed = s_seed * 1664525 + 1013904223;
+    return s_seed >> 8;
+}
+
+// Mask values with the edge cases of the mix conversion well represented
+static lv_opa_t next_mask(void)
+{
+    static const lv_opa_t edges[] = {0, 1, LV_OPA_MAX - 1, LV_OPA_MAX, LV_OPA_MAX + 1, 255};
+    const uint32_t        r       = next_rand();
+    return r % 3 ? edges[r / 3 % 6] : (lv_opa_t) (r >> 4);
+}
+
+static void setup(void)
+{
+    lv_host_reset();
+    lv_disp_drv_t* drv = lv_host_disp()->driver;
+    simd_draw_ctx_init(drv, (lv_draw_ctx_t*) &s_ctx);
+    lv_draw_sw_init_ctx(drv, (lv_draw_ctx_t*) &s_ref_ctx);
+    drv->draw_ctx = (lv_draw_ctx_t*) &s_ctx;
+    s_clip        = s_buf_area;
+    for (int i = 0; i < BUF_W * BUF_H; i++)
+        s_out[i].full = (uint16_t) next_rand();
+    memcpy(s_ref, s_out, sizeof(s_out));
+}
+
+static void teardown(void)
+{
+    simd_draw_ctx_deinit(lv_host_disp()->driver, (lv_draw_ctx_t*) &s_ctx);
+}
+
+// Blends `dsc` through both contexts, returns true when the buffers still match
+static bool blend_both(const lv_draw_sw_blend_dsc_t* dsc)
+{
+    lv_draw_ctx_t* ctx = (lv_draw_ctx_t*) &s_ctx;
+    ctx->buf           = s_out;
+    ctx->buf_area      = &s_buf_area;
+    ctx->clip_area     = &s_clip;
+    s_ctx.base_sw.blend(ctx, dsc);
+
+    lv_draw_ctx_t* ref = (lv_draw_ctx_t*) &s_ref_ctx;
+    ref->buf           = s_ref;
+    ref->buf_area      = &s_buf_area;
+    ref->clip_area     = &s_clip;
+    s_ref_ctx.blend(ref, dsc);
+    return memcmp(s_out, s_ref, sizeof(s_out)) == 0;
+}
+
+static void fill_sources(int32_t px)
+{
+    for (int32_t i = 0; i < px; i++)
+    {
+        s_src[i].full = (uint16_t) next_rand();
+        s_mask[i]     = next_mask();
+    }
+}
+
+static void test_takes_over_the_blend(void)
+{
+    setup();
+    CHECK(s_ctx.base_sw.blend != lv_draw_sw_blend_basic);
+    CHECK(s_ctx.fg_row[0] && s_ctx.fg_row[1] && s_ctx.mix_row[0] && s_ctx.mix_row[1]);
+    CHECK(simd_draw_self_test());
+    teardown();
+}
+
+// Every head length and width up to a few vectors, so the head, body and tail all get every size
+static void test_row_split(void)
+{
+    setup();
+    static const lv_opa_t opas[] = {LV_OPA_COVER, LV_OPA_MAX, LV_OPA_MAX - 1, LV_OPA_60, 0};
+    uint32_t              bad    = 0;
+    for (int32_t x1 = 0; x1 < 8; x1++)
+    {
+        for (int32_t w = 1; w <= 40; w++)
+        {
+            for (int kind = 0; kind < 4; kind++)
+            {
+                for (lv_opa_t opa : opas)
+                {
+                    const lv_area_t area = {(lv_coord_t) x1, 101, (lv_coord_t) (x1 + w - 1), 102};
+                    fill_sources(w * 2);
+                    lv_draw_sw_blend_dsc_t dsc = {};
+                    dsc.blend_area             = &area;
+                    dsc.color.full             = (uint16_t) next_rand();
+                    dsc.opa                    = opa;
+                    dsc.src_buf                = kind & 1 ? s_src : NULL;
+                    if (kind & 2)
+                    {
+                        dsc.mask_buf  = s_mask;
+                        dsc.mask_area = &area;
+                        dsc.mask_res  = LV_DRAW_MASK_RES_CHANGED;
+                    }
+                    bad += !blend_both(&dsc);
+                }
+            }
+        }
+    }
+    CHECK_EQ(bad, 0);
+    teardown();
+}
+
+// Sources and masks wider than the blend and not aligned like the destination, clipped
+static void test_random_blends(void)
+{
+    setup();
+    uint32_t bad   = 0;
+    uint32_t blends = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        lv_area_t area;
+        area.x1 = (lv_coord_t) (next_rand() % (BUF_W + 20) - 10);
+        area.x2 = (lv_coord_t) (area.x1 + next_rand() % 64 + (i % 8 == 0 ? BUF_W / 2 : 0));
+        area.y1 = (lv_coord_t) (s_buf_area.y1 - 2 + next_rand() % BUF_H);
+        area.y2 = (lv_coord_t) (area.y1 + next_rand() % 12);
+        s_clip  = s_buf_area;
+        s_clip.x1 += next_rand() % 24;
+        s_clip.x2 -= next_rand() % 24;
+        if (lv_area_get_size(&area) > SRC_W * BUF_H)
+            continue;
+        fill_sources((int32_t) lv_area_get_size(&area));
+
+        // Sources start off the 16 byte grid too
+        const uint32_t         shift = next_rand() % 8;
+        lv_draw_sw_blend_dsc_t dsc   = {};
+        dsc.blend_area               = &area;
+        dsc.color.full               = (uint16_t) next_rand();
+        dsc.opa      = next_rand() % 3 ? (lv_opa_t) (255 - next_rand() % 4) : (lv_opa_t) next_rand();
+        dsc.src_buf  = next_rand() % 2 ? s_src + shift : NULL;
+        if (next_rand() % 2)
+        {
+            dsc.mask_buf  = s_mask + shift;
+            dsc.mask_area = &area;
+            dsc.mask_res  = next_rand() % 4 ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER;
+        }
+        bad += !blend_both(&dsc);
+        blends++;
+    }
+    CHECK_EQ(bad, 0);
+    CHECK(blends > 15000);
+    CHECK(s_split_jobs > 0);
+    teardown();
+}
+
+static void test_transparent_mask_draws_nothing(void)
+{
+    setup();
+    const lv_area_t area = {0, 100, 99, 110};
+    memset(s_mask, 0xFF, sizeof(s_mask));
+    lv_draw_sw_blend_dsc_t dsc = {};
+    dsc.blend_area             = &area;
+    dsc.opa                    = LV_OPA_COVER;
+    dsc.mask_buf               = s_mask;
+    dsc.mask_area              = &area;
+    dsc.mask_res               = LV_DRAW_MASK_RES_TRANSP;
+    lv_color_t before          = s_out[0];
+    CHECK(blend_both(&dsc));
+    CHECK_EQ(s_out[0].full, before.full);
+    teardown();
+}
+
+// What the kernels don't cover goes to LVGL unchanged, and still matches
+static void test_falls_back_to_lvgl(void)
+{
+    setup();
+    lv_disp_drv_t*  drv  = lv_host_disp()->driver;
+    const lv_area_t area = {3, 100, 200, 110};
+    fill_sources(lv_area_get_size(&area));
+    lv_draw_sw_blend_dsc_t dsc = {};
+    dsc.blend_area             = &area;
+    dsc.src_buf                = s_src + 1;
+    dsc.opa                    = LV_OPA_COVER; // Opaque image, a memcpy already
+    CHECK(blend_both(&dsc));
+
+    dsc.src_buf          = NULL;
+    dsc.opa              = LV_OPA_60;
+    drv->antialiasing    = 0;
+    CHECK(blend_both(&dsc));
+    drv->antialiasing    = 1;
+    dsc.blend_mode       = LV_BLEND_MODE_ADDITIVE;
+    CHECK(blend_both(&dsc));
+    teardown();
+}
+
+int main(void)
+{
+    RUN_TEST(test_takes_over_the_blend);
+    RUN_TEST(test_row_split);
+    RUN_TEST(test_random_blends);
+    RUN_TEST(test_transparent_mask_draws_nothing);
+    RUN_TEST(test_falls_back_to_lvgl);
+    return host_test_result();
+}
@@ -0,0 +1,174 @@
+// Keep-alive connection against spotify_server.py, plain and over TLS: requests reuse the open
+// connection, and when the server drops a reused one on a request, GET and PUT go out again on a
+// new connection while a POST, which the server may have acted on, is not sent twice.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "spotify_conn.h"
+#if HOST_TLS_OPENSSL
+#include "mbedtls/ssl.h"
+#endif
+
+static pid_t s_server;
+static char  s_ca[4096];
+
+typedef struct
+{
+    char   data[64];
+    size_t len;
+} body_t;
+
+static bool collect(const char* data, size_t len, void* arg)
+{
+    body_t* body = (body_t*) arg;
+    if (body->len + len >= sizeof(body->data))
+        return false;
+    memcpy(body->data + body->len, data, len);
+    body->len += len;
+    body->data[body->len] = '\0';
+    return true;
+}
+
+// Starts the server and returns its port
+static uint16_t start_server(bool tls)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return 0;
+    s_server = fork();
+    if (s_server == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        execl(HOST_TEST_PYTHON, HOST_TEST_PYTHON, "spotify_server.py", tls ? "--tls" : NULL,
+              (char*) NULL);
+        _exit(127);
+    }
+    close(fds[1]);
+    FILE* out  = fdopen(fds[0], "r");
+    int   port = 0;
+    if (!out || fscanf(out, "%d", &port) != 1)
+        port = 0;
+    if (out)
+        fclose(out);
+    return (uint16_t) port;
+}
+
+static void stop_server(void)
+{
+    kill(s_server, SIGTERM);
+    waitpid(s_server, NULL, 0);
+}
+
+static esp_err_t request(spotify_conn_t* conn, const char* method, const char* path,
+                         spotify_timing_t* timing)
+{
+    body_t body = {};
+    return spotify_conn_request(conn, method, path, NULL, NULL, 0, collect, &body, timing);
+}
+
+// How many times the server got `path`
+static int seen(spotify_conn_t* conn, const char* path)
+{
+    char query[64];
+    snprintf(query, sizeof(query), "/seen?path=%s", path);
+    body_t           body = {};
+    spotify_timing_t t;
+    if (spotify_conn_request(conn, "GET", query, NULL, NULL, 0, collect, &body, &t) != ESP_OK)
+        return -1;
+    return atoi(body.data);
+}
+
+static spotify_conn_stats_t stats(const spotify_conn_t* conn)
+{
+    spotify_conn_stats_t s;
+    spotify_conn_get_stats(conn, &s);
+    return s;
+}
+
+static void run(bool tls)
+{
+    const uint16_t port = start_server(tls);
+    CHECK(port != 0);
+    if (!port)
+        return;
+    const spotify_conn_config_t config = {.host       = "localhost",
+                                          .port       = port,
+                                          .use_tls    = tls,
+                                          .ca_pem     = s_ca,
+                                          .timeout_ms = 2000};
+    spotify_conn_t*             conn   = spotify_conn_create(&config);
+    CHECK(conn != NULL);
+    spotify_timing_t t;
+
+    // Opened once, then kept
+    CHECK_EQ(request(conn, "GET", "/v1/me/player", &t), ESP_OK);
+    CHECK_EQ(t.status, 200);
+    CHECK(!t.reused);
+    CHECK_EQ(request(conn, "GET", "/v1/me/player", &t), ESP_OK);
+    CHECK(t.reused);
+    CHECK_EQ(stats(conn).connects, 1);
+
+    // Dropped on the reused connection, answered on the next one
+    CHECK_EQ(request(conn, "GET", "/drop/get", &t), ESP_OK);
+    CHECK_EQ(t.status, 200);
+    CHECK(!t.reused);
+    CHECK_EQ(stats(conn).retries, 1);
+    CHECK_EQ(stats(conn).connects, 2);
+    CHECK_EQ(seen(conn, "/drop/get"), 2);
+
+    CHECK_EQ(request(conn, "PUT", "/drop/put", &t), ESP_OK);
+    CHECK_EQ(stats(conn).retries, 2);
+    CHECK_EQ(seen(conn, "/drop/put"), 2);
+
+    // Like next track: the server got it, so it is not repeated
+    CHECK(request(conn, "POST", "/drop/post", &t) != ESP_OK);
+    CHECK_EQ(stats(conn).retries, 2);
+    CHECK_EQ(stats(conn).failures, 1);
+    CHECK_EQ(seen(conn, "/drop/post"), 1);
+
+    // The server count above opened a new connection, the next request keeps it
+    CHECK_EQ(request(conn, "POST", "/v1/me/player/next", &t), ESP_OK);
+    CHECK(t.reused);
+    CHECK_EQ(stats(conn).connects, 4);
+    if (tls)
+        CHECK(stats(conn).tls_us > 0);
+#if HOST_TLS_OPENSSL
+    // The handshakes after the first resumed its session
+    if (tls)
+        CHECK_EQ(host_mbedtls_resumed(), 3);
+#endif
+
+    spotify_conn_report(conn);
+    spotify_conn_destroy(conn);
+    stop_server();
+}
+
+static void test_plain(void)
+{
+    run(false);
+}
+
+static void test_tls(void)
+{
+    run(true);
+}
+
+int main(void)
+{
+    FILE* ca = fopen("certs/ca.pem", "r");
+    CHECK(ca != NULL);
+    if (ca)
+    {
+        s_ca[fread(s_ca, 1, sizeof(s_ca) - 1, ca)] = '\0';
+        fclose(ca);
+    }
+    RUN_TEST(test_plain);
+    RUN_TEST(test_tls);
+    return host_test_result();
+}
@@ -0,0 +1,409 @@
+// Streaming extraction on fixtures in the shape of the Web API responses the firmware asks for
+// (playback state, queue, a page of saved tracks, a page of playlist tracks, all pretty-printed as
+// the API sends them, the saved tracks with every non-ASCII character as a \u escape). The tracks
+// come out the same however the body is cut into chunks. The benchmark sets the parser against
+// cJSON, the DOM parser ESP-IDF ships, where the build found it.
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "spotify_json.h"
+#if HOST_TEST_CJSON
+#include "cJSON.h"
+#endif
+
+static uint32_t s_mallocs;
+static uint32_t s_seed = 1;
+
+extern "C" void* __real_malloc(size_t size);
+extern "C" void* __wrap_malloc(size_t size)
+{
+    s_mallocs++;
+    return __real_malloc(size);
+}
+
+static const char* const s_fixtures[] = {"player.json", "queue.json", "saved_tracks.json",
+                                         "playlist_tracks.json"};
+
+typedef struct
+{
+    std::vector<spotify_track_t> tracks;
+    spotify_playback_t           playback;
+    esp_err_t                    err;
+} result_t;
+
+static uint32_t next_rand(uint32_t n)
+{
+    s_seed = s_seed * 1664525 + 1013904223;
+    return (s_seed >> 8) % n;
+}
+
+static std::string load(const char* name)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "fixtures/spotify/%s", name);
+    std::string body;
+    FILE*       f = fopen(path, "rb");
+    CHECK(f != NULL);
+    if (!f)
+        return body;
+    char   buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        body.append(buf, n);
+    fclose(f);
+    return body;
+}
+
+static bool keep(const spotify_track_t* track, void* arg)
+{
+    ((std::vector<spotify_track_t>*) arg)->push_back(*track);
+    return true;
+}
+
+// Feeds the body in the chunk sizes `chunk` hands out
+template <typename F> static result_t parse(const std::string& body, F chunk)
+{
+    result_t       r = {};
+    spotify_json_t json;
+    spotify_json_init(&json, keep, &r.tracks);
+    bool ok = true;
+    for (size_t pos = 0; pos < body.size() && ok;)
+    {
+        const size_t n = std::min<size_t>(chunk(), body.size() - pos);
+        ok             = spotify_json_feed(&json, body.data() + pos, n);
+        pos += n;
+    }
+    r.err      = ok ? spotify_json_finish(&json) : ESP_ERR_INVALID_RESPONSE;
+    r.playback = *spotify_json_playback(&json);
+    return r;
+}
+
+static result_t parse_whole(const std::string& body)
+{
+    return parse(body, [&] { return body.size(); });
+}
+
+static bool same_track(const spotify_track_t& a, const spotify_track_t& b)
+{
+    return a.index == b.index && a.duration_ms == b.duration_ms && !strcmp(a.name, b.name) &&
+           !strcmp(a.artists, b.artists) && !strcmp(a.uri, b.uri) &&
+           !strcmp(a.image_url, b.image_url);
+}
+
+static bool same(const result_t& a, const result_t& b)
+{
+    if (a.err != b.err || a.tracks.size() != b.tracks.size() ||
+        a.playback.progress_ms != b.playback.progress_ms ||
+        a.playback.is_playing != b.playback.is_playing)
+        return false;
+    for (size_t i = 0; i < a.tracks.size(); i++)
+    {
+        if (!same_track(a.tracks[i], b.tracks[i]))
+            return false;
+    }
+    return true;
+}
+
+static const spotify_track_t* find(const result_t& r, int16_t index)
+{
+    for (const spotify_track_t& t : r.tracks)
+    {
+        if (t.index == index)
+            return &t;
+    }
+    return NULL;
+}
+
+// The album image picked is the 300 px one, of the three Spotify lists
+static bool medium_image(const spotify_track_t* t)
+{
+    return strncmp(t->image_url, "https://i.scdn.co/image/ab67616d00001e02", 40) == 0;
+}
+
+static void test_player(void)
+{
+    const result_t r = parse_whole(load("player.json"));
+    CHECK_EQ(r.err, ESP_OK);
+    CHECK_EQ(r.tracks.size(), 1);
+    CHECK_EQ(r.playback.progress_ms, 83412);
+    CHECK(r.playback.is_playing);
+    const spotify_track_t* t = find(r, -1);
+    CHECK(t != NULL);
+    if (!t)
+        return;
+    CHECK(!strcmp(t->name, "Smile :)"));
+    CHECK(!strcmp(t->artists, "DJ Ñu, The \"Quoted\" Band, Orbital Haze"));
+    CHECK_EQ(t->duration_ms, 221701);
+    CHECK(!strcmp(t->uri, "spotify:track:N3nn14Sgea0JKsMYfhXvV5"));
+    CHECK(medium_image(t));
+}
+
+// The track playing and twenty after it, one of them a podcast episode
+static void test_queue(void)
+{
+    const result_t r = parse_whole(load("queue.json"));
+    CHECK_EQ(r.err, ESP_OK);
+    CHECK_EQ(r.tracks.size(), 21);
+    const spotify_track_t* playing = find(r, -1);
+    const spotify_track_t* cut     = find(r, 1);
+    const spotify_track_t* long_   = find(r, 6);
+    const spotify_track_t* episode = find(r, 7);
+    CHECK(playing && cut && long_ && episode && find(r, 19));
+    if (!playing || !cut || !long_ || !episode)
+        return;
+    CHECK(!strcmp(playing->name, "Sunday 🌅"));
+    CHECK(medium_image(playing));
+    // Cut at a character, in the middle of Greek and of ASCII
+    CHECK(!strcmp(cut->name, "Ἀπόλλων, or the Dance of the Seven Veils Performed in F"));
+    CHECK(!strcmp(long_->name, "Where the Rivers Meet the Sea, the Long Way Home (Live at the R"));
+    CHECK(!strcmp(long_->artists, "The \"Quoted\" Band, Ψυχή, Lumen Drift"));
+    // No album, so no artists or album art
+    CHECK(!strcmp(episode->name, "Episode 112: Embedded Frontends"));
+    CHECK(!strcmp(episode->uri, "spotify:episode:f0GPhqAi1RQ9ThyIRWg7uH"));
+    CHECK_EQ(episode->duration_ms, 3121345);
+    CHECK(!episode->artists[0]);
+    CHECK(!episode->image_url[0]);
+}
+
+// Saved tracks and playlist tracks, {added_at, track} items. The playlist page has a local file,
+// whose URI is too long to keep, and a track since removed from Spotify, which is null.
+static void test_pages(void)
+{
+    const result_t saved = parse_whole(load("saved_tracks.json"));
+    CHECK_EQ(saved.err, ESP_OK);
+    CHECK_EQ(saved.tracks.size(), 20);
+    for (size_t i = 0; i < saved.tracks.size(); i++)
+    {
+        CHECK_EQ(saved.tracks[i].index, i);
+        CHECK(medium_image(&saved.tracks[i]));
+    }
+    const spotify_track_t* slash = find(saved, 11);
+    CHECK(slash && !strcmp(slash->name, "Back\\Slash"));
+    // From the escapes, a surrogate pair among them
+    const spotify_track_t* escaped = find(saved, 0);
+    CHECK(escaped && !strcmp(escaped->artists, "Les Étoiles Fanées, 東京スカイライン, DJ Ñu"));
+    const spotify_track_t* pair = find(saved, 16);
+    CHECK(pair && !strcmp(pair->name, "Sunday 🌅"));
+    const spotify_track_t* cut = find(saved, 1);
+    CHECK(cut && !strcmp(cut->name, "Ἀπόλλων, or the Dance of the Seven Veils Performed in F"));
+
+    const result_t playlist = parse_whole(load("playlist_tracks.json"));
+    CHECK_EQ(playlist.err, ESP_OK);
+    CHECK_EQ(playlist.tracks.size(), 19);
+    CHECK(find(playlist, 16) == NULL);
+    const spotify_track_t* local = find(playlist, 11);
+    CHECK(local != NULL);
+    if (!local)
+        return;
+    CHECK(!strcmp(local->name, "demo take 3"));
+    CHECK(!strcmp(local->artists, "Me"));
+    CHECK_EQ(local->duration_ms, 201000);
+    CHECK(!local->uri[0]);
+    CHECK(!local->image_url[0]);
+    const spotify_track_t* last = find(playlist, 19);
+    CHECK(last && !strcmp(last->uri, "spotify:track:Hiuvo4AYPF2OVksDQxw2pI"));
+}
+
+// One byte at a time splits every token everywhere at once, TCP segments and TLS records are what
+// the connection hands over. The playback state is also split in two at every byte.
+static void test_chunk_split(void)
+{
+    for (const char* name : s_fixtures)
+    {
+        const std::string body  = load(name);
+        const result_t    whole = parse_whole(body);
+        CHECK_EQ(whole.err, ESP_OK);
+        CHECK(same(parse(body, [] { return 1; }), whole));
+        for (int i = 0; i < 8; i++)
+        {
+            CHECK(same(parse(body, [] { return 1 + next_rand(1460); }), whole));
+            CHECK(same(parse(body, [] { return 1 + next_rand(16384); }), whole));
+            CHECK(same(parse(body, [] { return 1 + next_rand(8); }), whole));
+        }
+    }
+
+    const std::string body  = load("player.json");
+    const result_t    whole = parse_whole(body);
+    uint32_t          split = 0;
+    for (size_t at = 1; at < body.size(); at++)
+    {
+        bool first = true;
+        split += same(parse(body,
+                            [&]
+                            {
+                                const size_t n = first ? at : body.size();
+                                first          = false;
+                                return n;
+                            }),
+                      whole);
+    }
+    CHECK_EQ(split, body.size() - 1);
+}
+
+#if HOST_TEST_CJSON
+static size_t s_heap;
+static size_t s_heap_peak;
+
+// cJSON's allocations with their size in front, for the peak
+static void* counted_malloc(size_t size)
+{
+    size_t* block = (size_t*) malloc(size + 16);
+    if (!block)
+        return NULL;
+    *block = size;
+    s_heap += size;
+    s_heap_peak = std::max(s_heap_peak, s_heap);
+    return (char*) block + 16;
+}
+
+static void counted_free(void* ptr)
+{
+    if (!ptr)
+        return;
+    size_t* block = (size_t*) ((char*) ptr - 16);
+    s_heap -= *block;
+    free(block);
+}
+
+static void cjson_copy(char* out, size_t size, const cJSON* item)
+{
+    if (cJSON_IsString(item))
+        snprintf(out, size, "%s", item->valuestring);
+}
+
+// The same fields out of the DOM, as the firmware would with cJSON
+static void cjson_track(const cJSON* item, int16_t index, std::vector<spotify_track_t>* out)
+{
+    if (!cJSON_IsObject(item))
+        return;
+    spotify_track_t t = {};
+    t.index           = index;
+    cjson_copy(t.name, sizeof(t.name), cJSON_GetObjectItemCaseSensitive(item, "name"));
+    const cJSON* uri = cJSON_GetObjectItemCaseSensitive(item, "uri");
+    if (cJSON_IsString(uri) && strlen(uri->valuestring) < sizeof(t.uri))
+        strcpy(t.uri, uri->valuestring);
+    const cJSON* duration = cJSON_GetObjectItemCaseSensitive(item, "duration_ms");
+    if (cJSON_IsNumber(duration))
+        t.duration_ms = (uint32_t) duration->valuedouble;
+    const cJSON* artist;
+    cJSON_ArrayForEach(artist, cJSON_GetObjectItemCaseSensitive(item, "artists"))
+    {
+        const size_t len = strlen(t.artists);
+        snprintf(t.artists + len, sizeof(t.artists) - len, "%s", len ? ", " : "");
+        cjson_copy(t.artists + strlen(t.artists), sizeof(t.artists) - strlen(t.artists),
+                   cJSON_GetObjectItemCaseSensitive(artist, "name"));
+    }
+    const cJSON* album = cJSON_GetObjectItemCaseSensitive(item, "album");
+    const cJSON* image;
+    int          best = 0;
+    cJSON_ArrayForEach(image, cJSON_GetObjectItemCaseSensitive(album, "images"))
+    {
+        const cJSON* width = cJSON_GetObjectItemCaseSensitive(image, "width");
+        const int    w     = cJSON_IsNumber(width) ? width->valueint : 0;
+        if (!t.image_url[0] || (w >= SPOTIFY_JSON_IMAGE_WIDTH && w < best) ||
+            (best < SPOTIFY_JSON_IMAGE_WIDTH && w > best))
+        {
+            cjson_copy(t.image_url, sizeof(t.image_url),
+                       cJSON_GetObjectItemCaseSensitive(image, "url"));
+            best = w;
+        }
+    }
+    out->push_back(t);
+}
+
+static std::vector<spotify_track_t> cjson_parse(const std::string& body)
+{
+    std::vector<spotify_track_t> tracks;
+    cJSON*                       root = cJSON_ParseWithLength(body.data(), body.size());
+    cjson_track(cJSON_GetObjectItemCaseSensitive(root, "item"), -1, &tracks);
+    cjson_track(cJSON_GetObjectItemCaseSensitive(root, "currently_playing"), -1, &tracks);
+    const cJSON* item;
+    int16_t      index = 0;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItemCaseSensitive(root, "queue"))
+        cjson_track(item, index++, &tracks);
+    index = 0;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItemCaseSensitive(root, "items"))
+        cjson_track(cJSON_GetObjectItemCaseSensitive(item, "track"), index++, &tracks);
+    cJSON_Delete(root);
+    return tracks;
+}
+#endif
+
+template <typename F> static double mb_per_s(size_t bytes, int iterations, F run)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        run();
+    const std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    return bytes * (double) iterations / took.count() / 1e6;
+}
+
+// Host CPU time, not the ESP32-S3's, only the ratio carries over. The streaming parser gets the
+// body in 1460 byte segments and needs no heap past its state; cJSON needs the whole body in one
+// buffer and builds the DOM next to it.
+static void test_benchmark(void)
+{
+    printf("    %-22s %8s  %12s %9s", "fixture", "bytes", "stream MB/s", "state");
+#if HOST_TEST_CJSON
+    printf("  %10s %9s", "cJSON MB/s", "heap");
+    cJSON_Hooks hooks = {counted_malloc, counted_free};
+    cJSON_InitHooks(&hooks);
+#else
+    printf("  (no cJSON in this build)");
+#endif
+    printf("\n");
+    for (const char* name : s_fixtures)
+    {
+        const std::string body       = load(name);
+        const int         iterations = std::max<int>(20, (int) (20000000 / body.size()));
+        const result_t    whole      = parse_whole(body);
+
+        const uint32_t mallocs = s_mallocs;
+        spotify_json_t json;
+        const double   stream  = mb_per_s(body.size(), iterations,
+                                          [&]
+                                          {
+                                            spotify_json_init(&json, NULL, NULL);
+                                            for (size_t pos = 0; pos < body.size(); pos += 1460)
+                                                spotify_json_feed(
+                                                    &json, body.data() + pos,
+                                                    std::min<size_t>(1460, body.size() - pos));
+                                            spotify_json_finish(&json);
+                                        });
+        CHECK_EQ(s_mallocs - mallocs, 0);
+        CHECK_EQ(json.tracks, whole.tracks.size());
+        printf("    %-22s %8zu  %12.1f %9zu", name, body.size(), stream, sizeof(spotify_json_t));
+
+#if HOST_TEST_CJSON
+        s_heap_peak                                = 0;
+        const std::vector<spotify_track_t> tracks = cjson_parse(body);
+        CHECK_EQ(s_heap, 0);
+        CHECK_EQ(tracks.size(), whole.tracks.size());
+        for (size_t i = 0; i < tracks.size() && i < whole.tracks.size(); i++)
+        {
+            CHECK_EQ(tracks[i].index, whole.tracks[i].index);
+            CHECK_EQ(tracks[i].duration_ms, whole.tracks[i].duration_ms);
+            CHECK(!strcmp(tracks[i].uri, whole.tracks[i].uri));
+            CHECK(!strcmp(tracks[i].image_url, whole.tracks[i].image_url));
+        }
+        const double dom = mb_per_s(body.size(), iterations, [&] { cjson_parse(body); });
+        // The DOM at its largest, and the body it was parsed from
+        printf("  %10.1f %9zu", dom, s_heap_peak + body.size());
+#endif
+        printf("\n");
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_player);
+    RUN_TEST(test_queue);
+    RUN_TEST(test_pages);
+    RUN_TEST(test_chunk_split);
+    RUN_TEST(test_benchmark);
+    return host_test_result();
+}
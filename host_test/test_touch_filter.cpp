@@ -0,0 +1,109 @@
+// Touch filter on a trace: the extrapolation leads the finger while it moves and fades out once it
+// stops, instead of carrying the point past it, and the filter still takes out the jitter.
+
+#include "host_test.h"
+#include "touch_filter.h"
+#include "user_config.h"
+
+static const touch_sample_t s_trace[] = {
+#include "traces/touch_drag_stop.inc"
+};
+static const uint32_t s_trace_len = sizeof(s_trace) / sizeof(s_trace[0]);
+
+#define READ_STEP_US 2000 // LVGL reads far more often than it does, so every age gets seen
+
+typedef struct
+{
+    float max_lead_px;      // Ahead of the filtered point while the finger moves
+    float max_overshoot_px; // Past the finger once it stopped, after the fade
+} drag_stats_t;
+
+// Replays the first touch of the trace like the indev read does: the latest sample goes in, the
+// point comes out extrapolated to the time of the read
+static drag_stats_t replay_drag(void)
+{
+    // The finger stopped where the reports went from every 10 ms to the 40 ms release reads
+    uint32_t stop = 1;
+    while (s_trace[stop].time_us - s_trace[stop - 1].time_us < 20000)
+        stop++;
+    stop--;
+    const float   stop_y  = s_trace[stop].y;
+    const int64_t stop_us = s_trace[stop].time_us;
+    const int64_t fade_us = (s_trace[stop].time_us - s_trace[stop - 1].time_us) * 5 / 2;
+
+    touch_filter_t filter;
+    touch_filter_init(&filter, NULL);
+    drag_stats_t stats = {};
+    uint32_t     next  = 0;
+    for (int64_t now = s_trace[0].time_us; s_trace[next].pressed; now += READ_STEP_US)
+    {
+        while (next < s_trace_len && s_trace[next].time_us <= now)
+            touch_filter_update(&filter, &s_trace[next++]);
+        if (!s_trace[next].pressed)
+            break;
+        touch_point_t point;
+        touch_filter_get(&filter, now, &point);
+        if (now < stop_us && filter.point.y - point.y > stats.max_lead_px)
+            stats.max_lead_px = filter.point.y - point.y;
+        // The drag goes up the screen, past the finger is above it
+        if (now > stop_us + fade_us && stop_y - point.y > stats.max_overshoot_px)
+            stats.max_overshoot_px = stop_y - point.y;
+    }
+    return stats;
+}
+
+static void test_leads_while_moving(void)
+{
+    const drag_stats_t stats = replay_drag();
+    CHECK(stats.max_lead_px > 8.0f);
+    CHECK(stats.max_lead_px <= EXAMPLE_TOUCH_PREDICT_MAX_PX);
+}
+
+static void test_stops_with_the_finger(void)
+{
+    const drag_stats_t stats = replay_drag();
+    CHECK(stats.max_overshoot_px < 1.0f);
+}
+
+// Without prediction the point never passes the finger either
+static void test_no_prediction(void)
+{
+    touch_filter_config_t config;
+    touch_filter_t        filter;
+    touch_filter_init(&filter, NULL);
+    config            = filter.config;
+    config.predict_ms = 0;
+    touch_filter_init(&filter, &config);
+    for (uint32_t i = 0; s_trace[i].pressed; i++)
+    {
+        touch_filter_update(&filter, &s_trace[i]);
+        touch_point_t point;
+        touch_filter_get(&filter, s_trace[i].time_us + 100000, &point);
+        CHECK_EQ(point.x, filter.point.x);
+        CHECK_EQ(point.y, filter.point.y);
+    }
+}
+
+// The resting finger of the second touch
+static void test_replay_takes_out_jitter(void)
+{
+    uint32_t first = 0;
+    while (s_trace[first].pressed)
+        first++;
+    first++;
+    touch_filter_replay_stats_t stats;
+    touch_filter_replay(s_trace + first, s_trace_len - first, NULL, &stats);
+    CHECK_EQ(stats.samples, s_trace_len - first - 1);
+    CHECK(stats.raw_jitter_px > 0.5f);
+    CHECK(stats.jitter_px < stats.raw_jitter_px / 2);
+    CHECK(stats.lag_px < 1.5f);
+}
+
+int main(void)
+{
+    RUN_TEST(test_leads_while_moving);
+    RUN_TEST(test_stops_with_the_finger);
+    RUN_TEST(test_no_prediction);
+    RUN_TEST(test_replay_takes_out_jitter);
+    return host_test_result();
+}
@@ -0,0 +1,212 @@
+// Touch sampling task against a mock CST816 on the I2C bus: reads only after an INT edge, the read
+// after the edges stop, the published samples, and the polling fallback without the interrupt.
+// Run with "poll" as the argument, the interrupt service fails to install.
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "i2c_bsp.h"
+#include "touch_sampler.h"
+#include "user_config.h"
+
+#define TOUCH_REG_BYTES 7
+#define TASK_LATENCY_US 800 // From the edge until the task gets the CPU
+
+i2c_master_dev_handle_t disp_touch_dev_handle = (i2c_master_dev_handle_t) &disp_touch_dev_handle;
+i2c_master_dev_handle_t drv2605_dev_handle    = NULL;
+
+// The controller: finger state and the register block lcd_touch_bsp reads from 0x00
+static struct
+{
+    bool     pressed;
+    uint16_t x;
+    uint16_t y;
+    uint32_t reads;
+    int64_t  last_read_us;
+} s_ctp;
+
+static uint32_t s_wakes;
+static int64_t  s_wake_us;
+
+void power_manager_wake(int64_t input_us)
+{
+    s_wakes++;
+    s_wake_us = input_us;
+}
+
+void i2c_bsp_report(void)
+{
+}
+
+// Register address out, the block back, one ACK bit per byte
+static int64_t bus_time_us(uint32_t bytes)
+{
+    return (int64_t) (bytes + 2) * 9 * 1000000 / EXAMPLE_I2C_SPEED_HZ;
+}
+
+uint8_t i2c_read_buff(i2c_master_dev_handle_t dev_handle, int reg, uint8_t* buf, uint8_t len)
+{
+    CHECK(dev_handle == disp_touch_dev_handle);
+    uint8_t regs[TOUCH_REG_BYTES] = {};
+    regs[2]                       = s_ctp.pressed;
+    regs[3]                       = (uint8_t) (s_ctp.x >> 8);
+    regs[4]                       = (uint8_t) s_ctp.x;
+    regs[5]                       = (uint8_t) (s_ctp.y >> 8);
+    regs[6]                       = (uint8_t) s_ctp.y;
+    memcpy(buf, regs + reg, len < TOUCH_REG_BYTES - reg ? len : TOUCH_REG_BYTES - reg);
+    host_time_us += bus_time_us(len);
+    s_ctp.last_read_us = host_time_us;
+    s_ctp.reads++;
+    return ESP_OK;
+}
+
+uint8_t i2c_write_buff(i2c_master_dev_handle_t dev_handle, int reg, uint8_t* buf, uint8_t len)
+{
+    return ESP_OK;
+}
+
+// The controller announces a new point: INT low, and the ISR runs. The task reads it a little
+// later, once it gets the CPU.
+static void ctp_point(uint16_t x, uint16_t y, bool pressed)
+{
+    s_ctp.x       = x;
+    s_ctp.y       = y;
+    s_ctp.pressed = pressed;
+    CHECK(host_gpio_fire(EXAMPLE_PIN_NUM_TOUCH_INT));
+    host_time_us += TASK_LATENCY_US;
+    host_freertos_run();
+}
+
+static touch_sampler_stats_t stats(void)
+{
+    touch_sampler_stats_t s;
+    touch_sampler_get_stats(&s);
+    return s;
+}
+
+static void test_reads_on_edges_only(void)
+{
+    const uint32_t reads = s_ctp.reads;
+    host_freertos_advance(2000000);
+    CHECK_EQ(s_ctp.reads, reads); // Nothing touched, nothing read
+
+    const int64_t  edge_us = host_time_us;
+    touch_sample_t before;
+    touch_sampler_get(&before);
+    ctp_point(120, 200, true);
+    CHECK_EQ(s_ctp.reads, reads + 1);
+
+    touch_sample_t sample;
+    touch_sampler_get(&sample);
+    CHECK(sample.pressed);
+    CHECK_EQ(sample.x, 120);
+    CHECK_EQ(sample.y, 200);
+    CHECK_EQ(sample.time_us, edge_us); // The edge, not the read
+    CHECK(s_ctp.last_read_us > edge_us + TASK_LATENCY_US);
+    CHECK_EQ(sample.seq, before.seq + 1);
+    CHECK_EQ(s_wakes > 0 ? s_wake_us : -1, edge_us);
+
+    // A drag, the controller reports every 10 ms
+    for (int i = 1; i <= 20; i++)
+    {
+        host_freertos_advance(10000);
+        ctp_point(120, (uint16_t) (200 - i * 3), true);
+    }
+    touch_sampler_get(&sample);
+    CHECK_EQ(sample.y, 140);
+    CHECK_EQ(sample.seq, before.seq + 21);
+    CHECK_EQ(s_ctp.reads, reads + 21);
+    CHECK_EQ(stats().release_polls, 0);
+
+    // The lift comes with an edge too
+    host_freertos_advance(10000);
+    ctp_point(120, 140, false);
+    touch_sampler_get(&sample);
+    CHECK(!sample.pressed);
+    host_freertos_advance(1000000);
+    CHECK_EQ(s_ctp.reads, reads + 22);
+    CHECK_EQ(stats().release_polls, 0);
+}
+
+// The controller stops the edges while the finger is down: one more read after the release time
+static void test_reads_once_when_edges_stop(void)
+{
+    ctp_point(60, 60, true);
+    const uint32_t reads = s_ctp.reads;
+    const uint32_t polls = stats().release_polls;
+    s_ctp.pressed        = false; // Lifted without an edge
+    const int64_t edge   = host_time_us;
+
+    host_freertos_advance(EXAMPLE_TOUCH_RELEASE_MS * 1000 - 1000);
+    CHECK_EQ(s_ctp.reads, reads);
+    host_freertos_advance(2000);
+    CHECK_EQ(s_ctp.reads, reads + 1);
+    CHECK_EQ(stats().release_polls, polls + 1);
+    CHECK(s_ctp.last_read_us - edge >= EXAMPLE_TOUCH_RELEASE_MS * 1000);
+
+    touch_sample_t sample;
+    touch_sampler_get(&sample);
+    CHECK(!sample.pressed);
+    CHECK(sample.time_us >= edge + EXAMPLE_TOUCH_RELEASE_MS * 1000); // Read time, no edge
+
+    // Released, back to waiting for an edge without a timeout
+    host_freertos_advance(1000000);
+    CHECK_EQ(s_ctp.reads, reads + 1);
+}
+
+// Readers copy the snapshot without touching the bus
+static void test_get_does_not_read(void)
+{
+    const uint32_t reads     = s_ctp.reads;
+    const uint32_t snapshots = stats().snapshots;
+    touch_sample_t sample;
+    for (int i = 0; i < 100; i++)
+        touch_sampler_get(&sample);
+    CHECK_EQ(s_ctp.reads, reads);
+    CHECK_EQ(stats().snapshots, snapshots + 100);
+}
+
+static void test_polls_without_interrupt(void)
+{
+    CHECK(host_gpio[EXAMPLE_PIN_NUM_TOUCH_INT].isr == NULL);
+    const uint32_t reads = s_ctp.reads;
+    host_freertos_advance(CONFIG_LV_INDEV_DEF_READ_PERIOD * 1000 * 10);
+    CHECK_NEAR(s_ctp.reads - reads, 10, 1);
+
+    s_ctp.pressed = true;
+    s_ctp.x       = 10;
+    s_ctp.y       = 20;
+    host_freertos_advance(CONFIG_LV_INDEV_DEF_READ_PERIOD * 1000);
+    touch_sample_t sample;
+    touch_sampler_get(&sample);
+    CHECK(sample.pressed);
+    CHECK_EQ(sample.y, 20);
+    CHECK_EQ(stats().edges, 0);
+    CHECK_EQ(stats().release_polls, 0);
+}
+
+int main(int argc, char** argv)
+{
+    const bool poll = argc > 1 && strcmp(argv[1], "poll") == 0;
+    host_gpio_reset();
+    if (poll)
+        host_gpio_isr_service_err = ESP_FAIL;
+    CHECK(touch_sampler_init());
+    host_freertos_run();
+    CHECK_EQ(s_ctp.reads, 1); // Once at the start, whatever the controller has
+
+    if (poll)
+    {
+        RUN_TEST(test_polls_without_interrupt);
+    }
+    else
+    {
+        RUN_TEST(test_reads_on_edges_only);
+        RUN_TEST(test_reads_once_when_edges_stop);
+        RUN_TEST(test_get_does_not_read);
+    }
+    host_freertos_reset();
+    return host_test_result();
+}
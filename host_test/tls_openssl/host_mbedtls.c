@@ -0,0 +1,283 @@
+// mbedTLS client calls on OpenSSL, behind tls_openssl/mbedtls/ssl.h. OpenSSL reads and writes the
+// records through a BIO that calls the send and receive callbacks given to mbedtls_ssl_set_bio(),
+// so the socket code of the caller runs as it does on the target.
+
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/err.h>
+#include <openssl/rand.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include "mbedtls/ssl.h"
+
+static BIO_METHOD* s_bio_method;
+static uint32_t    s_resumed;
+
+static int host_bio_write(BIO* bio, const char* buf, int len)
+{
+    mbedtls_ssl_context* ssl = (mbedtls_ssl_context*) BIO_get_data(bio);
+    BIO_clear_retry_flags(bio);
+    const int n = ssl->f_send(ssl->p_bio, (const unsigned char*) buf, (size_t) len);
+    if (n >= 0)
+        return n;
+    ssl->bio_err = n;
+    return -1;
+}
+
+static int host_bio_read(BIO* bio, char* buf, int len)
+{
+    mbedtls_ssl_context* ssl = (mbedtls_ssl_context*) BIO_get_data(bio);
+    BIO_clear_retry_flags(bio);
+    const int n = ssl->f_recv(ssl->p_bio, (unsigned char*) buf, (size_t) len);
+    if (n > 0)
+        return n;
+    ssl->bio_err = n;
+    return n == 0 ? 0 : -1;
+}
+
+static long host_bio_ctrl(BIO* bio, int cmd, long num, void* ptr)
+{
+    return cmd == BIO_CTRL_FLUSH ? 1 : 0;
+}
+
+// The error of the last call, in mbedTLS terms
+static int host_ssl_error(mbedtls_ssl_context* ssl, int ret)
+{
+    const int err = SSL_get_error(ssl->ssl, ret);
+    ERR_clear_error();
+    if (err == SSL_ERROR_WANT_READ)
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    if (err == SSL_ERROR_WANT_WRITE)
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    if (err == SSL_ERROR_ZERO_RETURN)
+        return MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY;
+    if (ssl->bio_err < 0)
+        return ssl->bio_err;
+    if (ssl->bio_err == 0 && err == SSL_ERROR_SYSCALL)
+        return MBEDTLS_ERR_SSL_CONN_EOF;
+    return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+}
+
+int mbedtls_entropy_func(void* data, unsigned char* output, size_t len)
+{
+    return RAND_bytes(output, (int) len) == 1 ? 0 : MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+}
+
+void mbedtls_entropy_init(mbedtls_entropy_context* ctx) {}
+
+void mbedtls_entropy_free(mbedtls_entropy_context* ctx) {}
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context* ctx) {}
+
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context* ctx) {}
+
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context* ctx,
+                          int (*f_entropy)(void*, unsigned char*, size_t), void* p_entropy,
+                          const unsigned char* custom, size_t len)
+{
+    return 0;
+}
+
+int mbedtls_ctr_drbg_random(void* p_rng, unsigned char* output, size_t output_len)
+{
+    return mbedtls_entropy_func(NULL, output, output_len);
+}
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt)
+{
+    crt->store = NULL;
+}
+
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt)
+{
+    X509_STORE_free(crt->store);
+    crt->store = NULL;
+}
+
+// PEM, the terminator counted in `buflen` as mbedTLS wants it
+int mbedtls_x509_crt_parse(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen)
+{
+    if (!chain->store)
+        chain->store = X509_STORE_new();
+    BIO* mem    = BIO_new_mem_buf(buf, (int) buflen - 1);
+    int  certs  = 0;
+    X509* cert;
+    while ((cert = PEM_read_bio_X509(mem, NULL, NULL, NULL)))
+    {
+        X509_STORE_add_cert(chain->store, cert);
+        X509_free(cert);
+        certs++;
+    }
+    BIO_free(mem);
+    ERR_clear_error();
+    return certs > 0 ? 0 : MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+}
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config* conf)
+{
+    conf->ctx = NULL;
+}
+
+void mbedtls_ssl_config_free(mbedtls_ssl_config* conf)
+{
+    SSL_CTX_free(conf->ctx);
+    conf->ctx = NULL;
+}
+
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config* conf, int endpoint, int transport, int preset)
+{
+    if (!s_bio_method)
+    {
+        s_bio_method = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "mbedtls_bio");
+        BIO_meth_set_write(s_bio_method, host_bio_write);
+        BIO_meth_set_read(s_bio_method, host_bio_read);
+        BIO_meth_set_ctrl(s_bio_method, host_bio_ctrl);
+    }
+    conf->ctx = SSL_CTX_new(TLS_client_method());
+    if (!conf->ctx)
+        return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    // Sessions are kept by the caller through mbedtls_ssl_get_session()
+    SSL_CTX_set_session_cache_mode(conf->ctx, SSL_SESS_CACHE_OFF);
+    return 0;
+}
+
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config* conf, mbedtls_x509_crt* ca_chain, void* ca_crl)
+{
+    X509_STORE_up_ref(ca_chain->store);
+    SSL_CTX_set_cert_store(conf->ctx, ca_chain->store);
+}
+
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config* conf, int authmode)
+{
+    SSL_CTX_set_verify(conf->ctx,
+                       authmode == MBEDTLS_SSL_VERIFY_REQUIRED ? SSL_VERIFY_PEER : SSL_VERIFY_NONE,
+                       NULL);
+}
+
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config* conf, int (*f_rng)(void*, unsigned char*, size_t),
+                          void* p_rng)
+{
+}
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session)
+{
+    session->session = NULL;
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session)
+{
+    SSL_SESSION_free(session->session);
+    session->session = NULL;
+}
+
+void mbedtls_ssl_init(mbedtls_ssl_context* ssl)
+{
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+void mbedtls_ssl_free(mbedtls_ssl_context* ssl)
+{
+    SSL_free(ssl->ssl);
+    free(ssl->hostname);
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+int mbedtls_ssl_setup(mbedtls_ssl_context* ssl, const mbedtls_ssl_config* conf)
+{
+    ssl->conf = conf;
+    return mbedtls_ssl_session_reset(ssl);
+}
+
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context* ssl, const char* hostname)
+{
+    free(ssl->hostname);
+    ssl->hostname = strdup(hostname);
+    return mbedtls_ssl_session_reset(ssl);
+}
+
+// A new SSL object for the next handshake, as mbedTLS reuses the context
+int mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl)
+{
+    SSL_free(ssl->ssl);
+    ssl->ssl     = SSL_new(ssl->conf->ctx);
+    ssl->bio_err = 0;
+    if (!ssl->ssl)
+        return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    if (ssl->hostname)
+    {
+        SSL_set_tlsext_host_name(ssl->ssl, ssl->hostname);
+        SSL_set1_host(ssl->ssl, ssl->hostname);
+    }
+    if (ssl->f_send)
+        mbedtls_ssl_set_bio(ssl, ssl->p_bio, ssl->f_send, ssl->f_recv, NULL);
+    return 0;
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session)
+{
+    return SSL_set_session(ssl->ssl, session->session) == 1 ? 0 : MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session)
+{
+    SSL_SESSION_free(session->session);
+    session->session = SSL_get1_session(ssl->ssl);
+    return session->session ? 0 : MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+}
+
+void mbedtls_ssl_set_bio(mbedtls_ssl_context* ssl, void* p_bio, mbedtls_ssl_send_t f_send,
+                         mbedtls_ssl_recv_t f_recv, mbedtls_ssl_recv_timeout_t f_recv_timeout)
+{
+    ssl->p_bio  = p_bio;
+    ssl->f_send = f_send;
+    ssl->f_recv = f_recv;
+    BIO* bio    = BIO_new(s_bio_method);
+    BIO_set_data(bio, ssl);
+    BIO_set_init(bio, 1);
+    SSL_set_bio(ssl->ssl, bio, bio);
+}
+
+int mbedtls_ssl_handshake(mbedtls_ssl_context* ssl)
+{
+    ssl->bio_err  = 0;
+    const int ret = SSL_connect(ssl->ssl);
+    if (ret == 1)
+    {
+        s_resumed += SSL_session_reused(ssl->ssl);
+        return 0;
+    }
+    if (SSL_get_verify_result(ssl->ssl) != X509_V_OK)
+    {
+        ERR_clear_error();
+        return MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+    }
+    const int err = host_ssl_error(ssl, ret);
+    return err == MBEDTLS_ERR_SSL_INTERNAL_ERROR ? MBEDTLS_ERR_SSL_HANDSHAKE_FAILURE : err;
+}
+
+int mbedtls_ssl_write(mbedtls_ssl_context* ssl, const unsigned char* buf, size_t len)
+{
+    ssl->bio_err  = 0;
+    const int ret = SSL_write(ssl->ssl, buf, (int) len);
+    return ret > 0 ? ret : host_ssl_error(ssl, ret);
+}
+
+int mbedtls_ssl_read(mbedtls_ssl_context* ssl, unsigned char* buf, size_t len)
+{
+    ssl->bio_err  = 0;
+    const int ret = SSL_read(ssl->ssl, buf, (int) len);
+    return ret > 0 ? ret : host_ssl_error(ssl, ret);
+}
+
+int mbedtls_ssl_close_notify(mbedtls_ssl_context* ssl)
+{
+    ssl->bio_err = 0;
+    SSL_shutdown(ssl->ssl);
+    ERR_clear_error();
+    return 0;
+}
+
+uint32_t host_mbedtls_resumed(void)
+{
+    return s_resumed;
+}
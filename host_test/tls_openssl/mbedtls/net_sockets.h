@@ -0,0 +1,7 @@
+#ifndef MBEDTLS_NET_SOCKETS_H
+#define MBEDTLS_NET_SOCKETS_H
+
+// All of the mbedTLS stand-in is in ssl.h
+#include "mbedtls/ssl.h"
+
+#endif
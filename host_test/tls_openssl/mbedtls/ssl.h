@@ -0,0 +1,125 @@
+#ifndef MBEDTLS_SSL_H
+#define MBEDTLS_SSL_H
+
+// The part of the mbedTLS 3 client API spotify_conn.c uses, on OpenSSL by host_mbedtls.c, for
+// hosts without the mbedTLS headers. The send and receive callbacks carry the TLS records as they
+// do under mbedTLS, and the error codes are the mbedTLS ones.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <openssl/ssl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MBEDTLS_ERR_NET_RECV_FAILED                 -0x004C
+#define MBEDTLS_ERR_NET_SEND_FAILED                 -0x004E
+#define MBEDTLS_ERR_NET_CONN_RESET                  -0x0050
+#define MBEDTLS_ERR_X509_CERT_VERIFY_FAILED         -0x2700
+#define MBEDTLS_ERR_SSL_TIMEOUT                     -0x6800
+#define MBEDTLS_ERR_SSL_WANT_WRITE                  -0x6880
+#define MBEDTLS_ERR_SSL_WANT_READ                   -0x6900
+#define MBEDTLS_ERR_SSL_INTERNAL_ERROR              -0x6C00
+#define MBEDTLS_ERR_SSL_CONN_EOF                    -0x7280
+#define MBEDTLS_ERR_SSL_HANDSHAKE_FAILURE           -0x7780
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY           -0x7880
+#define MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET -0x7B00
+
+#define MBEDTLS_SSL_IS_CLIENT        0
+#define MBEDTLS_SSL_TRANSPORT_STREAM 0
+#define MBEDTLS_SSL_PRESET_DEFAULT   0
+#define MBEDTLS_SSL_VERIFY_REQUIRED  2
+
+typedef int (*mbedtls_ssl_send_t)(void* ctx, const unsigned char* buf, size_t len);
+typedef int (*mbedtls_ssl_recv_t)(void* ctx, unsigned char* buf, size_t len);
+typedef int (*mbedtls_ssl_recv_timeout_t)(void* ctx, unsigned char* buf, size_t len,
+                                          uint32_t timeout);
+
+// OpenSSL has its own RNG, seeded by itself
+typedef struct
+{
+    int unused;
+} mbedtls_entropy_context;
+
+typedef struct
+{
+    int unused;
+} mbedtls_ctr_drbg_context;
+
+typedef struct
+{
+    X509_STORE* store;
+} mbedtls_x509_crt;
+
+typedef struct
+{
+    SSL_CTX* ctx;
+} mbedtls_ssl_config;
+
+typedef struct
+{
+    SSL_SESSION* session;
+} mbedtls_ssl_session;
+
+typedef struct
+{
+    const mbedtls_ssl_config* conf;
+    SSL*                      ssl;
+    char*                     hostname;
+    void*                     p_bio;
+    mbedtls_ssl_send_t        f_send;
+    mbedtls_ssl_recv_t        f_recv;
+    int                       bio_err; // Last error of a callback, 0 for the end of the stream
+} mbedtls_ssl_context;
+
+int  mbedtls_entropy_func(void* data, unsigned char* output, size_t len);
+void mbedtls_entropy_init(mbedtls_entropy_context* ctx);
+void mbedtls_entropy_free(mbedtls_entropy_context* ctx);
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context* ctx);
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context* ctx);
+int  mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context* ctx,
+                           int (*f_entropy)(void*, unsigned char*, size_t), void* p_entropy,
+                           const unsigned char* custom, size_t len);
+int  mbedtls_ctr_drbg_random(void* p_rng, unsigned char* output, size_t output_len);
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt);
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt);
+int  mbedtls_x509_crt_parse(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen);
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config* conf);
+void mbedtls_ssl_config_free(mbedtls_ssl_config* conf);
+int  mbedtls_ssl_config_defaults(mbedtls_ssl_config* conf, int endpoint, int transport,
+                                 int preset);
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config* conf, mbedtls_x509_crt* ca_chain,
+                               void* ca_crl);
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config* conf, int authmode);
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config* conf, int (*f_rng)(void*, unsigned char*, size_t),
+                          void* p_rng);
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session);
+
+void mbedtls_ssl_init(mbedtls_ssl_context* ssl);
+void mbedtls_ssl_free(mbedtls_ssl_context* ssl);
+int  mbedtls_ssl_setup(mbedtls_ssl_context* ssl, const mbedtls_ssl_config* conf);
+int  mbedtls_ssl_set_hostname(mbedtls_ssl_context* ssl, const char* hostname);
+int  mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl);
+int  mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session);
+int  mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session);
+void mbedtls_ssl_set_bio(mbedtls_ssl_context* ssl, void* p_bio, mbedtls_ssl_send_t f_send,
+                         mbedtls_ssl_recv_t f_recv, mbedtls_ssl_recv_timeout_t f_recv_timeout);
+int  mbedtls_ssl_handshake(mbedtls_ssl_context* ssl);
+int  mbedtls_ssl_write(mbedtls_ssl_context* ssl, const unsigned char* buf, size_t len);
+int  mbedtls_ssl_read(mbedtls_ssl_context* ssl, unsigned char* buf, size_t len);
+int  mbedtls_ssl_close_notify(mbedtls_ssl_context* ssl);
+
+// Handshakes that resumed a session, for the tests
+uint32_t host_mbedtls_resumed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
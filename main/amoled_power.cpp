@@ -0,0 +1,212 @@
+// Panel power estimate. An AMOLED has no backlight to speak of, every pixel emits its own light,
+// so the panel draws a static part plus a part that follows the light of the lit pixels, per
+// channel since blue subpixels are the least efficient. The estimate keeps a grid of every
+// EXAMPLE_AMOLED_SAMPLE_STEP-th pixel of both axes, updated from the flushed data, and running
+// sums of the linear channel levels of the grid, so a frame costs a few hundred lookups no matter
+// how much of the screen it leaves as it is.
+//
+// The channel coefficients are full-screen figures at full brightness, scaled by the brightness
+// duty. They are rough, calibrate them against a meter on the board before comparing absolutes,
+// the relative numbers between two UI variants hold without.
+
+#include <math.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "amoled_power.h"
+#include "lcd_bl_pwm_bsp.h"
+#include "user_config.h"
+#if EXAMPLE_USE_ROUND_MASK
+#include "round_mask.h"
+#endif
+
+static const char* TAG = "amoled_power";
+
+#define AMOLED_POWER_GAMMA 2.2f
+#define AMOLED_POWER_COLS                                                                          \
+    ((EXAMPLE_LCD_H_RES + EXAMPLE_AMOLED_SAMPLE_STEP - 1) / EXAMPLE_AMOLED_SAMPLE_STEP)
+#define AMOLED_POWER_ROWS                                                                          \
+    ((EXAMPLE_LCD_V_RES + EXAMPLE_AMOLED_SAMPLE_STEP - 1) / EXAMPLE_AMOLED_SAMPLE_STEP)
+
+static uint16_t             s_cells[AMOLED_POWER_ROWS * AMOLED_POWER_COLS]; // Sampled, RGB565
+static uint8_t              s_lin5[32]; // Linear level 0-255 of a 5 bit channel
+static uint8_t              s_lin6[64]; // and of the 6 bit green
+static uint32_t             s_sum[3];   // Linear red, green and blue of all cells
+static uint32_t             s_visible;  // Cells on the visible part of the panel
+static float                s_mw;       // Estimate since s_mw_us
+static int64_t              s_mw_us;
+static float                s_energy_uj; // Fraction not yet in s_stats.energy_uj
+static amoled_power_stats_t s_stats;
+#if EXAMPLE_AMOLED_REPORT_MS
+static int64_t s_report_us;
+#endif
+
+static inline uint16_t amoled_power_rgb565(uint16_t raw)
+{
+#if LV_COLOR_16_SWAP
+    return (uint16_t) ((raw >> 8) | (raw << 8));
+#else
+    return raw;
+#endif
+}
+
+// Mean linear level of a channel over the visible cells, 0-1
+static float amoled_power_mean(int channel)
+{
+    return (float) s_sum[channel] / (255.0f * s_visible);
+}
+
+static float amoled_power_estimate(void)
+{
+    const float content = EXAMPLE_AMOLED_RED_MW * amoled_power_mean(0) +
+                          EXAMPLE_AMOLED_GREEN_MW * amoled_power_mean(1) +
+                          EXAMPLE_AMOLED_BLUE_MW * amoled_power_mean(2);
+    return EXAMPLE_AMOLED_STATIC_MW + content * lcd_bl_pwm_bsp_get_duty() / 255.0f;
+}
+
+// Closes the time at the previous estimate and takes a new one
+static void amoled_power_integrate(void)
+{
+    const int64_t now = esp_timer_get_time();
+    s_energy_uj += s_mw * (now - s_mw_us) / 1000.0f;
+    s_stats.energy_uj += (uint64_t) s_energy_uj;
+    s_energy_uj -= (uint64_t) s_energy_uj;
+    s_mw_us = now;
+    s_mw    = amoled_power_estimate();
+
+    const uint16_t mw = (uint16_t) lroundf(s_mw);
+    s_stats.power_mw  = mw;
+    if (mw > s_stats.peak_mw)
+        s_stats.peak_mw = mw;
+    if (mw < s_stats.min_mw)
+        s_stats.min_mw = mw;
+}
+
+// Catches brightness fades on a static screen, which flush nothing
+static void amoled_power_timer_cb(lv_timer_t* timer)
+{
+    amoled_power_integrate();
+#if EXAMPLE_AMOLED_REPORT_MS
+    if (s_mw_us - s_report_us >= EXAMPLE_AMOLED_REPORT_MS * 1000LL)
+    {
+        amoled_power_report();
+        amoled_power_session_start();
+        s_report_us = s_mw_us;
+    }
+#endif
+}
+
+void amoled_power_init(void)
+{
+    for (int i = 0; i < 32; i++)
+        s_lin5[i] = (uint8_t) lroundf(255.0f * powf(i / 31.0f, AMOLED_POWER_GAMMA));
+    for (int i = 0; i < 64; i++)
+        s_lin6[i] = (uint8_t) lroundf(255.0f * powf(i / 63.0f, AMOLED_POWER_GAMMA));
+
+    s_visible = 0;
+    for (int row = 0; row < AMOLED_POWER_ROWS; row++)
+    {
+#if EXAMPLE_USE_ROUND_MASK
+        int16_t x1;
+        int16_t x2;
+        round_mask_row_span(row * EXAMPLE_AMOLED_SAMPLE_STEP, &x1, &x2);
+        for (int col = 0; col < AMOLED_POWER_COLS; col++)
+        {
+            const int x = col * EXAMPLE_AMOLED_SAMPLE_STEP;
+            s_visible += x >= x1 && x <= x2;
+        }
+#else
+        s_visible += AMOLED_POWER_COLS;
+#endif
+    }
+
+    s_mw_us = esp_timer_get_time();
+    s_mw             = amoled_power_estimate();
+    s_stats.power_mw = (uint16_t) lroundf(s_mw);
+    amoled_power_session_start();
+#if EXAMPLE_AMOLED_REPORT_MS
+    s_report_us = s_mw_us;
+#endif
+    lv_timer_create(amoled_power_timer_cb, EXAMPLE_AMOLED_SAMPLE_MS, NULL);
+    ESP_LOGI(TAG, "%" PRIu32 " of %d cells sampled, every %d px", s_visible,
+             AMOLED_POWER_ROWS * AMOLED_POWER_COLS, EXAMPLE_AMOLED_SAMPLE_STEP);
+}
+
+void amoled_power_flush(const lv_area_t* area, const void* data)
+{
+    const int       step = EXAMPLE_AMOLED_SAMPLE_STEP;
+    const int32_t   w    = lv_area_get_width(area);
+    const uint16_t* px   = (const uint16_t*) data;
+    // First grid point inside the area on each axis
+    const int32_t x0 = (area->x1 + step - 1) / step * step;
+    const int32_t y0 = (area->y1 + step - 1) / step * step;
+
+    for (int32_t y = y0; y <= area->y2; y += step)
+    {
+        const uint16_t* row  = px + (y - area->y1) * w;
+        uint16_t*       cell = &s_cells[y / step * AMOLED_POWER_COLS + x0 / step];
+        for (int32_t x = x0; x <= area->x2; x += step, cell++)
+        {
+            const uint16_t c   = amoled_power_rgb565(row[x - area->x1]);
+            const uint16_t old = *cell;
+            s_stats.sampled_px++;
+            if (c == old)
+                continue;
+            // Unsigned wrap-around is fine, the sums never go negative
+            s_sum[0] += s_lin5[c >> 11] - s_lin5[old >> 11];
+            s_sum[1] += s_lin6[(c >> 5) & 0x3F] - s_lin6[(old >> 5) & 0x3F];
+            s_sum[2] += s_lin5[c & 0x1F] - s_lin5[old & 0x1F];
+            *cell = c;
+        }
+    }
+}
+
+void amoled_power_frame_done(void)
+{
+    const float luminance = 0.2126f * amoled_power_mean(0) + 0.7152f * amoled_power_mean(1) +
+                            0.0722f * amoled_power_mean(2);
+    s_stats.luminance = (uint16_t) lroundf(luminance * 1000.0f);
+    s_stats.frames++;
+    amoled_power_integrate();
+}
+
+uint32_t amoled_power_get_mw(void)
+{
+    return (uint32_t) lroundf(amoled_power_estimate());
+}
+
+void amoled_power_session_start(void)
+{
+    const uint16_t luminance = s_stats.luminance;
+    const uint16_t mw        = s_stats.power_mw;
+    s_stats                  = {};
+    s_stats.luminance        = luminance;
+    s_stats.power_mw         = mw;
+    s_stats.peak_mw          = mw;
+    s_stats.min_mw           = mw;
+    s_stats.since_us         = esp_timer_get_time();
+}
+
+void amoled_power_get_stats(amoled_power_stats_t* stats)
+{
+    *stats = s_stats;
+    // With the time since the last estimate
+    const float open_uj = s_energy_uj + s_mw * (esp_timer_get_time() - s_mw_us) / 1000.0f;
+    stats->energy_uj += (uint64_t) open_uj;
+}
+
+void amoled_power_report(void)
+{
+    amoled_power_stats_t stats;
+    amoled_power_get_stats(&stats);
+    const int64_t elapsed_us = esp_timer_get_time() - stats.since_us;
+    if (elapsed_us <= 0)
+        return;
+
+    ESP_LOGI(TAG, "%" PRIu64 " ms, %" PRIu32 " frames, %" PRIu32 " px sampled:",
+             elapsed_us / 1000, stats.frames, stats.sampled_px);
+    ESP_LOGI(TAG, "  %" PRIu64 " mJ, %" PRIu64 " mW avg, %u-%u mW, now %u mW at luminance %u.%u%%",
+             stats.energy_uj / 1000, stats.energy_uj * 1000 / elapsed_us, stats.min_mw,
+             stats.peak_mw, stats.power_mw, stats.luminance / 10, stats.luminance % 10);
+}
@@ -0,0 +1,36 @@
+#ifndef AMOLED_POWER_H
+#define AMOLED_POWER_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+typedef struct
+{
+    uint32_t frames;
+    uint16_t luminance;  // Of the visible area in the last frame, 0-1000
+    uint16_t power_mw;   // Content of the last frame at the current brightness
+    uint16_t peak_mw;
+    uint16_t min_mw;
+    uint64_t energy_uj;  // Since since_us
+    uint32_t sampled_px; // Pixels read from the flushed data, for the cost of the estimate
+    int64_t  since_us;
+} amoled_power_stats_t;
+
+// Starts the estimate from a black panel. Creates an LVGL timer, call before the LVGL task runs
+// or with the LVGL lock held.
+void amoled_power_init(void);
+
+// Flushed area and its RGB565 pixels, packed as sent to the panel. Samples a grid of pixels.
+void amoled_power_flush(const lv_area_t* area, const void* data);
+
+// Called from the LVGL monitor_cb once a frame is out
+void amoled_power_frame_done(void);
+
+// Estimated panel power right now
+uint32_t amoled_power_get_mw(void);
+
+void amoled_power_session_start(void);
+void amoled_power_get_stats(amoled_power_stats_t* stats);
+void amoled_power_report(void);
+
+#endif
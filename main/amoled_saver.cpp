@@ -0,0 +1,219 @@
+// AMOLED saver. Black costs nothing on an AMOLED, a lit background costs for every pixel of it.
+// After EXAMPLE_AMOLED_SAVER_AFTER_MS without input the large bright backgrounds of the screen,
+// like the green title panels, keep only EXAMPLE_AMOLED_SAVER_OPA_SCALE percent of their opacity
+// over the black screen. After EXAMPLE_AMOLED_CLOCK_AFTER_MS a black screen with a small clock
+// replaces the UI. The clock timer runs once a minute, so only the digits are redrawn, moved by a
+// few pixels each time so the same pixels don't stay lit for hours. Until the time has been set
+// the clock would count from 1970, so the screen stays black instead.
+//
+// Everything runs from one LVGL timer whose period is the time to the next step, it doesn't add
+// wake-ups to an idle UI.
+
+#include <time.h>
+#include <sys/time.h>
+#include "esp_log.h"
+
+#include "amoled_saver.h"
+#include "user_config.h"
+
+static const char* TAG = "amoled_saver";
+
+#define AMOLED_SAVER_POLL_MS  1000 // While dimmed, for screens loaded without input
+#define AMOLED_SAVER_SET_YEAR 2024 // An earlier year is the clock running from boot, never set
+
+typedef struct
+{
+    lv_obj_t* obj;
+    lv_opa_t  opa; // As designed
+} amoled_saver_dimmed_t;
+
+// Clock offsets, in EXAMPLE_AMOLED_CLOCK_SHIFT_PX
+static const int8_t s_shifts[][2] = {{0, 0},  {1, 0},   {1, 1},  {0, 1}, {-1, 1},
+                                     {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+static amoled_saver_dimmed_t s_dimmed[EXAMPLE_AMOLED_SAVER_MAX_OBJS];
+static uint32_t              s_dimmed_cnt  = 0;
+static lv_obj_t*             s_dimmed_scr  = NULL; // Screen the dimmed objects are on
+static lv_obj_t*             s_clock_scr   = NULL;
+static lv_obj_t*             s_clock_label = NULL;
+static lv_obj_t*             s_prev_scr    = NULL; // Under the clock
+static lv_timer_t*           s_timer       = NULL;
+static int                   s_minute      = -1;
+static uint32_t              s_shift       = 0;
+static amoled_saver_stats_t  s_stats;
+
+static bool amoled_saver_is_bright(lv_obj_t* obj)
+{
+    return lv_obj_get_style_bg_opa(obj, LV_PART_MAIN) > LV_OPA_TRANSP &&
+           lv_area_get_size(&obj->coords) >= EXAMPLE_AMOLED_SAVER_MIN_PX &&
+           lv_color_brightness(lv_obj_get_style_bg_color(obj, LV_PART_MAIN)) >=
+               EXAMPLE_AMOLED_SAVER_MIN_BRIGHTNESS;
+}
+
+static void amoled_saver_dim_children(lv_obj_t* obj)
+{
+    const uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt && s_dimmed_cnt < EXAMPLE_AMOLED_SAVER_MAX_OBJS; i++)
+    {
+        lv_obj_t* child = lv_obj_get_child(obj, i);
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
+            continue;
+        if (amoled_saver_is_bright(child))
+        {
+            const lv_opa_t opa         = lv_obj_get_style_bg_opa(child, LV_PART_MAIN);
+            s_dimmed[s_dimmed_cnt].obj = child;
+            s_dimmed[s_dimmed_cnt].opa = opa;
+            s_dimmed_cnt++;
+            lv_obj_set_style_bg_opa(child, opa * EXAMPLE_AMOLED_SAVER_OPA_SCALE / 100,
+                                    LV_PART_MAIN);
+        }
+        amoled_saver_dim_children(child);
+    }
+}
+
+// The screen itself is black and stays as it is
+static void amoled_saver_dim(void)
+{
+    s_dimmed_scr = lv_scr_act();
+    amoled_saver_dim_children(s_dimmed_scr);
+    s_stats.dimmed_objs = s_dimmed_cnt;
+}
+
+static void amoled_saver_undim(void)
+{
+    for (uint32_t i = 0; i < s_dimmed_cnt; i++)
+    {
+        if (lv_obj_is_valid(s_dimmed[i].obj))
+            lv_obj_set_style_bg_opa(s_dimmed[i].obj, s_dimmed[i].opa, LV_PART_MAIN);
+    }
+    s_dimmed_cnt = 0;
+    s_dimmed_scr = NULL;
+}
+
+// Redraws the digits when the minute changed, returns the time to the next minute
+static uint32_t amoled_saver_clock_update(void)
+{
+    struct timeval tv;
+    struct tm      tm;
+    gettimeofday(&tv, NULL);
+    localtime_r(&tv.tv_sec, &tm);
+    if (tm.tm_year + 1900 < AMOLED_SAVER_SET_YEAR)
+    {
+        lv_obj_add_flag(s_clock_label, LV_OBJ_FLAG_HIDDEN);
+        s_minute = -1;
+    }
+    else if (tm.tm_min != s_minute)
+    {
+        lv_obj_clear_flag(s_clock_label, LV_OBJ_FLAG_HIDDEN);
+        s_minute = tm.tm_min;
+        s_shift  = (s_shift + 1) % (sizeof(s_shifts) / sizeof(s_shifts[0]));
+        lv_label_set_text_fmt(s_clock_label, "%02d:%02d", tm.tm_hour, tm.tm_min);
+        lv_obj_align(s_clock_label, LV_ALIGN_CENTER,
+                     s_shifts[s_shift][0] * EXAMPLE_AMOLED_CLOCK_SHIFT_PX,
+                     s_shifts[s_shift][1] * EXAMPLE_AMOLED_CLOCK_SHIFT_PX);
+        s_stats.clock_updates++;
+    }
+    // Just past the minute, the timer never runs early
+    return 60000 - (tm.tm_sec * 1000 + tv.tv_usec / 1000) + 10;
+}
+
+static void amoled_saver_enter(amoled_saver_state_t state)
+{
+    ESP_LOGD(TAG, "State %d -> %d", s_stats.state, state);
+    s_stats.state = state;
+}
+
+static void amoled_saver_show_clock(void)
+{
+    // The screen under the clock comes back as designed
+    amoled_saver_undim();
+    s_prev_scr = lv_scr_act();
+    s_minute   = -1;
+    lv_scr_load(s_clock_scr);
+    amoled_saver_enter(AMOLED_SAVER_CLOCK);
+    s_stats.clocks++;
+}
+
+static void amoled_saver_wake(void)
+{
+    if (s_stats.state == AMOLED_SAVER_CLOCK && lv_obj_is_valid(s_prev_scr))
+        lv_scr_load(s_prev_scr);
+    amoled_saver_undim();
+    amoled_saver_enter(AMOLED_SAVER_OFF);
+    s_stats.wakes++;
+    lv_timer_set_period(s_timer, EXAMPLE_AMOLED_SAVER_AFTER_MS);
+    lv_timer_reset(s_timer);
+}
+
+static void amoled_saver_timer_cb(lv_timer_t* timer)
+{
+    const uint32_t inactive = lv_disp_get_inactive_time(NULL);
+    uint32_t       next     = AMOLED_SAVER_POLL_MS;
+
+    // Activity that didn't come through amoled_saver_input()
+    if (s_stats.state != AMOLED_SAVER_OFF && inactive < EXAMPLE_AMOLED_SAVER_AFTER_MS)
+        amoled_saver_wake();
+
+    switch (s_stats.state)
+    {
+    case AMOLED_SAVER_OFF:
+        if (inactive < EXAMPLE_AMOLED_SAVER_AFTER_MS)
+        {
+            next = EXAMPLE_AMOLED_SAVER_AFTER_MS - inactive;
+            break;
+        }
+        amoled_saver_dim();
+        amoled_saver_enter(AMOLED_SAVER_DIM);
+        s_stats.dims++;
+        break;
+    case AMOLED_SAVER_DIM:
+        if (EXAMPLE_AMOLED_CLOCK_AFTER_MS > 0 && inactive >= EXAMPLE_AMOLED_CLOCK_AFTER_MS)
+        {
+            amoled_saver_show_clock();
+            next = amoled_saver_clock_update();
+        }
+        else if (lv_scr_act() != s_dimmed_scr)
+        {
+            amoled_saver_undim();
+            amoled_saver_dim();
+        }
+        break;
+    case AMOLED_SAVER_CLOCK:
+        next = amoled_saver_clock_update();
+        break;
+    }
+    lv_timer_set_period(timer, next);
+}
+
+void amoled_saver_init(void)
+{
+    s_clock_scr = lv_obj_create(NULL);
+    lv_obj_clear_flag(s_clock_scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_color(s_clock_scr, lv_color_hex(0x000000), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(s_clock_scr, LV_OPA_COVER, LV_PART_MAIN);
+
+    s_clock_label = lv_label_create(s_clock_scr);
+    lv_obj_set_style_text_font(s_clock_label, &lv_font_montserrat_40, LV_PART_MAIN);
+    lv_obj_set_style_text_color(s_clock_label, lv_color_hex(EXAMPLE_AMOLED_CLOCK_COLOR),
+                                LV_PART_MAIN);
+    lv_label_set_text(s_clock_label, "");
+    lv_obj_center(s_clock_label);
+
+    s_timer = lv_timer_create(amoled_saver_timer_cb, EXAMPLE_AMOLED_SAVER_AFTER_MS, NULL);
+    ESP_LOGI(TAG, "Dims after %d ms, clock after %d ms", EXAMPLE_AMOLED_SAVER_AFTER_MS,
+             EXAMPLE_AMOLED_CLOCK_AFTER_MS);
+}
+
+bool amoled_saver_input(void)
+{
+    if (!s_timer || s_stats.state == AMOLED_SAVER_OFF)
+        return false;
+    const bool clock = s_stats.state == AMOLED_SAVER_CLOCK;
+    amoled_saver_wake();
+    return clock;
+}
+
+void amoled_saver_get_stats(amoled_saver_stats_t* stats)
+{
+    *stats = s_stats;
+}
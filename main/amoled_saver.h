@@ -0,0 +1,34 @@
+#ifndef AMOLED_SAVER_H
+#define AMOLED_SAVER_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+typedef enum
+{
+    AMOLED_SAVER_OFF = 0, // Screen as designed
+    AMOLED_SAVER_DIM,     // Large bright backgrounds dimmed
+    AMOLED_SAVER_CLOCK,   // Always-on clock on a black screen
+} amoled_saver_state_t;
+
+typedef struct
+{
+    amoled_saver_state_t state;
+    uint32_t             dims;          // After EXAMPLE_AMOLED_SAVER_AFTER_MS without input
+    uint32_t             dimmed_objs;   // Backgrounds dimmed the last time
+    uint32_t             clocks;        // After EXAMPLE_AMOLED_CLOCK_AFTER_MS without input
+    uint32_t             clock_updates; // Minutes drawn
+    uint32_t             wakes;         // Back to the screen as designed on input
+} amoled_saver_stats_t;
+
+// Creates the clock screen and the timer that follows the display inactivity. After ui_init(),
+// from the LVGL context.
+void amoled_saver_init(void);
+
+// Input from the touch panel or the knob, in the LVGL indev read callbacks. Restores the screen,
+// returns true when it ended the clock so the input should go nowhere.
+bool amoled_saver_input(void);
+
+void amoled_saver_get_stats(amoled_saver_stats_t* stats);
+
+#endif
@@ -0,0 +1,186 @@
+// Backlight fades run in the LEDC hardware, the CPU only starts them. LEDC fades are linear in
+// duty, which the eye sees as a jump at the dark end and a crawl at the bright end, so a fade is
+// split into EXAMPLE_BACKLIGHT_SEGMENTS linear pieces along a gamma curve. The fade-end interrupt
+// wakes the task to start the next piece, it sleeps in between.
+//
+// The policy dims to EXAMPLE_BACKLIGHT_DIM_LEVEL after EXAMPLE_BACKLIGHT_DIM_AFTER_MS without
+// input and fades back up on the next touch or detent.
+
+#include <math.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "backlight.h"
+#include "lcd_bl_pwm_bsp.h"
+#include "user_config.h"
+
+static const char* TAG = "backlight";
+
+#define BACKLIGHT_STACK_SIZE (2 * 1024)
+#define BACKLIGHT_SLACK_MS   20 // Past the end of a piece without its interrupt, go on anyway
+
+// Task notification bits
+#define BACKLIGHT_FADE_END (1 << 0)
+#define BACKLIGHT_WAKE     (1 << 1)
+#define BACKLIGHT_LEVEL    (1 << 2)
+
+typedef struct
+{
+    uint8_t  from; // Perceived levels
+    uint8_t  to;
+    uint8_t  segment; // Pieces started, EXAMPLE_BACKLIGHT_SEGMENTS when done
+    uint8_t  duty;    // End of the running piece
+    uint32_t segment_ms;
+} backlight_fade_t;
+
+static uint8_t              s_gamma[256]; // Duty per perceived level
+static TaskHandle_t         s_task = NULL;
+static std::atomic<int64_t> s_input_us(0);
+static std::atomic<bool>    s_dimmed(false);
+static std::atomic<uint8_t> s_level(EXAMPLE_BACKLIGHT_LEVEL);
+static std::atomic<uint8_t> s_current(0); // Perceived level the last piece ends at
+static backlight_stats_t    s_stats;
+
+static bool backlight_fade_end(void* arg)
+{
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(s_task, BACKLIGHT_FADE_END, eSetBits, &woken);
+    return woken == pdTRUE;
+}
+
+static uint8_t backlight_level_of(uint16_t duty)
+{
+    uint8_t level = 0;
+    while (level < 255 && s_gamma[level] < duty)
+        level++;
+    return level;
+}
+
+static bool backlight_running(const backlight_fade_t* fade)
+{
+    return fade->segment < EXAMPLE_BACKLIGHT_SEGMENTS;
+}
+
+static void backlight_next(backlight_fade_t* fade)
+{
+    fade->segment++;
+    const uint8_t level =
+        fade->from + ((int32_t) fade->to - fade->from) * fade->segment / EXAMPLE_BACKLIGHT_SEGMENTS;
+    fade->duty = s_gamma[level];
+    lcd_bl_pwm_bsp_fade(fade->duty, fade->segment_ms);
+    s_current = level;
+    s_stats.segments++;
+}
+
+static void backlight_start(backlight_fade_t* fade, uint8_t to, uint32_t time_ms)
+{
+    if (backlight_running(fade))
+        s_stats.interrupted++;
+    // From wherever the running fade got to
+    fade->from       = backlight_level_of(lcd_bl_pwm_bsp_get_duty());
+    fade->to         = to;
+    fade->segment    = 0;
+    fade->segment_ms = time_ms / EXAMPLE_BACKLIGHT_SEGMENTS;
+    s_stats.fades++;
+    backlight_next(fade);
+}
+
+static void backlight_task(void* arg)
+{
+    backlight_fade_t fade = {};
+    fade.segment          = EXAMPLE_BACKLIGHT_SEGMENTS; // Nothing running
+    s_task                = xTaskGetCurrentTaskHandle(); // Before the first fade can end
+    backlight_start(&fade, s_level, EXAMPLE_BACKLIGHT_WAKE_MS);
+    while (1)
+    {
+        TickType_t wait = portMAX_DELAY;
+        if (backlight_running(&fade))
+            wait = pdMS_TO_TICKS(fade.segment_ms + BACKLIGHT_SLACK_MS);
+        else if (EXAMPLE_BACKLIGHT_DIM_AFTER_MS && !s_dimmed)
+        {
+            const int64_t left_us =
+                s_input_us + EXAMPLE_BACKLIGHT_DIM_AFTER_MS * 1000LL - esp_timer_get_time();
+            wait = left_us > 0 ? pdMS_TO_TICKS(left_us / 1000) + 1 : 0;
+        }
+
+        uint32_t bits = 0;
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, wait) != pdTRUE)
+            bits = 0;
+
+        if (bits & (BACKLIGHT_WAKE | BACKLIGHT_LEVEL))
+        {
+            s_stats.wakes += s_dimmed && (bits & BACKLIGHT_WAKE);
+            s_dimmed = false;
+            backlight_start(&fade, s_level, EXAMPLE_BACKLIGHT_WAKE_MS);
+        }
+        else if (backlight_running(&fade))
+        {
+            // The interrupt of a fade stopped early may still come in, only the end of this
+            // piece counts. Without any interrupt the timeout moves on.
+            if (bits == 0 || lcd_bl_pwm_bsp_get_duty() == fade.duty)
+                backlight_next(&fade);
+        }
+        else if (EXAMPLE_BACKLIGHT_DIM_AFTER_MS && !s_dimmed &&
+                 esp_timer_get_time() - s_input_us >= EXAMPLE_BACKLIGHT_DIM_AFTER_MS * 1000LL)
+        {
+            s_dimmed = true;
+            s_stats.dims++;
+            // Never brighter than what the user set
+            uint8_t dim = s_level;
+            if (dim > EXAMPLE_BACKLIGHT_DIM_LEVEL)
+                dim = EXAMPLE_BACKLIGHT_DIM_LEVEL;
+            backlight_start(&fade, dim, EXAMPLE_BACKLIGHT_DIM_MS);
+        }
+    }
+}
+
+bool backlight_init(void)
+{
+    for (int level = 0; level < 256; level++)
+    {
+        const long duty = lroundf(255.0f * powf(level / 255.0f, EXAMPLE_BACKLIGHT_GAMMA));
+        // Any level above 0 lights the panel
+        s_gamma[level] = level ? (uint8_t) (duty > 1 ? duty : 1) : 0;
+    }
+    s_input_us = esp_timer_get_time();
+
+    lcd_bl_pwm_bsp_fade_init(backlight_fade_end, NULL);
+    if (xTaskCreatePinnedToCore(backlight_task, "backlight", BACKLIGHT_STACK_SIZE, NULL,
+                                EXAMPLE_BACKLIGHT_TASK_PRIORITY, &s_task,
+                                EXAMPLE_LVGL_TASK_CORE ? 0 : 1) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start the backlight task");
+        return false;
+    }
+    ESP_LOGI(TAG, "Level %d, dims to %d after %d ms, gamma %.1f in %d pieces",
+             EXAMPLE_BACKLIGHT_LEVEL, EXAMPLE_BACKLIGHT_DIM_LEVEL, EXAMPLE_BACKLIGHT_DIM_AFTER_MS,
+             EXAMPLE_BACKLIGHT_GAMMA, EXAMPLE_BACKLIGHT_SEGMENTS);
+    return true;
+}
+
+void backlight_input(void)
+{
+    s_input_us = esp_timer_get_time();
+    if (s_dimmed && s_task)
+        xTaskNotify(s_task, BACKLIGHT_WAKE, eSetBits);
+}
+
+void backlight_set_level(uint8_t level)
+{
+    s_level = level;
+    if (s_task && !s_dimmed)
+        xTaskNotify(s_task, BACKLIGHT_LEVEL, eSetBits);
+}
+
+uint8_t backlight_get_level(void)
+{
+    return s_current;
+}
+
+void backlight_get_stats(backlight_stats_t* stats)
+{
+    *stats = s_stats;
+}
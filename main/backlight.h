@@ -0,0 +1,29 @@
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t fades;       // Fades started, each made of EXAMPLE_BACKLIGHT_SEGMENTS hardware fades
+    uint32_t segments;    // Hardware fades started
+    uint32_t interrupted; // Fades replaced by a new one before they ended
+    uint32_t dims;        // Fades down after EXAMPLE_BACKLIGHT_DIM_AFTER_MS without input
+    uint32_t wakes;       // Fades back up on input
+} backlight_stats_t;
+
+// Installs the LEDC fade service and starts the backlight task, which fades in to
+// EXAMPLE_BACKLIGHT_LEVEL. Must be called after lcd_bl_pwm_bsp_init().
+bool backlight_init(void);
+
+// Input from the touch panel or the encoder. Lock-free and never blocks, wakes the backlight when
+// it is dimmed.
+void backlight_input(void);
+
+// Perceived brightness while in use, 0-255. Fades there unless dimmed, never blocks.
+void backlight_set_level(uint8_t level);
+uint8_t backlight_get_level(void);
+
+void backlight_get_stats(backlight_stats_t* stats);
+
+#endif
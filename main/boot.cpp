@@ -0,0 +1,160 @@
+// Boot stages. Most of the boot is waiting on hardware: the panel reset and its 120 ms sleep-out,
+// the I2C devices. With EXAMPLE_BOOT_PARALLEL those stages run on tasks of their own while the
+// main task sets up LVGL and builds the screens, and the LVGL task only starts once they are
+// joined. Every stage is timestamped, the report after the first frame shows where the time to
+// it went. With EXAMPLE_BOOT_PARALLEL 0 in user_config.h the same stages run one after the other.
+//
+// To compare, flash once with each setting and read "First frame at" off the report of a few cold
+// boots each (power cycled, so the panel comes up from reset as it does in the field). The report
+// names the setting it was built with. Within one parallel boot, the stage time the overlap took
+// off is the sum of the stages less the time they spanned, the report logs that as well.
+
+#include <inttypes.h>
+#include <string.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+
+#include "boot.h"
+#include "user_config.h"
+#if EXAMPLE_PANEL_INIT_PLAYER
+#include "panel_init.h"
+#endif
+
+static const char* TAG = "boot";
+
+typedef struct
+{
+    const char* name;
+    void (*fn)(void);
+} boot_spawned_t;
+
+static boot_stage_t          s_stages[BOOT_MAX_STAGES];
+static std::atomic<uint32_t> s_stage_cnt(0);
+static std::atomic<int64_t>  s_first_frame_us(0);
+static SemaphoreHandle_t     s_done    = NULL; // Given by every spawned stage
+static uint32_t              s_pending = 0;    // Spawned and not joined, owned by the main task
+
+int boot_stage_begin(const char* name)
+{
+    const uint32_t stage = s_stage_cnt.fetch_add(1);
+    if (stage >= BOOT_MAX_STAGES)
+        return -1;
+    s_stages[stage].name     = name;
+    s_stages[stage].task     = pcTaskGetName(NULL);
+    s_stages[stage].start_us = esp_timer_get_time();
+    return (int) stage;
+}
+
+void boot_stage_end(int stage)
+{
+    if (stage >= 0)
+        s_stages[stage].end_us = esp_timer_get_time();
+}
+
+#if EXAMPLE_BOOT_PARALLEL
+static void boot_task(void* arg)
+{
+    const boot_spawned_t* spawned = (const boot_spawned_t*) arg;
+    const int             stage   = boot_stage_begin(spawned->name);
+    spawned->fn();
+    boot_stage_end(stage);
+    xSemaphoreGive(s_done);
+    vTaskDelete(NULL);
+}
+#endif
+
+void boot_spawn(const char* name, void (*fn)(void))
+{
+#if EXAMPLE_BOOT_PARALLEL
+    static boot_spawned_t spawned[BOOT_MAX_STAGES];
+    if (!s_done)
+        s_done = xSemaphoreCreateCounting(BOOT_MAX_STAGES, 0);
+    if (s_done && s_pending < BOOT_MAX_STAGES)
+    {
+        boot_spawned_t* slot = &spawned[s_pending];
+        slot->name           = name;
+        slot->fn             = fn;
+        if (xTaskCreate(boot_task, name, EXAMPLE_BOOT_TASK_STACK_SIZE, slot,
+                        EXAMPLE_BOOT_TASK_PRIORITY, NULL) == pdPASS)
+        {
+            s_pending++;
+            return;
+        }
+    }
+    ESP_LOGW(TAG, "Running %s in place", name);
+#endif
+    const int stage = boot_stage_begin(name);
+    fn();
+    boot_stage_end(stage);
+}
+
+void boot_join(void)
+{
+    const int stage = s_pending ? boot_stage_begin("join") : -1;
+    for (; s_pending; s_pending--)
+        xSemaphoreTake(s_done, portMAX_DELAY);
+    boot_stage_end(stage);
+}
+
+void boot_first_frame(void)
+{
+    int64_t expected = 0;
+    if (!s_first_frame_us.compare_exchange_strong(expected, esp_timer_get_time()))
+        return;
+#if EXAMPLE_BOOT_REPORT
+    boot_report();
+#endif
+}
+
+void boot_get_stats(boot_stats_t* stats)
+{
+    stats->stage_cnt = s_stage_cnt;
+    if (stats->stage_cnt > BOOT_MAX_STAGES)
+        stats->stage_cnt = BOOT_MAX_STAGES;
+    for (uint32_t i = 0; i < stats->stage_cnt; i++)
+        stats->stages[i] = s_stages[i];
+    stats->first_frame_us = s_first_frame_us;
+}
+
+void boot_report(void)
+{
+    static boot_stats_t stats;
+    boot_get_stats(&stats);
+
+    int64_t busy_us  = 0;
+    int64_t start_us = INT64_MAX;
+    int64_t end_us   = 0;
+    ESP_LOGI(TAG, "First frame at %" PRId64 " ms, EXAMPLE_BOOT_PARALLEL %d, %s stages:",
+             stats.first_frame_us / 1000, EXAMPLE_BOOT_PARALLEL,
+             EXAMPLE_BOOT_PARALLEL ? "parallel" : "serial");
+    for (uint32_t i = 0; i < stats.stage_cnt; i++)
+    {
+        const boot_stage_t* stage = &stats.stages[i];
+        const int64_t       us    = stage->end_us ? stage->end_us - stage->start_us : 0;
+        // Waiting for the others is no work of its own
+        if (strcmp(stage->name, "join") != 0)
+            busy_us += us;
+        start_us = LV_MIN(start_us, stage->start_us);
+        end_us   = LV_MAX(end_us, stage->end_us);
+        ESP_LOGI(TAG, "  %-10s %-10s at %5" PRId64 " ms, %4" PRId64 ".%" PRId64 " ms", stage->name,
+                 stage->task, stage->start_us / 1000, us / 1000, us % 1000 / 100);
+    }
+    if (end_us > start_us)
+        ESP_LOGI(TAG, "  %" PRId64 " ms of stages in %" PRId64 " ms, %" PRId64 " ms overlapped",
+                 busy_us / 1000, (end_us - start_us) / 1000,
+                 LV_MAX(busy_us - (end_us - start_us), 0) / 1000);
+#if EXAMPLE_PANEL_INIT_PLAYER
+    // Inside the panel stage, how much of it the panel made us wait
+    panel_init_stats_t panel;
+    panel_init_get_stats(&panel);
+    if (panel.cmds)
+        ESP_LOGI(TAG, "  panel init %" PRIu32 " commands, %" PRIu32 " bytes in %" PRId64
+                 ".%" PRId64 " ms, %" PRIu32 " ms of it waits",
+                 panel.cmds, panel.bytes, panel.us / 1000, panel.us % 1000 / 100, panel.wait_ms);
+#endif
+}
@@ -0,0 +1,39 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+#define BOOT_MAX_STAGES 16
+
+typedef struct
+{
+    const char* name;
+    const char* task;     // Task that ran the stage
+    int64_t     start_us; // esp_timer time, from the start of the application
+    int64_t     end_us;
+} boot_stage_t;
+
+typedef struct
+{
+    boot_stage_t stages[BOOT_MAX_STAGES];
+    uint32_t     stage_cnt;
+    int64_t      first_frame_us; // 0 until the first frame is out
+} boot_stats_t;
+
+// Timestamps a stage of the boot, from any task. Returns the stage to end.
+int  boot_stage_begin(const char* name);
+void boot_stage_end(int stage);
+
+// Runs `fn` as a stage on a task of its own with EXAMPLE_BOOT_PARALLEL, in place without
+void boot_spawn(const char* name, void (*fn)(void));
+
+// Waits until every stage spawned so far has ended
+void boot_join(void);
+
+// Called from the LVGL monitor_cb, the first call closes the boot and reports it
+void boot_first_frame(void);
+
+void boot_get_stats(boot_stats_t* stats);
+void boot_report(void);
+
+#endif
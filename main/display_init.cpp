@@ -3,6 +3,7 @@
 // https://www.waveshare.com/wiki/ESP32-S3-Knob-Touch-LCD-1.8#Working_with_ESP-IDF
 
 #include <stdio.h>
+#include <math.h>
 #include <inttypes.h>
 #include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
@@ -23,235 +24,341 @@
 #include "i2c_bsp.h"
 #include "lcd_touch_bsp.h"
 #include "user_config.h"
+#include "display_init.h"
 #include "lcd_bl_pwm_bsp.h"
+#include "display_rotation.h"
+#include "boot.h"
+#include "panel_init.h"
+#include <atomic>
 
-static const char*       TAG      = "display_init";
-static SemaphoreHandle_t lvgl_mux = NULL;
+#if EXAMPLE_USE_ROUND_MASK
+#include "round_mask.h"
+#endif
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+#include "refresh_governor.h"
+#endif
+#if EXAMPLE_USE_QUALITY_GOVERNOR
+#include "quality_governor.h"
+#endif
+#if EXAMPLE_USE_SCROLL_BLIT
+#include "scroll_blit.h"
+#endif
+#if EXAMPLE_USE_SIMD_DRAW
+#include "simd_draw.h"
+#endif
+#if EXAMPLE_USE_PARALLEL_DRAW
+#include "parallel_draw.h"
+#endif
+#if EXAMPLE_USE_DMA_COPY
+#include "dma_copy.h"
+#endif
+#if EXAMPLE_USE_TOUCH
+#include "touch_sampler.h"
+#endif
+#if EXAMPLE_USE_TOUCH && EXAMPLE_USE_TOUCH_FILTER
+#include "touch_filter.h"
+#endif
+#if EXAMPLE_USE_ENCODER_INDEV
+#include "encoder_input.h"
+#endif
+#if EXAMPLE_USE_BACKLIGHT
+#include "backlight.h"
+#endif
+#if EXAMPLE_USE_POWER_MANAGER
+#include "power_manager.h"
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+#include "input_latency.h"
+#endif
+#if EXAMPLE_USE_HAPTICS
+#include "haptics.h"
+#endif
+#if EXAMPLE_USE_AMOLED_POWER
+#include "amoled_power.h"
+#endif
+#if EXAMPLE_USE_AMOLED_SAVER
+#include "amoled_saver.h"
+#endif
+
+static const char*            TAG       = "display_init";
+static SemaphoreHandle_t      lvgl_mux  = NULL;
+static esp_lcd_panel_handle_t lcd_panel = NULL;
+
+// MADCTL is sent by display_init_panel() and by display_set_rotation()
+static esp_lcd_panel_io_handle_t           lcd_io          = NULL;
+static uint8_t                             lcd_madctl      = 0x00;
+static display_rotation_t                  lcd_rotation    = DISPLAY_ROTATION_0;
+static const display_rotation_transform_t* touch_transform = NULL;
 
 #if CONFIG_LV_COLOR_DEPTH == 32
 #define LCD_BIT_PER_PIXEL (24)
 #elif CONFIG_LV_COLOR_DEPTH == 16
 #define LCD_BIT_PER_PIXEL (16)
 #endif
+// SH8601 init sequence, packed for panel_init_play(). MADCTL and COLMOD are sent ahead of it.
 //d5-d7
-static const sh8601_lcd_init_cmd_t lcd_init_cmds[] = {
-    {0xF0, (uint8_t[]){0x28}, 1, 0},
-    {0xF2, (uint8_t[]){0x28}, 1, 0},
-    {0x73, (uint8_t[]){0xF0}, 1, 0},
-    {0x7C, (uint8_t[]){0xD1}, 1, 0},
-    {0x83, (uint8_t[]){0xE0}, 1, 0},
-    {0x84, (uint8_t[]){0x61}, 1, 0},
-    {0xF2, (uint8_t[]){0x82}, 1, 0},
-    {0xF0, (uint8_t[]){0x00}, 1, 0},
-    {0xF0, (uint8_t[]){0x01}, 1, 0},
-    {0xF1, (uint8_t[]){0x01}, 1, 0},
-    {0xB0, (uint8_t[]){0x56}, 1, 0},
-    {0xB1, (uint8_t[]){0x4D}, 1, 0},
-    {0xB2, (uint8_t[]){0x24}, 1, 0},
-    {0xB4, (uint8_t[]){0x87}, 1, 0},
-    {0xB5, (uint8_t[]){0x44}, 1, 0},
-    {0xB6, (uint8_t[]){0x8B}, 1, 0},
-    {0xB7, (uint8_t[]){0x40}, 1, 0},
-    {0xB8, (uint8_t[]){0x86}, 1, 0},
-    {0xBA, (uint8_t[]){0x00}, 1, 0},
-    {0xBB, (uint8_t[]){0x08}, 1, 0},
-    {0xBC, (uint8_t[]){0x08}, 1, 0},
-    {0xBD, (uint8_t[]){0x00}, 1, 0},
-    {0xC0, (uint8_t[]){0x80}, 1, 0},
-    {0xC1, (uint8_t[]){0x10}, 1, 0},
-    {0xC2, (uint8_t[]){0x37}, 1, 0},
-    {0xC3, (uint8_t[]){0x80}, 1, 0},
-    {0xC4, (uint8_t[]){0x10}, 1, 0},
-    {0xC5, (uint8_t[]){0x37}, 1, 0},
-    {0xC6, (uint8_t[]){0xA9}, 1, 0},
-    {0xC7, (uint8_t[]){0x41}, 1, 0},
-    {0xC8, (uint8_t[]){0x01}, 1, 0},
-    {0xC9, (uint8_t[]){0xA9}, 1, 0},
-    {0xCA, (uint8_t[]){0x41}, 1, 0},
-    {0xCB, (uint8_t[]){0x01}, 1, 0},
-    {0xD0, (uint8_t[]){0x91}, 1, 0},
-    {0xD1, (uint8_t[]){0x68}, 1, 0},
-    {0xD2, (uint8_t[]){0x68}, 1, 0},
-    {0xF5, (uint8_t[]){0x00, 0xA5}, 2, 0},
-    {0xDD, (uint8_t[]){0x4F}, 1, 0},
-    {0xDE, (uint8_t[]){0x4F}, 1, 0},
-    {0xF1, (uint8_t[]){0x10}, 1, 0},
-    {0xF0, (uint8_t[]){0x00}, 1, 0},
-    {0xF0, (uint8_t[]){0x02}, 1, 0},
-    {0xE0,
-     (uint8_t[]){0xF0, 0x0A, 0x10, 0x09, 0x09, 0x36, 0x35, 0x33, 0x4A, 0x29, 0x15, 0x15, 0x2E,
-                 0x34},
-     14, 0},
-    {0xE1,
-     (uint8_t[]){0xF0, 0x0A, 0x0F, 0x08, 0x08, 0x05, 0x34, 0x33, 0x4A, 0x39, 0x15, 0x15, 0x2D,
-                 0x33},
-     14, 0},
-    {0xF0, (uint8_t[]){0x10}, 1, 0},
-    {0xF3, (uint8_t[]){0x10}, 1, 0},
-    {0xE0, (uint8_t[]){0x07}, 1, 0},
-    {0xE1, (uint8_t[]){0x00}, 1, 0},
-    {0xE2, (uint8_t[]){0x00}, 1, 0},
-    {0xE3, (uint8_t[]){0x00}, 1, 0},
-    {0xE4, (uint8_t[]){0xE0}, 1, 0},
-    {0xE5, (uint8_t[]){0x06}, 1, 0},
-    {0xE6, (uint8_t[]){0x21}, 1, 0},
-    {0xE7, (uint8_t[]){0x01}, 1, 0},
-    {0xE8, (uint8_t[]){0x05}, 1, 0},
-    {0xE9, (uint8_t[]){0x02}, 1, 0},
-    {0xEA, (uint8_t[]){0xDA}, 1, 0},
-    {0xEB, (uint8_t[]){0x00}, 1, 0},
-    {0xEC, (uint8_t[]){0x00}, 1, 0},
-    {0xED, (uint8_t[]){0x0F}, 1, 0},
-    {0xEE, (uint8_t[]){0x00}, 1, 0},
-    {0xEF, (uint8_t[]){0x00}, 1, 0},
-    {0xF8, (uint8_t[]){0x00}, 1, 0},
-    {0xF9, (uint8_t[]){0x00}, 1, 0},
-    {0xFA, (uint8_t[]){0x00}, 1, 0},
-    {0xFB, (uint8_t[]){0x00}, 1, 0},
-    {0xFC, (uint8_t[]){0x00}, 1, 0},
-    {0xFD, (uint8_t[]){0x00}, 1, 0},
-    {0xFE, (uint8_t[]){0x00}, 1, 0},
-    {0xFF, (uint8_t[]){0x00}, 1, 0},
-    {0x60, (uint8_t[]){0x40}, 1, 0},
-    {0x61, (uint8_t[]){0x04}, 1, 0},
-    {0x62, (uint8_t[]){0x00}, 1, 0},
-    {0x63, (uint8_t[]){0x42}, 1, 0},
-    {0x64, (uint8_t[]){0xD9}, 1, 0},
-    {0x65, (uint8_t[]){0x00}, 1, 0},
-    {0x66, (uint8_t[]){0x00}, 1, 0},
-    {0x67, (uint8_t[]){0x00}, 1, 0},
-    {0x68, (uint8_t[]){0x00}, 1, 0},
-    {0x69, (uint8_t[]){0x00}, 1, 0},
-    {0x6A, (uint8_t[]){0x00}, 1, 0},
-    {0x6B, (uint8_t[]){0x00}, 1, 0},
-    {0x70, (uint8_t[]){0x40}, 1, 0},
-    {0x71, (uint8_t[]){0x03}, 1, 0},
-    {0x72, (uint8_t[]){0x00}, 1, 0},
-    {0x73, (uint8_t[]){0x42}, 1, 0},
-    {0x74, (uint8_t[]){0xD8}, 1, 0},
-    {0x75, (uint8_t[]){0x00}, 1, 0},
-    {0x76, (uint8_t[]){0x00}, 1, 0},
-    {0x77, (uint8_t[]){0x00}, 1, 0},
-    {0x78, (uint8_t[]){0x00}, 1, 0},
-    {0x79, (uint8_t[]){0x00}, 1, 0},
-    {0x7A, (uint8_t[]){0x00}, 1, 0},
-    {0x7B, (uint8_t[]){0x00}, 1, 0},
-    {0x80, (uint8_t[]){0x48}, 1, 0},
-    {0x81, (uint8_t[]){0x00}, 1, 0},
-    {0x82, (uint8_t[]){0x06}, 1, 0},
-    {0x83, (uint8_t[]){0x02}, 1, 0},
-    {0x84, (uint8_t[]){0xD6}, 1, 0},
-    {0x85, (uint8_t[]){0x04}, 1, 0},
-    {0x86, (uint8_t[]){0x00}, 1, 0},
-    {0x87, (uint8_t[]){0x00}, 1, 0},
-    {0x88, (uint8_t[]){0x48}, 1, 0},
-    {0x89, (uint8_t[]){0x00}, 1, 0},
-    {0x8A, (uint8_t[]){0x08}, 1, 0},
-    {0x8B, (uint8_t[]){0x02}, 1, 0},
-    {0x8C, (uint8_t[]){0xD8}, 1, 0},
-    {0x8D, (uint8_t[]){0x04}, 1, 0},
-    {0x8E, (uint8_t[]){0x00}, 1, 0},
-    {0x8F, (uint8_t[]){0x00}, 1, 0},
-    {0x90, (uint8_t[]){0x48}, 1, 0},
-    {0x91, (uint8_t[]){0x00}, 1, 0},
-    {0x92, (uint8_t[]){0x0A}, 1, 0},
-    {0x93, (uint8_t[]){0x02}, 1, 0},
-    {0x94, (uint8_t[]){0xDA}, 1, 0},
-    {0x95, (uint8_t[]){0x04}, 1, 0},
-    {0x96, (uint8_t[]){0x00}, 1, 0},
-    {0x97, (uint8_t[]){0x00}, 1, 0},
-    {0x98, (uint8_t[]){0x48}, 1, 0},
-    {0x99, (uint8_t[]){0x00}, 1, 0},
-    {0x9A, (uint8_t[]){0x0C}, 1, 0},
-    {0x9B, (uint8_t[]){0x02}, 1, 0},
-    {0x9C, (uint8_t[]){0xDC}, 1, 0},
-    {0x9D, (uint8_t[]){0x04}, 1, 0},
-    {0x9E, (uint8_t[]){0x00}, 1, 0},
-    {0x9F, (uint8_t[]){0x00}, 1, 0},
-    {0xA0, (uint8_t[]){0x48}, 1, 0},
-    {0xA1, (uint8_t[]){0x00}, 1, 0},
-    {0xA2, (uint8_t[]){0x05}, 1, 0},
-    {0xA3, (uint8_t[]){0x02}, 1, 0},
-    {0xA4, (uint8_t[]){0xD5}, 1, 0},
-    {0xA5, (uint8_t[]){0x04}, 1, 0},
-    {0xA6, (uint8_t[]){0x00}, 1, 0},
-    {0xA7, (uint8_t[]){0x00}, 1, 0},
-    {0xA8, (uint8_t[]){0x48}, 1, 0},
-    {0xA9, (uint8_t[]){0x00}, 1, 0},
-    {0xAA, (uint8_t[]){0x07}, 1, 0},
-    {0xAB, (uint8_t[]){0x02}, 1, 0},
-    {0xAC, (uint8_t[]){0xD7}, 1, 0},
-    {0xAD, (uint8_t[]){0x04}, 1, 0},
-    {0xAE, (uint8_t[]){0x00}, 1, 0},
-    {0xAF, (uint8_t[]){0x00}, 1, 0},
-    {0xB0, (uint8_t[]){0x48}, 1, 0},
-    {0xB1, (uint8_t[]){0x00}, 1, 0},
-    {0xB2, (uint8_t[]){0x09}, 1, 0},
-    {0xB3, (uint8_t[]){0x02}, 1, 0},
-    {0xB4, (uint8_t[]){0xD9}, 1, 0},
-    {0xB5, (uint8_t[]){0x04}, 1, 0},
-    {0xB6, (uint8_t[]){0x00}, 1, 0},
-    {0xB7, (uint8_t[]){0x00}, 1, 0},
-    {0xB8, (uint8_t[]){0x48}, 1, 0},
-    {0xB9, (uint8_t[]){0x00}, 1, 0},
-    {0xBA, (uint8_t[]){0x0B}, 1, 0},
-    {0xBB, (uint8_t[]){0x02}, 1, 0},
-    {0xBC, (uint8_t[]){0xDB}, 1, 0},
-    {0xBD, (uint8_t[]){0x04}, 1, 0},
-    {0xBE, (uint8_t[]){0x00}, 1, 0},
-    {0xBF, (uint8_t[]){0x00}, 1, 0},
-    {0xC0, (uint8_t[]){0x10}, 1, 0},
-    {0xC1, (uint8_t[]){0x47}, 1, 0},
-    {0xC2, (uint8_t[]){0x56}, 1, 0},
-    {0xC3, (uint8_t[]){0x65}, 1, 0},
-    {0xC4, (uint8_t[]){0x74}, 1, 0},
-    {0xC5, (uint8_t[]){0x88}, 1, 0},
-    {0xC6, (uint8_t[]){0x99}, 1, 0},
-    {0xC7, (uint8_t[]){0x01}, 1, 0},
-    {0xC8, (uint8_t[]){0xBB}, 1, 0},
-    {0xC9, (uint8_t[]){0xAA}, 1, 0},
-    {0xD0, (uint8_t[]){0x10}, 1, 0},
-    {0xD1, (uint8_t[]){0x47}, 1, 0},
-    {0xD2, (uint8_t[]){0x56}, 1, 0},
-    {0xD3, (uint8_t[]){0x65}, 1, 0},
-    {0xD4, (uint8_t[]){0x74}, 1, 0},
-    {0xD5, (uint8_t[]){0x88}, 1, 0},
-    {0xD6, (uint8_t[]){0x99}, 1, 0},
-    {0xD7, (uint8_t[]){0x01}, 1, 0},
-    {0xD8, (uint8_t[]){0xBB}, 1, 0},
-    {0xD9, (uint8_t[]){0xAA}, 1, 0},
-    {0xF3, (uint8_t[]){0x01}, 1, 0},
-    {0xF0, (uint8_t[]){0x00}, 1, 0},
-    {0x21, (uint8_t[]){0x00}, 1, 0},
-    {0x11, (uint8_t[]){0x00}, 1, 120},
-    {0x29, (uint8_t[]){0x00}, 1, 0},
-#ifdef EXAMPLE_Rotate_90
-    {0x36, (uint8_t[]){0x60}, 1, 0},
-#else
-    {0x36, (uint8_t[]){0x00}, 1, 0},
-#endif
+static const uint8_t lcd_init_seq[] = {
+    0xF0, 1, 0x28,
+    0xF2, 1, 0x28,
+    0x73, 1, 0xF0,
+    0x7C, 1, 0xD1,
+    0x83, 1, 0xE0,
+    0x84, 1, 0x61,
+    0xF2, 1, 0x82,
+    0xF0, 1, 0x00,
+    0xF0, 1, 0x01,
+    0xF1, 1, 0x01,
+    0xB0, 1, 0x56,
+    0xB1, 1, 0x4D,
+    0xB2, 1, 0x24,
+    0xB4, 1, 0x87,
+    0xB5, 1, 0x44,
+    0xB6, 1, 0x8B,
+    0xB7, 1, 0x40,
+    0xB8, 1, 0x86,
+    0xBA, 1, 0x00,
+    0xBB, 1, 0x08,
+    0xBC, 1, 0x08,
+    0xBD, 1, 0x00,
+    0xC0, 1, 0x80,
+    0xC1, 1, 0x10,
+    0xC2, 1, 0x37,
+    0xC3, 1, 0x80,
+    0xC4, 1, 0x10,
+    0xC5, 1, 0x37,
+    0xC6, 1, 0xA9,
+    0xC7, 1, 0x41,
+    0xC8, 1, 0x01,
+    0xC9, 1, 0xA9,
+    0xCA, 1, 0x41,
+    0xCB, 1, 0x01,
+    0xD0, 1, 0x91,
+    0xD1, 1, 0x68,
+    0xD2, 1, 0x68,
+    0xF5, 2, 0x00, 0xA5,
+    0xDD, 1, 0x4F,
+    0xDE, 1, 0x4F,
+    0xF1, 1, 0x10,
+    0xF0, 1, 0x00,
+    0xF0, 1, 0x02,
+    0xE0, 14, 0xF0, 0x0A, 0x10, 0x09, 0x09, 0x36, 0x35, 0x33, 0x4A, 0x29, 0x15, 0x15, 0x2E, 0x34,
+    0xE1, 14, 0xF0, 0x0A, 0x0F, 0x08, 0x08, 0x05, 0x34, 0x33, 0x4A, 0x39, 0x15, 0x15, 0x2D, 0x33,
+    0xF0, 1, 0x10,
+    0xF3, 1, 0x10,
+    0xE0, 1, 0x07,
+    0xE1, 1, 0x00,
+    0xE2, 1, 0x00,
+    0xE3, 1, 0x00,
+    0xE4, 1, 0xE0,
+    0xE5, 1, 0x06,
+    0xE6, 1, 0x21,
+    0xE7, 1, 0x01,
+    0xE8, 1, 0x05,
+    0xE9, 1, 0x02,
+    0xEA, 1, 0xDA,
+    0xEB, 1, 0x00,
+    0xEC, 1, 0x00,
+    0xED, 1, 0x0F,
+    0xEE, 1, 0x00,
+    0xEF, 1, 0x00,
+    0xF8, 1, 0x00,
+    0xF9, 1, 0x00,
+    0xFA, 1, 0x00,
+    0xFB, 1, 0x00,
+    0xFC, 1, 0x00,
+    0xFD, 1, 0x00,
+    0xFE, 1, 0x00,
+    0xFF, 1, 0x00,
+    0x60, 1, 0x40,
+    0x61, 1, 0x04,
+    0x62, 1, 0x00,
+    0x63, 1, 0x42,
+    0x64, 1, 0xD9,
+    0x65, 1, 0x00,
+    0x66, 1, 0x00,
+    0x67, 1, 0x00,
+    0x68, 1, 0x00,
+    0x69, 1, 0x00,
+    0x6A, 1, 0x00,
+    0x6B, 1, 0x00,
+    0x70, 1, 0x40,
+    0x71, 1, 0x03,
+    0x72, 1, 0x00,
+    0x73, 1, 0x42,
+    0x74, 1, 0xD8,
+    0x75, 1, 0x00,
+    0x76, 1, 0x00,
+    0x77, 1, 0x00,
+    0x78, 1, 0x00,
+    0x79, 1, 0x00,
+    0x7A, 1, 0x00,
+    0x7B, 1, 0x00,
+    0x80, 1, 0x48,
+    0x81, 1, 0x00,
+    0x82, 1, 0x06,
+    0x83, 1, 0x02,
+    0x84, 1, 0xD6,
+    0x85, 1, 0x04,
+    0x86, 1, 0x00,
+    0x87, 1, 0x00,
+    0x88, 1, 0x48,
+    0x89, 1, 0x00,
+    0x8A, 1, 0x08,
+    0x8B, 1, 0x02,
+    0x8C, 1, 0xD8,
+    0x8D, 1, 0x04,
+    0x8E, 1, 0x00,
+    0x8F, 1, 0x00,
+    0x90, 1, 0x48,
+    0x91, 1, 0x00,
+    0x92, 1, 0x0A,
+    0x93, 1, 0x02,
+    0x94, 1, 0xDA,
+    0x95, 1, 0x04,
+    0x96, 1, 0x00,
+    0x97, 1, 0x00,
+    0x98, 1, 0x48,
+    0x99, 1, 0x00,
+    0x9A, 1, 0x0C,
+    0x9B, 1, 0x02,
+    0x9C, 1, 0xDC,
+    0x9D, 1, 0x04,
+    0x9E, 1, 0x00,
+    0x9F, 1, 0x00,
+    0xA0, 1, 0x48,
+    0xA1, 1, 0x00,
+    0xA2, 1, 0x05,
+    0xA3, 1, 0x02,
+    0xA4, 1, 0xD5,
+    0xA5, 1, 0x04,
+    0xA6, 1, 0x00,
+    0xA7, 1, 0x00,
+    0xA8, 1, 0x48,
+    0xA9, 1, 0x00,
+    0xAA, 1, 0x07,
+    0xAB, 1, 0x02,
+    0xAC, 1, 0xD7,
+    0xAD, 1, 0x04,
+    0xAE, 1, 0x00,
+    0xAF, 1, 0x00,
+    0xB0, 1, 0x48,
+    0xB1, 1, 0x00,
+    0xB2, 1, 0x09,
+    0xB3, 1, 0x02,
+    0xB4, 1, 0xD9,
+    0xB5, 1, 0x04,
+    0xB6, 1, 0x00,
+    0xB7, 1, 0x00,
+    0xB8, 1, 0x48,
+    0xB9, 1, 0x00,
+    0xBA, 1, 0x0B,
+    0xBB, 1, 0x02,
+    0xBC, 1, 0xDB,
+    0xBD, 1, 0x04,
+    0xBE, 1, 0x00,
+    0xBF, 1, 0x00,
+    0xC0, 1, 0x10,
+    0xC1, 1, 0x47,
+    0xC2, 1, 0x56,
+    0xC3, 1, 0x65,
+    0xC4, 1, 0x74,
+    0xC5, 1, 0x88,
+    0xC6, 1, 0x99,
+    0xC7, 1, 0x01,
+    0xC8, 1, 0xBB,
+    0xC9, 1, 0xAA,
+    0xD0, 1, 0x10,
+    0xD1, 1, 0x47,
+    0xD2, 1, 0x56,
+    0xD3, 1, 0x65,
+    0xD4, 1, 0x74,
+    0xD5, 1, 0x88,
+    0xD6, 1, 0x99,
+    0xD7, 1, 0x01,
+    0xD8, 1, 0xBB,
+    0xD9, 1, 0xAA,
+    0xF3, 1, 0x01,
+    0xF0, 1, 0x00,
+    0x21, 1, 0x00,
+    0x11, 1 | PANEL_INIT_DELAY, 0x00, 120,
+    0x29, 1, 0x00,
 };
 
+// Color transfers finish in the order they were queued, so a sequence number tells when a
+// given transfer is out. A flush may take several transfers, LVGL gets the buffer back after
+// the last one.
+static std::atomic<uint32_t> trans_queued(0);
+static std::atomic<uint32_t> trans_done(0);
+static std::atomic<uint32_t> flush_last_trans(0);
+static std::atomic<bool>     flush_waiting(false);
+
 static bool example_notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t      panel_io,
                                             esp_lcd_panel_io_event_data_t* edata, void* user_ctx)
 {
     lv_disp_drv_t* disp_driver = (lv_disp_drv_t*) user_ctx;
-    lv_disp_flush_ready(disp_driver);
+    const uint32_t done        = trans_done.fetch_add(1) + 1;
+    if (flush_waiting.load() && done == flush_last_trans.load() && flush_waiting.exchange(false))
+        lv_disp_flush_ready(disp_driver);
     return false;
 }
 
+static uint32_t example_lcd_draw(esp_lcd_panel_handle_t panel_handle, const lv_area_t* area,
+                                 const void* data)
+{
+    const uint32_t seq = trans_queued.fetch_add(1) + 1;
+    // copy a buffer's content to a specific area of the display
+    if (esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1,
+                                  data) != ESP_OK)
+        trans_done.fetch_add(1);
+#if EXAMPLE_USE_AMOLED_POWER && LCD_BIT_PER_PIXEL == 16
+    // Reads the pixels while the DMA sends them
+    amoled_power_flush(area, data);
+#endif
+#if EXAMPLE_USE_POWER_MANAGER
+    power_manager_flush();
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+    input_latency_flush(area);
+#endif
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+    refresh_governor_note_flush(lv_area_get_size(area) * LCD_BIT_PER_PIXEL / 8);
+#endif
+    return seq;
+}
+
+static bool example_lcd_trans_is_done(uint32_t seq)
+{
+    return (int32_t) (trans_done.load() - seq) >= 0;
+}
+
+#if EXAMPLE_USE_SCROLL_BLIT
+static uint32_t example_scroll_blit_draw(const lv_area_t* area, const void* data)
+{
+    return example_lcd_draw(lcd_panel, area, data);
+}
+#endif
+
+// Hands the buffer back to LVGL once transfer `last` is out
+static void example_lvgl_flush_release(lv_disp_drv_t* drv, uint32_t last)
+{
+    flush_last_trans.store(last);
+    flush_waiting.store(true);
+    if (example_lcd_trans_is_done(last) && flush_waiting.exchange(false))
+        lv_disp_flush_ready(drv);
+}
+
 static void example_lvgl_flush_cb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_map)
 {
     esp_lcd_panel_handle_t panel_handle = (esp_lcd_panel_handle_t) drv->user_data;
-    const int              offsetx1     = area->x1;
-    const int              offsetx2     = area->x2;
-    const int              offsety1     = area->y1;
-    const int              offsety2     = area->y2;
+
+#if EXAMPLE_USE_SCROLL_BLIT
+    scroll_blit_store(area, color_map);
+#endif
 
 #if LCD_BIT_PER_PIXEL == 24
     uint8_t* to        = (uint8_t*) color_map;
     uint8_t  temp      = 0;
-    uint16_t pixel_num = (offsetx2 - offsetx1 + 1) * (offsety2 - offsety1 + 1);
+    uint16_t pixel_num = (area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1);
 
     // Special dealing for first pixel
     temp  = color_map[0].ch.blue;
@@ -267,13 +374,34 @@ static void example_lvgl_flush_cb(lv_disp_drv_t* drv, const lv_area_t* area, lv_
     }
 #endif
 
-    // copy a buffer's content to a specific area of the display
-    esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1,
-                              color_map);
+#if EXAMPLE_USE_ROUND_MASK
+    static round_mask_band_t bands[EXAMPLE_LVGL_BUF_HEIGHT / 2];
+    const int                band_num = round_mask_pack_bands(
+        area, (uint8_t*) color_map, LCD_BIT_PER_PIXEL / 8, bands, sizeof(bands) / sizeof(bands[0]));
+
+    uint32_t last = trans_queued.load();
+    for (int i = 0; i < band_num; i++)
+        last = example_lcd_draw(panel_handle, &bands[i].area, bands[i].data);
+    example_lvgl_flush_release(drv, last);
+#else
+    example_lvgl_flush_release(drv, example_lcd_draw(panel_handle, area, color_map));
+#endif
 }
 
 void example_lvgl_rounder_cb(struct _lv_disp_drv_t* disp_drv, lv_area_t* area)
 {
+#if EXAMPLE_USE_REFRESH_GOVERNOR || EXAMPLE_USE_INPUT_LATENCY
+    // LVGL also rounds a probe of column 0 while rendering, to fit the stripes to whole rounded
+    // rows. Only the calls from _lv_inv_area() are invalidations, it refuses them while rendering.
+    const lv_disp_t* disp       = _lv_refr_get_disp_refreshing();
+    const bool       invalidate = !disp || !disp->rendering_in_progress;
+#endif
+#if EXAMPLE_USE_SCROLL_BLIT
+    scroll_blit_rounder(area);
+#endif
+#if EXAMPLE_USE_ROUND_MASK
+    round_mask_clip_area(area);
+#endif
     uint16_t x1 = area->x1;
     uint16_t x2 = area->x2;
 
@@ -286,28 +414,180 @@ void example_lvgl_rounder_cb(struct _lv_disp_drv_t* disp_drv, lv_area_t* area)
     // round the end of coordinate up to the nearest 2N+1 number
     area->x2 = ((x2 >> 1) << 1) + 1;
     area->y2 = ((y2 >> 1) << 1) + 1;
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+    if (invalidate)
+        refresh_governor_note_invalidate(area);
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+    if (invalidate)
+        input_latency_invalidate(area);
+#endif
+}
+
+#if EXAMPLE_USE_ROUND_MASK
+static void example_lvgl_draw_ctx_init(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx)
+{
+#if EXAMPLE_USE_SIMD_DRAW
+    simd_draw_ctx_init(drv, draw_ctx);
+#else
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+#endif
+    round_mask_wrap_blend(draw_ctx);
+}
+#endif
+
+static void example_lvgl_monitor_cb(lv_disp_drv_t* drv, uint32_t time, uint32_t px)
+{
+    boot_first_frame();
+#if EXAMPLE_USE_ROUND_MASK
+    round_mask_frame_done();
+#endif
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+    refresh_governor_frame_done(time, px);
+#endif
+#if EXAMPLE_USE_QUALITY_GOVERNOR
+    quality_governor_frame_done(time, px);
+#endif
+#if EXAMPLE_USE_SCROLL_BLIT
+    scroll_blit_frame_done(time, px);
+#endif
+#if EXAMPLE_USE_AMOLED_POWER
+    amoled_power_frame_done();
+#endif
 }
 
 #if EXAMPLE_USE_TOUCH
+#if EXAMPLE_USE_TOUCH_FILTER
+static touch_filter_t touch_filter;
+#endif
+#if EXAMPLE_USE_GESTURES
+static gesture_recognizer_t gesture;
+static display_gesture_cb_t gesture_cb = NULL;
+
+void display_set_gesture_cb(display_gesture_cb_t cb)
+{
+    gesture_cb = cb;
+}
+
+void display_set_jog_enabled(bool enabled)
+{
+    gesture.jog_enabled = enabled;
+}
+
+// Fed with every new sample, filtered but not extrapolated
+static void example_gesture_feed(const touch_sample_t* sample)
+{
+    static uint32_t seq;
+    if (sample->seq == seq)
+        return;
+    seq = sample->seq;
+
+#if EXAMPLE_USE_TOUCH_FILTER
+    float x = touch_filter.point.x;
+    float y = touch_filter.point.y;
+#else
+    float x = sample->x;
+    float y = sample->y;
+#endif
+    display_rotation_map(touch_transform, x, y, &x, &y);
+    gesture_event_t event;
+    bool            taken = false;
+    if (gesture_feed(&gesture, x, y, sample->pressed, sample->time_us, &event) && gesture_cb)
+        taken = gesture_cb(&event);
+    // Widgets lose the touch, without a click once it ends. A swipe is recognized on the release
+    // LVGL is about to process, it gets PRESS_LOST instead of the click.
+    if (taken || gesture_owns_touch(&gesture))
+        lv_indev_wait_release(lv_indev_get_act());
+}
+#endif
+
+#if EXAMPLE_USE_INPUT_LATENCY
+// Press, lift and every move of the finger start a measurement
+static void example_latency_input(const touch_sample_t* sample)
+{
+    static touch_sample_t last;
+    if (sample->seq == last.seq)
+        return;
+    if (sample->pressed != last.pressed)
+        input_latency_input(sample->pressed ? INPUT_LATENCY_TOUCH_PRESS
+                                            : INPUT_LATENCY_TOUCH_RELEASE,
+                            sample->time_us);
+    else if (sample->pressed && (sample->x != last.x || sample->y != last.y))
+        input_latency_input(INPUT_LATENCY_TOUCH_DRAG, sample->time_us);
+    last = *sample;
+}
+#endif
+
 static void example_lvgl_touch_cb(lv_indev_drv_t* drv, lv_indev_data_t* data)
 {
-    uint16_t tp_x;
-    uint16_t tp_y;
-    uint8_t  win = tpGetCoordinates(&tp_x, &tp_y);
+    touch_sample_t sample;
+#if EXAMPLE_USE_INPUT_LATENCY
+    input_latency_indev_read();
+#endif
+#if EXAMPLE_USE_TOUCH_IRQ
+    touch_sampler_get(&sample);
+#else
+    static uint32_t seq;
+    sample         = {};
+    sample.pressed = tpGetCoordinates(&sample.x, &sample.y);
+    sample.time_us = esp_timer_get_time();
+    sample.seq     = ++seq;
+#if EXAMPLE_USE_POWER_MANAGER
+    // Polled while idle as well, a press wakes the UI
+    if (sample.pressed)
+        power_manager_wake(sample.time_us);
+#endif
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY && EXAMPLE_INPUT_LATENCY_SIM_CYCLES
+    input_latency_sim_touch(esp_timer_get_time(), &sample);
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+    example_latency_input(&sample);
+#endif
+    uint16_t   tp_x = sample.x;
+    uint16_t   tp_y = sample.y;
+    const bool win  = sample.pressed;
+#if EXAMPLE_USE_TOUCH_FILTER
+    // Only touches and their lift go into the trace, not the idle samples in between
+    const bool was_pressed = touch_filter.point.pressed;
+    if (touch_filter_update(&touch_filter, &sample) && (win || was_pressed))
+    {
+        touch_filter_trace_record(&sample);
+#if EXAMPLE_TOUCH_TRACE_DUMP
+        if (!win)
+            touch_filter_trace_dump(NULL);
+#endif
+    }
     if (win)
     {
-#ifdef EXAMPLE_Rotate_90
-        data->point.x = tp_y;
-        data->point.y = (EXAMPLE_LCD_V_RES - tp_x);
-#else
-        data->point.x = tp_x;
-        data->point.y = tp_y;
+        touch_point_t point;
+        touch_filter_get(&touch_filter, esp_timer_get_time(), &point);
+        tp_x = (uint16_t) lroundf(point.x);
+        tp_y = (uint16_t) lroundf(point.y);
+    }
 #endif
-        if (data->point.x > EXAMPLE_LCD_H_RES)
-            data->point.x = EXAMPLE_LCD_H_RES;
-        if (data->point.y > EXAMPLE_LCD_V_RES)
-            data->point.y = EXAMPLE_LCD_V_RES;
+#if EXAMPLE_USE_GESTURES
+    example_gesture_feed(&sample);
+#endif
+    if (win)
+    {
+        float x;
+        float y;
+        display_rotation_map(touch_transform, tp_x, tp_y, &x, &y);
+        data->point.x = LV_CLAMP(0, (lv_coord_t) x, EXAMPLE_LCD_H_RES - 1);
+        data->point.y = LV_CLAMP(0, (lv_coord_t) y, EXAMPLE_LCD_V_RES - 1);
         data->state = LV_INDEV_STATE_PRESSED;
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+        refresh_governor_input();
+#endif
+#if EXAMPLE_USE_BACKLIGHT
+        backlight_input();
+#endif
+#if EXAMPLE_USE_AMOLED_SAVER
+        // The touch that ends the always-on clock goes nowhere
+        if (amoled_saver_input())
+            lv_indev_wait_release(lv_indev_get_act());
+#endif
         //ESP_LOGE("TP","(%d,%d)",data->point.x,data->point.y);
     }
     else
@@ -317,6 +597,64 @@ static void example_lvgl_touch_cb(lv_indev_drv_t* drv, lv_indev_data_t* data)
 }
 #endif
 
+bool display_set_rotation(display_rotation_t rotation, bool save)
+{
+    const uint8_t madctl = display_rotation_madctl(rotation);
+    // Waits for the queued color transfers, they land in the old order
+    if (panel_init_tx(lcd_io, 0x36, &madctl, 1) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set MADCTL 0x%02X", madctl);
+        return false;
+    }
+    lcd_madctl      = madctl;
+    lcd_rotation    = rotation;
+    touch_transform = display_rotation_transform(rotation);
+    // The panel RAM is scanned in the new order, what is on it has to be drawn again
+    lv_obj_invalidate(lv_scr_act());
+    ESP_LOGI(TAG, "Rotated to %d degrees", rotation * 90);
+    if (save)
+        display_rotation_save(rotation);
+    return true;
+}
+
+display_rotation_t display_get_rotation(void)
+{
+    return lcd_rotation;
+}
+
+#if EXAMPLE_USE_ENCODER_INDEV
+static lv_group_t* encoder_group = NULL;
+
+lv_group_t* display_get_encoder_group(void)
+{
+    return encoder_group;
+}
+#endif
+
+bool display_is_control(lv_obj_t* obj)
+{
+    if (!lv_obj_has_flag(obj, LV_OBJ_FLAG_CLICKABLE))
+        return false;
+    if (lv_obj_check_type(obj, &lv_btn_class) || lv_obj_check_type(obj, &lv_arc_class))
+        return true;
+    // The event callbacks themselves are private to LVGL, only their number is not
+    return obj->spec_attr && obj->spec_attr->event_dsc_cnt > 0 &&
+           !lv_obj_has_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+}
+
+#if EXAMPLE_USE_TOUCH && EXAMPLE_USE_HAPTICS
+// Presses on a bare screen, a label or a list background are no button press
+static void example_lvgl_feedback_cb(lv_indev_drv_t* drv, uint8_t code)
+{
+    if (code != LV_EVENT_CLICKED && code != LV_EVENT_LONG_PRESSED)
+        return;
+    lv_obj_t* obj = lv_indev_get_obj_act();
+    if (!obj || !display_is_control(obj))
+        return;
+    haptics_play(code == LV_EVENT_CLICKED ? HAPTICS_CLICK : HAPTICS_LONG_PRESS);
+}
+#endif
+
 static void example_increase_lvgl_tick(void* arg)
 {
     /* Tell LVGL how many milliseconds has elapsed */
@@ -341,12 +679,35 @@ static void example_lvgl_port_task(void* arg)
 {
     ESP_LOGI(TAG, "Starting LVGL task");
     uint32_t task_delay_ms = EXAMPLE_LVGL_TASK_MAX_DELAY_MS;
+#if EXAMPLE_USE_SIMD_DRAW && EXAMPLE_SIMD_DRAW_BENCHMARK
+    // On the render core, so the parallel blend is measured the way it runs
+    if (example_lvgl_lock(-1))
+    {
+        simd_draw_benchmark();
+        example_lvgl_unlock();
+    }
+#endif
+#if EXAMPLE_USE_DMA_COPY && EXAMPLE_DMA_COPY_BENCHMARK
+    dma_copy_benchmark();
+#endif
     while (1)
     {
         // Lock the mutex due to the LVGL APIs are not thread-safe
         if (example_lvgl_lock(-1))
         {
+#if EXAMPLE_USE_POWER_MANAGER
+            power_manager_before_handler();
+#endif
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+            const int64_t handler_start = esp_timer_get_time();
+            task_delay_ms               = lv_timer_handler();
+            refresh_governor_update((uint32_t) (esp_timer_get_time() - handler_start));
+#else
             task_delay_ms = lv_timer_handler();
+#endif
+#if EXAMPLE_USE_POWER_MANAGER
+            power_manager_after_handler();
+#endif
             // Release the mutex
             example_lvgl_unlock();
         }
@@ -358,36 +719,82 @@ static void example_lvgl_port_task(void* arg)
         {
             task_delay_ms = EXAMPLE_LVGL_TASK_MIN_DELAY_MS;
         }
+#if EXAMPLE_USE_POWER_MANAGER
+        // Input while idle cuts the wait short
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(task_delay_ms));
+#else
         vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+#endif
     }
 }
 #ifdef Backlight_Testing
 void example_backlight_test_task(void* arg)
 {
+    static const uint8_t levels[] = {LCD_PWM_MODE_255, LCD_PWM_MODE_200, LCD_PWM_MODE_150,
+                                     LCD_PWM_MODE_100, LCD_PWM_MODE_50,  LCD_PWM_MODE_0};
     for (;;)
     {
-        setUpduty(LCD_PWM_MODE_255);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        setUpduty(LCD_PWM_MODE_200);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        setUpduty(LCD_PWM_MODE_150);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        setUpduty(LCD_PWM_MODE_100);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        setUpduty(LCD_PWM_MODE_50);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        setUpduty(LCD_PWM_MODE_0);
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        for (uint8_t level : levels)
+        {
+#if EXAMPLE_USE_BACKLIGHT
+            backlight_set_level(level);
+#else
+            setUpduty(level);
+#endif
+            vTaskDelay(pdMS_TO_TICKS(1000));
+        }
     }
 }
 #endif
 
+// Reset and init commands, most of it waiting for the panel to sleep out
+static void display_init_panel(void)
+{
+    ESP_ERROR_CHECK(esp_lcd_panel_reset(lcd_panel));
+    const int64_t start = esp_timer_get_time();
+#if EXAMPLE_PANEL_INIT_PLAYER
+    // What the driver's init sends ahead of its table, without the sleep out and its 100 ms
+    const uint8_t colmod = LCD_BIT_PER_PIXEL == 24 ? 0x77 : 0x55;
+    ESP_ERROR_CHECK(panel_init_tx(lcd_io, 0x3A, &colmod, 1));
+    ESP_ERROR_CHECK(panel_init_tx(lcd_io, 0x36, &lcd_madctl, 1));
+    ESP_ERROR_CHECK(panel_init_play(lcd_io, lcd_init_seq, sizeof(lcd_init_seq)));
+#else
+    ESP_ERROR_CHECK(esp_lcd_panel_init(lcd_panel));
+    ESP_ERROR_CHECK(panel_init_tx(lcd_io, 0x36, &lcd_madctl, 1));
+#endif
+    ESP_LOGI(TAG, "Panel init in %" PRId64 " ms by the %s", (esp_timer_get_time() - start) / 1000,
+             EXAMPLE_PANEL_INIT_PLAYER ? "player" : "driver");
+}
+
+// The I2C bus and the devices on it
+static void display_init_io(void)
+{
+    i2c_master_Init(); //I2C_Init
+#if EXAMPLE_USE_TOUCH
+    lcd_touch_init();
+#if EXAMPLE_USE_TOUCH_IRQ
+    touch_sampler_init();
+#endif
+#endif
+#if EXAMPLE_USE_HAPTICS
+    haptics_init();
+#endif
+}
+
+static lv_disp_t*         lvgl_disp       = NULL;
+static esp_timer_handle_t lvgl_tick_timer = NULL;
+
 void display_init(void)
 {
     static lv_disp_draw_buf_t disp_buf; // contains internal graphic buffer(s) called draw buffer(s)
     static lv_disp_drv_t      disp_drv; // contains callback functions
 
+    int stage = boot_stage_begin("panel_io");
+#if EXAMPLE_USE_BACKLIGHT
+    lcd_bl_pwm_bsp_init(LCD_PWM_MODE_0); // Faded in by backlight_init()
+#else
     lcd_bl_pwm_bsp_init(LCD_PWM_MODE_255);
+#endif
 
     ESP_LOGI(TAG, "Initialize SPI bus");
     const spi_bus_config_t buscfg = {
@@ -400,13 +807,29 @@ void display_init(void)
     };
     ESP_ERROR_CHECK(spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
 
+    // The first frame already comes out rotated
+    lcd_rotation    = display_rotation_load();
+    lcd_madctl      = display_rotation_madctl(lcd_rotation);
+    touch_transform = display_rotation_transform(lcd_rotation);
+
     ESP_LOGI(TAG, "Install panel IO");
     esp_lcd_panel_io_handle_t           io_handle = NULL;
     const esp_lcd_panel_io_spi_config_t io_config = SH8601_PANEL_IO_QSPI_CONFIG(
         EXAMPLE_PIN_NUM_LCD_CS, example_notify_lvgl_flush_ready, &disp_drv);
+#if EXAMPLE_PANEL_INIT_PLAYER
+    // esp_lcd_panel_init() is not called, the player sends the sequence
+    const sh8601_lcd_init_cmd_t* lcd_init_cmds = NULL;
+    const size_t                 lcd_init_cnt  = 0;
+#else
+    // At least two bytes per command
+    static sh8601_lcd_init_cmd_t lcd_init_cmds[sizeof(lcd_init_seq) / 2];
+    const size_t                 lcd_init_cnt =
+        panel_init_unpack(lcd_init_seq, sizeof(lcd_init_seq), lcd_init_cmds,
+                          sizeof(lcd_init_cmds) / sizeof(lcd_init_cmds[0]));
+#endif
     sh8601_vendor_config_t vendor_config = {
         .init_cmds      = lcd_init_cmds,
-        .init_cmds_size = sizeof(lcd_init_cmds) / sizeof(lcd_init_cmds[0]),
+        .init_cmds_size = (uint16_t) lcd_init_cnt,
         .flags =
             {
                 .use_qspi_interface = 1,
@@ -425,11 +848,22 @@ void display_init(void)
     };
     ESP_LOGI(TAG, "Install SH8601 panel driver");
     ESP_ERROR_CHECK(esp_lcd_new_panel_sh8601(io_handle, &panel_config, &panel_handle));
-    ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
-    ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
-    i2c_master_Init(); //I2C_Init
+    lcd_panel = panel_handle;
+    lcd_io    = io_handle;
+    boot_stage_end(stage);
+
+    // Neither touches LVGL, which is set up meanwhile. The LVGL task waits for them.
+    boot_spawn("panel", display_init_panel);
+    boot_spawn("i2c", display_init_io);
+
+    stage = boot_stage_begin("lvgl");
 #if EXAMPLE_USE_TOUCH
-    lcd_touch_init();
+#if EXAMPLE_USE_TOUCH_FILTER
+    touch_filter_init(&touch_filter, NULL);
+#endif
+#if EXAMPLE_USE_GESTURES
+    gesture_init(&gesture, false);
+#endif
 #endif
 
     // ESP_LOGI(TAG, "Initialize LVGL library");
@@ -451,15 +885,33 @@ void display_init(void)
     disp_drv.ver_res    = EXAMPLE_LCD_V_RES;
     disp_drv.flush_cb   = example_lvgl_flush_cb;
     disp_drv.rounder_cb = example_lvgl_rounder_cb;
+    disp_drv.monitor_cb = example_lvgl_monitor_cb;
+#if EXAMPLE_USE_PARALLEL_DRAW
+    parallel_draw_init();
+#endif
+#if EXAMPLE_USE_SIMD_DRAW
+    disp_drv.draw_ctx_init   = simd_draw_ctx_init;
+    disp_drv.draw_ctx_deinit = simd_draw_ctx_deinit;
+    disp_drv.draw_ctx_size   = sizeof(simd_draw_ctx_t);
+#endif
+#if EXAMPLE_USE_ROUND_MASK
+    disp_drv.draw_ctx_init = example_lvgl_draw_ctx_init;
+#endif
     disp_drv.draw_buf   = &disp_buf;
     disp_drv.user_data  = panel_handle;
     lv_disp_t* disp     = lv_disp_drv_register(&disp_drv);
+    lvgl_disp           = disp;
+#if EXAMPLE_USE_ROUND_MASK
+    round_mask_stats_t mask_stats;
+    round_mask_get_stats(&mask_stats);
+    ESP_LOGI(TAG, "Round mask: %" PRIu32 " of %d pixels visible", mask_stats.visible_px,
+             EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES);
+#endif
 
     ESP_LOGI(TAG, "Install LVGL tick timer");
     //Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
     const esp_timer_create_args_t lvgl_tick_timer_args = {.callback = &example_increase_lvgl_tick,
                                                           .name     = "lvgl_tick"};
-    esp_timer_handle_t            lvgl_tick_timer      = NULL;
     ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, EXAMPLE_LVGL_TICK_PERIOD_MS * 1000));
 
@@ -469,14 +921,50 @@ void display_init(void)
     indev_drv.type    = LV_INDEV_TYPE_POINTER;
     indev_drv.disp    = disp;
     indev_drv.read_cb = example_lvgl_touch_cb;
+#if EXAMPLE_USE_HAPTICS
+    indev_drv.feedback_cb = example_lvgl_feedback_cb;
+#endif
     lv_indev_drv_register(&indev_drv);
 #endif
+#if EXAMPLE_USE_ENCODER_INDEV
+    encoder_group = encoder_input_init(disp);
+#endif
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+    refresh_governor_init(disp);
+#endif
+#if EXAMPLE_USE_DMA_COPY
+    dma_copy_init();
+#endif
+#if EXAMPLE_USE_SCROLL_BLIT
+    scroll_blit_init(example_scroll_blit_draw, example_lcd_trans_is_done);
+#endif
+#if EXAMPLE_USE_AMOLED_POWER
+    amoled_power_init();
+#endif
+    boot_stage_end(stage);
+}
+
+void display_start(void)
+{
+    boot_join();
 
     lvgl_mux = xSemaphoreCreateMutex();
     assert(lvgl_mux);
-    xTaskCreate(example_lvgl_port_task, "LVGL", EXAMPLE_LVGL_TASK_STACK_SIZE, NULL,
-                EXAMPLE_LVGL_TASK_PRIORITY, NULL);
+    TaskHandle_t lvgl_task = NULL;
+    xTaskCreatePinnedToCore(example_lvgl_port_task, "LVGL", EXAMPLE_LVGL_TASK_STACK_SIZE, NULL,
+                            EXAMPLE_LVGL_TASK_PRIORITY, &lvgl_task, EXAMPLE_LVGL_TASK_CORE);
+#if EXAMPLE_USE_POWER_MANAGER
+    // The LVGL task runs already and calls into the power manager between handler runs
+    if (example_lvgl_lock(-1))
+    {
+        power_manager_init(lvgl_disp, lvgl_tick_timer, lvgl_task);
+        example_lvgl_unlock();
+    }
+#endif
+#if EXAMPLE_USE_BACKLIGHT
+    backlight_init();
+#endif
 #ifdef Backlight_Testing
-    xTaskCreate(example_backlight_test_task, "backlight", 3 * 1024, NULL, 2, NULL);
+    xTaskCreate(example_backlight_test_task, "bl_test", 3 * 1024, NULL, 2, NULL);
 #endif
 }
\ No newline at end of file
@@ -1,6 +1,44 @@
 #ifndef DISPLAY_INIT_H
 #define DISPLAY_INIT_H
 
+#include "user_config.h"
+#include "display_rotation.h"
+#if EXAMPLE_USE_TOUCH && EXAMPLE_USE_GESTURES
+#include "gesture.h"
+
+// Runs in the LVGL task with the LVGL lock held. Returns true when the gesture was acted on, the
+// widgets under the finger then lose the touch and don't get a click when it ends.
+typedef bool (*display_gesture_cb_t)(const gesture_event_t* event);
+#endif
+
+#include "lvgl.h"
+
+// Sets up LVGL while the panel and the I2C devices come up on boot tasks. Nothing runs LVGL
+// yet, the application builds its screens without taking the lock.
 void display_init(void);
 
+// Waits for the panel and the I2C devices, then starts the LVGL task and the backlight
+void display_start(void);
+
+// Rotates the panel through MADCTL and remaps the touch points, with the LVGL lock held. The
+// rotation is kept in NVS with `save` and comes back at the next boot.
+bool display_set_rotation(display_rotation_t rotation, bool save);
+display_rotation_t display_get_rotation(void);
+
+#if EXAMPLE_USE_TOUCH && EXAMPLE_USE_GESTURES
+void display_set_gesture_cb(display_gesture_cb_t cb);
+
+// Jogs along the bezel take the touch away from the widgets, enable them only where wanted
+void display_set_jog_enabled(bool enabled);
+#endif
+
+// Buttons, arcs, and panels with an event handler such as list rows: what a press acts on.
+// Scrollable containers are clickable and carry handlers too, they are not controls.
+bool display_is_control(lv_obj_t* obj);
+
+#if EXAMPLE_USE_ENCODER_INDEV
+// Group navigated by the knob, empty until the application adds the objects of a screen
+lv_group_t* display_get_encoder_group(void);
+#endif
+
 #endif
\ No newline at end of file
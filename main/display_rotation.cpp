@@ -0,0 +1,74 @@
+// Panel rotation in the SH8601 itself. MADCTL sets the order the panel scans its RAM in, so LVGL
+// renders and flushes exactly as it does unrotated and only the touch points need a remap, a
+// fixed integer transform per rotation. The panel is square, the resolution stays the same.
+
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "display_rotation.h"
+#include "user_config.h"
+
+static const char* TAG = "display_rotation";
+
+#define DISPLAY_ROTATION_NVS_NAMESPACE "display"
+#define DISPLAY_ROTATION_NVS_KEY       "rotation"
+
+// MADCTL bits
+#define DISPLAY_ROTATION_MY 0x80 // Row order
+#define DISPLAY_ROTATION_MX 0x40 // Column order
+#define DISPLAY_ROTATION_MV 0x20 // Row/column exchange
+
+static const uint8_t s_madctl[DISPLAY_ROTATIONS] = {
+    0x00,
+    DISPLAY_ROTATION_MX | DISPLAY_ROTATION_MV,
+    DISPLAY_ROTATION_MX | DISPLAY_ROTATION_MY,
+    DISPLAY_ROTATION_MY | DISPLAY_ROTATION_MV,
+};
+
+// Clockwise, matching s_madctl
+static const display_rotation_transform_t s_transforms[DISPLAY_ROTATIONS] = {
+    {1, 0, 0, 1, 0, 0},
+    {0, 1, -1, 0, 0, EXAMPLE_LCD_H_RES - 1},
+    {-1, 0, 0, -1, EXAMPLE_LCD_H_RES - 1, EXAMPLE_LCD_V_RES - 1},
+    {0, -1, 1, 0, EXAMPLE_LCD_V_RES - 1, 0},
+};
+
+uint8_t display_rotation_madctl(display_rotation_t rotation)
+{
+    return s_madctl[rotation];
+}
+
+const display_rotation_transform_t* display_rotation_transform(display_rotation_t rotation)
+{
+    return &s_transforms[rotation];
+}
+
+display_rotation_t display_rotation_load(void)
+{
+    display_rotation_t rotation = (display_rotation_t) (EXAMPLE_ROTATION_DEFAULT / 90 % 4);
+    nvs_handle_t       nvs;
+    // Not found until the first save
+    if (nvs_open(DISPLAY_ROTATION_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK)
+        return rotation;
+    uint8_t value = 0;
+    if (nvs_get_u8(nvs, DISPLAY_ROTATION_NVS_KEY, &value) == ESP_OK && value < DISPLAY_ROTATIONS)
+        rotation = (display_rotation_t) value;
+    nvs_close(nvs);
+    return rotation;
+}
+
+esp_err_t display_rotation_save(display_rotation_t rotation)
+{
+    nvs_handle_t nvs;
+    esp_err_t    err = nvs_open(DISPLAY_ROTATION_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_u8(nvs, DISPLAY_ROTATION_NVS_KEY, (uint8_t) rotation);
+        if (err == ESP_OK)
+            err = nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "Rotation not saved (%s)", esp_err_to_name(err));
+    return err;
+}
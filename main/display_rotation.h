@@ -0,0 +1,44 @@
+#ifndef DISPLAY_ROTATION_H
+#define DISPLAY_ROTATION_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    DISPLAY_ROTATION_0 = 0,
+    DISPLAY_ROTATION_90,
+    DISPLAY_ROTATION_180,
+    DISPLAY_ROTATION_270,
+    DISPLAY_ROTATIONS,
+} display_rotation_t;
+
+// Panel coordinates of the touch controller to LVGL coordinates:
+// x' = xx * x + xy * y + x0, y' = yx * x + yy * y + y0
+typedef struct
+{
+    int8_t  xx;
+    int8_t  xy;
+    int8_t  yx;
+    int8_t  yy;
+    int16_t x0;
+    int16_t y0;
+} display_rotation_transform_t;
+
+// MADCTL (0x36) value that scans the panel RAM in the given rotation
+uint8_t display_rotation_madctl(display_rotation_t rotation);
+
+const display_rotation_transform_t* display_rotation_transform(display_rotation_t rotation);
+
+static inline void display_rotation_map(const display_rotation_transform_t* t, float x, float y,
+                                        float* out_x, float* out_y)
+{
+    *out_x = t->xx * x + t->xy * y + t->x0;
+    *out_y = t->yx * x + t->yy * y + t->y0;
+}
+
+// The rotation saved in NVS, EXAMPLE_ROTATION_DEFAULT without one. Needs nvs_flash_init().
+display_rotation_t display_rotation_load(void);
+esp_err_t display_rotation_save(display_rotation_t rotation);
+
+#endif
@@ -0,0 +1,256 @@
+// Background copies on the general purpose DMA (GDMA) through esp_async_memcpy. A copy is queued
+// as one transaction per row. Transactions complete in the order they were queued, so the
+// callback of the last row means the whole copy is done.
+//
+// The DMA only writes to internal RAM. A PSRAM destination would need cache line aligned rows
+// and a cache invalidation afterwards, those copies stay on the CPU. PSRAM sources are fine once
+// the cache has been written back.
+
+#include <string.h>
+#include <inttypes.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_async_memcpy.h"
+#include "esp_cache.h"
+#include "esp_memory_utils.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "dma_copy.h"
+#include "user_config.h"
+
+static const char* TAG = "dma_copy";
+
+#define DMA_COPY_BACKLOG    64 // Rows in flight
+#define DMA_COPY_MAX_JOBS   8
+#define DMA_COPY_ALIGN      4  // Addresses, strides and row sizes
+#define DMA_BENCH_BYTES     (64 * 1024)
+#define DMA_BENCH_ROW_BYTES 4096
+
+typedef struct
+{
+    std::atomic<uint32_t> rows_left;
+    dma_copy_done_cb      done;
+    void*                 arg;
+    int64_t               start_us;
+} dma_copy_job_t;
+
+static async_memcpy_handle_t s_mcp  = NULL;
+static SemaphoreHandle_t     s_lock = NULL;
+static std::atomic<uint32_t> s_inflight(0);
+static dma_copy_job_t        s_jobs[DMA_COPY_MAX_JOBS];
+static uint32_t              s_next_job;
+static dma_copy_stats_t      s_stats;
+
+static bool IRAM_ATTR dma_copy_row_done(async_memcpy_handle_t mcp, async_memcpy_event_t* event,
+                                        void* args)
+{
+    dma_copy_job_t* job = (dma_copy_job_t*) args;
+    // The slot can be reused as soon as the last row is counted
+    const dma_copy_done_cb done  = job->done;
+    void* const            arg   = job->arg;
+    const int64_t          start = job->start_us;
+
+    s_inflight.fetch_sub(1);
+    if (job->rows_left.fetch_sub(1) != 1)
+        return false;
+    s_stats.dma_us += esp_timer_get_time() - start;
+    return done ? done(arg) : false;
+}
+
+bool dma_copy_init(void)
+{
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog               = DMA_COPY_BACKLOG;
+
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock || esp_async_memcpy_install(&config, &s_mcp) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "GDMA not available, copies stay on the CPU");
+        s_mcp = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void dma_copy_cpu(uint8_t* dst, size_t dst_stride, const uint8_t* src, size_t src_stride,
+                         size_t row_bytes, size_t rows)
+{
+    const int64_t start = esp_timer_get_time();
+    for (size_t r = 0; r < rows; r++)
+        memcpy(dst + r * dst_stride, src + r * src_stride, row_bytes);
+    s_stats.cpu_jobs++;
+    s_stats.cpu_bytes += row_bytes * rows;
+    s_stats.cpu_us += esp_timer_get_time() - start;
+}
+
+bool dma_copy_2d(void* dst, size_t dst_stride, const void* src, size_t src_stride,
+                 size_t row_bytes, size_t rows, dma_copy_done_cb done, void* arg)
+{
+    uint8_t*        d     = (uint8_t*) dst;
+    const uint8_t*  s     = (const uint8_t*) src;
+    const uintptr_t align = (uintptr_t) d | (uintptr_t) s | dst_stride | src_stride | row_bytes;
+
+    // Flash (e.g. images in rodata) is out of reach for the DMA
+    if (!s_mcp || row_bytes * rows < EXAMPLE_DMA_COPY_MIN_BYTES || rows > DMA_COPY_BACKLOG ||
+        (align & (DMA_COPY_ALIGN - 1)) || !esp_ptr_dma_capable(d) ||
+        !(esp_ptr_dma_capable(s) || esp_ptr_external_ram(s)))
+    {
+        dma_copy_cpu(d, dst_stride, s, src_stride, row_bytes, rows);
+        return false;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    dma_copy_job_t* job = &s_jobs[s_next_job];
+    if (job->rows_left.load() != 0 || s_inflight.load() + rows > DMA_COPY_BACKLOG)
+    {
+        xSemaphoreGive(s_lock);
+        dma_copy_cpu(d, dst_stride, s, src_stride, row_bytes, rows);
+        return false;
+    }
+    s_next_job = (s_next_job + 1) % DMA_COPY_MAX_JOBS;
+
+    const int64_t start = esp_timer_get_time();
+    // Rows the CPU wrote may still sit in the cache
+    if (esp_ptr_external_ram(s))
+        esp_cache_msync((void*) s, src_stride * (rows - 1) + row_bytes,
+                        ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+
+    job->done      = done;
+    job->arg       = arg;
+    job->start_us  = start;
+    job->rows_left = rows;
+    s_inflight += rows;
+    for (size_t r = 0; r < rows; r++)
+    {
+        esp_err_t err;
+        // A transaction node may still be on its way back from the completion ISR
+        while ((err = esp_async_memcpy(s_mcp, d + r * dst_stride, (void*) (s + r * src_stride),
+                                       row_bytes, dma_copy_row_done, job)) ==
+               ESP_ERR_INVALID_STATE)
+            taskYIELD();
+        if (err == ESP_OK)
+            continue;
+
+        // The driver has its own alignment rules for PSRAM, rows share one alignment so usually
+        // the first row is refused. The CPU copies the rows that were not queued.
+        const size_t left = rows - r;
+        s_inflight -= left;
+        dma_copy_cpu(d + r * dst_stride, dst_stride, s + r * src_stride, src_stride, row_bytes,
+                     left);
+        if (r == 0)
+        {
+            job->rows_left = 0;
+            xSemaphoreGive(s_lock);
+            return false;
+        }
+        ESP_LOGW(TAG, "DMA refused row %u of %u: %s", (unsigned) r, (unsigned) rows,
+                 esp_err_to_name(err));
+        s_stats.dma_jobs++;
+        s_stats.dma_bytes += row_bytes * r;
+        s_stats.submit_us += esp_timer_get_time() - start;
+        xSemaphoreGive(s_lock);
+        // The queued rows may all be written already, their callback then did not end the job
+        if (job->rows_left.fetch_sub(left) == left)
+        {
+            s_stats.dma_us += esp_timer_get_time() - start;
+            if (done)
+                done(arg);
+        }
+        return true;
+    }
+
+    s_stats.dma_jobs++;
+    s_stats.dma_bytes += row_bytes * rows;
+    s_stats.submit_us += esp_timer_get_time() - start;
+    xSemaphoreGive(s_lock);
+    return true;
+}
+
+void dma_copy_get_stats(dma_copy_stats_t* stats)
+{
+    *stats = s_stats;
+}
+
+void dma_copy_report(void)
+{
+    dma_copy_stats_t stats;
+    dma_copy_get_stats(&stats);
+
+    ESP_LOGI(TAG, "DMA %" PRIu32 " copies, %" PRIu64 " KB, %" PRIu64 " MB/s, queueing %" PRIu64
+                  " us",
+             stats.dma_jobs, stats.dma_bytes / 1024,
+             stats.dma_us ? stats.dma_bytes / stats.dma_us : 0, stats.submit_us);
+    ESP_LOGI(TAG, "CPU %" PRIu32 " copies, %" PRIu64 " KB, %" PRIu64 " MB/s", stats.cpu_jobs,
+             stats.cpu_bytes / 1024, stats.cpu_us ? stats.cpu_bytes / stats.cpu_us : 0);
+    // What the DMA copies would have cost at the CPU's own rate
+    if (stats.cpu_bytes)
+    {
+        const uint64_t cpu_equiv_us = stats.dma_bytes * stats.cpu_us / stats.cpu_bytes;
+        ESP_LOGI(TAG, "CPU time saved ~%" PRIu64 " us",
+                 cpu_equiv_us > stats.submit_us ? cpu_equiv_us - stats.submit_us : 0);
+    }
+}
+
+static bool IRAM_ATTR dma_bench_done(void* arg)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t) arg, &woken);
+    return woken == pdTRUE;
+}
+
+void dma_copy_benchmark(void)
+{
+    uint8_t*          psram = (uint8_t*) heap_caps_malloc(DMA_BENCH_BYTES, MALLOC_CAP_SPIRAM);
+    uint8_t*          sram  = (uint8_t*) heap_caps_malloc(DMA_BENCH_BYTES, MALLOC_CAP_DMA);
+    uint8_t*          dst   = (uint8_t*) heap_caps_malloc(DMA_BENCH_BYTES, MALLOC_CAP_DMA);
+    SemaphoreHandle_t sem   = xSemaphoreCreateBinary();
+    if (!psram || !sram || !dst || !sem)
+    {
+        ESP_LOGW(TAG, "No memory for the benchmark");
+        goto out;
+    }
+    for (int i = 0; i < DMA_BENCH_BYTES; i++)
+    {
+        psram[i] = i * 7;
+        sram[i]  = i * 13;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        const uint8_t* src  = i == 0 ? psram : sram;
+        const char*    name = i == 0 ? "PSRAM" : "SRAM";
+
+        int64_t start = esp_timer_get_time();
+        memcpy(dst, src, DMA_BENCH_BYTES);
+        const int64_t cpu_us = esp_timer_get_time() - start;
+
+        memset(dst, 0, DMA_BENCH_BYTES);
+        start = esp_timer_get_time();
+        const bool queued =
+            dma_copy_2d(dst, DMA_BENCH_ROW_BYTES, src, DMA_BENCH_ROW_BYTES, DMA_BENCH_ROW_BYTES,
+                        DMA_BENCH_BYTES / DMA_BENCH_ROW_BYTES, dma_bench_done, sem);
+        const int64_t busy_us = esp_timer_get_time() - start;
+        if (queued)
+            xSemaphoreTake(sem, portMAX_DELAY);
+        const int64_t dma_us = esp_timer_get_time() - start;
+
+        ESP_LOGI(TAG,
+                 "%-5s -> SRAM %d KB: CPU %" PRId64 " us, DMA %" PRId64 " us (CPU busy %" PRId64
+                 " us)%s%s",
+                 name, DMA_BENCH_BYTES / 1024, cpu_us, dma_us, busy_us,
+                 queued ? "" : ", fell back to the CPU",
+                 memcmp(dst, src, DMA_BENCH_BYTES) ? ", MISMATCH" : "");
+    }
+
+out:
+    heap_caps_free(psram);
+    heap_caps_free(sram);
+    heap_caps_free(dst);
+    if (sem)
+        vSemaphoreDelete(sem);
+}
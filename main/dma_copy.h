@@ -0,0 +1,46 @@
+#ifndef DMA_COPY_H
+#define DMA_COPY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Called in ISR context once a DMA copy finished. Returns whether a higher priority task was
+// woken, like the esp_lcd and esp_async_memcpy callbacks.
+typedef bool (*dma_copy_done_cb)(void* arg);
+
+typedef struct
+{
+    uint32_t dma_jobs;
+    uint64_t dma_bytes;
+    uint64_t dma_us;    // Queueing to completion, summed over the DMA jobs
+    uint64_t submit_us; // CPU time spent queueing them
+    uint32_t cpu_jobs;  // Small, unaligned or PSRAM bound copies done by the CPU
+    uint64_t cpu_bytes;
+    uint64_t cpu_us;
+} dma_copy_stats_t;
+
+bool dma_copy_init(void);
+
+// Copies `rows` rows of `row_bytes` each. Returns true when the copy was queued on the DMA,
+// `done` then runs once all rows are written, usually from the completion ISR. When the DMA
+// refuses a later row the CPU copies the rest, and `done` may run in the caller before
+// dma_copy_2d() returns. Returns false when the CPU already did the copy, `done` is not called.
+// A src_stride of 0 copies the same source row over and over.
+bool dma_copy_2d(void* dst, size_t dst_stride, const void* src, size_t src_stride,
+                 size_t row_bytes, size_t rows, dma_copy_done_cb done, void* arg);
+
+static inline bool dma_copy(void* dst, const void* src, size_t n, dma_copy_done_cb done,
+                            void* arg)
+{
+    return dma_copy_2d(dst, n, src, n, n, 1, done, arg);
+}
+
+void dma_copy_get_stats(dma_copy_stats_t* stats);
+
+// Logs throughput of both paths and the CPU time the DMA saved
+void dma_copy_report(void);
+
+// Copies PSRAM to internal RAM and internal to internal RAM with the CPU and the DMA
+void dma_copy_benchmark(void);
+
+#endif
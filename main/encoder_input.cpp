@@ -0,0 +1,132 @@
+// The knob as an LVGL encoder. The knob callbacks only add to a signed delta, which the read
+// callback takes whole, so detents arriving between two reads all reach LVGL instead of
+// collapsing into one event bit. Turning faster multiplies the steps per detent, so a long list
+// or a full arc sweep takes a flick of the wrist, while slow turns still move one step at a time.
+
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "encoder_input.h"
+#include "user_encoder_bsp.h"
+#include "user_config.h"
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+#include "refresh_governor.h"
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+#include "input_latency.h"
+#endif
+#if EXAMPLE_USE_HAPTICS
+#include "haptics.h"
+#endif
+#if EXAMPLE_USE_BACKLIGHT
+#include "backlight.h"
+#endif
+#if EXAMPLE_USE_AMOLED_SAVER
+#include "amoled_saver.h"
+#endif
+
+static const char* TAG = "encoder_input";
+
+static const encoder_accel_config_t s_config = {
+    .min_rate = EXAMPLE_ENCODER_ACCEL_MIN_RATE,
+    .max_rate = EXAMPLE_ENCODER_ACCEL_MAX_RATE,
+    .max_gain = EXAMPLE_ENCODER_ACCEL_MAX_GAIN,
+};
+
+static encoder_input_stats_t s_stats;
+static int64_t               s_prev_us; // Latest detent of the previous read, 0 after a reversal
+static int32_t               s_dir;
+static float                 s_carry; // Fraction of a step left over by the gain
+
+float encoder_input_gain(const encoder_accel_config_t* config, float rate)
+{
+    if (config->max_rate <= config->min_rate)
+        return 1.0f;
+    // Quadratic, so a brisk turn gains a little and only a spin gains a lot
+    const float t = LV_CLAMP(0.0f, (rate - config->min_rate) / (config->max_rate - config->min_rate),
+                             1.0f);
+    return 1.0f + (config->max_gain - 1.0f) * t * t;
+}
+
+static void encoder_input_read_cb(lv_indev_drv_t* drv, lv_indev_data_t* data)
+{
+    user_encoder_delta_t delta;
+#if EXAMPLE_USE_INPUT_LATENCY
+    input_latency_indev_read();
+#endif
+    user_encoder_take(&delta);
+#if EXAMPLE_USE_INPUT_LATENCY && EXAMPLE_INPUT_LATENCY_SIM_CYCLES
+    input_latency_sim_encoder(esp_timer_get_time(), &delta.steps, &delta.last_us);
+#endif
+    s_stats.reads++;
+    data->state = LV_INDEV_STATE_RELEASED; // The knob has no push button
+    if (delta.steps == 0)
+        return;
+
+    const int32_t dir = delta.steps > 0 ? 1 : -1;
+    if (dir != s_dir)
+    {
+        s_stats.reversals += s_dir != 0;
+        s_dir             = dir;
+        s_prev_us         = 0;
+        s_carry           = 0;
+    }
+
+    // Mean rate of the detents taken now, timed from the last one taken before
+    const uint32_t detents = abs(delta.steps);
+    float          rate    = 0;
+    if (s_prev_us)
+        rate = detents * 1e6f / LV_MAX(delta.last_us - s_prev_us, 1);
+    s_prev_us = delta.last_us;
+
+    const float   gain  = encoder_input_gain(&s_config, rate);
+    const float   steps = detents * gain + s_carry;
+    const int32_t whole = LV_MIN((int32_t) steps, INT16_MAX);
+    s_carry             = steps - whole;
+
+    data->enc_diff = (int16_t) (dir * whole);
+#if EXAMPLE_USE_INPUT_LATENCY
+    input_latency_input(INPUT_LATENCY_ENCODER, delta.last_us);
+#endif
+    s_stats.detents += detents;
+    s_stats.steps += whole;
+    s_stats.peak_gain = LV_MAX(s_stats.peak_gain, gain);
+#if EXAMPLE_USE_HAPTICS
+    // One tick per read, the haptics task merges a burst further
+    haptics_play(HAPTICS_DETENT);
+#endif
+#if EXAMPLE_USE_REFRESH_GOVERNOR
+    refresh_governor_input();
+#endif
+#if EXAMPLE_USE_BACKLIGHT
+    backlight_input();
+#endif
+#if EXAMPLE_USE_AMOLED_SAVER
+    // The turn that ends the always-on clock moves nothing
+    if (amoled_saver_input())
+        data->enc_diff = 0;
+#endif
+}
+
+lv_group_t* encoder_input_init(lv_disp_t* disp)
+{
+    static lv_indev_drv_t indev_drv;
+    lv_group_t*           group = lv_group_create();
+    // Fast turns stop at the end of a list rather than jumping back to its start
+    lv_group_set_wrap(group, false);
+
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type    = LV_INDEV_TYPE_ENCODER;
+    indev_drv.disp    = disp;
+    indev_drv.read_cb = encoder_input_read_cb;
+    lv_indev_set_group(lv_indev_drv_register(&indev_drv), group);
+    ESP_LOGI(TAG, "Encoder indev, gain 1 up to %.0f detents/s, %.0f at %.0f detents/s",
+             s_config.min_rate, s_config.max_gain, s_config.max_rate);
+    return group;
+}
+
+void encoder_input_get_stats(encoder_input_stats_t* stats)
+{
+    *stats = s_stats;
+}
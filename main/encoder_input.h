@@ -0,0 +1,32 @@
+#ifndef ENCODER_INPUT_H
+#define ENCODER_INPUT_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+typedef struct
+{
+    float min_rate; // Detents/s up to which every detent is one step
+    float max_rate; // Detents/s at which the gain peaks
+    float max_gain; // Steps per detent at full speed, 1 for no acceleration
+} encoder_accel_config_t;
+
+typedef struct
+{
+    uint32_t reads;     // LVGL reads
+    uint32_t detents;   // Detents taken from the knob, both directions
+    uint32_t steps;     // Steps handed to LVGL after acceleration
+    uint32_t reversals; // Direction changes, each drops the gain back to 1
+    float    peak_gain;
+} encoder_input_stats_t;
+
+// Registers the knob as an LV_INDEV_TYPE_ENCODER on `disp`, navigating the returned group.
+// user_encoder_init() must have been called. Must be called with the LVGL lock held.
+lv_group_t* encoder_input_init(lv_disp_t* disp);
+
+// Steps per detent for a knob turned at `rate` detents/s
+float encoder_input_gain(const encoder_accel_config_t* config, float rate);
+
+void encoder_input_get_stats(encoder_input_stats_t* stats);
+
+#endif
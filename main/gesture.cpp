@@ -0,0 +1,129 @@
+// Gestures on the round touchscreen, recognized on top of what LVGL does with the same touch.
+// A swipe is decided on release, so it never competes with scrolling or a press. A jog has to
+// start in the ring along the bezel and travel EXAMPLE_GESTURE_JOG_START_DEG around the center
+// before it locks in, after which the angle is reported with every point.
+
+#include <math.h>
+
+#include "gesture.h"
+#include "user_config.h"
+
+#define GESTURE_CENTER_X ((EXAMPLE_LCD_H_RES - 1) / 2.0f)
+#define GESTURE_CENTER_Y ((EXAMPLE_LCD_V_RES - 1) / 2.0f)
+#define GESTURE_RADIUS   (EXAMPLE_LCD_H_RES / 2.0f)
+
+static inline float gesture_angle(float x, float y)
+{
+    return atan2f(y - GESTURE_CENTER_Y, x - GESTURE_CENTER_X) * (180.0f / (float) M_PI);
+}
+
+static inline bool gesture_in_ring(float x, float y)
+{
+    const float dx = x - GESTURE_CENTER_X;
+    const float dy = y - GESTURE_CENTER_Y;
+    const float r  = GESTURE_RADIUS - EXAMPLE_GESTURE_JOG_RING_PX;
+    return dx * dx + dy * dy >= r * r;
+}
+
+// Screen y grows downwards, so an increasing angle is clockwise
+static inline float gesture_angle_delta(float from, float to)
+{
+    float d = to - from;
+    if (d > 180.0f)
+        d -= 360.0f;
+    else if (d < -180.0f)
+        d += 360.0f;
+    return d;
+}
+
+void gesture_init(gesture_recognizer_t* g, bool jog_enabled)
+{
+    *g             = {};
+    g->jog_enabled = jog_enabled;
+}
+
+static gesture_type_t gesture_swipe(const gesture_recognizer_t* g, float x, float y,
+                                    int64_t time_us)
+{
+    const float dx = x - g->x0;
+    const float dy = y - g->y0;
+    if (time_us - g->t0_us > EXAMPLE_GESTURE_SWIPE_MAX_MS * 1000LL)
+        return GESTURE_NONE;
+    // Mostly along one axis, diagonal strokes are nothing
+    if (fabsf(dx) >= EXAMPLE_GESTURE_SWIPE_MIN_PX && fabsf(dx) >= 2 * fabsf(dy))
+        return dx > 0 ? GESTURE_SWIPE_RIGHT : GESTURE_SWIPE_LEFT;
+    if (fabsf(dy) >= EXAMPLE_GESTURE_SWIPE_MIN_PX && fabsf(dy) >= 2 * fabsf(dx))
+        return dy > 0 ? GESTURE_SWIPE_DOWN : GESTURE_SWIPE_UP;
+    return GESTURE_NONE;
+}
+
+bool gesture_feed(gesture_recognizer_t* g, float x, float y, bool pressed, int64_t time_us,
+                  gesture_event_t* event)
+{
+    event->type    = GESTURE_NONE;
+    event->jog_deg = 0;
+    event->x       = (int16_t) g->x0;
+    event->y       = (int16_t) g->y0;
+
+    if (!pressed)
+    {
+        // The last point before the lift was fed while pressed, the release carries the same
+        if (g->state == GESTURE_STATE_DOWN || g->state == GESTURE_STATE_MOVED)
+            event->type = gesture_swipe(g, x, y, time_us);
+        g->state = GESTURE_STATE_IDLE;
+        return event->type != GESTURE_NONE;
+    }
+
+    const float angle = gesture_angle(x, y);
+    if (g->state == GESTURE_STATE_IDLE)
+    {
+        g->state   = GESTURE_STATE_DOWN;
+        g->x0      = x;
+        g->y0      = y;
+        g->t0_us   = time_us;
+        g->angle   = angle;
+        g->jog_deg = 0;
+        g->in_ring = gesture_in_ring(x, y);
+        return false;
+    }
+
+    const float delta = gesture_angle_delta(g->angle, angle);
+    g->angle          = angle;
+    if (g->state == GESTURE_STATE_JOG)
+    {
+        event->type    = GESTURE_JOG;
+        event->jog_deg = delta;
+        return delta != 0;
+    }
+    if (g->state == GESTURE_STATE_LONG)
+        return false;
+
+    if (g->in_ring && !gesture_in_ring(x, y))
+        g->in_ring = false;
+    if (g->in_ring && g->jog_enabled)
+    {
+        g->jog_deg += delta;
+        if (fabsf(g->jog_deg) >= EXAMPLE_GESTURE_JOG_START_DEG)
+        {
+            g->state       = GESTURE_STATE_JOG;
+            event->type    = GESTURE_JOG;
+            event->jog_deg = g->jog_deg;
+            return true;
+        }
+    }
+
+    const float dx = x - g->x0;
+    const float dy = y - g->y0;
+    if (dx * dx + dy * dy > EXAMPLE_GESTURE_SLOP_PX * EXAMPLE_GESTURE_SLOP_PX)
+    {
+        g->state = GESTURE_STATE_MOVED;
+    }
+    else if (g->state == GESTURE_STATE_DOWN &&
+             time_us - g->t0_us >= EXAMPLE_GESTURE_LONG_PRESS_MS * 1000LL)
+    {
+        g->state    = GESTURE_STATE_LONG;
+        event->type = GESTURE_LONG_PRESS;
+        return true;
+    }
+    return false;
+}
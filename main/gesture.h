@@ -0,0 +1,60 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+
+typedef enum
+{
+    GESTURE_NONE = 0,
+    GESTURE_SWIPE_LEFT, // Finger moved right to left
+    GESTURE_SWIPE_RIGHT,
+    GESTURE_SWIPE_UP,
+    GESTURE_SWIPE_DOWN,
+    GESTURE_LONG_PRESS,
+    GESTURE_JOG, // Circular motion along the bezel, reported continuously
+} gesture_type_t;
+
+typedef struct
+{
+    gesture_type_t type;
+    float          jog_deg; // GESTURE_JOG: angle since the last report, clockwise positive
+    int16_t        x;       // Where the touch started
+    int16_t        y;
+} gesture_event_t;
+
+typedef enum
+{
+    GESTURE_STATE_IDLE = 0,
+    GESTURE_STATE_DOWN,  // Pressed, nothing decided yet
+    GESTURE_STATE_MOVED, // Left the slop, a swipe if it is quick and straight enough
+    GESTURE_STATE_LONG,  // Long press reported, the rest of the touch is ignored
+    GESTURE_STATE_JOG,
+} gesture_state_t;
+
+// Incremental, allocation-free recognizer fed one touch point at a time
+typedef struct
+{
+    gesture_state_t state;
+    float           x0; // Touch down
+    float           y0;
+    int64_t         t0_us;
+    float           angle;       // Around the screen center, degrees, of the previous point
+    float           jog_deg;     // Travelled along the bezel before the jog locks in
+    bool            in_ring;     // Never left the bezel ring since touch down
+    bool            jog_enabled; // Off where lists near the bezel would be taken for a jog
+} gesture_recognizer_t;
+
+void gesture_init(gesture_recognizer_t* g, bool jog_enabled);
+
+// Feeds the next point of the touch, or its release. Returns true with `event` filled when a
+// gesture was recognized.
+bool gesture_feed(gesture_recognizer_t* g, float x, float y, bool pressed, int64_t time_us,
+                  gesture_event_t* event);
+
+// Whether the current touch belongs to a gesture that widgets should no longer see
+static inline bool gesture_owns_touch(const gesture_recognizer_t* g)
+{
+    return g->state == GESTURE_STATE_JOG;
+}
+
+#endif
@@ -0,0 +1,168 @@
+// Haptic feedback through the DRV2605 on the touch I2C bus. Callers only queue an effect, a low
+// priority task loads up to eight of them into the waveform sequencer of the chip and starts it
+// with the GO bit. Detents that arrive while an effect plays are merged, so a fast spin of the
+// knob gives a steady buzz of ticks instead of a backlog that lasts after the knob stopped.
+//
+// The touch controller shares the bus. A sequence costs two short writes, and while it plays the
+// GO bit is read back only every EXAMPLE_HAPTICS_POLL_MS, so touch reads rarely wait on it.
+
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "haptics.h"
+#include "i2c_bsp.h"
+#include "user_config.h"
+
+static const char* TAG = "haptics";
+
+#define HAPTICS_STACK_SIZE (3 * 1024)
+#define HAPTICS_QUEUE_LEN  16
+#define HAPTICS_SEQ_LEN    8 // Waveform sequencer slots of the DRV2605
+
+// DRV2605 registers
+#define DRV2605_REG_STATUS   0x00
+#define DRV2605_REG_MODE     0x01
+#define DRV2605_REG_LIBRARY  0x03
+#define DRV2605_REG_WAVESEQ1 0x04
+#define DRV2605_REG_GO       0x0C
+#define DRV2605_REG_FEEDBACK 0x1A
+
+#define DRV2605_MODE_INTERNAL_TRIGGER 0x00
+#define DRV2605_FEEDBACK_LRA          0x80
+#define DRV2605_ID_DRV2605            3
+#define DRV2605_ID_DRV2605L           7
+
+// Effects of the ROM library, see the DRV2605 datasheet
+static const uint8_t effect_ids[HAPTICS_EFFECTS] = {
+    26, // Sharp tick 3, 60 %
+    4,  // Sharp click, 100 %
+    10, // Double click, 100 %
+};
+
+static QueueHandle_t   s_queue = NULL;
+static haptics_stats_t s_stats;
+
+static bool haptics_write(uint8_t reg, uint8_t* data, uint8_t len)
+{
+    const int64_t start = esp_timer_get_time();
+    const bool    ok    = i2c_write_buff(drv2605_dev_handle, reg, data, len) == ESP_OK;
+    s_stats.bus_us += esp_timer_get_time() - start;
+    s_stats.bus_errors += !ok;
+    return ok;
+}
+
+static bool haptics_read(uint8_t reg, uint8_t* data)
+{
+    const int64_t start = esp_timer_get_time();
+    const bool    ok    = i2c_read_buff(drv2605_dev_handle, reg, data, 1) == ESP_OK;
+    s_stats.bus_us += esp_timer_get_time() - start;
+    s_stats.bus_errors += !ok;
+    return ok;
+}
+
+// Takes what is queued, in order, up to a full sequence. Returns the number of slots used.
+static uint8_t haptics_collect(haptics_effect_t first, uint8_t* seq)
+{
+    haptics_effect_t effect = first;
+    haptics_effect_t last   = HAPTICS_EFFECTS;
+    uint8_t          n      = 0;
+    do
+    {
+        // A detent right after a detent adds nothing the hand could tell apart
+        if (effect == HAPTICS_DETENT && last == HAPTICS_DETENT)
+        {
+            s_stats.coalesced++;
+            continue;
+        }
+        seq[n++] = effect_ids[effect];
+        last     = effect;
+    } while (n < HAPTICS_SEQ_LEN && xQueueReceive(s_queue, &effect, 0) == pdTRUE);
+    return n;
+}
+
+static void haptics_task(void* arg)
+{
+    haptics_effect_t effect;
+    while (1)
+    {
+        xQueueReceive(s_queue, &effect, portMAX_DELAY);
+
+        uint8_t       seq[HAPTICS_SEQ_LEN] = {}; // A zero ends the sequence
+        const uint8_t n                    = haptics_collect(effect, seq);
+        uint8_t       go                   = 1;
+        if (!haptics_write(DRV2605_REG_WAVESEQ1, seq, HAPTICS_SEQ_LEN) ||
+            !haptics_write(DRV2605_REG_GO, &go, 1))
+            continue;
+        s_stats.sequences++;
+        s_stats.effects += n;
+
+        // The chip clears GO when the sequence is over, requests queue up in the meantime
+        const int64_t deadline = esp_timer_get_time() + EXAMPLE_HAPTICS_TIMEOUT_MS * 1000LL;
+        do
+        {
+            vTaskDelay(pdMS_TO_TICKS(EXAMPLE_HAPTICS_POLL_MS));
+            s_stats.polls++;
+        } while (haptics_read(DRV2605_REG_GO, &go) && (go & 1) &&
+                 esp_timer_get_time() < deadline);
+    }
+}
+
+bool haptics_init(void)
+{
+    uint8_t status;
+    if (!haptics_read(DRV2605_REG_STATUS, &status))
+    {
+        ESP_LOGW(TAG, "No DRV2605 at 0x%02x", EXAMPLE_DRV2605_ADDR);
+        return false;
+    }
+    const uint8_t id = status >> 5;
+    if (id != DRV2605_ID_DRV2605 && id != DRV2605_ID_DRV2605L)
+        ESP_LOGW(TAG, "Unexpected device ID %u at 0x%02x", id, EXAMPLE_DRV2605_ADDR);
+
+    // Out of standby, effects started by the GO bit
+    uint8_t mode     = DRV2605_MODE_INTERNAL_TRIGGER;
+    uint8_t library  = EXAMPLE_HAPTICS_LIBRARY;
+    uint8_t feedback = 0;
+    if (!haptics_read(DRV2605_REG_FEEDBACK, &feedback))
+        return false;
+    if (EXAMPLE_HAPTICS_LRA)
+        feedback |= DRV2605_FEEDBACK_LRA;
+    else
+        feedback &= ~DRV2605_FEEDBACK_LRA;
+    if (!haptics_write(DRV2605_REG_MODE, &mode, 1) ||
+        !haptics_write(DRV2605_REG_FEEDBACK, &feedback, 1) ||
+        !haptics_write(DRV2605_REG_LIBRARY, &library, 1))
+    {
+        ESP_LOGE(TAG, "Failed to set up the DRV2605");
+        return false;
+    }
+
+    s_queue = xQueueCreate(HAPTICS_QUEUE_LEN, sizeof(haptics_effect_t));
+    if (!s_queue || xTaskCreatePinnedToCore(haptics_task, "haptics", HAPTICS_STACK_SIZE, NULL,
+                                            EXAMPLE_HAPTICS_TASK_PRIORITY, NULL,
+                                            EXAMPLE_LVGL_TASK_CORE ? 0 : 1) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start the haptics task");
+        return false;
+    }
+    ESP_LOGI(TAG, "DRV2605 ready, library %d", EXAMPLE_HAPTICS_LIBRARY);
+    return true;
+}
+
+void haptics_play(haptics_effect_t effect)
+{
+    if (!s_queue)
+        return;
+    s_stats.requested++;
+    if (xQueueSend(s_queue, &effect, 0) != pdTRUE)
+        s_stats.dropped++;
+}
+
+void haptics_get_stats(haptics_stats_t* stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,35 @@
+#ifndef HAPTICS_H
+#define HAPTICS_H
+
+#include <stdint.h>
+
+typedef enum
+{
+    HAPTICS_DETENT = 0, // Knob detent, bursts of them are played as one
+    HAPTICS_CLICK,      // Button press
+    HAPTICS_LONG_PRESS,
+    HAPTICS_EFFECTS,
+} haptics_effect_t;
+
+typedef struct
+{
+    uint32_t requested;  // haptics_play() calls
+    uint32_t dropped;    // Requests lost to a full queue
+    uint32_t coalesced;  // Detents merged into one already queued
+    uint32_t sequences;  // GO commands sent, each with up to 8 effects
+    uint32_t effects;    // Effects played
+    uint32_t polls;      // GO bit reads while an effect played
+    uint32_t bus_errors; // Failed transfers
+    uint64_t bus_us;     // Time spent on the I2C bus
+} haptics_stats_t;
+
+// Checks for the DRV2605, sets it up for its effect library and starts the haptics task.
+// Must be called after i2c_master_Init(). Returns false without a driver chip.
+bool haptics_init(void);
+
+// Queues an effect. Never blocks and never touches the bus, safe from the LVGL task.
+void haptics_play(haptics_effect_t effect);
+
+void haptics_get_stats(haptics_stats_t* stats);
+
+#endif
@@ -0,0 +1,319 @@
+// Input-to-photon latency. Every input the indev read callbacks hand to LVGL is stamped with the
+// time the hardware saw it, the touch INT edge or the knob detent. Whatever LVGL invalidates
+// while handling it, up to the next indev read, is taken as its response, and the first flush
+// covering any of that ends the measurement once esp_lcd_panel_draw_bitmap() has queued it.
+// Latencies are kept as histograms per screen and input type.
+//
+// With EXAMPLE_INPUT_LATENCY_SIM_CYCLES the touch panel and the knob are replaced by a fixed
+// script of drags and turns, so runs can be repeated and compared before and after a change.
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "input_latency.h"
+#include "user_config.h"
+
+static const char* TAG = "input_latency";
+
+#define INPUT_LATENCY_OTHER EXAMPLE_INPUT_LATENCY_SCREENS // Slot of the screens without a name
+
+static const char* const type_names[INPUT_LATENCY_TYPES] = {"press", "drag", "release", "encoder"};
+
+typedef enum
+{
+    PENDING_NONE = 0,
+    PENDING_INPUT, // Handled by LVGL, collecting what it invalidates
+    PENDING_FLUSH, // Waiting for a flush that covers the response
+} pending_state_t;
+
+static struct
+{
+    pending_state_t      state;
+    input_latency_type_t type;
+    uint8_t              screen;
+    bool                 invalidated;
+    int64_t              input_us;
+    lv_area_t            area; // Bounding box of the response
+} s_pending;
+
+static lv_obj_t*             s_screens[EXAMPLE_INPUT_LATENCY_SCREENS];
+static const char*           s_names[EXAMPLE_INPUT_LATENCY_SCREENS];
+static input_latency_hist_t  s_hist[EXAMPLE_INPUT_LATENCY_SCREENS + 1][INPUT_LATENCY_TYPES];
+static input_latency_stats_t s_stats;
+#if EXAMPLE_INPUT_LATENCY_REPORT_MS
+static int64_t s_report_us;
+#endif
+
+void input_latency_name_screen(lv_obj_t* scr, const char* name)
+{
+    for (int i = 0; i < EXAMPLE_INPUT_LATENCY_SCREENS; i++)
+    {
+        if (s_screens[i] == NULL || s_screens[i] == scr)
+        {
+            s_screens[i] = scr;
+            s_names[i]   = name;
+            return;
+        }
+    }
+    ESP_LOGW(TAG, "No slot left for screen %s", name);
+}
+
+static uint8_t input_latency_screen_slot(const lv_obj_t* scr)
+{
+    for (uint8_t i = 0; i < EXAMPLE_INPUT_LATENCY_SCREENS && s_screens[i]; i++)
+    {
+        if (s_screens[i] == scr)
+            return i;
+    }
+    return INPUT_LATENCY_OTHER;
+}
+
+static void input_latency_drop(void)
+{
+    s_hist[s_pending.screen][s_pending.type].unanswered++;
+    s_stats.unanswered++;
+    s_pending.state = PENDING_NONE;
+}
+
+void input_latency_indev_read(void)
+{
+    const int64_t now = esp_timer_get_time();
+    // The response window of the previous input closes here
+    if (s_pending.state == PENDING_INPUT)
+    {
+        if (s_pending.invalidated)
+            s_pending.state = PENDING_FLUSH;
+        else
+            input_latency_drop();
+    }
+    // The response may have been clipped away entirely, e.g. outside the round panel
+    else if (s_pending.state == PENDING_FLUSH &&
+             now - s_pending.input_us > EXAMPLE_INPUT_LATENCY_TIMEOUT_MS * 1000LL)
+    {
+        input_latency_drop();
+    }
+
+#if EXAMPLE_INPUT_LATENCY_REPORT_MS
+    if (now - s_report_us >= EXAMPLE_INPUT_LATENCY_REPORT_MS * 1000LL)
+    {
+        if (s_report_us)
+            input_latency_report();
+        s_report_us = now;
+    }
+#endif
+}
+
+void input_latency_input(input_latency_type_t type, int64_t input_us)
+{
+    s_stats.inputs++;
+    if (s_pending.state != PENDING_NONE)
+    {
+        // The earlier input is still measured, this one rides along with it
+        s_stats.overlapped++;
+        return;
+    }
+    s_pending.state       = PENDING_INPUT;
+    s_pending.type        = type;
+    s_pending.screen      = input_latency_screen_slot(lv_scr_act());
+    s_pending.invalidated = false;
+    s_pending.input_us    = input_us;
+}
+
+void input_latency_invalidate(const lv_area_t* area)
+{
+    if (s_pending.state != PENDING_INPUT)
+        return;
+    if (!s_pending.invalidated)
+    {
+        s_pending.area        = *area;
+        s_pending.invalidated = true;
+        return;
+    }
+    s_pending.area.x1 = LV_MIN(s_pending.area.x1, area->x1);
+    s_pending.area.y1 = LV_MIN(s_pending.area.y1, area->y1);
+    s_pending.area.x2 = LV_MAX(s_pending.area.x2, area->x2);
+    s_pending.area.y2 = LV_MAX(s_pending.area.y2, area->y2);
+}
+
+void input_latency_flush(const lv_area_t* area)
+{
+    // The refresh may run before the next indev read closes the window
+    if (s_pending.state == PENDING_NONE || !s_pending.invalidated ||
+        !_lv_area_is_on(area, &s_pending.area))
+        return;
+
+    const uint32_t        us = (uint32_t) LV_MAX(esp_timer_get_time() - s_pending.input_us, 0);
+    input_latency_hist_t* h  = &s_hist[s_pending.screen][s_pending.type];
+    h->count++;
+    h->sum_us += us;
+    h->max_us     = LV_MAX(h->max_us, us);
+    uint16_t* cnt = &h->buckets[LV_MIN(us / (INPUT_LATENCY_BUCKET_MS * 1000),
+                                       (uint32_t) INPUT_LATENCY_BUCKETS - 1)];
+    if (*cnt < UINT16_MAX)
+        (*cnt)++;
+    s_stats.measured++;
+    s_pending.state = PENDING_NONE;
+}
+
+void input_latency_get_stats(input_latency_stats_t* stats)
+{
+    *stats = s_stats;
+}
+
+const input_latency_hist_t* input_latency_get_hist(const char* name, input_latency_type_t type)
+{
+    uint8_t slot = INPUT_LATENCY_OTHER;
+    for (uint8_t i = 0; i < EXAMPLE_INPUT_LATENCY_SCREENS && s_names[i]; i++)
+    {
+        if (strcmp(s_names[i], name) == 0)
+            slot = i;
+    }
+    if (slot == INPUT_LATENCY_OTHER && strcmp(name, "other") != 0)
+        return NULL;
+    const input_latency_hist_t* h = &s_hist[slot][type];
+    return h->count || h->unanswered ? h : NULL;
+}
+
+// Upper edge of the bucket holding the given fraction of the measurements, in ms
+static uint32_t input_latency_percentile(const input_latency_hist_t* h, uint32_t percent)
+{
+    const uint32_t rank = (h->count * percent + 99) / 100;
+    uint32_t       sum  = 0;
+    for (int i = 0; i < INPUT_LATENCY_BUCKETS - 1; i++)
+    {
+        sum += h->buckets[i];
+        if (sum >= rank)
+            return (i + 1) * INPUT_LATENCY_BUCKET_MS;
+    }
+    return (h->max_us + 999) / 1000;
+}
+
+void input_latency_report(void)
+{
+    ESP_LOGI(TAG, "Input to photon: %" PRIu32 " inputs, %" PRIu32 " measured, %" PRIu32
+                  " unanswered, %" PRIu32 " overlapped",
+             s_stats.inputs, s_stats.measured, s_stats.unanswered, s_stats.overlapped);
+    for (int s = 0; s <= EXAMPLE_INPUT_LATENCY_SCREENS; s++)
+    {
+        const char* name = s < EXAMPLE_INPUT_LATENCY_SCREENS ? s_names[s] : "other";
+        for (int t = 0; t < INPUT_LATENCY_TYPES; t++)
+        {
+            const input_latency_hist_t* h = &s_hist[s][t];
+            if (h->count == 0)
+            {
+                if (h->unanswered)
+                    ESP_LOGI(TAG, "  %-10s %-7s %" PRIu32 " unanswered", name, type_names[t],
+                             h->unanswered);
+                continue;
+            }
+            ESP_LOGI(TAG,
+                     "  %-10s %-7s n %4" PRIu32 "  mean %5.1f  p50 %3" PRIu32 "  p90 %3" PRIu32
+                     "  p99 %3" PRIu32 "  max %5.1f ms, %" PRIu32 " unanswered",
+                     name, type_names[t], h->count, h->sum_us / 1000.0f / h->count,
+                     input_latency_percentile(h, 50), input_latency_percentile(h, 90),
+                     input_latency_percentile(h, 99), h->max_us / 1000.0f, h->unanswered);
+            // Non-empty buckets as "upper edge in ms:count"
+            char line[INPUT_LATENCY_BUCKETS * 12];
+            int  len = 0;
+            for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+            {
+                if (h->buckets[i] == 0)
+                    continue;
+                if (i == INPUT_LATENCY_BUCKETS - 1)
+                    len += snprintf(line + len, sizeof(line) - len, " >%d:%u",
+                                    i * INPUT_LATENCY_BUCKET_MS, h->buckets[i]);
+                else
+                    len += snprintf(line + len, sizeof(line) - len, " %d:%u",
+                                    (i + 1) * INPUT_LATENCY_BUCKET_MS, h->buckets[i]);
+            }
+            ESP_LOGI(TAG, "   %s", line);
+        }
+    }
+}
+
+void input_latency_reset(void)
+{
+    memset(s_hist, 0, sizeof(s_hist));
+    s_stats         = {};
+    s_pending.state = PENDING_NONE;
+}
+
+#if EXAMPLE_INPUT_LATENCY_SIM_CYCLES
+// One cycle: a drag up the middle of the screen, reported every 10 ms like the controller
+// does, then five detents clockwise and five back, 100 ms apart
+#define SIM_CYCLE_US     2000000LL
+#define SIM_DRAG_US      400000LL
+#define SIM_SAMPLE_US    10000LL
+#define SIM_DRAG_FROM_Y  250
+#define SIM_DRAG_TO_Y    110
+#define SIM_DETENT_US    1000000LL // First detent of the cycle
+#define SIM_DETENT_GAP   100000LL
+#define SIM_DETENTS      10
+#define SIM_SEQ_BASE     0x80000000u // Away from the sequence numbers of the real controller
+
+static int64_t  s_sim_start_us;
+static uint32_t s_sim_detents; // Handed out so far
+static bool     s_sim_done;
+
+// Position in the script, false before it starts and after it ended
+static bool input_latency_sim_time(int64_t now_us, int64_t* t_us)
+{
+    if (s_sim_start_us == 0)
+    {
+        s_sim_start_us = now_us + EXAMPLE_INPUT_LATENCY_SIM_DELAY_MS * 1000LL;
+        ESP_LOGI(TAG, "Simulated input starts in %d ms, %d cycles",
+                 EXAMPLE_INPUT_LATENCY_SIM_DELAY_MS, EXAMPLE_INPUT_LATENCY_SIM_CYCLES);
+    }
+    *t_us = now_us - s_sim_start_us;
+    if (*t_us < 0 || s_sim_done)
+        return false;
+    if (*t_us >= EXAMPLE_INPUT_LATENCY_SIM_CYCLES * SIM_CYCLE_US)
+    {
+        s_sim_done = true;
+        input_latency_report();
+        return false;
+    }
+    return true;
+}
+
+bool input_latency_sim_touch(int64_t now_us, touch_sample_t* sample)
+{
+    int64_t t;
+    if (!input_latency_sim_time(now_us, &t))
+        return false;
+
+    const int64_t  cycle   = t / SIM_CYCLE_US;
+    const int64_t  slots   = SIM_DRAG_US / SIM_SAMPLE_US;
+    const int64_t  slot    = LV_MIN((t % SIM_CYCLE_US) / SIM_SAMPLE_US, slots);
+    const uint32_t y_range = SIM_DRAG_FROM_Y - SIM_DRAG_TO_Y;
+    sample->pressed        = slot < slots;
+    sample->x              = EXAMPLE_LCD_H_RES / 2;
+    sample->y              = SIM_DRAG_FROM_Y - y_range * LV_MIN(slot, slots - 1) / (slots - 1);
+    sample->time_us        = s_sim_start_us + cycle * SIM_CYCLE_US + slot * SIM_SAMPLE_US;
+    sample->seq            = SIM_SEQ_BASE + (uint32_t) (cycle * (slots + 1) + slot);
+    return true;
+}
+
+bool input_latency_sim_encoder(int64_t now_us, int32_t* steps, int64_t* last_us)
+{
+    int64_t t;
+    if (!input_latency_sim_time(now_us, &t))
+        return false;
+
+    const int64_t cycle  = t / SIM_CYCLE_US;
+    const int64_t in     = t % SIM_CYCLE_US - SIM_DETENT_US;
+    const int64_t passed = in < 0 ? 0 : LV_MIN(in / SIM_DETENT_GAP + 1, SIM_DETENTS);
+    *steps               = 0;
+    for (; s_sim_detents < cycle * SIM_DETENTS + passed; s_sim_detents++)
+    {
+        const uint32_t i = s_sim_detents % SIM_DETENTS;
+        *steps += i < SIM_DETENTS / 2 ? 1 : -1;
+        *last_us = s_sim_start_us + s_sim_detents / SIM_DETENTS * SIM_CYCLE_US + SIM_DETENT_US +
+                   i * SIM_DETENT_GAP;
+    }
+    return true;
+}
+#endif
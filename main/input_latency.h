@@ -0,0 +1,71 @@
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "touch_sampler.h"
+#include "user_config.h"
+
+typedef enum
+{
+    INPUT_LATENCY_TOUCH_PRESS = 0,
+    INPUT_LATENCY_TOUCH_DRAG,
+    INPUT_LATENCY_TOUCH_RELEASE,
+    INPUT_LATENCY_ENCODER,
+    INPUT_LATENCY_TYPES,
+} input_latency_type_t;
+
+#define INPUT_LATENCY_BUCKET_MS 5
+#define INPUT_LATENCY_BUCKETS   33 // The last one takes everything slower
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t unanswered; // Inputs that invalidated nothing
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint16_t buckets[INPUT_LATENCY_BUCKETS];
+} input_latency_hist_t;
+
+typedef struct
+{
+    uint32_t inputs;
+    uint32_t measured;
+    uint32_t overlapped; // Inputs while an earlier one still waited for its flush
+    uint32_t unanswered;
+} input_latency_stats_t;
+
+// Names a screen in the report. Inputs on screens that were not named are counted as "other".
+void input_latency_name_screen(lv_obj_t* scr, const char* name);
+
+// Called at the top of every indev read callback. Whatever was invalidated since the previous
+// read is the response to the input that read delivered.
+void input_latency_indev_read(void);
+
+// An input handed to LVGL by the read callback, `input_us` is when the hardware saw it
+void input_latency_input(input_latency_type_t type, int64_t input_us);
+
+// From the rounder callback, for every area LVGL invalidates
+void input_latency_invalidate(const lv_area_t* area);
+
+// After esp_lcd_panel_draw_bitmap() returned for `area`
+void input_latency_flush(const lv_area_t* area);
+
+void input_latency_get_stats(input_latency_stats_t* stats);
+
+// Histogram of `type` on the screen named `name`, NULL when nothing was recorded
+const input_latency_hist_t* input_latency_get_hist(const char* name, input_latency_type_t type);
+
+// Logs count, percentiles and the histogram per screen and input type
+void input_latency_report(void);
+
+void input_latency_reset(void);
+
+#if EXAMPLE_INPUT_LATENCY_SIM_CYCLES
+// Scripted input for repeatable runs, replaces the touch panel and the knob while it lasts.
+// Each returns true while the script runs, with the input the hardware would have delivered.
+bool input_latency_sim_touch(int64_t now_us, touch_sample_t* sample);
+bool input_latency_sim_encoder(int64_t now_us, int32_t* steps, int64_t* last_us);
+#endif
+
+#endif
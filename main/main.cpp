@@ -15,20 +15,180 @@
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include "esp_timer.h"
+#include "nvs_flash.h"
 
 #include "user_config.h"
 #include "user_encoder_bsp.h"
 #include "ui.h"
 #include "display_init.h"
+#include "boot.h"
+#if EXAMPLE_USE_SCROLL_BLIT
+#include "scroll_blit.h"
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+#include "input_latency.h"
+#endif
+#if EXAMPLE_USE_AMOLED_SAVER
+#include "amoled_saver.h"
+#endif
+
+#define APP_USE_GESTURES (EXAMPLE_USE_TOUCH && EXAMPLE_USE_GESTURES)
 
 static const char* TAG = "main";
 
+#if APP_USE_GESTURES
+// A swipe to the right goes back, through the back button of the screen
+static lv_obj_t* app_back_button(lv_obj_t* scr)
+{
+    if (scr == ui_Now_Playing_Screen)
+        return ui_Now_Playing_Back_Btn;
+    if (scr == ui_Queue_Screen)
+        return ui_Queue_Back_Btn;
+    if (scr == ui_Playlists_Screen)
+        return ui_Playlists_Back_Btn;
+    if (scr == ui_PlayList_Screen)
+        return ui_Playlist_Back_Btn;
+    if (scr == ui_Settings_Screen)
+        return ui_Settings_Back_Btn;
+    return NULL;
+}
+
+// One turn around the bezel scrubs through the whole track
+static void app_scrub(float deg)
+{
+    static float  carry;
+    const int32_t range =
+        lv_arc_get_max_value(ui_Now_Playing_Arc) - lv_arc_get_min_value(ui_Now_Playing_Arc);
+    carry += deg * range / 360.0f;
+    const int32_t steps = (int32_t) carry;
+    carry -= steps;
+    if (steps == 0)
+        return;
+    lv_arc_set_value(ui_Now_Playing_Arc, lv_arc_get_value(ui_Now_Playing_Arc) + steps);
+    lv_event_send(ui_Now_Playing_Arc, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+// Long presses are left to the widgets. A swipe that went back takes the touch, so the row it
+// started on is not clicked as well.
+static bool app_gesture_cb(const gesture_event_t* event)
+{
+    lv_disp_t* disp = lv_disp_get_default();
+    lv_obj_t*  scr  = lv_disp_get_scr_act(disp);
+    if (disp->scr_to_load)
+        return false;
+
+    if (event->type == GESTURE_SWIPE_RIGHT)
+    {
+        lv_obj_t* back = app_back_button(scr);
+        if (!back)
+            return false;
+        lv_event_send(back, LV_EVENT_CLICKED, NULL);
+        return true;
+    }
+    if (event->type == GESTURE_JOG && scr == ui_Now_Playing_Screen)
+    {
+        app_scrub(event->jog_deg);
+        return true;
+    }
+    return false;
+}
+
+// The other screens have lists and buttons near the bezel
+static void app_jog_screen_cb(lv_event_t* e)
+{
+    display_set_jog_enabled(lv_event_get_code(e) == LV_EVENT_SCREEN_LOADED);
+}
+#endif
+
+#if EXAMPLE_USE_ENCODER_INDEV
+static void app_encoder_add(lv_group_t* group, lv_obj_t* obj)
+{
+    const uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        lv_obj_t* child = lv_obj_get_child(obj, i);
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
+            continue;
+        if (display_is_control(child))
+            lv_group_add_obj(group, child);
+        app_encoder_add(group, child);
+    }
+}
+
+// The knob walks the buttons and panels of the screen in creation order, the lists scroll along
+// with the focus. On Now Playing it sweeps the arc instead.
+static void app_encoder_fill(lv_obj_t* scr)
+{
+    lv_group_t* group = display_get_encoder_group();
+    lv_group_remove_all_objs(group);
+    if (scr == ui_Now_Playing_Screen)
+    {
+        lv_group_add_obj(group, ui_Now_Playing_Arc);
+        lv_group_set_editing(group, true);
+        return;
+    }
+    lv_group_set_editing(group, false);
+    app_encoder_add(group, scr);
+}
+
+static void app_encoder_screen_cb(lv_event_t* e)
+{
+    app_encoder_fill(lv_event_get_target(e));
+}
+#endif
+
 extern "C" void app_main(void)
 {
     ESP_LOGI(TAG, "Starting Spotify App\n");
 
+    int       stage = boot_stage_begin("nvs");
+    esp_err_t err   = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+    boot_stage_end(stage);
+
+    stage = boot_stage_begin("encoder");
+    user_encoder_init();
+    boot_stage_end(stage);
     display_init();
+
+    // Built while the panel sleeps out, the LVGL task doesn't run until display_start()
+    stage = boot_stage_begin("ui");
     ui_init();
+#if EXAMPLE_USE_SCROLL_BLIT
+    scroll_blit_attach(ui_Queue_Container);
+    scroll_blit_attach(ui_Songs_Container);
+#endif
+#if APP_USE_GESTURES
+    display_set_gesture_cb(app_gesture_cb);
+    lv_obj_add_event_cb(ui_Now_Playing_Screen, app_jog_screen_cb, LV_EVENT_SCREEN_LOADED, NULL);
+    lv_obj_add_event_cb(ui_Now_Playing_Screen, app_jog_screen_cb, LV_EVENT_SCREEN_UNLOAD_START,
+                        NULL);
+#endif
+#if EXAMPLE_USE_ENCODER_INDEV
+    lv_obj_t* const screens[] = {ui_Main_Screen,      ui_Now_Playing_Screen, ui_Queue_Screen,
+                                 ui_Playlists_Screen, ui_PlayList_Screen,    ui_Settings_Screen};
+    for (size_t i = 0; i < sizeof(screens) / sizeof(screens[0]); i++)
+        lv_obj_add_event_cb(screens[i], app_encoder_screen_cb, LV_EVENT_SCREEN_LOADED, NULL);
+    app_encoder_fill(lv_scr_act());
+#endif
+#if EXAMPLE_USE_INPUT_LATENCY
+    input_latency_name_screen(ui_Main_Screen, "main");
+    input_latency_name_screen(ui_Now_Playing_Screen, "playing");
+    input_latency_name_screen(ui_Queue_Screen, "queue");
+    input_latency_name_screen(ui_Playlists_Screen, "playlists");
+    input_latency_name_screen(ui_PlayList_Screen, "playlist");
+    input_latency_name_screen(ui_Settings_Screen, "settings");
+#endif
+#if EXAMPLE_USE_AMOLED_SAVER
+    amoled_saver_init();
+#endif
+    boot_stage_end(stage);
+    display_start();
 
     while (1)
         vTaskSuspend(NULL);
@@ -0,0 +1,85 @@
+// SH8601 init sequence player. The vendor table is close to two hundred register writes and the
+// driver sends each of them with its own yield and delay, after a fixed 100 ms wait of its own
+// behind the first sleep out. Here the table is packed into bytes, the writes go out back to back
+// and the only wait is the one the panel needs, the 120 ms after sleep out.
+//
+// The SPI panel IO has no queued path for parameters, tx_color carries its data in quad mode, so
+// every write is a polling transaction. They take a few microseconds each.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "panel_init.h"
+
+static const char* TAG = "panel_init";
+
+static panel_init_stats_t s_stats;
+
+esp_err_t panel_init_tx(esp_lcd_panel_io_handle_t io, uint8_t cmd, const void* data, size_t len)
+{
+    return esp_lcd_panel_io_tx_param(io, PANEL_INIT_QSPI_CMD(cmd), len ? data : NULL, len);
+}
+
+esp_err_t panel_init_play(esp_lcd_panel_io_handle_t io, const uint8_t* seq, size_t size)
+{
+    panel_init_stats_t stats = {};
+    const int64_t      start = esp_timer_get_time();
+    size_t             pos   = 0;
+    while (pos + 2 <= size)
+    {
+        const uint8_t  cmd  = seq[pos];
+        const uint8_t  len  = seq[pos + 1] & PANEL_INIT_LEN;
+        const bool     wait = seq[pos + 1] & PANEL_INIT_DELAY;
+        const uint8_t* data = &seq[pos + 2];
+        pos += 2 + len + wait;
+        if (pos > size)
+        {
+            ESP_LOGE(TAG, "Sequence cut off at command 0x%02X", cmd);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        const esp_err_t err = panel_init_tx(io, cmd, data, len);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Command 0x%02X failed (%s)", cmd, esp_err_to_name(err));
+            return err;
+        }
+        stats.cmds++;
+        stats.bytes += len;
+        if (wait)
+        {
+            stats.wait_ms += data[len];
+            vTaskDelay(pdMS_TO_TICKS(data[len]));
+        }
+    }
+    // Reported by boot_report()
+    stats.us = esp_timer_get_time() - start;
+    s_stats  = stats;
+    return ESP_OK;
+}
+
+size_t panel_init_unpack(const uint8_t* seq, size_t size, sh8601_lcd_init_cmd_t* cmds, size_t max)
+{
+    size_t cnt = 0;
+    size_t pos = 0;
+    while (pos + 2 <= size && cnt < max)
+    {
+        const uint8_t len  = seq[pos + 1] & PANEL_INIT_LEN;
+        const bool    wait = seq[pos + 1] & PANEL_INIT_DELAY;
+        if (pos + 2 + len + wait > size)
+            break;
+        cmds[cnt].cmd        = seq[pos];
+        cmds[cnt].data       = &seq[pos + 2];
+        cmds[cnt].data_bytes = len;
+        cmds[cnt].delay_ms   = wait ? seq[pos + 2 + len] : 0;
+        cnt++;
+        pos += 2 + len + wait;
+    }
+    return cnt;
+}
+
+void panel_init_get_stats(panel_init_stats_t* stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,38 @@
+#ifndef PANEL_INIT_H
+#define PANEL_INIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_sh8601.h"
+
+// Packed init sequence: per command `cmd, len, data[len]`, with PANEL_INIT_DELAY set in `len` a
+// byte with the wait after it in ms follows the data
+#define PANEL_INIT_DELAY 0x80
+#define PANEL_INIT_LEN   0x7F
+
+// Command phase of a QSPI register write, as the SH8601 driver sends it
+#define PANEL_INIT_QSPI_CMD(cmd) ((0x02UL << 24) | ((uint32_t) (cmd) << 8))
+
+typedef struct
+{
+    uint32_t cmds;    // Commands sent
+    uint32_t bytes;   // Parameter bytes sent
+    uint32_t wait_ms; // Required waits in the sequence
+    int64_t  us;      // The whole sequence, waits included
+} panel_init_stats_t;
+
+// Writes one register of the panel behind the QSPI panel IO
+esp_err_t panel_init_tx(esp_lcd_panel_io_handle_t io, uint8_t cmd, const void* data, size_t len);
+
+// Sends the packed sequence back to back and waits only where it says so
+esp_err_t panel_init_play(esp_lcd_panel_io_handle_t io, const uint8_t* seq, size_t size);
+
+// The packed sequence as the SH8601 driver's init_cmds, pointing into `seq`. Returns the count.
+size_t panel_init_unpack(const uint8_t* seq, size_t size, sh8601_lcd_init_cmd_t* cmds, size_t max);
+
+// The last panel_init_play(), for the boot report
+void panel_init_get_stats(panel_init_stats_t* stats);
+
+#endif
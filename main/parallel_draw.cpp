@@ -0,0 +1,86 @@
+// Dual-core rendering. LVGL 8 walks the object tree and builds masks on one core, and its draw
+// state is global, so two cores cannot render two parts of the screen on their own. What can
+// run concurrently is the blend of a large area: the rows are independent, so the lower half is
+// handed to a helper task pinned to the other core and joined before the blend returns. The
+// stripe is therefore complete by the time flush_cb sees it.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "parallel_draw.h"
+#include "user_config.h"
+
+static const char* TAG = "parallel_draw";
+
+typedef struct
+{
+    parallel_draw_fn fn;
+    void*            arg;
+    int32_t          y1;
+    int32_t          y2;
+} parallel_draw_job_t;
+
+static TaskHandle_t          s_helper = NULL;
+static SemaphoreHandle_t     s_done   = NULL;
+static parallel_draw_job_t   s_job;
+static parallel_draw_stats_t s_stats;
+
+static void parallel_draw_helper_task(void* arg)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        s_job.fn(s_job.arg, s_job.y1, s_job.y2, 1);
+        xSemaphoreGive(s_done);
+    }
+}
+
+bool parallel_draw_init(void)
+{
+    s_done = xSemaphoreCreateBinary();
+    if (!s_done)
+        return false;
+    const BaseType_t core = EXAMPLE_LVGL_TASK_CORE ? 0 : 1;
+    if (xTaskCreatePinnedToCore(parallel_draw_helper_task, "LVGL draw", 3 * 1024, NULL,
+                                EXAMPLE_LVGL_TASK_PRIORITY, &s_helper, core) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start the helper task, rendering on one core");
+        vSemaphoreDelete(s_done);
+        s_done = NULL;
+        return false;
+    }
+    ESP_LOGI(TAG, "Helper running on core %d", core);
+    return true;
+}
+
+void parallel_draw_rows(parallel_draw_fn fn, void* arg, int32_t y1, int32_t y2, int32_t w)
+{
+    const int32_t  rows = y2 - y1 + 1;
+    const uint32_t px   = rows * w;
+    if (!s_helper || rows < 2 || px < EXAMPLE_PARALLEL_DRAW_MIN_PX)
+    {
+        s_stats.inline_jobs++;
+        s_stats.inline_px += px;
+        fn(arg, y1, y2, 0);
+        return;
+    }
+
+    const int32_t mid = y1 + rows / 2;
+    s_job             = {fn, arg, mid, y2};
+    xTaskNotifyGive(s_helper);
+    fn(arg, y1, mid - 1, 0);
+
+    const int64_t wait_start = esp_timer_get_time();
+    xSemaphoreTake(s_done, portMAX_DELAY);
+    s_stats.wait_us += esp_timer_get_time() - wait_start;
+    s_stats.split_jobs++;
+    s_stats.split_px += px;
+}
+
+void parallel_draw_get_stats(parallel_draw_stats_t* stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,28 @@
+#ifndef PARALLEL_DRAW_H
+#define PARALLEL_DRAW_H
+
+#include <stdint.h>
+
+// Renders rows [y1, y2] of one job. `band` is 0 on the LVGL core and 1 on the helper core, so
+// jobs can keep per-band scratch buffers.
+typedef void (*parallel_draw_fn)(void* arg, int32_t y1, int32_t y2, int band);
+
+typedef struct
+{
+    uint32_t split_jobs;  // Jobs rendered on both cores
+    uint32_t inline_jobs; // Jobs too small to be worth the hand-over
+    uint64_t split_px;
+    uint64_t inline_px;
+    uint64_t wait_us;     // Time the LVGL core waited for the helper at the join
+} parallel_draw_stats_t;
+
+// Starts the helper task on the core the LVGL task does not run on
+bool parallel_draw_init(void);
+
+// Runs `fn` over rows [y1, y2] of `w` pixels each. Large jobs are split into two bands, the lower
+// one is rendered on the helper core. Returns after both bands are done.
+void parallel_draw_rows(parallel_draw_fn fn, void* arg, int32_t y1, int32_t y2, int32_t w);
+
+void parallel_draw_get_stats(parallel_draw_stats_t* stats);
+
+#endif
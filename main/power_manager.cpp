@@ -0,0 +1,294 @@
+// Power management for a UI that is mostly looked at, not touched. While anything moves the
+// LVGL task holds a CPU_FREQ_MAX lock. Once the refresh governor turns idle the lock is released,
+// so DFS drops the clock and the idle task may enter light sleep, and the periodic wake-ups of the
+// UI stop: the 2 ms LVGL tick timer and the LVGL indev read timers. Only the scheduled data
+// updates of the idle refresh period remain, the LVGL tick is caught up before each of them.
+//
+// Touch INT and the knob contacts are armed as level wake-up sources only for the time of a light
+// sleep, from the sleep callbacks, since a level interrupt on INT would fire for as long as the
+// line is low. Input wakes the LVGL task directly, which resumes the timers and reads the input
+// device right away, so the first frame after a wake is not held back by a timer period. Without
+// EXAMPLE_USE_TOUCH_IRQ nothing reads the controller but the touch indev timer, so that one keeps
+// running while idle and its reads wake the UI.
+
+#include <inttypes.h>
+#include <atomic>
+#include "sdkconfig.h"
+#include "freertos/event_groups.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+
+#include "power_manager.h"
+#include "refresh_governor.h"
+#include "user_encoder_bsp.h"
+#include "user_config.h"
+
+// esp_pm_configure() fails without CONFIG_PM_ENABLE, and without the callbacks nothing arms the
+// wake-up pins. The sleep callback API only exists with them, so this file builds either way.
+#if EXAMPLE_PM_LIGHT_SLEEP && CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+#define PM_LIGHT_SLEEP 1
+#else
+#define PM_LIGHT_SLEEP 0
+#endif
+#if EXAMPLE_USE_POWER_MANAGER
+#if !CONFIG_PM_ENABLE || !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#error "EXAMPLE_USE_POWER_MANAGER needs CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE"
+#elif EXAMPLE_PM_LIGHT_SLEEP && !PM_LIGHT_SLEEP
+#error "EXAMPLE_PM_LIGHT_SLEEP needs CONFIG_PM_LIGHT_SLEEP_CALLBACKS"
+#endif
+#endif
+
+static const char* TAG = "power_manager";
+
+static const char* const state_names[POWER_MANAGER_STATES] = {"active", "idle", "sleep"};
+
+typedef struct
+{
+    gpio_num_t      pin;
+    gpio_int_type_t awake_type; // Interrupt type outside of light sleep
+} power_manager_pin_t;
+
+// Active low, the controller pulls INT down and the knob closes a contact to ground
+static DRAM_ATTR const power_manager_pin_t s_pins[] = {
+#if EXAMPLE_USE_TOUCH
+    {EXAMPLE_PIN_NUM_TOUCH_INT, EXAMPLE_USE_TOUCH_IRQ ? GPIO_INTR_NEGEDGE : GPIO_INTR_DISABLE},
+#endif
+    {(gpio_num_t) EXAMPLE_ENCODER_ECA_PIN, GPIO_INTR_DISABLE},
+    {(gpio_num_t) EXAMPLE_ENCODER_ECB_PIN, GPIO_INTR_DISABLE},
+};
+
+static lv_disp_t*            s_disp      = NULL;
+static esp_timer_handle_t    s_tick      = NULL;
+static TaskHandle_t          s_lvgl_task = NULL;
+static esp_pm_lock_handle_t  s_cpu_lock  = NULL;
+static power_manager_state_t s_state     = POWER_MANAGER_ACTIVE; // Owned by the LVGL task
+static int64_t               s_state_us;       // Entry into s_state
+static int64_t               s_tick_us;        // LVGL tick accounted up to here while stopped
+static int64_t               s_resume_from_us; // Input of the last wake, until its flush
+static std::atomic<bool>     s_idle(false);
+static std::atomic<uint32_t> s_wake(0); // Set by the first input while idle
+static volatile int64_t      s_wake_us;
+static volatile uint64_t     s_sleep_us;
+static power_manager_stats_t s_stats;
+#if EXAMPLE_PM_REPORT_MS
+static int64_t s_report_us;
+#endif
+
+#if PM_LIGHT_SLEEP
+static esp_err_t IRAM_ATTR power_manager_sleep_enter(int64_t sleep_time_us, void* arg)
+{
+    gpio_dev_t* hw = GPIO_LL_GET_HW(GPIO_PORT_0);
+    for (const power_manager_pin_t& p : s_pins)
+    {
+        gpio_ll_set_intr_type(hw, p.pin, GPIO_INTR_LOW_LEVEL);
+        gpio_ll_wakeup_enable(hw, p.pin);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t IRAM_ATTR power_manager_sleep_exit(int64_t sleep_time_us, void* arg)
+{
+    gpio_dev_t* hw = GPIO_LL_GET_HW(GPIO_PORT_0);
+    for (const power_manager_pin_t& p : s_pins)
+    {
+        gpio_ll_wakeup_disable(hw, p.pin);
+        gpio_ll_set_intr_type(hw, p.pin, p.awake_type);
+    }
+    s_sleep_us = s_sleep_us + sleep_time_us;
+    s_stats.sleeps++;
+
+    // A timer wake-up is a scheduled data update, only a pin wakes the UI
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO && s_idle && !s_wake)
+    {
+        s_wake_us = esp_timer_get_time();
+        if (s_wake.exchange(1) == 0)
+        {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(s_lvgl_task, &woken);
+        }
+    }
+    return ESP_OK;
+}
+#endif
+
+static void power_manager_enter(power_manager_state_t state)
+{
+    const int64_t now = esp_timer_get_time();
+    s_stats.state_us[s_state] += now - s_state_us;
+    s_state    = state;
+    s_state_us = now;
+}
+
+static void power_manager_set_indev_reads(bool run)
+{
+    for (lv_indev_t* indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev))
+    {
+        if (!indev->driver->read_timer)
+            continue;
+#if !EXAMPLE_USE_TOUCH_IRQ
+        if (indev->driver->type == LV_INDEV_TYPE_POINTER)
+            continue;
+#endif
+        if (run)
+        {
+            lv_timer_resume(indev->driver->read_timer);
+            lv_timer_ready(indev->driver->read_timer);
+        }
+        else
+            lv_timer_pause(indev->driver->read_timer);
+    }
+}
+
+// Hands LVGL the milliseconds that passed since the tick timer stopped
+static void power_manager_catch_up(void)
+{
+    const uint32_t ms = (uint32_t) ((esp_timer_get_time() - s_tick_us) / 1000);
+    lv_tick_inc(ms);
+    s_tick_us += ms * 1000LL;
+}
+
+static void power_manager_resume(void)
+{
+    const int64_t input_us = s_wake_us;
+    s_wake                 = 0;
+    esp_pm_lock_acquire(s_cpu_lock);
+    power_manager_catch_up();
+    esp_timer_start_periodic(s_tick, EXAMPLE_LVGL_TICK_PERIOD_MS * 1000);
+    power_manager_set_indev_reads(true);
+    user_encoder_set_idle(false);
+    refresh_governor_input();
+    s_idle = false;
+    power_manager_enter(POWER_MANAGER_ACTIVE);
+    s_resume_from_us = input_us;
+    s_stats.wakes++;
+}
+
+static void power_manager_suspend(void)
+{
+    // Before the timers stop, so input from here on asks for a wake
+    s_idle = true;
+    power_manager_set_indev_reads(false);
+    esp_timer_stop(s_tick);
+    s_tick_us = esp_timer_get_time();
+    user_encoder_set_idle(true);
+    power_manager_enter(POWER_MANAGER_IDLE);
+    s_stats.idles++;
+    esp_pm_lock_release(s_cpu_lock);
+}
+
+bool power_manager_init(lv_disp_t* disp, esp_timer_handle_t lvgl_tick, TaskHandle_t lvgl_task)
+{
+    const esp_pm_config_t config = {
+        .max_freq_mhz       = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz       = EXAMPLE_PM_MIN_FREQ_MHZ,
+        .light_sleep_enable = PM_LIGHT_SLEEP,
+    };
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_OK)
+        err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ui", &s_cpu_lock);
+    if (err == ESP_OK)
+        err = esp_pm_lock_acquire(s_cpu_lock);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "No power management (%s)", esp_err_to_name(err));
+        return false;
+    }
+#if PM_LIGHT_SLEEP
+    esp_pm_sleep_cbs_register_config_t cbs = {};
+    cbs.enter_cb                            = power_manager_sleep_enter;
+    cbs.exit_cb                             = power_manager_sleep_exit;
+    esp_sleep_enable_gpio_wakeup();
+    esp_pm_light_sleep_register_cbs(&cbs);
+#endif
+
+    s_tick           = lvgl_tick;
+    s_lvgl_task      = lvgl_task;
+    s_state_us       = esp_timer_get_time();
+    s_stats.since_us = s_state_us;
+#if EXAMPLE_PM_REPORT_MS
+    s_report_us = s_state_us;
+#endif
+    user_encoder_set_detent_cb(power_manager_wake);
+    s_disp = disp;
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", EXAMPLE_PM_MIN_FREQ_MHZ,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, PM_LIGHT_SLEEP ? "on" : "off");
+    return true;
+}
+
+void power_manager_before_handler(void)
+{
+    if (!s_disp || s_state == POWER_MANAGER_ACTIVE)
+        return;
+    power_manager_catch_up();
+    if (s_wake)
+        power_manager_resume();
+}
+
+void power_manager_after_handler(void)
+{
+    if (!s_disp)
+        return;
+#if EXAMPLE_PM_REPORT_MS
+    const int64_t now = esp_timer_get_time();
+    if (now - s_report_us >= EXAMPLE_PM_REPORT_MS * 1000LL)
+    {
+        power_manager_report();
+        s_report_us = now;
+    }
+#endif
+    if (s_state == POWER_MANAGER_ACTIVE && refresh_governor_get_state() == REFRESH_GOVERNOR_IDLE)
+        power_manager_suspend();
+}
+
+void power_manager_wake(int64_t input_us)
+{
+    if (!s_idle || s_wake)
+        return;
+    s_wake_us = input_us;
+    if (s_wake.exchange(1) == 0)
+        xTaskNotifyGive(s_lvgl_task);
+}
+
+void power_manager_flush(void)
+{
+    if (!s_resume_from_us)
+        return;
+    const uint32_t us = (uint32_t) (esp_timer_get_time() - s_resume_from_us);
+    s_resume_from_us  = 0;
+    s_stats.resumes++;
+    s_stats.resume_us += us;
+    if (us > s_stats.resume_max_us)
+        s_stats.resume_max_us = us;
+}
+
+void power_manager_get_stats(power_manager_stats_t* stats)
+{
+    *stats                  = s_stats;
+    const uint64_t sleep_us = s_sleep_us;
+    stats->state_us[s_state] += esp_timer_get_time() - s_state_us;
+    // Light sleep only happens while idle
+    stats->state_us[POWER_MANAGER_IDLE] -= LV_MIN(sleep_us, stats->state_us[POWER_MANAGER_IDLE]);
+    stats->state_us[POWER_MANAGER_SLEEP] = sleep_us;
+}
+
+void power_manager_report(void)
+{
+    power_manager_stats_t stats;
+    power_manager_get_stats(&stats);
+    const int64_t elapsed_us = esp_timer_get_time() - stats.since_us;
+    if (elapsed_us <= 0)
+        return;
+
+    ESP_LOGI(TAG, "%" PRIu64 " ms, %" PRIu32 " times idle, %" PRIu32 " light sleeps:",
+             elapsed_us / 1000, stats.idles, stats.sleeps);
+    for (int i = 0; i < POWER_MANAGER_STATES; i++)
+        ESP_LOGI(TAG, "  %-6s %3" PRIu64 "%%", state_names[i],
+                 stats.state_us[i] * 100 / elapsed_us);
+    if (stats.resumes)
+        ESP_LOGI(TAG, "  %" PRIu32 " wakes, input to flush %" PRIu64 " us avg, %" PRIu32 " us max",
+                 stats.wakes, stats.resume_us / stats.resumes, stats.resume_max_us);
+}
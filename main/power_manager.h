@@ -0,0 +1,48 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+
+typedef enum
+{
+    POWER_MANAGER_ACTIVE = 0, // Full clock, LVGL tick and indev reads running
+    POWER_MANAGER_IDLE,       // UI idle and awake, DFS at the minimum clock
+    POWER_MANAGER_SLEEP,      // UI idle and in automatic light sleep
+    POWER_MANAGER_STATES,
+} power_manager_state_t;
+
+typedef struct
+{
+    uint64_t state_us[POWER_MANAGER_STATES]; // Residency
+    uint32_t idles;                          // Active -> idle
+    uint32_t sleeps;                         // Light sleeps
+    uint32_t wakes;                          // Idle -> active on input
+    uint32_t resumes;                        // Wakes with a flush after them
+    uint32_t resume_max_us;                  // Input to the first flush after a wake
+    uint64_t resume_us;
+    int64_t  since_us;
+} power_manager_stats_t;
+
+// Enables DFS and light sleep, lets the LVGL tick timer and indev reads stop while the refresh
+// governor is idle and wakes `lvgl_task` on input. Returns false when esp_pm refuses.
+bool power_manager_init(lv_disp_t* disp, esp_timer_handle_t lvgl_tick, TaskHandle_t lvgl_task);
+
+// Around every lv_timer_handler run in the LVGL task, with the LVGL lock held. The first resumes
+// after a wake and keeps the LVGL tick while it is stopped, the second goes idle.
+void power_manager_before_handler(void);
+void power_manager_after_handler(void);
+
+// Input from the touch panel or the knob, from any task. Wakes the LVGL task when idle.
+void power_manager_wake(int64_t input_us);
+
+// After esp_lcd_panel_draw_bitmap() returned
+void power_manager_flush(void);
+
+void power_manager_get_stats(power_manager_stats_t* stats);
+void power_manager_report(void);
+
+#endif
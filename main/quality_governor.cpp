@@ -0,0 +1,230 @@
+// Adaptive render quality. Frame times of large refreshes are collected in windows; when too
+// many frames miss the budget the UI steps down one tier, and after two windows with plenty of
+// headroom it steps back up.
+//
+// The screen transitions are SquareLine's _ui_screen_change() calls in the generated screens. The
+// generated code stays as exported: main links with --wrap=_ui_screen_change, so the calls land in
+// __wrap__ui_screen_change() below, which drops the animation in QUALITY_TIER_NO_TRANSITIONS.
+
+#include "esp_log.h"
+#include "lvgl.h"
+
+#include "quality_governor.h"
+#include "user_config.h"
+
+static const char* TAG = "quality_governor";
+
+#define QUALITY_HEADROOM_PCT   60 // A window has headroom when its worst frame is below this
+#define QUALITY_UP_WINDOWS     2  // Windows with headroom needed to step up
+#define QUALITY_MAX_OVERRIDES  128
+
+static const char* const tier_names[QUALITY_TIER_MAX] = {"full", "no transitions", "opaque",
+                                                         "no anti-aliasing"};
+
+// Local style values replaced while in QUALITY_TIER_OPAQUE
+typedef struct
+{
+    lv_obj_t*           obj;
+    lv_style_selector_t selector;
+    lv_style_prop_t     prop;
+    lv_opa_t            opa;
+    bool                had_color; // LV_STYLE_BG_OPA only: `color` was a local BG_COLOR
+    lv_color_t          color;
+} quality_override_t;
+
+static quality_tier_t     s_tier         = QUALITY_TIER_FULL;
+static quality_tier_t     s_applied_tier = QUALITY_TIER_FULL;
+static uint32_t           s_window_frames;
+static uint32_t           s_window_over;
+static uint32_t           s_window_worst;
+static uint32_t           s_up_windows;
+static quality_override_t s_overrides[QUALITY_MAX_OVERRIDES];
+static uint32_t           s_override_cnt;
+
+quality_tier_t quality_governor_feed(uint32_t frame_ms, uint32_t px)
+{
+    // Small refreshes are always fast and say nothing about the cost of the effects
+    if (px < EXAMPLE_QUALITY_MIN_PX)
+        return s_tier;
+
+    s_window_frames++;
+    if (frame_ms > EXAMPLE_QUALITY_BUDGET_MS)
+        s_window_over++;
+    if (frame_ms > s_window_worst)
+        s_window_worst = frame_ms;
+    if (s_window_frames < EXAMPLE_QUALITY_WINDOW)
+        return s_tier;
+
+    if (s_window_over * 4 > s_window_frames)
+    {
+        s_up_windows = 0;
+        if (s_tier < QUALITY_TIER_MAX - 1)
+            s_tier = (quality_tier_t) (s_tier + 1);
+    }
+    else if (s_window_worst * 100 <= EXAMPLE_QUALITY_BUDGET_MS * QUALITY_HEADROOM_PCT)
+    {
+        if (++s_up_windows >= QUALITY_UP_WINDOWS && s_tier > QUALITY_TIER_FULL)
+        {
+            s_tier       = (quality_tier_t) (s_tier - 1);
+            s_up_windows = 0;
+        }
+    }
+    else
+    {
+        s_up_windows = 0;
+    }
+
+    s_window_frames = 0;
+    s_window_over   = 0;
+    s_window_worst  = 0;
+    return s_tier;
+}
+
+// What `obj` is drawn over: the background of the nearest opaque parent, with the translucent
+// ones in between mixed in. Parents are snapped before their children, so they are opaque by now.
+static lv_color_t quality_backdrop(const lv_obj_t* obj)
+{
+    const lv_obj_t* parent = lv_obj_get_parent(obj);
+    // Below the screens the panel is off
+    if (!parent)
+        return lv_color_black();
+    const lv_opa_t   opa   = lv_obj_get_style_bg_opa(parent, LV_PART_MAIN);
+    const lv_color_t color = lv_obj_get_style_bg_color(parent, LV_PART_MAIN);
+    if (opa >= LV_OPA_MAX)
+        return color;
+    if (opa <= LV_OPA_MIN)
+        return quality_backdrop(parent);
+    return lv_color_mix(color, quality_backdrop(parent), opa);
+}
+
+static void quality_snap_obj(lv_obj_t* obj)
+{
+    static const lv_style_prop_t props[] = {LV_STYLE_BG_OPA, LV_STYLE_BORDER_OPA,
+                                            LV_STYLE_BG_IMG_OPA};
+    static const lv_style_selector_t selectors[] = {LV_PART_MAIN | LV_STATE_DEFAULT,
+                                                    LV_PART_MAIN | LV_STATE_PRESSED};
+
+    for (lv_style_selector_t selector : selectors)
+    {
+        for (lv_style_prop_t prop : props)
+        {
+            lv_style_value_t value;
+            if (lv_obj_get_local_style_prop(obj, prop, &value, selector) != LV_RES_OK)
+                continue;
+            if (value.num <= LV_OPA_TRANSP || value.num >= LV_OPA_COVER)
+                continue;
+            if (s_override_cnt == QUALITY_MAX_OVERRIDES)
+            {
+                ESP_LOGW(TAG, "Override table full, some panels stay translucent");
+                return;
+            }
+            quality_override_t* o = &s_overrides[s_override_cnt++];
+            *o                    = {obj, selector, prop, (lv_opa_t) value.num, false, {}};
+            if (prop == LV_STYLE_BG_OPA)
+            {
+                // The panel keeps its look: its colour is blended once here instead of per frame
+                lv_style_value_t color;
+                o->had_color = lv_obj_get_local_style_prop(obj, LV_STYLE_BG_COLOR, &color,
+                                                           selector) == LV_RES_OK;
+                if (!o->had_color)
+                    color.color = lv_obj_get_style_bg_color(obj, LV_PART_MAIN);
+                o->color    = color.color;
+                color.color = lv_color_mix(color.color, quality_backdrop(obj), value.num);
+                lv_obj_set_local_style_prop(obj, LV_STYLE_BG_COLOR, color, selector);
+                value.num = LV_OPA_COVER;
+            }
+            else
+            {
+                // A faint wallpaper is the single most expensive blend, drop it entirely
+                value.num = prop == LV_STYLE_BORDER_OPA && value.num >= LV_OPA_50 ? LV_OPA_COVER
+                                                                                  : LV_OPA_TRANSP;
+            }
+            lv_obj_set_local_style_prop(obj, prop, value, selector);
+        }
+    }
+
+    const uint32_t child_cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < child_cnt; i++)
+        quality_snap_obj(lv_obj_get_child(obj, i));
+}
+
+static void quality_set_opaque(bool opaque)
+{
+    if (opaque)
+    {
+        lv_disp_t* disp = lv_disp_get_default();
+        for (uint32_t i = 0; i < disp->screen_cnt; i++)
+            quality_snap_obj(disp->screens[i]);
+        return;
+    }
+
+    for (uint32_t i = 0; i < s_override_cnt; i++)
+    {
+        quality_override_t* o = &s_overrides[i];
+        if (!lv_obj_is_valid(o->obj))
+            continue;
+        lv_style_value_t value;
+        value.num = o->opa;
+        lv_obj_set_local_style_prop(o->obj, o->prop, value, o->selector);
+        if (o->prop != LV_STYLE_BG_OPA)
+            continue;
+        if (o->had_color)
+        {
+            value.color = o->color;
+            lv_obj_set_local_style_prop(o->obj, LV_STYLE_BG_COLOR, value, o->selector);
+        }
+        else
+        {
+            lv_obj_remove_local_style_prop(o->obj, LV_STYLE_BG_COLOR, o->selector);
+        }
+    }
+    s_override_cnt = 0;
+}
+
+static void quality_apply(quality_tier_t tier)
+{
+    const quality_tier_t old  = s_applied_tier;
+    lv_disp_t*           disp = lv_disp_get_default();
+
+    if ((old >= QUALITY_TIER_OPAQUE) != (tier >= QUALITY_TIER_OPAQUE))
+        quality_set_opaque(tier >= QUALITY_TIER_OPAQUE);
+    if ((old >= QUALITY_TIER_NO_AA) != (tier >= QUALITY_TIER_NO_AA))
+    {
+        disp->driver->antialiasing = tier < QUALITY_TIER_NO_AA;
+        lv_obj_invalidate(lv_scr_act());
+    }
+
+    s_applied_tier = tier;
+    ESP_LOGI(TAG, "Render quality %s -> %s", tier_names[old], tier_names[tier]);
+}
+
+void quality_governor_frame_done(uint32_t frame_ms, uint32_t px)
+{
+    const quality_tier_t tier = quality_governor_feed(frame_ms, px);
+    if (tier != s_applied_tier)
+        quality_apply(tier);
+}
+
+quality_tier_t quality_governor_get_tier(void)
+{
+    return s_tier;
+}
+
+const char* quality_governor_tier_name(quality_tier_t tier)
+{
+    return tier < QUALITY_TIER_MAX ? tier_names[tier] : "?";
+}
+
+extern "C" void __real__ui_screen_change(lv_obj_t** target, lv_scr_load_anim_t fademode, int spd,
+                                         int delay, void (*target_init)(void));
+
+extern "C" void __wrap__ui_screen_change(lv_obj_t** target, lv_scr_load_anim_t fademode, int spd,
+                                         int delay, void (*target_init)(void))
+{
+    if (s_applied_tier >= QUALITY_TIER_NO_TRANSITIONS)
+    {
+        fademode = LV_SCR_LOAD_ANIM_NONE;
+        spd      = 0;
+    }
+    __real__ui_screen_change(target, fademode, spd, delay, target_init);
+}
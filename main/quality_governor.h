@@ -0,0 +1,27 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <stdint.h>
+
+// Each tier keeps the savings of the tiers above it
+typedef enum
+{
+    QUALITY_TIER_FULL = 0,
+    QUALITY_TIER_NO_TRANSITIONS, // Screens load without the 500 ms fade
+    QUALITY_TIER_OPAQUE,         // Translucent panels turn opaque in their blended colour,
+                                 // wallpapers are dropped
+    QUALITY_TIER_NO_AA,          // Anti-aliasing off, mostly for the progress arc
+    QUALITY_TIER_MAX,
+} quality_tier_t;
+
+// Feeds the render time of one refresh. Returns the tier the UI should be rendered at. Pure
+// bookkeeping, no LVGL calls, so it can be driven with synthetic frame times.
+quality_tier_t quality_governor_feed(uint32_t frame_ms, uint32_t px);
+
+// Called from the LVGL monitor_cb, feeds the frame and applies tier changes to the UI
+void quality_governor_frame_done(uint32_t frame_ms, uint32_t px);
+
+quality_tier_t quality_governor_get_tier(void);
+const char*    quality_governor_tier_name(quality_tier_t tier);
+
+#endif
@@ -0,0 +1,239 @@
+// Adaptive refresh rate. LVGL refreshes at a fixed CONFIG_LV_DISP_DEF_REFR_PERIOD, but the UI
+// only needs a high rate while something moves. The governor picks the period of the display
+// refresh timer from the running animations, the input activity and the scheduled data updates.
+
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "refresh_governor.h"
+#include "user_config.h"
+
+static const char* TAG = "refr_governor";
+
+static const char* const state_names[REFRESH_GOVERNOR_STATE_MAX] = {"active", "settling", "idle"};
+
+static lv_disp_t*               s_disp        = NULL;
+static uint32_t                 s_data_period = EXAMPLE_REFR_IDLE_PERIOD_MS;
+static int64_t                  s_last_us     = 0;
+static float                    s_ticks       = 0;
+static refresh_governor_stats_t s_stats;
+
+// Invalidations of the current period of the fixed rate timer, as LVGL would have buffered them
+static lv_area_t s_fixed_areas[LV_INV_BUF_SIZE];
+static uint8_t   s_fixed_num  = 0;
+static int64_t   s_fixed_tick = 0;
+
+static void refresh_governor_apply(refresh_governor_state_t state)
+{
+    uint32_t period = EXAMPLE_REFR_ACTIVE_PERIOD_MS;
+    if (state == REFRESH_GOVERNOR_SETTLING)
+        period = EXAMPLE_REFR_SETTLE_PERIOD_MS;
+    else if (state == REFRESH_GOVERNOR_IDLE)
+        period = LV_MIN(EXAMPLE_REFR_IDLE_PERIOD_MS, s_data_period);
+
+    if (state != s_stats.state)
+        ESP_LOGD(TAG, "%s -> %s, %" PRIu32 " ms", state_names[s_stats.state], state_names[state],
+                 period);
+    s_stats.state = state;
+    if (period != s_stats.period_ms)
+    {
+        s_stats.period_ms = period;
+        lv_timer_set_period(s_disp->refr_timer, period);
+    }
+}
+
+// Bytes a refresh at the end of the fixed period would render, the areas joined as lv_refr joins
+static uint32_t refresh_governor_fixed_size(void)
+{
+    lv_area_t areas[LV_INV_BUF_SIZE];
+    bool      joined[LV_INV_BUF_SIZE] = {};
+    for (int i = 0; i < s_fixed_num; i++)
+        areas[i] = s_fixed_areas[i];
+    for (int in = 0; in < s_fixed_num; in++)
+    {
+        if (joined[in])
+            continue;
+        for (int from = 0; from < s_fixed_num; from++)
+        {
+            if (joined[from] || in == from || !_lv_area_is_on(&areas[in], &areas[from]))
+                continue;
+            lv_area_t area;
+            _lv_area_join(&area, &areas[in], &areas[from]);
+            if (lv_area_get_size(&area) <
+                lv_area_get_size(&areas[in]) + lv_area_get_size(&areas[from]))
+            {
+                areas[in]    = area;
+                joined[from] = true;
+            }
+        }
+    }
+    uint32_t size = 0;
+    for (int i = 0; i < s_fixed_num; i++)
+        if (!joined[i])
+            size += lv_area_get_size(&areas[i]);
+    return size * sizeof(lv_color_t);
+}
+
+static bool refresh_governor_input_busy(void)
+{
+    for (lv_indev_t* indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev))
+    {
+        // A throw keeps scrolling after the finger is lifted
+        if (indev->proc.state == LV_INDEV_STATE_PRESSED || lv_indev_get_scroll_obj(indev))
+            return true;
+    }
+    return false;
+}
+
+void refresh_governor_init(lv_disp_t* disp)
+{
+    s_disp = disp;
+    // Animations only run in the active state, keep them on the same cadence as the refresh
+    lv_timer_set_period(lv_anim_get_timer(), EXAMPLE_REFR_ACTIVE_PERIOD_MS);
+    s_stats.state     = REFRESH_GOVERNOR_ACTIVE;
+    s_stats.period_ms = 0;
+    refresh_governor_apply(REFRESH_GOVERNOR_ACTIVE);
+    refresh_governor_session_start();
+}
+
+void refresh_governor_update(uint32_t handler_us)
+{
+    const int64_t now     = esp_timer_get_time();
+    const int64_t elapsed = now - s_last_us;
+    s_last_us             = now;
+
+    s_stats.session_us += elapsed;
+    s_stats.state_us[s_stats.state] += elapsed;
+    s_stats.busy_us += handler_us;
+    s_ticks += (float) elapsed / (s_stats.period_ms * 1000);
+
+    refresh_governor_state_t state = REFRESH_GOVERNOR_IDLE;
+    if (lv_anim_count_running() > 0 || refresh_governor_input_busy())
+        state = REFRESH_GOVERNOR_ACTIVE;
+    else if (lv_disp_get_inactive_time(s_disp) < EXAMPLE_REFR_SETTLE_TIME_MS)
+        state = REFRESH_GOVERNOR_SETTLING;
+    refresh_governor_apply(state);
+
+#if EXAMPLE_REFR_SESSION_MS
+    if (s_stats.session_us >= EXAMPLE_REFR_SESSION_MS * 1000LL)
+    {
+        refresh_governor_session_report();
+        refresh_governor_session_start();
+    }
+#endif
+}
+
+void refresh_governor_input(void)
+{
+    if (s_stats.state == REFRESH_GOVERNOR_ACTIVE)
+        return;
+    refresh_governor_apply(REFRESH_GOVERNOR_ACTIVE);
+    lv_timer_ready(s_disp->refr_timer);
+}
+
+refresh_governor_state_t refresh_governor_get_state(void)
+{
+    return s_stats.state;
+}
+
+void refresh_governor_request_frame(void)
+{
+    lv_timer_ready(s_disp->refr_timer);
+}
+
+void refresh_governor_set_data_period(uint32_t period_ms)
+{
+    s_data_period = period_ms ? period_ms : EXAMPLE_REFR_IDLE_PERIOD_MS;
+}
+
+void refresh_governor_note_invalidate(const lv_area_t* area)
+{
+    s_stats.invalidated_bytes += lv_area_get_size(area) * sizeof(lv_color_t);
+
+    const int64_t tick = esp_timer_get_time() / (CONFIG_LV_DISP_DEF_REFR_PERIOD * 1000);
+    if (tick != s_fixed_tick && s_fixed_num)
+    {
+        s_stats.fixed_bytes += refresh_governor_fixed_size();
+        s_stats.fixed_frames++;
+        s_fixed_num = 0;
+    }
+    s_fixed_tick = tick;
+    // Same buffering as _lv_inv_area(): covered areas are dropped, a full buffer takes the screen
+    for (int i = 0; i < s_fixed_num; i++)
+        if (_lv_area_is_in(area, &s_fixed_areas[i], 0))
+            return;
+    if (s_fixed_num == LV_INV_BUF_SIZE)
+    {
+        lv_area_set(&s_fixed_areas[0], 0, 0, lv_disp_get_hor_res(s_disp) - 1,
+                    lv_disp_get_ver_res(s_disp) - 1);
+        s_fixed_num = 1;
+        return;
+    }
+    s_fixed_areas[s_fixed_num++] = *area;
+}
+
+void refresh_governor_note_flush(uint32_t bytes)
+{
+    s_stats.flushed_bytes += bytes;
+}
+
+void refresh_governor_frame_done(uint32_t render_ms, uint32_t px)
+{
+    s_stats.frames++;
+    s_stats.render_us += render_ms * 1000;
+    s_stats.refreshed_bytes += (uint64_t) px * sizeof(lv_color_t);
+}
+
+void refresh_governor_session_start(void)
+{
+    const refresh_governor_state_t state  = s_stats.state;
+    const uint32_t                 period = s_stats.period_ms;
+    s_stats                               = {};
+    s_stats.state                         = state;
+    s_stats.period_ms                     = period;
+    s_ticks                               = 0;
+    s_last_us                             = esp_timer_get_time();
+    s_fixed_num                           = 0;
+}
+
+void refresh_governor_get_stats(refresh_governor_stats_t* stats)
+{
+    *stats             = s_stats;
+    stats->refr_ticks  = (uint32_t) s_ticks;
+    stats->fixed_ticks =
+        (uint32_t) (s_stats.session_us / (CONFIG_LV_DISP_DEF_REFR_PERIOD * 1000));
+    // The period still open counts as refreshed
+    if (s_fixed_num)
+    {
+        stats->fixed_bytes += refresh_governor_fixed_size();
+        stats->fixed_frames++;
+    }
+}
+
+void refresh_governor_session_report(void)
+{
+    refresh_governor_stats_t stats;
+    refresh_governor_get_stats(&stats);
+    if (stats.session_us == 0)
+        return;
+
+    ESP_LOGI(TAG, "Session of %" PRIu64 " ms:", stats.session_us / 1000);
+    for (int i = 0; i < REFRESH_GOVERNOR_STATE_MAX; i++)
+        ESP_LOGI(TAG, "  %-8s %3" PRIu64 "%%", state_names[i],
+                 stats.state_us[i] * 100 / stats.session_us);
+    ESP_LOGI(TAG, "  refresh timer ran %" PRIu32 " times, %" PRIu32 " at the fixed %d ms",
+             stats.refr_ticks, stats.fixed_ticks, CONFIG_LV_DISP_DEF_REFR_PERIOD);
+    ESP_LOGI(TAG, "  %" PRIu32 " frames, render %" PRIu64 " ms, LVGL busy %" PRIu64 " ms",
+             stats.frames, stats.render_us / 1000, stats.busy_us / 1000);
+    ESP_LOGI(TAG, "  rendered %" PRIu64 " bytes, the fixed %d ms period %" PRIu32
+                  " frames and %" PRIu64 " bytes",
+             stats.refreshed_bytes, CONFIG_LV_DISP_DEF_REFR_PERIOD, stats.fixed_frames,
+             stats.fixed_bytes);
+    ESP_LOGI(TAG, "  saved %" PRId64 " frames and %" PRId64 " bytes over the fixed period",
+             (int64_t) stats.fixed_frames - stats.frames,
+             (int64_t) stats.fixed_bytes - (int64_t) stats.refreshed_bytes);
+    ESP_LOGI(TAG, "  QSPI %" PRIu64 " bytes sent, %" PRIu64 " bytes invalidated",
+             stats.flushed_bytes, stats.invalidated_bytes);
+}
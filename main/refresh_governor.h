@@ -0,0 +1,63 @@
+#ifndef REFRESH_GOVERNOR_H
+#define REFRESH_GOVERNOR_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+typedef enum
+{
+    REFRESH_GOVERNOR_ACTIVE = 0, // Animations running or finger on the screen
+    REFRESH_GOVERNOR_SETTLING,   // Shortly after the last input, scroll throw may still follow
+    REFRESH_GOVERNOR_IDLE,       // Static screen, only scheduled data updates
+    REFRESH_GOVERNOR_STATE_MAX,
+} refresh_governor_state_t;
+
+typedef struct
+{
+    refresh_governor_state_t state;
+    uint32_t                 period_ms;                               // Current refresh period
+    uint64_t                 session_us;                              // Length of the session
+    uint64_t                 state_us[REFRESH_GOVERNOR_STATE_MAX];    // Residency per state
+    uint32_t                 frames;                                  // Frames actually refreshed
+    uint32_t                 refr_ticks;                              // Refresh timer periods
+    uint32_t                 fixed_ticks;                             // Periods at the fixed rate
+    uint64_t                 busy_us;                                 // Time in lv_timer_handler
+    uint64_t                 render_us;                               // Time spent refreshing
+    uint64_t                 invalidated_bytes;                       // Bytes LVGL was asked for
+    uint64_t                 refreshed_bytes;                         // Bytes LVGL rendered
+    uint64_t                 flushed_bytes;                           // Bytes sent over QSPI
+    uint32_t                 fixed_frames;                            // Frames at the fixed rate
+    uint64_t                 fixed_bytes;                             // Bytes at the fixed rate
+} refresh_governor_stats_t;
+
+// Takes over the refresh timer of `disp`. Must be called with the LVGL lock held.
+void refresh_governor_init(lv_disp_t* disp);
+
+// Re-evaluates the refresh period, called after every lv_timer_handler run
+void refresh_governor_update(uint32_t handler_us);
+
+// Input from the touch panel or the encoder, refreshes at the active rate right away
+void refresh_governor_input(void);
+
+refresh_governor_state_t refresh_governor_get_state(void);
+
+// Data producers call this after updating widgets whose change should not wait for the next
+// idle period, e.g. when a new track starts
+void refresh_governor_request_frame(void);
+
+// Period of the most frequent scheduled data update (e.g. 1000 ms for the playback progress)
+void refresh_governor_set_data_period(uint32_t period_ms);
+
+// The invalidations are also grouped into the periods of the fixed CONFIG_LV_DISP_DEF_REFR_PERIOD
+// timer and joined as LVGL joins them, which gives the frames and bytes that timer would have
+// refreshed for the same session
+void refresh_governor_note_invalidate(const lv_area_t* area);
+void refresh_governor_note_flush(uint32_t bytes);
+void refresh_governor_frame_done(uint32_t render_ms, uint32_t px);
+
+// Restarts the statistics, everything until the next report makes up one usage session
+void refresh_governor_session_start(void);
+void refresh_governor_get_stats(refresh_governor_stats_t* stats);
+void refresh_governor_session_report(void);
+
+#endif
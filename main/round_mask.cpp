@@ -0,0 +1,250 @@
+// Visibility mask for the circular SH8601 panel. Only the circle inscribed in the
+// EXAMPLE_LCD_H_RES x EXAMPLE_LCD_V_RES frame is visible through the glass, so the corners are
+// neither rendered nor sent to the panel.
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+
+#include "round_mask.h"
+#include "user_config.h"
+
+static const char* TAG = "round_mask";
+
+typedef struct
+{
+    int16_t  x1[EXAMPLE_LCD_V_RES];
+    int16_t  x2[EXAMPLE_LCD_V_RES];
+    uint32_t visible_px;
+} round_mask_span_table_t;
+
+static constexpr uint64_t round_mask_isqrt(uint64_t v)
+{
+    uint64_t lo = 0;
+    uint64_t hi = 1ULL << 32;
+    while (lo + 1 < hi)
+    {
+        uint64_t mid = (lo + hi) / 2;
+        if (mid * mid <= v)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// A pixel is visible when its centre lies inside the ellipse inscribed in the panel. Working in
+// doubled coordinates keeps the test exact: (2x+1-W)^2 * H^2 + (2y+1-H)^2 * W^2 <= W^2 * H^2
+static constexpr round_mask_span_table_t round_mask_build_spans()
+{
+    const int64_t           w = EXAMPLE_LCD_H_RES;
+    const int64_t           h = EXAMPLE_LCD_V_RES;
+    round_mask_span_table_t t = {};
+    for (int y = 0; y < EXAMPLE_LCD_V_RES; y++)
+    {
+        const int64_t dy  = 2 * y + 1 - h;
+        const int64_t rem = w * w * h * h - dy * dy * w * w;
+        t.x1[y]           = 0;
+        t.x2[y]           = -1;
+        if (rem < 0)
+            continue;
+        // Largest |2x+1-W| that is still inside the ellipse
+        const int64_t dx = (int64_t) round_mask_isqrt((uint64_t) (rem / (h * h)));
+        int64_t       x1 = (w - dx) / 2;
+        int64_t       x2 = (w - 1 + dx) / 2;
+        if (x2 > w - 1)
+            x2 = w - 1;
+        if (x1 > x2)
+            continue;
+        t.x1[y] = (int16_t) x1;
+        t.x2[y] = (int16_t) x2;
+        t.visible_px += (uint32_t) (x2 - x1 + 1);
+    }
+    return t;
+}
+
+static constexpr round_mask_span_table_t s_spans = round_mask_build_spans();
+static_assert(s_spans.visible_px > 0 &&
+                  s_spans.visible_px <= (uint32_t) EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES,
+              "round mask span table is empty");
+static_assert(EXAMPLE_ROUND_MASK_BAND_ROWS % 2 == 0,
+              "the SH8601 needs windows that start and end on even rows");
+
+static round_mask_frame_stats_t s_frame;
+static round_mask_stats_t       s_stats;
+// The blend of the draw context before round_mask_wrap_blend()
+static void (*s_blend)(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc);
+
+void round_mask_row_span(int y, int16_t* x1, int16_t* x2)
+{
+    if (y < 0 || y >= EXAMPLE_LCD_V_RES)
+    {
+        *x1 = 0;
+        *x2 = -1;
+        return;
+    }
+    *x1 = s_spans.x1[y];
+    *x2 = s_spans.x2[y];
+}
+
+// The visible width only grows towards the centre row, so the widest span of [y1, y2] is the
+// one of the row closest to the centre.
+static void round_mask_rows_bbox(int y1, int y2, int16_t* x1, int16_t* x2)
+{
+    const int centre = EXAMPLE_LCD_V_RES / 2;
+    int       y      = centre;
+    if (y2 < centre)
+        y = y2;
+    else if (y1 > centre)
+        y = y1;
+    round_mask_row_span(y, x1, x2);
+}
+
+void round_mask_clip_area(lv_area_t* area)
+{
+    int16_t x1;
+    int16_t x2;
+    round_mask_rows_bbox(area->y1, area->y2, &x1, &x2);
+    // Fully hidden areas are kept as they are, LVGL can't drop an invalidated area here
+    if (x1 > x2 || x2 < area->x1 || x1 > area->x2)
+        return;
+    if (area->x1 < x1)
+        area->x1 = x1;
+    if (area->x2 > x2)
+        area->x2 = x2;
+}
+
+// Bounding box of the visible pixels of `area`. False when none of them is visible.
+static bool round_mask_visible_bbox(lv_area_t* area)
+{
+    int16_t x1;
+    int16_t x2;
+    int32_t y1 = area->y1;
+    int32_t y2 = area->y2;
+    // Spans only widen towards the centre, so the hidden rows are at the ends
+    for (; y1 <= y2; y1++)
+    {
+        round_mask_row_span(y1, &x1, &x2);
+        if (x1 <= x2 && x2 >= area->x1 && x1 <= area->x2)
+            break;
+    }
+    for (; y2 > y1; y2--)
+    {
+        round_mask_row_span(y2, &x1, &x2);
+        if (x1 <= x2 && x2 >= area->x1 && x1 <= area->x2)
+            break;
+    }
+    if (y1 > y2)
+        return false;
+    round_mask_rows_bbox(y1, y2, &x1, &x2);
+    area->x1 = LV_MAX(area->x1, x1);
+    area->x2 = LV_MIN(area->x2, x2);
+    area->y1 = y1;
+    area->y2 = y2;
+    return true;
+}
+
+// Runs for every blend, after lv_refr has pointed buf_area and clip_area at the stripe being
+// rendered. The narrowed clip only lives for the one blend.
+static void round_mask_blend(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc)
+{
+    lv_disp_t* disp = _lv_refr_get_disp_refreshing();
+    lv_area_t  clip;
+    // Layers are drawn in their own buffer and may be transformed when blended to the screen,
+    // only the draw buffer of the display is in panel coordinates
+    if (draw_ctx->buf != disp->driver->draw_buf->buf_act)
+    {
+        s_blend(draw_ctx, dsc);
+        return;
+    }
+    if (!_lv_area_intersect(&clip, dsc->blend_area, draw_ctx->clip_area))
+        return;
+    s_frame.px_blend += lv_area_get_size(&clip);
+    if (!round_mask_visible_bbox(&clip))
+        return;
+    s_frame.px_rendered += lv_area_get_size(&clip);
+
+    const lv_area_t* clip_area = draw_ctx->clip_area;
+    draw_ctx->clip_area        = &clip;
+    s_blend(draw_ctx, dsc);
+    draw_ctx->clip_area = clip_area;
+}
+
+void round_mask_wrap_blend(lv_draw_ctx_t* draw_ctx)
+{
+    lv_draw_sw_ctx_t* sw_ctx = (lv_draw_sw_ctx_t*) draw_ctx;
+    s_blend                  = sw_ctx->blend;
+    sw_ctx->blend            = round_mask_blend;
+}
+
+int round_mask_pack_bands(const lv_area_t* area, uint8_t* buf, size_t px_size,
+                          round_mask_band_t* bands, int max_bands)
+{
+    const int32_t area_w = lv_area_get_width(area);
+    uint8_t*      dst    = buf;
+    int           count  = 0;
+
+    s_frame.px_full += lv_area_get_size(area);
+    int32_t by = area->y1;
+    while (by <= area->y2 && count < max_bands)
+    {
+        int32_t by2 = by + EXAMPLE_ROUND_MASK_BAND_ROWS - 1;
+        // The last available band takes whatever is left of the area
+        if (by2 > area->y2 || count == max_bands - 1)
+            by2 = area->y2;
+        const int32_t y1 = by;
+        by               = by2 + 1;
+
+        int16_t x1;
+        int16_t x2;
+        round_mask_rows_bbox(y1, by2, &x1, &x2);
+        if (x1 > x2 || x2 < area->x1 || x1 > area->x2)
+            continue;
+        // Keep the even alignment set up by the rounder
+        int32_t bx1 = LV_MAX(area->x1, x1 & ~1);
+        int32_t bx2 = LV_MIN(area->x2, x2 | 1);
+
+        round_mask_band_t* band = &bands[count++];
+        band->area.x1           = bx1;
+        band->area.y1           = y1;
+        band->area.x2           = bx2;
+        band->area.y2           = by2;
+        band->data              = dst;
+
+        // Rows are compacted towards the start of the buffer, so dst never overtakes the source
+        const size_t row_bytes = (bx2 - bx1 + 1) * px_size;
+        for (int32_t y = y1; y <= by2; y++)
+        {
+            const uint8_t* src = buf + ((y - area->y1) * area_w + (bx1 - area->x1)) * px_size;
+            if (src != dst)
+                memmove(dst, src, row_bytes);
+            dst += row_bytes;
+        }
+        s_frame.px_sent += lv_area_get_size(&band->area);
+    }
+    return count;
+}
+
+void round_mask_frame_done(void)
+{
+    if (s_frame.px_full == 0 && s_frame.px_blend == 0)
+        return;
+
+    s_stats.frames++;
+    s_stats.last_frame = s_frame;
+    s_stats.total_px_full += s_frame.px_full;
+    s_stats.total_px_blend += s_frame.px_blend;
+    s_stats.total_px_rendered += s_frame.px_rendered;
+    s_stats.total_px_sent += s_frame.px_sent;
+    ESP_LOGD(TAG, "frame %" PRIu32 ": blended %" PRIu32 "/%" PRIu32 " px, sent %" PRIu32
+                  "/%" PRIu32 " px",
+             s_stats.frames, s_frame.px_rendered, s_frame.px_blend, s_frame.px_sent,
+             s_frame.px_full);
+    memset(&s_frame, 0, sizeof(s_frame));
+}
+
+void round_mask_get_stats(round_mask_stats_t* stats)
+{
+    *stats            = s_stats;
+    stats->visible_px = s_spans.visible_px;
+}
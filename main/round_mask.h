@@ -0,0 +1,54 @@
+#ifndef ROUND_MASK_H
+#define ROUND_MASK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// A rectangular window of the panel sent as one contiguous transfer
+typedef struct
+{
+    lv_area_t area;
+    uint8_t*  data;
+} round_mask_band_t;
+
+typedef struct
+{
+    uint32_t px_full;     // Pixels of the flushed areas
+    uint32_t px_blend;    // Pixels LVGL blended into the draw buffer, overdraw included
+    uint32_t px_rendered; // The part of px_blend the mask let through
+    uint32_t px_sent;     // Pixels sent over QSPI
+} round_mask_frame_stats_t;
+
+typedef struct
+{
+    uint32_t                 visible_px; // Visible pixels of the whole panel
+    uint32_t                 frames;
+    round_mask_frame_stats_t last_frame;
+    uint64_t                 total_px_full;
+    uint64_t                 total_px_blend;
+    uint64_t                 total_px_rendered;
+    uint64_t                 total_px_sent;
+} round_mask_stats_t;
+
+// Visible [x1, x2] columns of row y
+void round_mask_row_span(int y, int16_t* x1, int16_t* x2);
+
+// Shrink an invalidated area to the bounding box of its visible pixels
+void round_mask_clip_area(lv_area_t* area);
+
+// Called from the draw_ctx_init of the display once the draw context is set up. Wraps its blend,
+// so every blend into the draw buffer is clipped to the visible pixels of the current stripe.
+void round_mask_wrap_blend(lv_draw_ctx_t* draw_ctx);
+
+// Packs the visible part of a flushed area into bands in place. `px_size` is the size of a
+// pixel in `buf`. Returns the number of bands written to `bands` (at most `max_bands`).
+int round_mask_pack_bands(const lv_area_t* area, uint8_t* buf, size_t px_size,
+                          round_mask_band_t* bands, int max_bands);
+
+// Called from the LVGL monitor_cb, closes the statistics of the frame that was just refreshed
+void round_mask_frame_done(void);
+
+void round_mask_get_stats(round_mask_stats_t* stats);
+
+#endif
@@ -0,0 +1,401 @@
+// Scroll acceleration for the full-screen list containers. A copy of what was sent to the panel
+// is kept in PSRAM as a ring of rows. When a list scrolls, the ring is rotated instead of
+// re-rendering the list, the shifted rows are sent from the copy, and LVGL only renders the
+// newly exposed rows plus whatever can't be shifted (round mask edges, overlays, scrollbar).
+//
+// A shift is only correct when the whole screen moves rigidly, so it is skipped while the screen
+// shows a wallpaper (e.g. until the quality governor drops it) or while a screen is loading.
+//
+// The copy is only kept while an attached container that can be shifted scrolls. Every other
+// flush skips it. The first step of a scroll invalidates the whole container, which is the whole
+// screen, so the frame it renders fills the ring and the shifts start with the second step.
+
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "scroll_blit.h"
+#include "user_config.h"
+#if EXAMPLE_USE_ROUND_MASK
+#include "round_mask.h"
+#endif
+#if EXAMPLE_USE_DMA_COPY
+#include "dma_copy.h"
+#endif
+
+static const char* TAG = "scroll_blit";
+
+static_assert(sizeof(lv_color_t) == 2, "the retained framebuffer stores RGB565");
+static_assert(EXAMPLE_SCROLL_BLIT_BAND_ROWS % 2 == 0,
+              "the SH8601 needs windows that start and end on even rows");
+
+#define SCROLL_BLIT_MAX_CONTAINERS 4
+#define SCROLL_BLIT_EDGE_ROWS      45 // Rows merged into one round mask edge invalidation
+
+typedef struct
+{
+    lv_obj_t*  obj;
+    lv_coord_t scroll_y;
+} scroll_blit_container_t;
+
+static scroll_blit_draw_fn     s_draw    = NULL;
+static scroll_blit_done_fn     s_done    = NULL;
+static lv_color_t*             s_shadow  = NULL;
+static int32_t                 s_offset  = 0; // Screen row y is ring row (y + s_offset) % V_RES
+static lv_color_t*             s_bounce[2];
+static uint32_t                s_bounce_seq[2];
+static bool                    s_enabled = true;
+static bool                    s_scrolling;
+static bool                    s_armed;  // Flushes are copied into the ring
+static bool                    s_synced; // The ring holds what is on the panel
+static uint32_t                s_stored_px;
+static bool                    s_suppress_pending;
+static lv_area_t               s_suppress;
+static lv_area_t               s_exposed;
+static bool                    s_blitted;
+static int64_t                 s_blit_us;
+static scroll_blit_container_t s_containers[SCROLL_BLIT_MAX_CONTAINERS];
+static uint32_t                s_container_cnt;
+static scroll_blit_stats_t     s_stats;
+#if EXAMPLE_USE_DMA_COPY
+static SemaphoreHandle_t s_fetch_done = NULL; // Given once per DMA copy out of the ring
+#endif
+
+static inline lv_color_t* scroll_blit_row(int32_t y)
+{
+    return s_shadow + ((y + s_offset) % EXAMPLE_LCD_V_RES) * EXAMPLE_LCD_H_RES;
+}
+
+bool scroll_blit_init(scroll_blit_draw_fn draw, scroll_blit_done_fn done)
+{
+    const size_t bounce_size =
+        EXAMPLE_LCD_H_RES * EXAMPLE_SCROLL_BLIT_BAND_ROWS * sizeof(lv_color_t);
+
+    s_draw   = draw;
+    s_done   = done;
+    s_shadow = (lv_color_t*) heap_caps_calloc(EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES,
+                                              sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    for (int i = 0; i < 2; i++)
+        s_bounce[i] = (lv_color_t*) heap_caps_malloc(bounce_size, MALLOC_CAP_DMA);
+#if EXAMPLE_USE_DMA_COPY
+    // A band wraps around the end of the ring at most once
+    s_fetch_done = xSemaphoreCreateCounting(2, 0);
+    assert(s_fetch_done);
+#endif
+    if (!s_shadow || !s_bounce[0] || !s_bounce[1])
+    {
+        ESP_LOGE(TAG, "Not enough memory for the retained framebuffer");
+        heap_caps_free(s_shadow);
+        heap_caps_free(s_bounce[0]);
+        heap_caps_free(s_bounce[1]);
+        s_shadow = NULL;
+        return false;
+    }
+    return true;
+}
+
+void scroll_blit_set_enabled(bool enabled)
+{
+    s_enabled = enabled;
+}
+
+void scroll_blit_store(const lv_area_t* area, const lv_color_t* color_map)
+{
+    if (!s_armed)
+        return;
+    const int32_t w = lv_area_get_width(area);
+    for (int32_t y = area->y1; y <= area->y2; y++)
+        memcpy(scroll_blit_row(y) + area->x1, color_map + (y - area->y1) * w,
+               w * sizeof(lv_color_t));
+    s_stored_px += lv_area_get_size(area);
+}
+
+static bool scroll_blit_eligible(lv_obj_t* obj)
+{
+    lv_disp_t* disp = lv_obj_get_disp(obj);
+    lv_obj_t*  scr  = lv_obj_get_screen(obj);
+    lv_area_t  coords;
+
+    if (!s_enabled || !s_shadow)
+        return false;
+    if (scr != lv_disp_get_scr_act(disp) || disp->scr_to_load)
+        return false;
+    lv_obj_get_coords(obj, &coords);
+    if (coords.x1 > 0 || coords.y1 > 0 || coords.x2 < EXAMPLE_LCD_H_RES - 1 ||
+        coords.y2 < EXAMPLE_LCD_V_RES - 1)
+        return false;
+    // Whatever is behind the list has to be a plain color, otherwise it doesn't move along
+    if (lv_obj_get_style_bg_opa(scr, LV_PART_MAIN) < LV_OPA_COVER ||
+        lv_obj_get_style_bg_grad_dir(scr, LV_PART_MAIN) != LV_GRAD_DIR_NONE)
+        return false;
+    if (lv_obj_get_style_bg_img_src(scr, LV_PART_MAIN) &&
+        lv_obj_get_style_bg_img_opa(scr, LV_PART_MAIN) > LV_OPA_TRANSP)
+        return false;
+    if (lv_obj_get_style_bg_opa(obj, LV_PART_MAIN) > LV_OPA_TRANSP ||
+        lv_obj_get_style_bg_img_src(obj, LV_PART_MAIN))
+        return false;
+    return true;
+}
+
+#if EXAMPLE_USE_DMA_COPY
+static bool IRAM_ATTR scroll_blit_fetch_done(void* arg)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(s_fetch_done, &woken);
+    return woken == pdTRUE;
+}
+#endif
+
+// Copies the rows of `band` out of the ring into `dst`. The GDMA does the copy where it can, the
+// LVGL task blocks meanwhile instead of spinning in memcpy.
+static void scroll_blit_fetch(lv_color_t* dst, const lv_area_t* band)
+{
+    const int32_t w      = lv_area_get_width(band);
+    int           queued = 0;
+    for (int32_t y = band->y1; y <= band->y2;)
+    {
+        const int32_t ring_y = (y + s_offset) % EXAMPLE_LCD_V_RES;
+        const int32_t rows   = LV_MIN(band->y2 - y + 1, EXAMPLE_LCD_V_RES - ring_y);
+#if EXAMPLE_USE_DMA_COPY
+        queued += dma_copy_2d(dst, w * sizeof(lv_color_t), scroll_blit_row(y) + band->x1,
+                              EXAMPLE_LCD_H_RES * sizeof(lv_color_t), w * sizeof(lv_color_t), rows,
+                              scroll_blit_fetch_done, NULL);
+#else
+        for (int32_t r = 0; r < rows; r++)
+            memcpy(dst + r * w, scroll_blit_row(y + r) + band->x1, w * sizeof(lv_color_t));
+#endif
+        dst += rows * w;
+        y += rows;
+    }
+#if EXAMPLE_USE_DMA_COPY
+    while (queued--)
+        xSemaphoreTake(s_fetch_done, portMAX_DELAY);
+#else
+    (void) queued;
+#endif
+}
+
+// Sends rows [y1, y2] from the retained framebuffer, ping-ponging between two bounce buffers
+static void scroll_blit_send(int32_t y1, int32_t y2)
+{
+    int k = 0;
+    for (int32_t by = y1 & ~1; by <= y2; by += EXAMPLE_SCROLL_BLIT_BAND_ROWS)
+    {
+        const int32_t by2  = LV_MIN(by + EXAMPLE_SCROLL_BLIT_BAND_ROWS - 1, y2 | 1);
+        lv_area_t     band = {0, (lv_coord_t) by, EXAMPLE_LCD_H_RES - 1,
+                              (lv_coord_t) LV_MIN(by2, EXAMPLE_LCD_V_RES - 1)};
+#if EXAMPLE_USE_ROUND_MASK
+        lv_area_t visible = band;
+        round_mask_clip_area(&visible);
+        band.x1 = visible.x1 & ~1;
+        band.x2 = visible.x2 | 1;
+#endif
+        while (s_bounce_seq[k] && !s_done(s_bounce_seq[k]))
+            taskYIELD();
+
+        scroll_blit_fetch(s_bounce[k], &band);
+        s_bounce_seq[k] = s_draw(&band, s_bounce[k]);
+        k ^= 1;
+    }
+}
+
+#if EXAMPLE_USE_ROUND_MASK
+// Rows that moved into a wider part of the circle carry hidden, never rendered, pixels at their
+// ends. Those edges are rendered again.
+static void scroll_blit_inv_edges(lv_disp_t* disp, int32_t y1, int32_t y2, lv_coord_t dy)
+{
+    for (int32_t cy = y1; cy <= y2; cy += SCROLL_BLIT_EDGE_ROWS)
+    {
+        lv_area_t left  = {EXAMPLE_LCD_H_RES, (lv_coord_t) cy, -1, 0};
+        lv_area_t right = {EXAMPLE_LCD_H_RES, (lv_coord_t) cy, -1, 0};
+        for (int32_t y = cy; y <= LV_MIN(cy + SCROLL_BLIT_EDGE_ROWS - 1, y2); y++)
+        {
+            int16_t dx1, dx2, sx1, sx2;
+            round_mask_row_span(y, &dx1, &dx2);
+            round_mask_row_span(y - dy, &sx1, &sx2);
+            if (sx1 > dx1)
+            {
+                left.x1 = LV_MIN(left.x1, dx1);
+                left.x2 = LV_MAX(left.x2, sx1 - 1);
+                left.y2 = y;
+            }
+            if (sx2 < dx2)
+            {
+                right.x1 = LV_MIN(right.x1, sx2 + 1);
+                right.x2 = LV_MAX(right.x2, dx2);
+                right.y2 = y;
+            }
+        }
+        if (left.x1 <= left.x2)
+            _lv_inv_area(disp, &left);
+        if (right.x1 <= right.x2)
+            _lv_inv_area(disp, &right);
+    }
+}
+#endif
+
+static void scroll_blit_shift(lv_obj_t* obj, lv_coord_t dy)
+{
+    const int64_t start = esp_timer_get_time();
+    lv_disp_t*    disp  = lv_obj_get_disp(obj);
+
+    // Areas still waiting for a refresh show stale pixels, and those move along
+    lv_area_t      pending[LV_INV_BUF_SIZE];
+    const uint16_t pending_cnt = disp->inv_p;
+    memcpy(pending, disp->inv_areas, pending_cnt * sizeof(lv_area_t));
+
+    s_offset = ((s_offset - dy) % EXAMPLE_LCD_V_RES + EXAMPLE_LCD_V_RES) % EXAMPLE_LCD_V_RES;
+    int32_t shifted_y1 = dy > 0 ? dy : 0;
+    int32_t shifted_y2 = dy > 0 ? EXAMPLE_LCD_V_RES - 1 : EXAMPLE_LCD_V_RES - 1 + dy;
+    scroll_blit_send(shifted_y1, shifted_y2);
+
+    s_exposed.x1 = 0;
+    s_exposed.x2 = EXAMPLE_LCD_H_RES - 1;
+    s_exposed.y1 = dy > 0 ? 0 : EXAMPLE_LCD_V_RES + dy;
+    s_exposed.y2 = dy > 0 ? dy - 1 : EXAMPLE_LCD_V_RES - 1;
+    // LVGL invalidates the whole container right after LV_EVENT_SCROLL
+    lv_obj_get_coords(obj, &s_suppress);
+    lv_area_t scr_area = {0, 0, EXAMPLE_LCD_H_RES - 1, EXAMPLE_LCD_V_RES - 1};
+    _lv_area_intersect(&s_suppress, &s_suppress, &scr_area);
+    s_suppress_pending = true;
+
+    for (uint16_t i = 0; i < pending_cnt; i++)
+    {
+        lv_area_move(&pending[i], 0, dy);
+        _lv_inv_area(disp, &pending[i]);
+    }
+#if EXAMPLE_USE_ROUND_MASK
+    scroll_blit_inv_edges(disp, shifted_y1, shifted_y2, dy);
+#endif
+
+    lv_area_t hor;
+    lv_area_t ver;
+    lv_obj_get_scrollbar_area(obj, &hor, &ver);
+    if (lv_area_get_width(&ver) > 0 && lv_area_get_height(&ver) > 0)
+    {
+        ver.y1 = s_suppress.y1;
+        ver.y2 = s_suppress.y2;
+        _lv_inv_area(disp, &ver);
+    }
+
+    // Objects drawn on top of the list don't move: render their old ghost and their own area
+    lv_obj_t*      parent = lv_obj_get_parent(obj);
+    const uint32_t cnt    = lv_obj_get_child_cnt(parent);
+    for (uint32_t i = lv_obj_get_index(obj) + 1; i < cnt; i++)
+    {
+        lv_obj_t* sibling = lv_obj_get_child(parent, i);
+        if (lv_obj_has_flag(sibling, LV_OBJ_FLAG_HIDDEN))
+            continue;
+        lv_area_t area;
+        lv_obj_get_coords(sibling, &area);
+        const lv_coord_t ext = _lv_obj_get_ext_draw_size(sibling);
+        lv_area_increase(&area, ext, ext);
+        _lv_inv_area(disp, &area);
+        lv_area_move(&area, 0, dy);
+        _lv_inv_area(disp, &area);
+    }
+
+    s_blitted = true;
+    s_blit_us += esp_timer_get_time() - start;
+}
+
+static void scroll_blit_report(void)
+{
+    if (s_stats.blit_frames == 0 || s_stats.full_frames == 0)
+        return;
+    ESP_LOGI(TAG, "Scroll frames: shifted %" PRIu64 " us / %" PRIu64 " px, regular %" PRIu64
+                  " us / %" PRIu64 " px",
+             s_stats.blit_us / s_stats.blit_frames, s_stats.blit_px / s_stats.blit_frames,
+             s_stats.full_us / s_stats.full_frames, s_stats.full_px / s_stats.full_frames);
+#if EXAMPLE_USE_DMA_COPY
+    dma_copy_report();
+#endif
+}
+
+static void scroll_blit_event_cb(lv_event_t* e)
+{
+    lv_obj_t*                obj  = lv_event_get_target(e);
+    scroll_blit_container_t* c    = (scroll_blit_container_t*) lv_event_get_user_data(e);
+    const lv_event_code_t    code = lv_event_get_code(e);
+    const lv_coord_t         sy   = lv_obj_get_scroll_y(obj);
+    const lv_coord_t         dy   = c->scroll_y - sy;
+
+    c->scroll_y = sy;
+    if (code == LV_EVENT_SCROLL_BEGIN)
+    {
+        s_scrolling = true;
+        s_armed     = scroll_blit_eligible(obj);
+        s_synced    = false;
+    }
+    else if (code == LV_EVENT_SCROLL_END)
+    {
+        s_scrolling = false;
+        s_armed     = false;
+        scroll_blit_report();
+    }
+    else if (dy != 0)
+    {
+        s_suppress_pending = false;
+        // E.g. a screen load started while the list still moved
+        if (s_armed && !scroll_blit_eligible(obj))
+            s_armed = false;
+        if (s_armed && s_synced && LV_ABS(dy) < EXAMPLE_LCD_V_RES / 2)
+            scroll_blit_shift(obj, dy);
+    }
+}
+
+void scroll_blit_attach(lv_obj_t* container)
+{
+    if (s_container_cnt == SCROLL_BLIT_MAX_CONTAINERS)
+    {
+        ESP_LOGW(TAG, "Too many scroll containers");
+        return;
+    }
+    scroll_blit_container_t* c = &s_containers[s_container_cnt++];
+    c->obj                     = container;
+    c->scroll_y                = lv_obj_get_scroll_y(container);
+    lv_obj_add_event_cb(container, scroll_blit_event_cb, LV_EVENT_SCROLL_BEGIN, c);
+    lv_obj_add_event_cb(container, scroll_blit_event_cb, LV_EVENT_SCROLL, c);
+    lv_obj_add_event_cb(container, scroll_blit_event_cb, LV_EVENT_SCROLL_END, c);
+}
+
+void scroll_blit_rounder(lv_area_t* area)
+{
+    if (!s_suppress_pending || !_lv_area_is_in(&s_suppress, area, 0))
+        return;
+    s_suppress_pending = false;
+    *area              = s_exposed;
+}
+
+void scroll_blit_frame_done(uint32_t time_ms, uint32_t px)
+{
+    s_suppress_pending = false;
+    if (s_armed && s_stored_px >= EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES)
+        s_synced = true;
+    s_stored_px = 0;
+    if (s_blitted)
+    {
+        s_stats.blit_frames++;
+        s_stats.blit_us += time_ms * 1000 + s_blit_us;
+        s_stats.blit_px += px;
+    }
+    else if (s_scrolling)
+    {
+        s_stats.full_frames++;
+        s_stats.full_us += time_ms * 1000;
+        s_stats.full_px += px;
+    }
+    s_blitted = false;
+    s_blit_us = 0;
+}
+
+void scroll_blit_get_stats(scroll_blit_stats_t* stats)
+{
+    *stats = s_stats;
+}
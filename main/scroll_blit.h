@@ -0,0 +1,43 @@
+#ifndef SCROLL_BLIT_H
+#define SCROLL_BLIT_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+// Queues a color transfer of `area` and returns its sequence number
+typedef uint32_t (*scroll_blit_draw_fn)(const lv_area_t* area, const void* data);
+// Tells whether the transfer with the given sequence number is out
+typedef bool (*scroll_blit_done_fn)(uint32_t seq);
+
+typedef struct
+{
+    uint32_t blit_frames; // Scroll frames where already rendered rows were shifted
+    uint64_t blit_us;     // Refresh plus shift time of those frames
+    uint64_t blit_px;     // Pixels LVGL rendered in those frames
+    uint32_t full_frames; // Scroll frames rendered the regular way
+    uint64_t full_us;
+    uint64_t full_px;
+} scroll_blit_stats_t;
+
+// Allocates the retained framebuffer. Returns false when there is not enough memory.
+bool scroll_blit_init(scroll_blit_draw_fn draw, scroll_blit_done_fn done);
+
+// Accelerates vertical scrolling of a full-screen list container
+void scroll_blit_attach(lv_obj_t* container);
+
+// Runtime switch, mostly to compare against the regular path
+void scroll_blit_set_enabled(bool enabled);
+
+// Keeps the retained framebuffer in sync, called for every flushed area. Returns right away
+// unless an attached container that can be shifted scrolls.
+void scroll_blit_store(const lv_area_t* area, const lv_color_t* color_map);
+
+// Called from the rounder, replaces the container's full invalidation after a shift
+void scroll_blit_rounder(lv_area_t* area);
+
+// Called from the LVGL monitor_cb
+void scroll_blit_frame_done(uint32_t time_ms, uint32_t px);
+
+void scroll_blit_get_stats(scroll_blit_stats_t* stats);
+
+#endif
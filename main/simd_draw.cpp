@@ -0,0 +1,439 @@
+// Vector blend backend for LVGL's software renderer. LVGL 8 blends every pixel in the scalar
+// loops of lv_draw_sw_blend_basic(). This draw context takes over the normal blend mode: solid
+// fills, fills with opacity or an anti-aliasing mask, and images with opacity or an alpha mask.
+// The vector kernels produce exactly what lv_color_mix() would, rows are split into an aligned
+// body for the kernels and a scalar head and tail.
+
+#include <string.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_cpu.h"
+
+#include "simd_draw.h"
+#include "user_config.h"
+#if EXAMPLE_USE_PARALLEL_DRAW
+#include "parallel_draw.h"
+#endif
+
+static const char* TAG = "simd_draw";
+
+#define SIMD_DRAW_MAX_W   EXAMPLE_LCD_H_RES // Widest blend area, all draw buffers are a screen wide
+#define SIMD_DRAW_VEC_PX  8                 // Pixels per 128-bit vector
+#define SIMD_DRAW_ALIGN   16
+#define SIMD_TEST_PX      64
+#define SIMD_BENCH_PX     (EXAMPLE_LCD_H_RES * EXAMPLE_LVGL_BUF_HEIGHT) // One draw stripe
+#define SIMD_BENCH_ROUNDS 8
+
+// fg and mix either stream n values (step 16) or repeat one vector of 8 values (step 0)
+typedef void (*simd_fill_fn)(lv_color_t* dst, const lv_color_t* color, uint32_t n);
+typedef void (*simd_mix_fn)(lv_color_t* dst, const lv_color_t* fg, uint32_t fg_step,
+                            const uint16_t* mix, uint32_t mix_step, uint32_t n);
+
+typedef struct
+{
+    const char*  name;
+    simd_fill_fn fill;
+    simd_mix_fn  mix;
+} simd_draw_kernels_t;
+
+// One blend call, rows are addressed relative to y1
+typedef struct
+{
+    simd_draw_ctx_t*  ctx;
+    lv_color_t*       dest;
+    const lv_color_t* src;
+    const lv_opa_t*   mask;
+    int32_t           dest_stride;
+    int32_t           src_stride;
+    int32_t           mask_stride;
+    int32_t           y1;
+    int32_t           w;
+    lv_color_t        color;
+    lv_opa_t          opa;
+} simd_draw_job_t;
+
+#if CONFIG_IDF_TARGET_ESP32S3
+extern "C" void simd_fill_rgb565_s3(lv_color_t* dst, const lv_color_t* color, uint32_t n);
+extern "C" void simd_mix_rgb565_s3(lv_color_t* dst, const lv_color_t* fg, uint32_t fg_step,
+                                   const uint16_t* mix, uint32_t mix_step, uint32_t n);
+#endif
+
+static void simd_fill_scalar(lv_color_t* dst, const lv_color_t* color, uint32_t n)
+{
+    lv_color_fill(dst, *color, n);
+}
+
+static void simd_mix_scalar(lv_color_t* dst, const lv_color_t* fg, uint32_t fg_step,
+                            const uint16_t* mix, uint32_t mix_step, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const lv_color_t c = fg[fg_step ? i : i % SIMD_DRAW_VEC_PX];
+        const uint16_t   m = mix[mix_step ? i : i % SIMD_DRAW_VEC_PX];
+        dst[i]             = lv_color_mix(c, dst[i], (uint8_t) m);
+    }
+}
+
+static const simd_draw_kernels_t scalar_kernels = {"scalar", simd_fill_scalar, simd_mix_scalar};
+#if CONFIG_IDF_TARGET_ESP32S3
+static const simd_draw_kernels_t pie_kernels = {"PIE", simd_fill_rgb565_s3, simd_mix_rgb565_s3};
+#endif
+static const simd_draw_kernels_t* s_kernels = &scalar_kernels;
+
+// Mix value of a masked pixel as lv_draw_sw_blend_basic() computes it. Fills and images treat
+// an opacity close to cover slightly differently, keep both to stay bit-exact.
+static inline uint16_t simd_draw_mask_mix(lv_opa_t m, lv_opa_t opa, bool image)
+{
+    if (image ? opa > LV_OPA_MAX : opa >= LV_OPA_MAX)
+        return m;
+    if (image ? m >= LV_OPA_MAX : m == LV_OPA_COVER)
+        return opa;
+    return (m * opa) >> 8;
+}
+
+static void simd_draw_row(lv_color_t* fg_row, uint16_t* mix_row, lv_color_t* dst,
+                          const lv_color_t* src, lv_color_t color, const lv_opa_t* mask,
+                          lv_opa_t opa, int32_t w)
+{
+    // Pixels before the first 16 byte boundary of the destination
+    const int32_t head =
+        LV_MIN((int32_t) (((0 - (uintptr_t) dst) & (SIMD_DRAW_ALIGN - 1)) / sizeof(lv_color_t)), w);
+    const int32_t body = (w - head) & ~(SIMD_DRAW_VEC_PX - 1);
+    const int32_t tail = head + body;
+
+    alignas(SIMD_DRAW_ALIGN) lv_color_t color_vec[SIMD_DRAW_VEC_PX];
+    alignas(SIMD_DRAW_ALIGN) uint16_t   mix_vec[SIMD_DRAW_VEC_PX];
+    for (int i = 0; i < SIMD_DRAW_VEC_PX; i++)
+    {
+        color_vec[i] = color;
+        mix_vec[i]   = opa;
+    }
+
+    if (!src && !mask && opa >= LV_OPA_MAX)
+    {
+        simd_fill_scalar(dst, &color, head);
+        s_kernels->fill(dst + head, color_vec, body);
+        simd_fill_scalar(dst + tail, &color, w - tail);
+        return;
+    }
+
+    const lv_color_t* fg       = src ? src : color_vec;
+    const uint32_t    fg_step  = src ? SIMD_DRAW_ALIGN : 0;
+    const uint16_t*   mix      = mix_vec;
+    uint32_t          mix_step = 0;
+    if (mask)
+    {
+        // Shifted so that the body starts on a 16 byte boundary too
+        uint16_t* row = mix_row + ((SIMD_DRAW_VEC_PX - head) & (SIMD_DRAW_VEC_PX - 1));
+        for (int32_t i = 0; i < w; i++)
+            row[i] = simd_draw_mask_mix(mask[i], opa, src != NULL);
+        mix      = row;
+        mix_step = SIMD_DRAW_ALIGN;
+    }
+
+    const lv_color_t* body_fg = fg_step ? fg + head : fg;
+    if (fg_step && ((uintptr_t) body_fg & (SIMD_DRAW_ALIGN - 1)))
+    {
+        memcpy(fg_row, body_fg, body * sizeof(lv_color_t));
+        body_fg = fg_row;
+    }
+
+    simd_mix_scalar(dst, fg, fg_step, mix, mix_step, head);
+    s_kernels->mix(dst + head, body_fg, fg_step, mix_step ? mix + head : mix, mix_step, body);
+    simd_mix_scalar(dst + tail, fg_step ? fg + tail : fg, fg_step, mix_step ? mix + tail : mix,
+                    mix_step, w - tail);
+}
+
+static void simd_draw_rows(void* arg, int32_t y1, int32_t y2, int band)
+{
+    const simd_draw_job_t* job  = (const simd_draw_job_t*) arg;
+    const int32_t          ofs  = y1 - job->y1;
+    lv_color_t*            dest = job->dest + ofs * job->dest_stride;
+    const lv_color_t*      src  = job->src + ofs * job->src_stride;
+    const lv_opa_t*        mask = job->mask + ofs * job->mask_stride;
+
+    for (int32_t y = y1; y <= y2; y++)
+    {
+        simd_draw_row(job->ctx->fg_row[band], job->ctx->mix_row[band], dest, src, job->color,
+                      mask, job->opa, job->w);
+        dest += job->dest_stride;
+        src += job->src_stride;
+        mask += job->mask_stride;
+    }
+}
+
+static void simd_draw_blend(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc)
+{
+    simd_draw_ctx_t* ctx  = (simd_draw_ctx_t*) draw_ctx;
+    lv_disp_t*       disp = _lv_refr_get_disp_refreshing();
+
+    const lv_opa_t* mask = dsc->mask_buf;
+    if (mask && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP)
+        return;
+    if (dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER)
+        mask = NULL;
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area))
+        return;
+    const int32_t w = lv_area_get_width(&blend_area);
+
+    // Other blend modes, layers with alpha, the mask rounding of disabled anti-aliasing and
+    // opaque image copies (already a memcpy) stay with LVGL
+    if (dsc->blend_mode != LV_BLEND_MODE_NORMAL || disp->driver->set_px_cb ||
+        disp->driver->screen_transp || !disp->driver->antialiasing ||
+        (dsc->src_buf && !mask && dsc->opa >= LV_OPA_MAX) || w > SIMD_DRAW_MAX_W)
+    {
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+
+    if (draw_ctx->wait_for_finish)
+        draw_ctx->wait_for_finish(draw_ctx);
+
+    const lv_area_t* buf_area    = draw_ctx->buf_area;
+    const int32_t    dest_stride = lv_area_get_width(buf_area);
+    lv_color_t*      dest        = (lv_color_t*) draw_ctx->buf;
+    dest += dest_stride * (blend_area.y1 - buf_area->y1) + (blend_area.x1 - buf_area->x1);
+
+    const lv_color_t* src        = dsc->src_buf;
+    int32_t           src_stride = 0;
+    if (src)
+    {
+        src_stride = lv_area_get_width(dsc->blend_area);
+        src += src_stride * (blend_area.y1 - dsc->blend_area->y1) +
+               (blend_area.x1 - dsc->blend_area->x1);
+    }
+
+    int32_t mask_stride = 0;
+    if (mask)
+    {
+        mask_stride = lv_area_get_width(dsc->mask_area);
+        mask += mask_stride * (blend_area.y1 - dsc->mask_area->y1) +
+                (blend_area.x1 - dsc->mask_area->x1);
+    }
+
+    const simd_draw_job_t job = {ctx,         dest,          src, mask,       dest_stride,
+                                 src_stride,  mask_stride,   blend_area.y1, w, dsc->color,
+                                 dsc->opa};
+#if EXAMPLE_USE_PARALLEL_DRAW
+    parallel_draw_rows(simd_draw_rows, (void*) &job, blend_area.y1, blend_area.y2, w);
+#else
+    simd_draw_rows((void*) &job, blend_area.y1, blend_area.y2, 0);
+#endif
+}
+
+void simd_draw_ctx_init(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx)
+{
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+
+    simd_draw_ctx_t* ctx = (simd_draw_ctx_t*) draw_ctx;
+    bool             ok  = true;
+    for (int band = 0; band < SIMD_DRAW_BANDS; band++)
+    {
+        ctx->fg_row[band]  = (lv_color_t*) heap_caps_aligned_alloc(
+            SIMD_DRAW_ALIGN, SIMD_DRAW_MAX_W * sizeof(lv_color_t), MALLOC_CAP_INTERNAL);
+        ctx->mix_row[band] = (uint16_t*) heap_caps_aligned_alloc(
+            SIMD_DRAW_ALIGN, (SIMD_DRAW_MAX_W + SIMD_DRAW_VEC_PX) * sizeof(uint16_t),
+            MALLOC_CAP_INTERNAL);
+        ok = ok && ctx->fg_row[band] && ctx->mix_row[band];
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "No memory for the row buffers, blending stays with LVGL");
+        simd_draw_ctx_deinit(drv, draw_ctx);
+        lv_draw_sw_init_ctx(drv, draw_ctx);
+        return;
+    }
+    ctx->base_sw.blend = simd_draw_blend;
+
+#if CONFIG_IDF_TARGET_ESP32S3
+    static bool tested = false;
+    if (!tested)
+    {
+        tested = true;
+        if (simd_draw_self_test())
+            s_kernels = &pie_kernels;
+        else
+            ESP_LOGE(TAG, "PIE kernels disagree with LVGL, using the scalar ones");
+    }
+#endif
+    ESP_LOGI(TAG, "Blending with the %s kernels", s_kernels->name);
+}
+
+void simd_draw_ctx_deinit(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx)
+{
+    simd_draw_ctx_t* ctx = (simd_draw_ctx_t*) draw_ctx;
+    for (int band = 0; band < SIMD_DRAW_BANDS; band++)
+    {
+        heap_caps_free(ctx->fg_row[band]);
+        heap_caps_free(ctx->mix_row[band]);
+        ctx->fg_row[band]  = NULL;
+        ctx->mix_row[band] = NULL;
+    }
+    lv_draw_sw_deinit_ctx(drv, draw_ctx);
+}
+
+// Deterministic pattern, covers every mix value including 0 and 255
+static uint32_t simd_test_next(uint32_t* seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return *seed >> 8;
+}
+
+bool simd_draw_self_test(void)
+{
+#if CONFIG_IDF_TARGET_ESP32S3
+    alignas(SIMD_DRAW_ALIGN) lv_color_t bg[SIMD_TEST_PX];
+    alignas(SIMD_DRAW_ALIGN) lv_color_t fg[SIMD_TEST_PX];
+    alignas(SIMD_DRAW_ALIGN) uint16_t   mix[SIMD_TEST_PX];
+    alignas(SIMD_DRAW_ALIGN) lv_color_t out_vec[SIMD_TEST_PX];
+    alignas(SIMD_DRAW_ALIGN) lv_color_t out_ref[SIMD_TEST_PX];
+
+    uint32_t seed = 1;
+    for (int round = 0; round < 256 / SIMD_TEST_PX * 4; round++)
+    {
+        for (int i = 0; i < SIMD_TEST_PX; i++)
+        {
+            bg[i].full = simd_test_next(&seed);
+            fg[i].full = simd_test_next(&seed);
+            mix[i]     = (round * SIMD_TEST_PX + i) & 0xFF;
+        }
+
+        // Streamed source and mask, then a repeated color and opacity
+        for (uint32_t step = 0; step <= SIMD_DRAW_ALIGN; step += SIMD_DRAW_ALIGN)
+        {
+            memcpy(out_vec, bg, sizeof(bg));
+            memcpy(out_ref, bg, sizeof(bg));
+            pie_kernels.mix(out_vec, fg, step, mix, step, SIMD_TEST_PX);
+            scalar_kernels.mix(out_ref, fg, step, mix, step, SIMD_TEST_PX);
+            if (memcmp(out_vec, out_ref, sizeof(out_ref)) != 0)
+                return false;
+        }
+
+        pie_kernels.fill(out_vec, fg, SIMD_TEST_PX);
+        scalar_kernels.fill(out_ref, fg, SIMD_TEST_PX);
+        if (memcmp(out_vec, out_ref, sizeof(out_ref)) != 0)
+            return false;
+    }
+#endif
+    return true;
+}
+
+static uint32_t simd_bench_cycles(const simd_draw_kernels_t* k, int kernel, lv_color_t* dst,
+                                  const lv_color_t* fg, const uint16_t* mix,
+                                  const lv_color_t* color_vec, const uint16_t* mix_vec)
+{
+    uint32_t best = UINT32_MAX;
+    for (int round = 0; round < SIMD_BENCH_ROUNDS; round++)
+    {
+        const uint32_t start = esp_cpu_get_cycle_count();
+        switch (kernel)
+        {
+            case 0:
+                k->fill(dst, color_vec, SIMD_BENCH_PX);
+                break;
+            case 1:
+                k->mix(dst, color_vec, 0, mix_vec, 0, SIMD_BENCH_PX);
+                break;
+            case 2:
+                k->mix(dst, color_vec, 0, mix, SIMD_DRAW_ALIGN, SIMD_BENCH_PX);
+                break;
+            default:
+                k->mix(dst, fg, SIMD_DRAW_ALIGN, mix, SIMD_DRAW_ALIGN, SIMD_BENCH_PX);
+                break;
+        }
+        best = LV_MIN(best, esp_cpu_get_cycle_count() - start);
+    }
+    return best;
+}
+
+void simd_draw_benchmark(void)
+{
+    static const char* const kernel_names[] = {"fill", "opacity", "masked fill", "alpha image"};
+
+    lv_color_t* dst = (lv_color_t*) heap_caps_aligned_alloc(
+        SIMD_DRAW_ALIGN, SIMD_BENCH_PX * sizeof(lv_color_t), MALLOC_CAP_INTERNAL);
+    lv_color_t* fg = (lv_color_t*) heap_caps_aligned_alloc(
+        SIMD_DRAW_ALIGN, SIMD_BENCH_PX * sizeof(lv_color_t), MALLOC_CAP_INTERNAL);
+    uint16_t* mix = (uint16_t*) heap_caps_aligned_alloc(
+        SIMD_DRAW_ALIGN, SIMD_BENCH_PX * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    if (!dst || !fg || !mix)
+    {
+        ESP_LOGW(TAG, "No memory for the benchmark");
+        heap_caps_free(dst);
+        heap_caps_free(fg);
+        heap_caps_free(mix);
+        return;
+    }
+
+    uint32_t seed = 1;
+    for (int i = 0; i < SIMD_BENCH_PX; i++)
+    {
+        dst[i].full = simd_test_next(&seed);
+        fg[i].full  = simd_test_next(&seed);
+        mix[i]      = simd_test_next(&seed) & 0xFF;
+    }
+    alignas(SIMD_DRAW_ALIGN) lv_color_t color_vec[SIMD_DRAW_VEC_PX];
+    alignas(SIMD_DRAW_ALIGN) uint16_t   mix_vec[SIMD_DRAW_VEC_PX];
+    for (int i = 0; i < SIMD_DRAW_VEC_PX; i++)
+    {
+        color_vec[i] = lv_color_hex(0x1DB954);
+        mix_vec[i]   = LV_OPA_60;
+    }
+
+    const simd_draw_kernels_t* kernels[] = {
+        &scalar_kernels,
+#if CONFIG_IDF_TARGET_ESP32S3
+        &pie_kernels,
+#endif
+    };
+    ESP_LOGI(TAG, "Cycles per pixel over %d pixels:", SIMD_BENCH_PX);
+    for (int kernel = 0; kernel < 4; kernel++)
+    {
+        for (const simd_draw_kernels_t* k : kernels)
+        {
+            const uint32_t cycles  = simd_bench_cycles(k, kernel, dst, fg, mix, color_vec, mix_vec);
+            const uint32_t per_100 = cycles * 100 / SIMD_BENCH_PX;
+            ESP_LOGI(TAG, "  %-11s %-6s %3" PRIu32 ".%02" PRIu32, kernel_names[kernel], k->name,
+                     per_100 / 100, per_100 % 100);
+        }
+    }
+
+#if EXAMPLE_USE_PARALLEL_DRAW
+    // A translucent wallpaper over a whole stripe, through the same path as a real blend. The row
+    // buffers are missing when the context fell back to LVGL's blend.
+    lv_disp_t* disp = lv_disp_get_default();
+    if (disp && ((simd_draw_ctx_t*) disp->driver->draw_ctx)->fg_row[0])
+    {
+        const simd_draw_job_t job = {(simd_draw_ctx_t*) disp->driver->draw_ctx,
+                                     dst,
+                                     fg,
+                                     NULL,
+                                     EXAMPLE_LCD_H_RES,
+                                     EXAMPLE_LCD_H_RES,
+                                     0,
+                                     0,
+                                     EXAMPLE_LCD_H_RES,
+                                     color_vec[0],
+                                     LV_OPA_60};
+        const int32_t         y2  = SIMD_BENCH_PX / EXAMPLE_LCD_H_RES - 1;
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        simd_draw_rows((void*) &job, 0, y2, 0);
+        const uint32_t one_core = esp_cpu_get_cycle_count() - start;
+        start                   = esp_cpu_get_cycle_count();
+        parallel_draw_rows(simd_draw_rows, (void*) &job, 0, y2, EXAMPLE_LCD_H_RES);
+        const uint32_t two_cores = LV_MAX(esp_cpu_get_cycle_count() - start, 1);
+        ESP_LOGI(TAG, "Stripe blend: %" PRIu32 " cycles on one core, %" PRIu32 " on two (x%" PRIu32
+                      ".%02" PRIu32 ")",
+                 one_core, two_cores, one_core / two_cores, one_core * 100 / two_cores % 100);
+    }
+#endif
+
+    heap_caps_free(dst);
+    heap_caps_free(fg);
+    heap_caps_free(mix);
+}
@@ -0,0 +1,30 @@
+#ifndef SIMD_DRAW_H
+#define SIMD_DRAW_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+#define SIMD_DRAW_BANDS 2 // Row bands blended concurrently, see parallel_draw.h
+
+// Software draw context whose blend step runs on ESP32-S3 PIE vector kernels. Everything else,
+// and blends the kernels do not cover, is left to LVGL's lv_draw_sw.
+typedef struct
+{
+    lv_draw_sw_ctx_t base_sw;
+    lv_color_t*      fg_row[SIMD_DRAW_BANDS];  // 16 byte aligned copies of unaligned source rows
+    uint16_t*        mix_row[SIMD_DRAW_BANDS]; // 16 byte aligned per-pixel mix values
+} simd_draw_ctx_t;
+
+// Pluggable into lv_disp_drv_t::draw_ctx_init / draw_ctx_deinit, with
+// draw_ctx_size = sizeof(simd_draw_ctx_t)
+void simd_draw_ctx_init(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx);
+void simd_draw_ctx_deinit(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx);
+
+// Runs the vector kernels against the scalar ones on synthetic rows. Returns false on any
+// mismatch, the draw context then stays on the scalar kernels.
+bool simd_draw_self_test(void);
+
+// Logs cycles per pixel of every kernel, vector and scalar
+void simd_draw_benchmark(void);
+
+#endif
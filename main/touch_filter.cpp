@@ -0,0 +1,200 @@
+// Touch filtering. The controller reports integer points with a pixel or two of noise, which
+// shows as trembling while a finger rests and as uneven scroll steps. A fixed low-pass would
+// trade that for lag, so the cutoff follows the speed of the finger (the "one euro" filter):
+// slow movement is smoothed heavily, fast movement passes almost untouched. The same filter
+// yields the velocity, used to extrapolate the point over the time until it reaches the panel.
+
+#include <stdio.h>
+#include <math.h>
+#include <inttypes.h>
+#include <algorithm>
+#include "esp_log.h"
+#include "lvgl.h"
+
+#include "touch_filter.h"
+#include "user_config.h"
+
+static const char* TAG = "touch_filter";
+
+static touch_sample_t s_trace[EXAMPLE_TOUCH_TRACE_LEN];
+static uint32_t       s_trace_cnt;
+
+static inline float touch_filter_alpha(float cutoff_hz, float dt)
+{
+    const float tau = 1.0f / (2.0f * (float) M_PI * cutoff_hz);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+// The controller reports every few ms while the finger moves. A sample overdue by half the last
+// interval means the finger stopped: the velocity is stale and fades out over one more interval.
+static inline float touch_filter_fade(int64_t age_us, int64_t period_us)
+{
+    if (period_us <= 0)
+        return 1.0f;
+    return LV_CLAMP(0.0f, 2.5f - (float) age_us / period_us, 1.0f);
+}
+
+void touch_filter_init(touch_filter_t* filter, const touch_filter_config_t* config)
+{
+    static const touch_filter_config_t defaults = {
+        .min_cutoff_hz  = EXAMPLE_TOUCH_FILTER_MIN_CUTOFF,
+        .beta           = EXAMPLE_TOUCH_FILTER_BETA,
+        .d_cutoff_hz    = EXAMPLE_TOUCH_FILTER_D_CUTOFF,
+        .predict_ms     = EXAMPLE_TOUCH_PREDICT_MS,
+        .predict_max_px = EXAMPLE_TOUCH_PREDICT_MAX_PX,
+    };
+    filter->config    = config ? *config : defaults;
+    filter->point     = {};
+    filter->raw_x     = 0;
+    filter->raw_y     = 0;
+    filter->seq       = 0;
+    filter->period_us = 0;
+}
+
+bool touch_filter_update(touch_filter_t* filter, const touch_sample_t* sample)
+{
+    touch_point_t* p = &filter->point;
+    if (sample->seq == filter->seq)
+        return false;
+    filter->seq = sample->seq;
+
+    // A new touch starts where the finger landed, at rest
+    if (sample->pressed && !p->pressed)
+    {
+        p->x              = sample->x;
+        p->y              = sample->y;
+        p->vx             = 0;
+        p->vy             = 0;
+        filter->period_us = 0;
+    }
+    else if (sample->pressed)
+    {
+        // Late after the previous sample: the finger stopped in between
+        const int64_t dt_us = sample->time_us - p->time_us;
+        const float   fade  = touch_filter_fade(dt_us, filter->period_us);
+        p->vx *= fade;
+        p->vy *= fade;
+        filter->period_us = dt_us;
+
+        const float dt = LV_MAX(dt_us, 1000) / 1e6f;
+        const float ad = touch_filter_alpha(filter->config.d_cutoff_hz, dt);
+        p->vx += ad * ((sample->x - filter->raw_x) / dt - p->vx);
+        p->vy += ad * ((sample->y - filter->raw_y) / dt - p->vy);
+
+        const float speed = sqrtf(p->vx * p->vx + p->vy * p->vy);
+        const float a =
+            touch_filter_alpha(filter->config.min_cutoff_hz + filter->config.beta * speed, dt);
+        p->x += a * (sample->x - p->x);
+        p->y += a * (sample->y - p->y);
+    }
+    if (sample->pressed)
+    {
+        filter->raw_x = sample->x;
+        filter->raw_y = sample->y;
+    }
+    // A lift keeps the last filtered point, LVGL releases where the finger was last seen
+    p->pressed = sample->pressed;
+    p->time_us = sample->time_us;
+    return true;
+}
+
+void touch_filter_get(const touch_filter_t* filter, int64_t now_us, touch_point_t* point)
+{
+    *point = filter->point;
+    if (!point->pressed || filter->config.predict_ms == 0)
+        return;
+
+    // The sample has aged since it was read, and the frame still has to reach the panel
+    const int64_t age_us = LV_MAX(now_us - point->time_us, 0);
+    const float   fade   = touch_filter_fade(age_us, filter->period_us);
+    const float   ahead  = (age_us / 1000.0f + filter->config.predict_ms) / 1000.0f * fade;
+    float         dx     = point->vx * ahead;
+    float         dy     = point->vy * ahead;
+    const float   dist   = sqrtf(dx * dx + dy * dy);
+    if (dist > filter->config.predict_max_px)
+    {
+        dx *= filter->config.predict_max_px / dist;
+        dy *= filter->config.predict_max_px / dist;
+    }
+    point->x = LV_CLAMP(0.0f, point->x + dx, EXAMPLE_LCD_H_RES - 1.0f);
+    point->y = LV_CLAMP(0.0f, point->y + dy, EXAMPLE_LCD_V_RES - 1.0f);
+}
+
+void touch_filter_trace_record(const touch_sample_t* sample)
+{
+    s_trace[s_trace_cnt++ % EXAMPLE_TOUCH_TRACE_LEN] = *sample;
+}
+
+void touch_filter_trace_dump(const touch_filter_config_t* config)
+{
+    const uint32_t n = LV_MIN(s_trace_cnt, (uint32_t) EXAMPLE_TOUCH_TRACE_LEN);
+    // Oldest sample first, so the ring can be replayed as is
+    std::rotate(s_trace, s_trace + s_trace_cnt % EXAMPLE_TOUCH_TRACE_LEN, s_trace + n);
+    s_trace_cnt = n;
+
+    ESP_LOGI(TAG, "Touch trace, %" PRIu32 " samples {x, y, pressed, time_us, seq}:", n);
+    for (uint32_t i = 0; i < n; i++)
+        printf("{%u, %u, %d, %" PRId64 ", %" PRIu32 "},\n", s_trace[i].x, s_trace[i].y,
+               s_trace[i].pressed, s_trace[i].time_us, s_trace[i].seq);
+
+    touch_filter_replay_stats_t stats;
+    touch_filter_replay(s_trace, n, config, &stats);
+    ESP_LOGI(TAG, "Replay: lag %.2f px, jitter %.2f px (raw %.2f px) over %" PRIu32 " samples",
+             stats.lag_px, stats.jitter_px, stats.raw_jitter_px, stats.samples);
+}
+
+void touch_filter_replay(const touch_sample_t* samples, uint32_t count,
+                         const touch_filter_config_t* config, touch_filter_replay_stats_t* stats)
+{
+    touch_filter_t filter;
+    touch_filter_init(&filter, config);
+    *stats = {};
+
+    // Second differences need the two previous points of the same touch
+    float    fx[2] = {};
+    float    fy[2] = {};
+    float    rx[2] = {};
+    float    ry[2] = {};
+    uint32_t run   = 0;
+    uint32_t steps = 0;
+    float    lag   = 0;
+    float    jit   = 0;
+    float    raw   = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        touch_filter_update(&filter, &samples[i]);
+        if (!samples[i].pressed)
+        {
+            run = 0;
+            continue;
+        }
+        touch_point_t p;
+        touch_filter_get(&filter, samples[i].time_us, &p);
+        const float x = samples[i].x;
+        const float y = samples[i].y;
+        lag += sqrtf((p.x - x) * (p.x - x) + (p.y - y) * (p.y - y));
+        stats->samples++;
+        if (run >= 2)
+        {
+            jit += fabsf(p.x - 2 * fx[1] + fx[0]) + fabsf(p.y - 2 * fy[1] + fy[0]);
+            raw += fabsf(x - 2 * rx[1] + rx[0]) + fabsf(y - 2 * ry[1] + ry[0]);
+            steps++;
+        }
+        fx[0] = fx[1];
+        fy[0] = fy[1];
+        rx[0] = rx[1];
+        ry[0] = ry[1];
+        fx[1] = p.x;
+        fy[1] = p.y;
+        rx[1] = x;
+        ry[1] = y;
+        run++;
+    }
+    if (stats->samples)
+        stats->lag_px = lag / stats->samples;
+    if (steps)
+    {
+        stats->jitter_px     = jit / steps;
+        stats->raw_jitter_px = raw / steps;
+    }
+}
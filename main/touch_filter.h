@@ -0,0 +1,67 @@
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include <stdint.h>
+#include "touch_sampler.h"
+
+typedef struct
+{
+    float    min_cutoff_hz; // Cutoff while the finger rests, lower means less jitter
+    float    beta;          // Cutoff added per px/s of speed, higher means less lag
+    float    d_cutoff_hz;   // Cutoff of the velocity estimate
+    uint32_t predict_ms;    // Extrapolation ahead of the latest sample, 0 for none
+    float    predict_max_px;
+} touch_filter_config_t;
+
+typedef struct
+{
+    float   x; // Filtered, and extrapolated when asked for
+    float   y;
+    float   vx; // px/s
+    float   vy;
+    bool    pressed;
+    int64_t time_us; // Time of the latest sample
+} touch_point_t;
+
+// Adaptive low-pass ("one euro") filter: heavy smoothing at rest, little lag in fast moves
+typedef struct
+{
+    touch_filter_config_t config;
+    touch_point_t         point;
+    float                 raw_x; // Previous sample, the velocity is taken from raw deltas
+    float                 raw_y;
+    uint32_t              seq;       // Last sample taken
+    int64_t               period_us; // Between the last two samples of the touch
+} touch_filter_t;
+
+typedef struct
+{
+    uint32_t samples;
+    float    lag_px;    // Mean distance between filtered and raw points while pressed
+    float    jitter_px; // Mean second difference of the points, raw vs filtered
+    float    raw_jitter_px;
+} touch_filter_replay_stats_t;
+
+// `config` NULL takes the EXAMPLE_TOUCH_FILTER_* defaults of user_config.h
+void touch_filter_init(touch_filter_t* filter, const touch_filter_config_t* config);
+
+// Feeds a sample, samples already seen (same seq) are ignored. Returns true for a new sample.
+bool touch_filter_update(touch_filter_t* filter, const touch_sample_t* sample);
+
+// Filtered point, extrapolated along the velocity to `now_us` plus config.predict_ms. Without a
+// new sample for well over the interval of the last two, the finger has likely stopped and the
+// extrapolation fades out.
+void touch_filter_get(const touch_filter_t* filter, int64_t now_us, touch_point_t* point);
+
+// Keeps the raw samples of the last touches in a ring, see touch_filter_trace_dump()
+void touch_filter_trace_record(const touch_sample_t* sample);
+
+// Logs the recorded samples as touch_sample_t initializers, ready to be pasted into a replay,
+// followed by the lag and jitter of replaying them with `config` (NULL for the defaults)
+void touch_filter_trace_dump(const touch_filter_config_t* config);
+
+// Runs a recorded trace through a fresh filter and measures lag against jitter
+void touch_filter_replay(const touch_sample_t* samples, uint32_t count,
+                         const touch_filter_config_t* config, touch_filter_replay_stats_t* stats);
+
+#endif
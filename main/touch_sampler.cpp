@@ -0,0 +1,170 @@
+// Interrupt-driven touch sampling. The controller pulls INT low when it has a new point, about
+// every 10 ms while a finger is down and not at all otherwise. A task reads the controller only
+// after such an edge and publishes the sample through a sequence lock, so the LVGL read callback
+// gets the latest point without waiting on the I2C bus.
+//
+// A lift is not always announced by an edge, so while pressed the task reads once more when the
+// edges stop for EXAMPLE_TOUCH_RELEASE_MS.
+
+#include <inttypes.h>
+#include <atomic>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "touch_sampler.h"
+#include "lcd_touch_bsp.h"
+#include "i2c_bsp.h"
+#include "user_config.h"
+#if EXAMPLE_USE_POWER_MANAGER
+#include "power_manager.h"
+#endif
+
+static const char* TAG = "touch_sampler";
+
+#define TOUCH_SAMPLER_STACK_SIZE (3 * 1024)
+
+static TaskHandle_t          s_task = NULL;
+static bool                  s_irq  = false;
+static volatile int64_t      s_edge_us;
+static std::atomic<uint32_t> s_seq(0); // Odd while the sample is being written
+static touch_sample_t        s_sample;
+static touch_sampler_stats_t s_stats;
+static int64_t               s_report_us;
+
+static void IRAM_ATTR touch_sampler_isr(void* arg)
+{
+    BaseType_t woken = pdFALSE;
+    s_edge_us        = esp_timer_get_time();
+    s_stats.edges++;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void touch_sampler_publish(const touch_sample_t* sample)
+{
+    const uint32_t seq = s_seq.load(std::memory_order_relaxed);
+    s_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s_sample     = *sample;
+    s_sample.seq = seq / 2 + 1;
+    s_seq.store(seq + 2, std::memory_order_release);
+}
+
+void touch_sampler_get(touch_sample_t* sample)
+{
+    uint32_t seq;
+    do
+    {
+        seq     = s_seq.load(std::memory_order_acquire);
+        *sample = s_sample;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != s_seq.load(std::memory_order_relaxed));
+    s_stats.snapshots++;
+}
+
+static void touch_sampler_task(void* arg)
+{
+    touch_sample_t sample = {};
+    while (1)
+    {
+        TickType_t wait = portMAX_DELAY;
+        if (!s_irq)
+            wait = pdMS_TO_TICKS(CONFIG_LV_INDEV_DEF_READ_PERIOD);
+        else if (sample.pressed)
+            wait = pdMS_TO_TICKS(EXAMPLE_TOUCH_RELEASE_MS);
+        const bool edge = ulTaskNotifyTake(pdTRUE, wait) > 0;
+        if (!edge && s_irq)
+            s_stats.release_polls++;
+
+        const int64_t start = esp_timer_get_time();
+        sample.pressed      = tpGetCoordinates(&sample.x, &sample.y);
+        const int64_t end   = esp_timer_get_time();
+        sample.time_us      = edge ? s_edge_us : start;
+        s_stats.reads++;
+        s_stats.read_us += end - start;
+        touch_sampler_publish(&sample);
+#if EXAMPLE_USE_POWER_MANAGER
+        if (sample.pressed)
+            power_manager_wake(sample.time_us);
+#endif
+
+#if EXAMPLE_TOUCH_REPORT_MS
+        if (!sample.pressed && end - s_report_us >= EXAMPLE_TOUCH_REPORT_MS * 1000LL)
+        {
+            touch_sampler_report();
+            s_report_us = end;
+        }
+#endif
+    }
+}
+
+bool touch_sampler_init(void)
+{
+    const gpio_config_t int_conf = {
+        .pin_bit_mask = 1ULL << EXAMPLE_PIN_NUM_TOUCH_INT,
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_NEGEDGE,
+    };
+    s_stats.since_us = esp_timer_get_time();
+    s_report_us      = s_stats.since_us;
+    if (xTaskCreatePinnedToCore(touch_sampler_task, "touch", TOUCH_SAMPLER_STACK_SIZE, NULL,
+                                EXAMPLE_TOUCH_TASK_PRIORITY, &s_task,
+                                EXAMPLE_LVGL_TASK_CORE ? 0 : 1) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start the touch task");
+        return false;
+    }
+
+    esp_err_t err = gpio_config(&int_conf);
+    if (err == ESP_OK)
+    {
+        // Other drivers may have installed the shared ISR service already
+        err = gpio_install_isr_service(0);
+        if (err == ESP_ERR_INVALID_STATE)
+            err = ESP_OK;
+    }
+    if (err == ESP_OK)
+        err = gpio_isr_handler_add(EXAMPLE_PIN_NUM_TOUCH_INT, touch_sampler_isr, NULL);
+    s_irq = err == ESP_OK;
+    if (!s_irq)
+        ESP_LOGW(TAG, "No touch interrupt (%s), polling every %d ms", esp_err_to_name(err),
+                 CONFIG_LV_INDEV_DEF_READ_PERIOD);
+    // The task may already sleep with portMAX_DELAY, or poll without knowing about the interrupt
+    xTaskNotifyGive(s_task);
+    return true;
+}
+
+void touch_sampler_get_stats(touch_sampler_stats_t* stats)
+{
+    *stats = s_stats;
+}
+
+void touch_sampler_report(void)
+{
+    touch_sampler_stats_t stats;
+    touch_sampler_get_stats(&stats);
+    const int64_t elapsed_us = esp_timer_get_time() - stats.since_us;
+    if (elapsed_us <= 0 || stats.reads == 0)
+        return;
+
+    // Polling reads the controller on every LVGL indev read, touched or not
+    const uint64_t read_avg_us = stats.read_us / stats.reads;
+    const uint64_t poll_reads  = elapsed_us / (CONFIG_LV_INDEV_DEF_READ_PERIOD * 1000);
+    ESP_LOGI(TAG,
+             "%" PRIu32 " reads (%" PRIu32 " release polls) for %" PRIu32 " edges, %" PRIu64
+             " us per read, %" PRIu32 " LVGL reads served from the snapshot",
+             stats.reads, stats.release_polls, stats.edges, read_avg_us, stats.snapshots);
+    ESP_LOGI(TAG, "Bus busy %" PRIu64 ".%02" PRIu64 " %%, polling would be %" PRIu64 ".%02" PRIu64
+                  " %% (%" PRIu64 " reads)",
+             stats.read_us * 100 / elapsed_us, stats.read_us * 10000 / elapsed_us % 100,
+             poll_reads * read_avg_us * 100 / elapsed_us,
+             poll_reads * read_avg_us * 10000 / elapsed_us % 100, poll_reads);
+    i2c_bsp_report();
+}
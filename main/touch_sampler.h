@@ -0,0 +1,37 @@
+#ifndef TOUCH_SAMPLER_H
+#define TOUCH_SAMPLER_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint16_t x; // Panel coordinates, as reported by the controller
+    uint16_t y;
+    bool     pressed;
+    int64_t  time_us; // INT edge that announced the sample, read time for polled samples
+    uint32_t seq;     // Increments with every published sample
+} touch_sample_t;
+
+typedef struct
+{
+    uint32_t edges;         // INT falling edges
+    uint32_t reads;         // Controller reads, one per handled edge or poll
+    uint32_t release_polls; // Reads because the edges stopped while pressed
+    uint32_t snapshots;     // Samples handed to LVGL without touching the bus
+    uint64_t read_us;       // Bus time spent reading the controller
+    uint64_t since_us;      // Start of the statistics
+} touch_sampler_stats_t;
+
+// Reads the controller from a task, woken by EXAMPLE_PIN_NUM_TOUCH_INT. Without the interrupt the
+// task polls at the LVGL indev read period instead.
+bool touch_sampler_init(void);
+
+// Copies the latest sample. Lock-free, never blocks and never touches the bus.
+void touch_sampler_get(touch_sample_t* sample);
+
+void touch_sampler_get_stats(touch_sampler_stats_t* stats);
+
+// Logs reads per second and bus utilisation next to what polling at the LVGL read period costs
+void touch_sampler_report(void);
+
+#endif
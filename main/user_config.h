@@ -9,6 +9,17 @@
 #define ESP32_SCL_NUM (GPIO_NUM_12)
 #define ESP32_SDA_NUM (GPIO_NUM_11)
 
+// Every transaction runs on a bus task, touch first, then haptics, then the rest
+#define EXAMPLE_I2C_TASK_PRIORITY       (EXAMPLE_TOUCH_TASK_PRIORITY + 1)
+#define EXAMPLE_I2C_SPEED_HZ            300000
+#define EXAMPLE_I2C_TOUCH_DEADLINE_MS   5   // Allowance on top of the transfer time
+#define EXAMPLE_I2C_DEADLINE_MS         5   // Other devices, also the longest a touch read waits
+#define EXAMPLE_I2C_BACKOFF_MIN_MS      10  // A failing device is skipped this long, doubling
+#define EXAMPLE_I2C_BACKOFF_MAX_MS      2000
+#define EXAMPLE_I2C_RESET_AFTER         3   // Touch failures in a row before a reset
+#define EXAMPLE_I2C_TOUCH_RESET_MS      5   // RST held low
+#define EXAMPLE_I2C_TOUCH_BOOT_MS       100 // Left alone after a reset
+
 
 //  DISP
 // The pixel number in horizontal and vertical
@@ -16,6 +27,27 @@
 #define EXAMPLE_LCD_V_RES              360
 #define EXAMPLE_LVGL_BUF_HEIGHT        (EXAMPLE_LCD_V_RES / 10)
 
+// The SH8601 glass is circular, only the inscribed circle of the panel is visible
+#define EXAMPLE_USE_ROUND_MASK         1 // Clip rendering and flushing to the visible circle
+#define EXAMPLE_ROUND_MASK_BAND_ROWS   6 // Rows per flushed band, must be even
+
+// Scrolled lists shift already rendered rows of a retained framebuffer in PSRAM
+#define EXAMPLE_USE_SCROLL_BLIT        1
+#define EXAMPLE_SCROLL_BLIT_BAND_ROWS  16 // Rows per bounce buffer, must be even
+
+// Blends of the software renderer run on the ESP32-S3 vector unit (PIE)
+#define EXAMPLE_USE_SIMD_DRAW          1
+#define EXAMPLE_SIMD_DRAW_BENCHMARK    0 // Log cycles per pixel of every kernel at boot
+
+// Large blends are split into two row bands rendered on both cores, needs EXAMPLE_USE_SIMD_DRAW
+#define EXAMPLE_USE_PARALLEL_DRAW      1
+#define EXAMPLE_PARALLEL_DRAW_MIN_PX   (EXAMPLE_LCD_H_RES * 8) // Smaller blends stay on one core
+
+// Large copies into internal RAM run on the GDMA (esp_async_memcpy), smaller ones on the CPU
+#define EXAMPLE_USE_DMA_COPY           1
+#define EXAMPLE_DMA_COPY_MIN_BYTES     2048
+#define EXAMPLE_DMA_COPY_BENCHMARK     0 // Log CPU and DMA copy times at boot
+
 #define EXAMPLE_PIN_NUM_LCD_CS      (gpio_num_t)14
 #define EXAMPLE_PIN_NUM_LCD_PCLK    (gpio_num_t)13
 #define EXAMPLE_PIN_NUM_LCD_DATA0   (gpio_num_t)15
@@ -29,21 +61,140 @@
 #define EXAMPLE_PIN_NUM_TOUCH_RST         (gpio_num_t)10
 #define EXAMPLE_PIN_NUM_TOUCH_INT         (gpio_num_t)9
 
+#define EXAMPLE_DRV2605_ADDR              0x5A // Haptic driver, on the touch I2C bus
+
 
 #define EXAMPLE_LVGL_TICK_PERIOD_MS    2
 #define EXAMPLE_LVGL_TASK_MAX_DELAY_MS 500
 #define EXAMPLE_LVGL_TASK_MIN_DELAY_MS 5
 #define EXAMPLE_LVGL_TASK_STACK_SIZE   (4 * 1024)
 #define EXAMPLE_LVGL_TASK_PRIORITY     2
+#define EXAMPLE_LVGL_TASK_CORE         1
+
+// Panel and I2C bring-up on tasks of their own while LVGL and the screens are set up
+#define EXAMPLE_BOOT_PARALLEL          1 // 0 runs the same stages in order, the baseline of boot.cpp
+#define EXAMPLE_BOOT_TASK_PRIORITY     (EXAMPLE_LVGL_TASK_PRIORITY + 1)
+#define EXAMPLE_BOOT_TASK_STACK_SIZE   (4 * 1024)
+#define EXAMPLE_BOOT_REPORT            1 // Log the stages and the time to the first frame
+
+// Panel init commands sent back to back, 0 for the SH8601 driver's esp_lcd_panel_init() to compare
+#define EXAMPLE_PANEL_INIT_PLAYER      1
+
+// Refresh rate follows what is on the screen instead of the fixed CONFIG_LV_DISP_DEF_REFR_PERIOD
+#define EXAMPLE_USE_REFRESH_GOVERNOR   1
+#define EXAMPLE_REFR_ACTIVE_PERIOD_MS  16   // ~60 Hz while animating or touched
+#define EXAMPLE_REFR_SETTLE_PERIOD_MS  33   // ~30 Hz right after the last input
+#define EXAMPLE_REFR_IDLE_PERIOD_MS    1000 // Static screens
+#define EXAMPLE_REFR_SETTLE_TIME_MS    1500 // Inactivity before a screen counts as static
+#define EXAMPLE_REFR_SESSION_MS        (5 * 60 * 1000) // Statistics report interval, 0 for none
+
+// Drops expensive effects in tiers when frames take longer than the budget
+#define EXAMPLE_USE_QUALITY_GOVERNOR   1
+#define EXAMPLE_QUALITY_BUDGET_MS      EXAMPLE_REFR_ACTIVE_PERIOD_MS
+#define EXAMPLE_QUALITY_WINDOW         16 // Frames per decision
+#define EXAMPLE_QUALITY_MIN_PX         (EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES / 8) // Smaller frames are ignored
 
 #define EXAMPLE_USE_TOUCH  1 //Without tp ---- Touch off
 
-// #define Backlight_Testing
-// #define EXAMPLE_Rotate_90
+// The touch controller is read after its INT edge by a task instead of on every LVGL indev read
+#define EXAMPLE_USE_TOUCH_IRQ          1
+#define EXAMPLE_TOUCH_TASK_PRIORITY    (EXAMPLE_LVGL_TASK_PRIORITY + 1)
+#define EXAMPLE_TOUCH_RELEASE_MS       40 // No edge for this long while pressed, read once more
+#define EXAMPLE_TOUCH_REPORT_MS        (5 * 60 * 1000) // Bus statistics report interval, 0 for none
+
+// Touch points pass an adaptive jitter filter and are extrapolated over the display latency
+#define EXAMPLE_USE_TOUCH_FILTER        1
+#define EXAMPLE_TOUCH_FILTER_MIN_CUTOFF 1.5f  // Hz, while the finger rests
+#define EXAMPLE_TOUCH_FILTER_BETA       0.01f // Hz added per px/s
+#define EXAMPLE_TOUCH_FILTER_D_CUTOFF   4.0f  // Hz, velocity estimate
+#define EXAMPLE_TOUCH_PREDICT_MS        EXAMPLE_REFR_ACTIVE_PERIOD_MS // One frame ahead, 0 for none
+#define EXAMPLE_TOUCH_PREDICT_MAX_PX    24.0f
+#define EXAMPLE_TOUCH_TRACE_LEN         512 // Raw samples kept for replay
+#define EXAMPLE_TOUCH_TRACE_DUMP        0   // Log the trace and its replay after every touch
+
+// Swipes, long presses and jogs along the bezel, recognized next to the LVGL touch indev
+#define EXAMPLE_USE_GESTURES            1
+#define EXAMPLE_GESTURE_SLOP_PX         12  // Movement that still counts as holding still
+#define EXAMPLE_GESTURE_LONG_PRESS_MS   600
+#define EXAMPLE_GESTURE_SWIPE_MIN_PX    80
+#define EXAMPLE_GESTURE_SWIPE_MAX_MS    400
+#define EXAMPLE_GESTURE_JOG_RING_PX     50  // Width of the ring along the bezel a jog starts in
+#define EXAMPLE_GESTURE_JOG_START_DEG   20  // Travel around the center before a jog locks in
+
+// #define Backlight_Testing // Steps through the levels, fading with EXAMPLE_USE_BACKLIGHT
+#define EXAMPLE_ROTATION_DEFAULT 0 // 0, 90, 180 or 270 until display_set_rotation() saved one
 
 //encoder
 #define EXAMPLE_ENCODER_ECA_PIN    8
 #define EXAMPLE_ENCODER_ECB_PIN    7
+#define EXAMPLE_ENCODER_USE_PCNT   1 // Count detents with the PCNT instead of sampling every 3 ms,
+                                     // on the press edge instead of the release
+
+// The knob as an LVGL encoder indev, turning faster moves more steps per detent
+#define EXAMPLE_USE_ENCODER_INDEV       1
+#define EXAMPLE_ENCODER_ACCEL_MIN_RATE  8.0f  // Detents/s up to which a detent is one step
+#define EXAMPLE_ENCODER_ACCEL_MAX_RATE  40.0f // Detents/s at which the gain peaks
+#define EXAMPLE_ENCODER_ACCEL_MAX_GAIN  24.0f // Steps per detent at full speed, 1 for none
+
+// Time from the touch INT edge or knob detent to the flush of the response, per screen and input
+#define EXAMPLE_USE_INPUT_LATENCY          1
+#define EXAMPLE_INPUT_LATENCY_SCREENS      8    // Screens named for the report
+#define EXAMPLE_INPUT_LATENCY_TIMEOUT_MS   500  // A response not flushed by then is dropped
+#define EXAMPLE_INPUT_LATENCY_REPORT_MS    (5 * 60 * 1000) // Report interval, 0 for none
+#define EXAMPLE_INPUT_LATENCY_SIM_CYCLES   0    // Cycles of scripted input instead of the hardware
+#define EXAMPLE_INPUT_LATENCY_SIM_DELAY_MS 5000 // Time to bring up the screen to measure
+
+// Haptic feedback for detents and button presses, played by a task from a queue
+#define EXAMPLE_USE_HAPTICS             1
+#define EXAMPLE_HAPTICS_TASK_PRIORITY   (EXAMPLE_LVGL_TASK_PRIORITY - 1)
+#define EXAMPLE_HAPTICS_LIBRARY         1   // DRV2605 effect library, 1-5 for ERM, 6 for LRA
+#define EXAMPLE_HAPTICS_LRA             0   // Motor is a linear resonant actuator, not an ERM
+#define EXAMPLE_HAPTICS_POLL_MS         20  // GO bit read back while an effect plays
+#define EXAMPLE_HAPTICS_TIMEOUT_MS      500 // Longest a sequence is waited for
+
+// Backlight fades in LEDC hardware along a perceptual curve, dims when idle and wakes on input
+#define EXAMPLE_USE_BACKLIGHT           1
+#define EXAMPLE_BACKLIGHT_TASK_PRIORITY (EXAMPLE_LVGL_TASK_PRIORITY - 1)
+#define EXAMPLE_BACKLIGHT_LEVEL         255   // Perceived brightness while in use, 0-255
+#define EXAMPLE_BACKLIGHT_DIM_LEVEL     48    // Perceived brightness when idle
+#define EXAMPLE_BACKLIGHT_DIM_AFTER_MS  30000 // Without input, 0 to never dim
+#define EXAMPLE_BACKLIGHT_WAKE_MS       150   // Fade up on input
+#define EXAMPLE_BACKLIGHT_DIM_MS        2000  // Fade down when idle
+#define EXAMPLE_BACKLIGHT_GAMMA         2.2f
+#define EXAMPLE_BACKLIGHT_SEGMENTS      4     // Linear hardware fades along the curve per fade
+
+// DFS and automatic light sleep while the UI is idle, waking on the touch INT or the knob. Needs
+// EXAMPLE_USE_REFRESH_GOVERNOR, CONFIG_PM_ENABLE, CONFIG_PM_LIGHT_SLEEP_CALLBACKS and
+// CONFIG_FREERTOS_USE_TICKLESS_IDLE, the build stops without them. sdkconfig.defaults sets them,
+// but the committed sdkconfig predates it: off until sdkconfig is regenerated (delete it and
+// build). Without EXAMPLE_USE_TOUCH_IRQ the touch indev reads go on while idle.
+#ifndef EXAMPLE_USE_POWER_MANAGER
+#define EXAMPLE_USE_POWER_MANAGER      0
+#endif
+#define EXAMPLE_PM_MIN_FREQ_MHZ        80 // While idle, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ otherwise
+#define EXAMPLE_PM_LIGHT_SLEEP         1  // Needs CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+#define EXAMPLE_PM_REPORT_MS           (5 * 60 * 1000) // Residency report interval, 0 for none
+
+// Panel power estimated from the flushed pixels. The figures are rough, calibrate with a meter.
+#define EXAMPLE_USE_AMOLED_POWER       1
+#define EXAMPLE_AMOLED_SAMPLE_STEP     6    // Every n-th pixel of both axes is sampled
+#define EXAMPLE_AMOLED_SAMPLE_MS       1000 // Estimate period on static screens
+#define EXAMPLE_AMOLED_STATIC_MW       30   // Panel with every pixel off
+#define EXAMPLE_AMOLED_RED_MW          120  // Added by a full red screen at full brightness
+#define EXAMPLE_AMOLED_GREEN_MW        100
+#define EXAMPLE_AMOLED_BLUE_MW         200
+#define EXAMPLE_AMOLED_REPORT_MS       (5 * 60 * 1000) // Report interval, 0 for none
+
+// Dims large bright backgrounds and later shows an always-on clock while there is no input
+#define EXAMPLE_USE_AMOLED_SAVER            1
+#define EXAMPLE_AMOLED_SAVER_AFTER_MS       20000
+#define EXAMPLE_AMOLED_SAVER_MIN_PX         (EXAMPLE_LCD_H_RES * 32) // Smaller ones stay
+#define EXAMPLE_AMOLED_SAVER_MIN_BRIGHTNESS 96  // lv_color_brightness() of the background
+#define EXAMPLE_AMOLED_SAVER_OPA_SCALE      25  // Percent of the background opacity kept
+#define EXAMPLE_AMOLED_SAVER_MAX_OBJS       16
+#define EXAMPLE_AMOLED_CLOCK_AFTER_MS       (2 * 60 * 1000) // 0 for no clock
+#define EXAMPLE_AMOLED_CLOCK_COLOR          0x808080
+#define EXAMPLE_AMOLED_CLOCK_SHIFT_PX       4   // Per minute, against burn-in
 
 //bit
 #define SET_BIT(reg,bit) (reg |= ((uint32_t)0x01<<bit))